@@ -29,7 +29,11 @@ void CPDF_ModuleMgr::Destroy() {
   g_pDefaultMgr = nullptr;
 }
 
-CPDF_ModuleMgr::CPDF_ModuleMgr() : m_pCodecModule(nullptr) {}
+CPDF_ModuleMgr::CPDF_ModuleMgr()
+    : m_pCodecModule(nullptr),
+      m_bPrefetchObjectStreams(false),
+      m_nObjectStreamCacheLimit(0),
+      m_bUseObjectArena(false) {}
 
 CPDF_ModuleMgr::~CPDF_ModuleMgr() {}
 
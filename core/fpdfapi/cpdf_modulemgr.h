@@ -64,6 +64,22 @@ class CPDF_ModuleMgr {
   CCodec_IccModule* GetIccModule();
   CCodec_FlateModule* GetFlateModule();
 
+  // Object stream handling for documents parsed afterwards. See
+  // FPDF_LIBRARY_CONFIG.
+  void SetPrefetchObjectStreams(bool bPrefetch) {
+    m_bPrefetchObjectStreams = bPrefetch;
+  }
+  bool GetPrefetchObjectStreams() const { return m_bPrefetchObjectStreams; }
+  void SetObjectStreamCacheLimit(size_t nBytes) {
+    m_nObjectStreamCacheLimit = nBytes;
+  }
+  size_t GetObjectStreamCacheLimit() const { return m_nObjectStreamCacheLimit; }
+
+  // Whether documents opened afterwards allocate their parsed objects from a
+  // CPDF_ObjectArena.
+  void SetUseObjectArena(bool bUseArena) { m_bUseObjectArena = bUseArena; }
+  bool GetUseObjectArena() const { return m_bUseObjectArena; }
+
  private:
   CPDF_ModuleMgr();
   ~CPDF_ModuleMgr();
@@ -71,6 +87,9 @@ class CPDF_ModuleMgr {
   CCodec_ModuleMgr* m_pCodecModule;
   std::unique_ptr<CPDF_PageModule> m_pPageModule;
   std::unique_ptr<CFSDK_UnsupportInfo_Adapter> m_pUnsupportInfoAdapter;
+  bool m_bPrefetchObjectStreams;
+  size_t m_nObjectStreamCacheLimit;
+  bool m_bUseObjectArena;
 };
 
 #endif  // CORE_FPDFAPI_CPDF_MODULEMGR_H_
@@ -19,12 +19,16 @@ class CPDF_Dictionary;
 class CPDF_Document;
 class CPDF_Object;
 class CPDF_Parser;
+class CPDF_StreamCompressor;
 class CPDF_XRefStream;
 
 #define FPDFCREATE_INCREMENTAL 1
 #define FPDFCREATE_NO_ORIGINAL 2
 #define FPDFCREATE_PROGRESSIVE 4
 #define FPDFCREATE_OBJECTSTREAM 8
+// Compress streams on the CFX_ThreadPool workers ahead of writing them. The
+// output is the same either way.
+#define FPDFCREATE_PARALLEL_COMPRESS 16
 
 CFX_ByteTextBuf& operator<<(CFX_ByteTextBuf& buf, const CPDF_Object* pObj);
 
@@ -38,6 +42,15 @@ class CPDF_Creator {
   int32_t Continue(IFX_Pause* pPause = nullptr);
   bool SetFileVersion(int32_t fileVersion = 17);
 
+  // Sets how many objects FPDFCREATE_OBJECTSTREAM packs into each object
+  // stream, at most. Returns false, leaving the default of 200, if |count|
+  // is not positive.
+  bool SetObjectStreamSize(int32_t count);
+
+  // Sets the zlib level, from 0 to 9, for the streams this compresses.
+  // Returns false, leaving the default of -1, if |level| is out of range.
+  bool SetCompressionLevel(int level);
+
  private:
   friend class CPDF_ObjectStream;
   friend class CPDF_XRefStream;
@@ -49,6 +62,7 @@ class CPDF_Creator {
   void InitOldObjNumOffsets();
   void InitNewObjNumOffsets();
   void InitID(bool bDefault = true);
+  void InitStreamCompressor();
 
   void AppendNewObjNum(uint32_t objbum);
   int32_t AppendObjectNumberToXRef(uint32_t objnum);
@@ -86,6 +100,8 @@ class CPDF_Creator {
   bool m_bLocalCryptoHandler;
   CPDF_Object* m_pMetadata;
   std::unique_ptr<CPDF_XRefStream> m_pXRefStream;
+  std::unique_ptr<CPDF_StreamCompressor> m_pStreamCompressor;
+  int m_CompressionLevel;
   int32_t m_ObjectStreamSize;
   uint32_t m_dwLastObjNum;
   CFX_FileBufferArchive m_File;
@@ -0,0 +1,101 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/edit/cpdf_streamcompressor.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/parser/cpdf_stream_acc.h"
+#include "core/fpdfapi/parser/fpdf_parser_decode.h"
+#include "core/fxcrt/cfx_threadpool.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+// Bounds how much stream data is held in memory at once, decoded and
+// encoded, beyond what the document holds already.
+const uint32_t kMaxBatchBytes = 32 * 1024 * 1024;
+
+}  // namespace
+
+CPDF_StreamCompressor::Job::Job(const CPDF_Stream* pStream)
+    : m_pStream(pStream), m_dwSize(0) {}
+
+CPDF_StreamCompressor::Job::Job(Job&& that) = default;
+
+CPDF_StreamCompressor::Job::~Job() {}
+
+CPDF_StreamCompressor::CPDF_StreamCompressor(CFX_ThreadPool* pPool, int level)
+    : m_pPool(pPool), m_Level(level), m_iNextJob(0), m_iBatchEnd(0) {}
+
+CPDF_StreamCompressor::~CPDF_StreamCompressor() {}
+
+void CPDF_StreamCompressor::AddStream(uint32_t objnum,
+                                      const CPDF_Stream* pStream) {
+  ASSERT(!pStream->HasFilter());
+  m_JobIndices.emplace(objnum, m_Jobs.size());
+  m_Jobs.emplace_back(pStream);
+}
+
+bool CPDF_StreamCompressor::TakeEncodedData(
+    uint32_t objnum,
+    std::unique_ptr<uint8_t, FxFreeDeleter>* pData,
+    uint32_t* pSize) {
+  auto it = m_JobIndices.find(objnum);
+  if (it == m_JobIndices.end() || it->second < m_iNextJob)
+    return false;
+
+  size_t index = it->second;
+  for (; m_iNextJob < index; ++m_iNextJob)
+    m_Jobs[m_iNextJob].m_pData.reset();
+  if (index >= m_iBatchEnd)
+    CompressBatch(index);
+
+  ++m_iNextJob;
+  Job& job = m_Jobs[index];
+  if (!job.m_pData)
+    return false;
+
+  *pData = std::move(job.m_pData);
+  *pSize = job.m_dwSize;
+  return true;
+}
+
+void CPDF_StreamCompressor::CompressBatch(size_t start) {
+  size_t end = start;
+  uint32_t batch_bytes = 0;
+  for (; end < m_Jobs.size(); ++end) {
+    uint32_t size = m_Jobs[end].m_pStream->GetRawSize();
+    if (end > start && size > kMaxBatchBytes - batch_bytes)
+      break;
+
+    batch_bytes += std::min(size, kMaxBatchBytes);
+    m_Jobs[end].m_pAcc = pdfium::MakeUnique<CPDF_StreamAcc>();
+    m_Jobs[end].m_pAcc->LoadAllData(m_Jobs[end].m_pStream, true);
+  }
+
+  const int level = m_Level;
+  auto compress = [this, start, level](size_t i) {
+    Job& job = m_Jobs[start + i];
+    uint8_t* buffer = nullptr;
+    uint32_t size = 0;
+    bool bRet = FlateEncode(job.m_pAcc->GetData(), job.m_pAcc->GetSize(),
+                            &buffer, &size, level);
+    job.m_pData.reset(buffer);
+    if (!bRet)
+      job.m_pData.reset();
+    job.m_dwSize = size;
+  };
+  if (m_pPool) {
+    m_pPool->ParallelFor(end - start, compress);
+  } else {
+    for (size_t i = 0; i < end - start; ++i)
+      compress(i);
+  }
+  for (size_t i = start; i < end; ++i)
+    m_Jobs[i].m_pAcc.reset();
+  m_iBatchEnd = end;
+}
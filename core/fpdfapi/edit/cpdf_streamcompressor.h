@@ -0,0 +1,65 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFAPI_EDIT_CPDF_STREAMCOMPRESSOR_H_
+#define CORE_FPDFAPI_EDIT_CPDF_STREAMCOMPRESSOR_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "core/fxcrt/fx_memory.h"
+#include "core/fxcrt/fx_system.h"
+
+class CFX_ThreadPool;
+class CPDF_Stream;
+class CPDF_StreamAcc;
+
+// Flate encodes the streams that CPDF_Creator is about to write ahead of
+// it, a batch at a time, on the worker threads of a CFX_ThreadPool. The
+// streams are read on the calling thread; only the compression itself runs
+// on the workers, so the output does not depend on how the work was split.
+class CPDF_StreamCompressor {
+ public:
+  // |level| is a zlib compression level, as for FlateEncode().
+  CPDF_StreamCompressor(CFX_ThreadPool* pPool, int level);
+  ~CPDF_StreamCompressor();
+
+  // Queues |pStream|, which must not have filters, to be written as object
+  // |objnum|. Streams must be queued in the order they are written.
+  void AddStream(uint32_t objnum, const CPDF_Stream* pStream);
+
+  // Hands over the encoded data of object |objnum|, compressing the batch
+  // that starts with it if that has not been done yet. Queued streams that
+  // come before it are dropped. Returns false if |objnum| is not queued or
+  // failed to encode, in which case the caller has to encode it itself.
+  bool TakeEncodedData(uint32_t objnum,
+                       std::unique_ptr<uint8_t, FxFreeDeleter>* pData,
+                       uint32_t* pSize);
+
+  size_t GetQueuedCount() const { return m_Jobs.size() - m_iNextJob; }
+
+ private:
+  struct Job {
+    explicit Job(const CPDF_Stream* pStream);
+    Job(Job&& that);
+    ~Job();
+
+    const CPDF_Stream* m_pStream;
+    std::unique_ptr<CPDF_StreamAcc> m_pAcc;
+    std::unique_ptr<uint8_t, FxFreeDeleter> m_pData;
+    uint32_t m_dwSize;
+  };
+
+  void CompressBatch(size_t start);
+
+  CFX_ThreadPool* const m_pPool;
+  const int m_Level;
+  std::vector<Job> m_Jobs;
+  std::map<uint32_t, size_t> m_JobIndices;  // Object number to job index.
+  size_t m_iNextJob;     // The first job not handed over or dropped yet.
+  size_t m_iBatchEnd;    // Jobs before this one have been compressed.
+};
+
+#endif  // CORE_FPDFAPI_EDIT_CPDF_STREAMCOMPRESSOR_H_
@@ -0,0 +1,112 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/edit/cpdf_streamcompressor.h"
+
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/fpdfapi/cpdf_modulemgr.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/parser/fpdf_parser_decode.h"
+#include "core/fxcodec/fx_codec.h"
+#include "core/fxcrt/cfx_threadpool.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+std::unique_ptr<CPDF_Stream> MakeStream(const std::string& content) {
+  std::unique_ptr<uint8_t, FxFreeDeleter> pData(
+      FX_Alloc(uint8_t, content.size()));
+  memcpy(pData.get(), content.data(), content.size());
+  return pdfium::MakeUnique<CPDF_Stream>(
+      std::move(pData), content.size(), pdfium::MakeUnique<CPDF_Dictionary>());
+}
+
+std::string MakeContent(int i) {
+  std::string content;
+  for (int j = 0; j < 2000 + i * 100; ++j)
+    content += std::to_string(i * j % 97) + " 0 m ";
+  return content;
+}
+
+std::vector<uint8_t> SerialEncode(const std::string& content, int level) {
+  uint8_t* buffer = nullptr;
+  uint32_t size = 0;
+  EXPECT_TRUE(FlateEncode(reinterpret_cast<const uint8_t*>(content.data()),
+                          content.size(), &buffer, &size, level));
+  std::vector<uint8_t> result(buffer, buffer + size);
+  FX_Free(buffer);
+  return result;
+}
+
+class cpdf_streamcompressor_test : public testing::Test {
+ public:
+  void SetUp() override {
+    CPDF_ModuleMgr::Get()->SetCodecModule(&m_CodecModule);
+  }
+  void TearDown() override { CPDF_ModuleMgr::Destroy(); }
+
+ private:
+  CCodec_ModuleMgr m_CodecModule;
+};
+
+}  // namespace
+
+TEST_F(cpdf_streamcompressor_test, MatchesSerialEncoding) {
+  CFX_ThreadPool pool(3);
+  CFX_ThreadPool* pools[] = {nullptr, &pool};
+  for (CFX_ThreadPool* pPool : pools) {
+    for (int level : {-1, 0, 1, 9}) {
+      std::vector<std::unique_ptr<CPDF_Stream>> streams;
+      CPDF_StreamCompressor compressor(pPool, level);
+      for (int i = 0; i < 20; ++i) {
+        streams.push_back(MakeStream(MakeContent(i)));
+        compressor.AddStream(i + 10, streams.back().get());
+      }
+      EXPECT_EQ(20u, compressor.GetQueuedCount());
+
+      for (int i = 0; i < 20; ++i) {
+        std::unique_ptr<uint8_t, FxFreeDeleter> pData;
+        uint32_t size = 0;
+        ASSERT_TRUE(compressor.TakeEncodedData(i + 10, &pData, &size));
+        std::vector<uint8_t> actual(pData.get(), pData.get() + size);
+        EXPECT_EQ(SerialEncode(MakeContent(i), level), actual)
+            << "stream " << i << " level " << level;
+      }
+      EXPECT_EQ(0u, compressor.GetQueuedCount());
+    }
+  }
+}
+
+TEST_F(cpdf_streamcompressor_test, SkipsStreamsNotWritten) {
+  CFX_ThreadPool pool(2);
+  std::vector<std::unique_ptr<CPDF_Stream>> streams;
+  CPDF_StreamCompressor compressor(&pool, -1);
+  for (int i = 0; i < 5; ++i) {
+    streams.push_back(MakeStream(MakeContent(i)));
+    compressor.AddStream(i + 1, streams.back().get());
+  }
+
+  std::unique_ptr<uint8_t, FxFreeDeleter> pData;
+  uint32_t size = 0;
+  EXPECT_FALSE(compressor.TakeEncodedData(42, &pData, &size));
+  EXPECT_EQ(5u, compressor.GetQueuedCount());
+
+  // Taking 3 drops 1 and 2, which can then no longer be taken.
+  ASSERT_TRUE(compressor.TakeEncodedData(3, &pData, &size));
+  EXPECT_EQ(SerialEncode(MakeContent(2), -1),
+            std::vector<uint8_t>(pData.get(), pData.get() + size));
+  EXPECT_EQ(2u, compressor.GetQueuedCount());
+  EXPECT_FALSE(compressor.TakeEncodedData(1, &pData, &size));
+  EXPECT_FALSE(compressor.TakeEncodedData(3, &pData, &size));
+  EXPECT_TRUE(compressor.TakeEncodedData(5, &pData, &size));
+  EXPECT_EQ(0u, compressor.GetQueuedCount());
+}
@@ -7,9 +7,11 @@
 #include "core/fpdfapi/edit/editint.h"
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "core/fpdfapi/edit/cpdf_creator.h"
+#include "core/fpdfapi/edit/cpdf_streamcompressor.h"
 #include "core/fpdfapi/parser/cpdf_array.h"
 #include "core/fpdfapi/parser/cpdf_crypto_handler.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
@@ -24,6 +26,7 @@
 #include "core/fpdfapi/parser/cpdf_string.h"
 #include "core/fpdfapi/parser/fpdf_parser_decode.h"
 #include "core/fxcrt/cfx_maybe_owned.h"
+#include "core/fxcrt/cfx_threadpool.h"
 #include "core/fxcrt/fx_ext.h"
 #include "third_party/base/ptr_util.h"
 #include "third_party/base/stl_util.h"
@@ -399,14 +402,21 @@ int32_t OutputIndex(CFX_FileBufferArchive* pFile, FX_FILESIZE offset) {
 
 class CPDF_FlateEncoder {
  public:
-  CPDF_FlateEncoder(CPDF_Stream* pStream, bool bFlateEncode);
+  CPDF_FlateEncoder(CPDF_Stream* pStream, bool bFlateEncode, int level);
+  // For |pStream|, which has no filters, with its data already Flate encoded
+  // into |pEncoded|.
+  CPDF_FlateEncoder(CPDF_Stream* pStream,
+                    std::unique_ptr<uint8_t, FxFreeDeleter> pEncoded,
+                    uint32_t size);
   CPDF_FlateEncoder(const uint8_t* pBuffer,
                     uint32_t size,
                     bool bFlateEncode,
-                    bool bXRefStream);
+                    bool bXRefStream,
+                    int level);
   ~CPDF_FlateEncoder();
 
   void CloneDict();
+  void SetFlateDict(CPDF_Stream* pStream);
 
   uint32_t m_dwSize;
   CFX_MaybeOwned<uint8_t, FxFreeDeleter> m_pData;
@@ -421,7 +431,16 @@ void CPDF_FlateEncoder::CloneDict() {
   ASSERT(m_pDict.IsOwned());
 }
 
-CPDF_FlateEncoder::CPDF_FlateEncoder(CPDF_Stream* pStream, bool bFlateEncode)
+void CPDF_FlateEncoder::SetFlateDict(CPDF_Stream* pStream) {
+  m_pDict = ToDictionary(pStream->GetDict()->Clone());
+  m_pDict->SetNewFor<CPDF_Number>("Length", static_cast<int>(m_dwSize));
+  m_pDict->SetNewFor<CPDF_Name>("Filter", "FlateDecode");
+  m_pDict->RemoveFor("DecodeParms");
+}
+
+CPDF_FlateEncoder::CPDF_FlateEncoder(CPDF_Stream* pStream,
+                                     bool bFlateEncode,
+                                     int level)
     : m_dwSize(0) {
   m_Acc.LoadAllData(pStream, true);
   bool bHasFilter = pStream && pStream->HasFilter();
@@ -442,18 +461,24 @@ CPDF_FlateEncoder::CPDF_FlateEncoder(CPDF_Stream* pStream, bool bFlateEncode)
   }
   // TODO(thestig): Move to Init() and check return value.
   uint8_t* buffer = nullptr;
-  ::FlateEncode(m_Acc.GetData(), m_Acc.GetSize(), &buffer, &m_dwSize);
+  ::FlateEncode(m_Acc.GetData(), m_Acc.GetSize(), &buffer, &m_dwSize, level);
   m_pData = std::unique_ptr<uint8_t, FxFreeDeleter>(buffer);
-  m_pDict = ToDictionary(pStream->GetDict()->Clone());
-  m_pDict->SetNewFor<CPDF_Number>("Length", static_cast<int>(m_dwSize));
-  m_pDict->SetNewFor<CPDF_Name>("Filter", "FlateDecode");
-  m_pDict->RemoveFor("DecodeParms");
+  SetFlateDict(pStream);
+}
+
+CPDF_FlateEncoder::CPDF_FlateEncoder(
+    CPDF_Stream* pStream,
+    std::unique_ptr<uint8_t, FxFreeDeleter> pEncoded,
+    uint32_t size)
+    : m_dwSize(size), m_pData(std::move(pEncoded)) {
+  SetFlateDict(pStream);
 }
 
 CPDF_FlateEncoder::CPDF_FlateEncoder(const uint8_t* pBuffer,
                                      uint32_t size,
                                      bool bFlateEncode,
-                                     bool bXRefStream)
+                                     bool bXRefStream,
+                                     int level)
     : m_dwSize(0) {
   if (!bFlateEncode) {
     m_pData = const_cast<uint8_t*>(pBuffer);
@@ -463,9 +488,9 @@ CPDF_FlateEncoder::CPDF_FlateEncoder(const uint8_t* pBuffer,
   uint8_t* buffer = nullptr;
   // TODO(thestig): Move to Init() and check return value.
   if (bXRefStream)
-    ::PngEncode(pBuffer, size, &buffer, &m_dwSize);
+    ::PngEncode(pBuffer, size, &buffer, &m_dwSize, level);
   else
-    ::FlateEncode(pBuffer, size, &buffer, &m_dwSize);
+    ::FlateEncode(pBuffer, size, &buffer, &m_dwSize, level);
   m_pData = std::unique_ptr<uint8_t, FxFreeDeleter>(buffer);
 }
 
@@ -576,7 +601,7 @@ FX_FILESIZE CPDF_ObjectStream::End(CPDF_Creator* pCreator) {
 
   tempBuffer << m_Buffer;
   CPDF_FlateEncoder encoder(tempBuffer.GetBuffer(), tempBuffer.GetLength(),
-                            true, false);
+                            true, false, pCreator->m_CompressionLevel);
   CPDF_Encryptor encryptor(pCreator->m_pCryptoHandler, m_dwObjNum,
                            encoder.m_pData.Get(), encoder.m_dwSize);
   if ((len = pFile->AppendDWord(encryptor.m_dwSize)) < 0) {
@@ -788,7 +813,7 @@ bool CPDF_XRefStream::GenerateXRefStream(CPDF_Creator* pCreator, bool bEOF) {
     offset += offset_len + 6;
   }
   CPDF_FlateEncoder encoder(m_Buffer.GetBuffer(), m_Buffer.GetLength(), true,
-                            true);
+                            true, pCreator->m_CompressionLevel);
   if (pFile->AppendString("/Filter /FlateDecode") < 0)
     return false;
 
@@ -886,6 +911,7 @@ CPDF_Creator::CPDF_Creator(CPDF_Document* pDoc)
       m_pCryptoHandler(m_pParser ? m_pParser->GetCryptoHandler() : nullptr),
       m_bLocalCryptoHandler(false),
       m_pMetadata(nullptr),
+      m_CompressionLevel(-1),
       m_ObjectStreamSize(200),
       m_dwLastObjNum(m_pDocument->GetLastObjNum()),
       m_Offset(0),
@@ -928,8 +954,6 @@ int32_t CPDF_Creator::WriteIndirectObjectToStream(const CPDF_Object* pObj) {
       return 1;
     if (pDict->IsSignatureDict())
       return 1;
-    if (pDict->GetStringFor("Type") == "Page")
-      return 1;
   }
 
   m_pXRefStream->AddObjectNumberToIndexArray(objnum);
@@ -985,17 +1009,27 @@ int32_t CPDF_Creator::AppendObjectNumberToXRef(uint32_t objnum) {
 int32_t CPDF_Creator::WriteStream(const CPDF_Object* pStream,
                                   uint32_t objnum,
                                   CPDF_CryptoHandler* pCrypto) {
-  CPDF_FlateEncoder encoder(const_cast<CPDF_Stream*>(pStream->AsStream()),
-                            pStream != m_pMetadata);
-  CPDF_Encryptor encryptor(pCrypto, objnum, encoder.m_pData.Get(),
-                           encoder.m_dwSize);
-  if (static_cast<uint32_t>(encoder.m_pDict->GetIntegerFor("Length")) !=
+  CPDF_Stream* pNonConstStream = const_cast<CPDF_Stream*>(pStream->AsStream());
+  std::unique_ptr<uint8_t, FxFreeDeleter> pEncoded;
+  uint32_t encoded_size = 0;
+  std::unique_ptr<CPDF_FlateEncoder> pEncoder;
+  if (m_pStreamCompressor && pStream != m_pMetadata &&
+      m_pStreamCompressor->TakeEncodedData(objnum, &pEncoded, &encoded_size)) {
+    pEncoder = pdfium::MakeUnique<CPDF_FlateEncoder>(
+        pNonConstStream, std::move(pEncoded), encoded_size);
+  } else {
+    pEncoder = pdfium::MakeUnique<CPDF_FlateEncoder>(
+        pNonConstStream, pStream != m_pMetadata, m_CompressionLevel);
+  }
+  CPDF_Encryptor encryptor(pCrypto, objnum, pEncoder->m_pData.Get(),
+                           pEncoder->m_dwSize);
+  if (static_cast<uint32_t>(pEncoder->m_pDict->GetIntegerFor("Length")) !=
       encryptor.m_dwSize) {
-    encoder.CloneDict();
-    encoder.m_pDict->SetNewFor<CPDF_Number>(
+    pEncoder->CloneDict();
+    pEncoder->m_pDict->SetNewFor<CPDF_Number>(
         "Length", static_cast<int>(encryptor.m_dwSize));
   }
-  if (WriteDirectObj(objnum, encoder.m_pDict.Get()) < 0)
+  if (WriteDirectObj(objnum, pEncoder->m_pDict.Get()) < 0)
     return -1;
 
   int len = m_File.AppendString("stream\r\n");
@@ -1100,7 +1134,7 @@ int32_t CPDF_Creator::WriteDirectObj(uint32_t objnum,
     }
     case CPDF_Object::STREAM: {
       CPDF_FlateEncoder encoder(const_cast<CPDF_Stream*>(pObj->AsStream()),
-                                true);
+                                true, m_CompressionLevel);
       CPDF_Encryptor encryptor(m_pCryptoHandler, objnum, encoder.m_pData.Get(),
                                encoder.m_dwSize);
       if (static_cast<uint32_t>(encoder.m_pDict->GetIntegerFor("Length")) !=
@@ -1235,8 +1269,10 @@ int32_t CPDF_Creator::WriteOldIndirectObject(uint32_t objnum) {
   bool bExistInMap = !!m_pDocument->GetIndirectObject(objnum);
   const uint8_t object_type = m_pParser->GetObjectType(objnum);
   bool bObjStm = (object_type == 2) && m_pEncryptDict && !m_pXRefStream;
+  // Writing object streams, objects get parsed so that the ones that can be
+  // packed into an object stream are, rather than copied as they are.
   if (m_pParser->IsVersionUpdated() || m_bSecurityChanged || bExistInMap ||
-      bObjStm) {
+      bObjStm || m_pXRefStream) {
     CPDF_Object* pObj = m_pDocument->GetOrParseIndirectObject(objnum);
     if (!pObj) {
       m_ObjectOffset[objnum] = 0;
@@ -1414,6 +1450,37 @@ void CPDF_Creator::InitNewObjNumOffsets() {
   m_ObjectOffset.Add(dwStartObjNum, dwLastObjNum - dwStartObjNum + 1);
 }
 
+void CPDF_Creator::InitStreamCompressor() {
+  CFX_ThreadPool* pPool = CFX_ThreadPool::Get();
+  if (!pPool)
+    return;
+
+  // Queues the loaded streams that WriteOldObjs() and WriteNewObjs() will
+  // Flate encode, in the order they write them. Streams that only get parsed
+  // while writing are encoded as they come.
+  auto pCompressor =
+      pdfium::MakeUnique<CPDF_StreamCompressor>(pPool, m_CompressionLevel);
+  auto add_stream = [this, &pCompressor](uint32_t objnum) {
+    const CPDF_Stream* pStream =
+        ToStream(m_pDocument->GetIndirectObject(objnum));
+    if (pStream && pStream != m_pMetadata && !pStream->HasFilter())
+      pCompressor->AddStream(objnum, pStream);
+  };
+  if ((m_dwFlags & FPDFCREATE_INCREMENTAL) == 0 && m_pParser) {
+    uint32_t nLastObjNum = m_pParser->GetLastObjNum();
+    if (m_pParser->IsValidObjectNumber(nLastObjNum)) {
+      for (uint32_t objnum = 0; objnum <= nLastObjNum; ++objnum) {
+        if (!m_pParser->IsObjectFreeOrNull(objnum))
+          add_stream(objnum);
+      }
+    }
+  }
+  for (uint32_t objnum : m_NewObjNumArray)
+    add_stream(objnum);
+  if (pCompressor->GetQueuedCount())
+    m_pStreamCompressor = std::move(pCompressor);
+}
+
 void CPDF_Creator::AppendNewObjNum(uint32_t objnum) {
   m_NewObjNumArray.insert(std::lower_bound(m_NewObjNumArray.begin(),
                                            m_NewObjNumArray.end(), objnum),
@@ -1429,6 +1496,9 @@ int32_t CPDF_Creator::WriteDoc_Stage1(IFX_Pause* pPause) {
     if (m_bSecurityChanged && (m_dwFlags & FPDFCREATE_NO_ORIGINAL) == 0) {
       m_dwFlags &= ~FPDFCREATE_INCREMENTAL;
     }
+    // A cross-reference stream cannot update a file that has an xref table.
+    if ((m_dwFlags & FPDFCREATE_INCREMENTAL) && !m_pParser->IsXRefStream())
+      m_dwFlags &= ~FPDFCREATE_OBJECTSTREAM;
     CPDF_Dictionary* pDict = m_pDocument->GetRoot();
     m_pMetadata = pDict ? pDict->GetDirectObjectFor("Metadata") : nullptr;
     if (m_dwFlags & FPDFCREATE_OBJECTSTREAM) {
@@ -1453,6 +1523,9 @@ int32_t CPDF_Creator::WriteDoc_Stage1(IFX_Pause* pPause) {
       } else if (m_pParser) {
         version = m_pParser->GetFileVersion();
       }
+      // Object and cross-reference streams are new in PDF 1.5.
+      if ((m_dwFlags & FPDFCREATE_OBJECTSTREAM) && version < 15)
+        version = 15;
       int32_t len = m_File.AppendDWord(version % 10);
       if (len < 0) {
         return -1;
@@ -1520,6 +1593,8 @@ int32_t CPDF_Creator::WriteDoc_Stage1(IFX_Pause* pPause) {
 int32_t CPDF_Creator::WriteDoc_Stage2(IFX_Pause* pPause) {
   ASSERT(m_iStage >= 20 || m_iStage < 30);
   if (m_iStage == 20) {
+    if (m_dwFlags & FPDFCREATE_PARALLEL_COMPRESS)
+      InitStreamCompressor();
     if ((m_dwFlags & FPDFCREATE_INCREMENTAL) == 0 && m_pParser) {
       m_Pos = (void*)(uintptr_t)0;
       m_iStage = 21;
@@ -1544,6 +1619,7 @@ int32_t CPDF_Creator::WriteDoc_Stage2(IFX_Pause* pPause) {
     if (iRet) {
       return iRet;
     }
+    m_pStreamCompressor.reset();
     m_iStage = 27;
   }
   if (m_iStage == 27) {
@@ -1875,6 +1951,7 @@ int32_t CPDF_Creator::WriteDoc_Stage4(IFX_Pause* pPause) {
 
 void CPDF_Creator::Clear() {
   m_pXRefStream.reset();
+  m_pStreamCompressor.reset();
   m_File.Clear();
   m_NewObjNumArray.clear();
   m_pIDArray.reset();
@@ -1979,6 +2056,20 @@ bool CPDF_Creator::SetFileVersion(int32_t fileVersion) {
   m_FileVersion = fileVersion;
   return true;
 }
+bool CPDF_Creator::SetObjectStreamSize(int32_t count) {
+  if (count <= 0)
+    return false;
+
+  m_ObjectStreamSize = count;
+  return true;
+}
+bool CPDF_Creator::SetCompressionLevel(int level) {
+  if (level < 0 || level > 9)
+    return false;
+
+  m_CompressionLevel = level;
+  return true;
+}
 void CPDF_Creator::RemoveSecurity() {
   ResetStandardSecurity();
   m_bSecurityChanged = true;
@@ -204,12 +204,13 @@ CPDF_CIDFont::CPDF_CIDFont()
       m_pCID2UnicodeMap(nullptr),
       m_bCIDIsGID(false),
       m_bAnsiWidthsFixed(false),
-      m_bAdobeCourierStd(false) {
-  for (size_t i = 0; i < FX_ArraySize(m_CharBBox); ++i)
-    m_CharBBox[i] = FX_RECT(-1, -1, -1, -1);
-}
+      m_bAdobeCourierStd(false),
+      m_pFaceCharmap(nullptr) {}
 
-CPDF_CIDFont::~CPDF_CIDFont() {}
+CPDF_CIDFont::~CPDF_CIDFont() {
+  if (m_pCMap && m_pCMap->IsEmbedded())
+    GetFontGlobals()->m_CMapCache.ReleaseCMap(m_pCMap);
+}
 
 bool CPDF_CIDFont::IsCIDFont() const {
   return true;
@@ -360,11 +361,10 @@ bool CPDF_CIDFont::Load() {
     if (!m_pCMap)
       return false;
   } else if (CPDF_Stream* pStream = pEncoding->AsStream()) {
-    m_pCMap = new CPDF_CMap;
-    m_pAllocatedCMap.reset(m_pCMap);
     CPDF_StreamAcc acc;
     acc.LoadAllData(pStream, false);
-    m_pCMap->LoadEmbedded(acc.GetData(), acc.GetSize());
+    m_pCMap = GetFontGlobals()->m_CMapCache.GetEmbeddedCMap(acc.GetData(),
+                                                            acc.GetSize());
   } else {
     return false;
   }
@@ -387,6 +387,7 @@ bool CPDF_CIDFont::Load() {
       FXFT_Select_Charmap(m_Font.GetFace(), FXFT_ENCODING_UNICODE);
     else
       FT_UseCIDCharmap(m_Font.GetFace(), m_pCMap->m_Coding);
+    m_pFaceCharmap = FXFT_Get_Face_Charmap(m_Font.GetFace());
   }
   m_DefaultWidth = pCIDFontDict->GetIntegerFor("DW", 1000);
   CPDF_Array* pWidthArray = pCIDFontDict->GetArrayFor("W");
@@ -430,9 +431,21 @@ bool CPDF_CIDFont::Load() {
 }
 
 FX_RECT CPDF_CIDFont::GetCharBBox(uint32_t charcode) {
-  if (charcode < 256 && m_CharBBox[charcode].right != -1)
-    return m_CharBBox[charcode];
+  {
+    CFX_AutoLock lock(&m_CharBBoxLock);
+    auto it = m_CharBBoxes.find(charcode);
+    if (it != m_CharBBoxes.end())
+      return it->second;
+  }
+  FX_RECT rect = LoadCharBBox(charcode);
+  CFX_AutoLock lock(&m_CharBBoxLock);
+  m_CharBBoxes[charcode] = rect;
+  return rect;
+}
 
+FX_RECT CPDF_CIDFont::LoadCharBBox(uint32_t charcode) {
+  // Boxes come from the FreeType face, which is shared across the document.
+  CFX_AutoLock lock(GetLock());
   FX_RECT rect;
   bool bVert = false;
   int glyph_index = GlyphFromCharCode(charcode, &bVert);
@@ -494,9 +507,6 @@ FX_RECT CPDF_CIDFont::GetCharBBox(uint32_t charcode) {
       rect = rect_f.GetOuterRect();
     }
   }
-  if (charcode < 256)
-    m_CharBBox[charcode] = rect;
-
   return rect;
 }
 
@@ -714,14 +724,14 @@ int CPDF_CIDFont::GlyphFromCharCode(uint32_t charcode, bool* pVertGlyph) {
     if (m_bType1)
       return cid;
 
-    if (m_pFontFile && !m_pCMap->m_pMapping)
+    if (m_pFontFile && !m_pCMap->IsEmbedded())
       return cid;
-    if (m_pCMap->m_Coding == CIDCODING_UNKNOWN ||
-        !FXFT_Get_Face_Charmap(m_Font.GetFace())) {
+    if (m_pCMap->m_Coding == CIDCODING_UNKNOWN || !m_pFaceCharmap)
       return cid;
-    }
-    if (FXFT_Get_Charmap_Encoding(FXFT_Get_Face_Charmap(m_Font.GetFace())) ==
-        FXFT_ENCODING_UNICODE) {
+
+    if (FXFT_Get_Face_Charmap(m_Font.GetFace()) != m_pFaceCharmap)
+      FXFT_Set_Charmap(m_Font.GetFace(), m_pFaceCharmap);
+    if (FXFT_Get_Charmap_Encoding(m_pFaceCharmap) == FXFT_ENCODING_UNICODE) {
       CFX_WideString unicode_str = UnicodeFromCharCode(charcode);
       if (unicode_str.IsEmpty())
         return -1;
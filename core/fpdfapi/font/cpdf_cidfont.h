@@ -8,6 +8,7 @@
 #define CORE_FPDFAPI_FONT_CPDF_CIDFONT_H_
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "core/fpdfapi/font/cpdf_font.h"
@@ -63,6 +64,7 @@ class CPDF_CIDFont : public CPDF_Font {
 
  protected:
   void LoadGB2312();
+  FX_RECT LoadCharBBox(uint32_t charcode);
   int GetGlyphIndex(uint32_t unicodeb, bool* pVertGlyph);
   int GetVerticalGlyph(int index, bool* pVertGlyph);
   void LoadMetricsArray(CPDF_Array* pArray,
@@ -71,8 +73,8 @@ class CPDF_CIDFont : public CPDF_Font {
   void LoadSubstFont();
   FX_WCHAR GetUnicodeFromCharCode(uint32_t charcode) const;
 
-  CPDF_CMap* m_pCMap;
-  std::unique_ptr<CPDF_CMap> m_pAllocatedCMap;
+  // Embedded CMaps are shared with other fonts through the CMap cache.
+  const CPDF_CMap* m_pCMap;
   CPDF_CID2UnicodeMap* m_pCID2UnicodeMap;
   CIDSet m_Charset;
   bool m_bType1;
@@ -80,12 +82,18 @@ class CPDF_CIDFont : public CPDF_Font {
   uint16_t m_DefaultWidth;
   std::unique_ptr<CPDF_StreamAcc> m_pStreamAcc;
   bool m_bAnsiWidthsFixed;
-  FX_RECT m_CharBBox[256];
+  // Boxes once loaded, with their own lock so that looking them up does not
+  // take the document lock.
+  CFX_Mutex m_CharBBoxLock;
+  std::unordered_map<uint32_t, FX_RECT> m_CharBBoxes;
   std::vector<uint32_t> m_WidthList;
   short m_DefaultVY;
   short m_DefaultW1;
   std::vector<uint32_t> m_VertMetrics;
   bool m_bAdobeCourierStd;
+  // The charmap selected on load. Embedded faces may be shared with other
+  // fonts, which select their own charmaps on them.
+  FXFT_CharMap m_pFaceCharmap;
   std::unique_ptr<CFX_CTTGSUBTable> m_pTTGSUBTable;
 };
 
@@ -0,0 +1,159 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/font/cpdf_cmapcache.h"
+
+#include <utility>
+
+#include "core/fdrm/crypto/fx_crypt.h"
+#include "core/fpdfapi/font/font_int.h"
+#include "third_party/base/numerics/safe_conversions.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+// Kinds of maps, which are kept apart even when their content is the same.
+const char kKindCMap = 'C';
+const char kKindToUnicode = 'U';
+
+CFX_ByteString MakeKey(char kind, const uint8_t* pData, uint32_t size) {
+  uint8_t digest[20];
+  CRYPT_SHA1Generate(pData, size, digest);
+  CFX_ByteString key(kind);
+  key += CFX_ByteStringC(digest, 20);
+  return key;
+}
+
+}  // namespace
+
+CPDF_CMapCache::CPDF_CMapCache()
+    : m_nBytes(0),
+      m_nMaxBytes(kDefaultMaxBytes),
+      m_nHits(0),
+      m_nMisses(0),
+      m_nEvictions(0) {}
+
+CPDF_CMapCache::~CPDF_CMapCache() {}
+
+void CPDF_CMapCache::SetMaxBytes(uint32_t nMaxBytes) {
+  CFX_AutoLock lock(&m_Lock);
+  m_nMaxBytes = nMaxBytes;
+  TrimLocked();
+}
+
+CPDF_CMapCache::Stats CPDF_CMapCache::GetStats() const {
+  CFX_AutoLock lock(&m_Lock);
+  Stats stats;
+  stats.nHits = m_nHits;
+  stats.nMisses = m_nMisses;
+  stats.nEvictions = m_nEvictions;
+  stats.nMaps = m_Index.size();
+  stats.nBytes = m_nBytes;
+  stats.nMaxBytes = m_nMaxBytes;
+  return stats;
+}
+
+const CPDF_CMap* CPDF_CMapCache::GetEmbeddedCMap(const uint8_t* pData,
+                                                 uint32_t size) {
+  CFX_ByteString key = MakeKey(kKindCMap, pData, size);
+  Entry* pEntry = Find(key);
+  if (!pEntry) {
+    // Parse outside the lock, so that fonts of other documents do not wait.
+    Entry entry;
+    entry.key = key;
+    entry.pCMap = pdfium::MakeUnique<CPDF_CMap>();
+    entry.pCMap->LoadEmbedded(pData, size);
+    entry.nBytes =
+        pdfium::base::saturated_cast<uint32_t>(entry.pCMap->GetMemorySize());
+    pEntry = Put(std::move(entry));
+  }
+  return pEntry->pCMap.get();
+}
+
+const CPDF_ToUnicodeMap* CPDF_CMapCache::GetToUnicodeMap(const uint8_t* pData,
+                                                         uint32_t size) {
+  CFX_ByteString key = MakeKey(kKindToUnicode, pData, size);
+  Entry* pEntry = Find(key);
+  if (!pEntry) {
+    Entry entry;
+    entry.key = key;
+    entry.pToUnicodeMap = pdfium::MakeUnique<CPDF_ToUnicodeMap>();
+    entry.pToUnicodeMap->Load(pData, size);
+    entry.nBytes = pdfium::base::saturated_cast<uint32_t>(
+        entry.pToUnicodeMap->GetMemorySize());
+    pEntry = Put(std::move(entry));
+  }
+  return pEntry->pToUnicodeMap.get();
+}
+
+bool CPDF_CMapCache::ReleaseCMap(const CPDF_CMap* pMap) {
+  return Release(pMap);
+}
+
+bool CPDF_CMapCache::ReleaseToUnicodeMap(const CPDF_ToUnicodeMap* pMap) {
+  return Release(pMap);
+}
+
+CPDF_CMapCache::Entry* CPDF_CMapCache::Find(const CFX_ByteString& key) {
+  CFX_AutoLock lock(&m_Lock);
+  auto it = m_Index.find(key);
+  if (it == m_Index.end()) {
+    ++m_nMisses;
+    return nullptr;
+  }
+  ++m_nHits;
+  m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+  ++it->second->nRefs;
+  return &*it->second;
+}
+
+CPDF_CMapCache::Entry* CPDF_CMapCache::Put(Entry entry) {
+  CFX_AutoLock lock(&m_Lock);
+  auto it = m_Index.find(entry.key);
+  if (it != m_Index.end()) {
+    m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+    ++it->second->nRefs;
+    return &*it->second;
+  }
+
+  entry.nRefs = 1;
+  m_Entries.push_front(std::move(entry));
+  Entry* pEntry = &m_Entries.front();
+  const void* pMap = pEntry->pCMap
+                         ? static_cast<const void*>(pEntry->pCMap.get())
+                         : pEntry->pToUnicodeMap.get();
+  m_Index[pEntry->key] = m_Entries.begin();
+  m_MapIndex[pMap] = m_Entries.begin();
+  m_nBytes += pEntry->nBytes;
+  TrimLocked();
+  return pEntry;
+}
+
+bool CPDF_CMapCache::Release(const void* pMap) {
+  CFX_AutoLock lock(&m_Lock);
+  auto it = m_MapIndex.find(pMap);
+  if (it == m_MapIndex.end())
+    return false;
+
+  ASSERT(it->second->nRefs > 0);
+  --it->second->nRefs;
+  TrimLocked();
+  return true;
+}
+
+void CPDF_CMapCache::TrimLocked() {
+  auto it = m_Entries.end();
+  while (m_nBytes > m_nMaxBytes && it != m_Entries.begin()) {
+    --it;
+    if (it->nRefs)
+      continue;
+
+    m_nBytes -= it->nBytes;
+    m_Index.erase(it->key);
+    m_MapIndex.erase(it->pCMap ? static_cast<const void*>(it->pCMap.get())
+                               : it->pToUnicodeMap.get());
+    it = m_Entries.erase(it);
+    ++m_nEvictions;
+  }
+}
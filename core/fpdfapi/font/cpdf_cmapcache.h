@@ -0,0 +1,88 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFAPI_FONT_CPDF_CMAPCACHE_H_
+#define CORE_FPDFAPI_FONT_CPDF_CMAPCACHE_H_
+
+#include <list>
+#include <map>
+#include <memory>
+
+#include "core/fxcrt/cfx_mutex.h"
+#include "core/fxcrt/fx_string.h"
+#include "core/fxcrt/fx_system.h"
+
+class CPDF_CMap;
+class CPDF_ToUnicodeMap;
+
+// Process-wide cache of the CMaps and ToUnicode maps embedded in fonts, by
+// the SHA-1 of their content, so that the same map embedded in many
+// documents, or in many fonts of a document, is only parsed once.
+//
+// Maps are shared by all the fonts that use them until those release them.
+// Maps no font uses stay for later fonts within a byte budget, the least
+// recently used going first.
+class CPDF_CMapCache {
+ public:
+  struct Stats {
+    uint32_t nHits;
+    uint32_t nMisses;
+    uint32_t nEvictions;
+    uint32_t nMaps;
+    uint32_t nBytes;
+    uint32_t nMaxBytes;
+  };
+
+  static const uint32_t kDefaultMaxBytes = 4 * 1024 * 1024;
+
+  CPDF_CMapCache();
+  ~CPDF_CMapCache();
+
+  void SetMaxBytes(uint32_t nMaxBytes);
+  Stats GetStats() const;
+
+  // Return the map embedded as |pData|, parsing it unless the cache holds
+  // one of the same content. The map is in use until released.
+  const CPDF_CMap* GetEmbeddedCMap(const uint8_t* pData, uint32_t size);
+  const CPDF_ToUnicodeMap* GetToUnicodeMap(const uint8_t* pData,
+                                           uint32_t size);
+
+  // Return false if |pMap| did not come from this cache.
+  bool ReleaseCMap(const CPDF_CMap* pMap);
+  bool ReleaseToUnicodeMap(const CPDF_ToUnicodeMap* pMap);
+
+ private:
+  struct Entry {
+    CFX_ByteString key;
+    std::unique_ptr<CPDF_CMap> pCMap;
+    std::unique_ptr<CPDF_ToUnicodeMap> pToUnicodeMap;
+    uint32_t nBytes;
+    int nRefs;
+  };
+  using EntryList = std::list<Entry>;
+
+  // Returns the entry for |key|, in use, and counts a hit, or counts a miss
+  // and returns nullptr.
+  Entry* Find(const CFX_ByteString& key);
+  // Stores |entry| and returns it in use. If the cache holds an entry for
+  // its key already, as another thread parsed the same map meanwhile, that
+  // one is returned instead.
+  Entry* Put(Entry entry);
+  bool Release(const void* pMap);
+  // Evicts unused maps until the cache is within its budget, or there are
+  // no more to evict.
+  void TrimLocked();
+
+  mutable CFX_Mutex m_Lock;
+  EntryList m_Entries;  // Most recently used first.
+  std::map<CFX_ByteString, EntryList::iterator> m_Index;
+  std::map<const void*, EntryList::iterator> m_MapIndex;
+  uint32_t m_nBytes;
+  uint32_t m_nMaxBytes;
+  uint32_t m_nHits;
+  uint32_t m_nMisses;
+  uint32_t m_nEvictions;
+};
+
+#endif  // CORE_FPDFAPI_FONT_CPDF_CMAPCACHE_H_
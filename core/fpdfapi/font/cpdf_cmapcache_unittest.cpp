@@ -0,0 +1,188 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/font/cpdf_cmapcache.h"
+
+#include <string>
+
+#include "core/fpdfapi/font/font_int.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const char kCMap[] =
+    "/CIDInit /ProcSet findresource begin\n"
+    "12 dict begin\n"
+    "begincmap\n"
+    "/CIDSystemInfo << /Registry (Adobe) /Ordering (Japan1) /Supplement 6 >> "
+    "def\n"
+    "/CMapName /Test-H def\n"
+    "1 begincodespacerange\n"
+    "<0000> <FFFF>\n"
+    "endcodespacerange\n"
+    "2 begincidrange\n"
+    "<0020> <007e> 1\n"
+    "<8140> <817e> 633\n"
+    "endcidrange\n"
+    "2 begincidchar\n"
+    "<0041> 500\n"
+    "<8150> 7\n"
+    "endcidchar\n"
+    "endcmap\n";
+
+// One and three byte codes.
+const char kMixedCMap[] =
+    "2 begincodespacerange\n"
+    "<00> <80>\n"
+    "<8EA1A1> <8EFEFE>\n"
+    "endcodespacerange\n"
+    "2 begincidrange\n"
+    "<20> <7e> 1\n"
+    "<8ea1a1> <8ea1fe> 100\n"
+    "endcidrange\n";
+
+const char kToUnicode[] =
+    "2 beginbfchar\n"
+    "<01> <0041>\n"
+    "<02> <00660069>\n"
+    "endbfchar\n"
+    "1 beginbfrange\n"
+    "<10> <1f> <0061>\n"
+    "endbfrange\n"
+    "1 beginbfrange\n"
+    "<13> <13> <0058>\n"
+    "endbfrange\n";
+
+const uint8_t* ToData(const std::string& str) {
+  return reinterpret_cast<const uint8_t*>(str.data());
+}
+
+}  // namespace
+
+TEST(cpdf_cmapcache, EmbeddedCMap) {
+  CPDF_CMapCache cache;
+  std::string data = kCMap;
+  const CPDF_CMap* pCMap = cache.GetEmbeddedCMap(ToData(data), data.size());
+  ASSERT_TRUE(pCMap);
+  EXPECT_TRUE(pCMap->IsEmbedded());
+  EXPECT_EQ(1, pCMap->CIDFromCharCode(0x20));
+  EXPECT_EQ(500, pCMap->CIDFromCharCode(0x41));
+  EXPECT_EQ(35, pCMap->CIDFromCharCode(0x42));
+  EXPECT_EQ(0, pCMap->CIDFromCharCode(0x7f));
+  EXPECT_EQ(7, pCMap->CIDFromCharCode(0x8150));
+  EXPECT_EQ(650, pCMap->CIDFromCharCode(0x8151));
+  EXPECT_EQ(0, pCMap->CIDFromCharCode(0x18151));
+
+  data = kMixedCMap;
+  const CPDF_CMap* pMixedCMap =
+      cache.GetEmbeddedCMap(ToData(data), data.size());
+  ASSERT_TRUE(pMixedCMap);
+  EXPECT_EQ(1, pMixedCMap->CIDFromCharCode(0x20));
+  EXPECT_EQ(100, pMixedCMap->CIDFromCharCode(0x8ea1a1));
+  EXPECT_EQ(104, pMixedCMap->CIDFromCharCode(0x8ea1a5));
+  EXPECT_EQ(0, pMixedCMap->CIDFromCharCode(0x8ea2a1));
+
+  EXPECT_TRUE(cache.ReleaseCMap(pCMap));
+  EXPECT_TRUE(cache.ReleaseCMap(pMixedCMap));
+}
+
+TEST(cpdf_cmapcache, ToUnicodeMap) {
+  CPDF_CMapCache cache;
+  std::string data = kToUnicode;
+  const CPDF_ToUnicodeMap* pMap =
+      cache.GetToUnicodeMap(ToData(data), data.size());
+  ASSERT_TRUE(pMap);
+  EXPECT_EQ(L"A", pMap->Lookup(0x01));
+  EXPECT_EQ(L"fi", pMap->Lookup(0x02));
+  EXPECT_EQ(L"", pMap->Lookup(0x03));
+  EXPECT_EQ(L"a", pMap->Lookup(0x10));
+  EXPECT_EQ(L"X", pMap->Lookup(0x13));
+  EXPECT_EQ(L"e", pMap->Lookup(0x14));
+  EXPECT_EQ(L"p", pMap->Lookup(0x1f));
+  EXPECT_EQ(L"", pMap->Lookup(0x20));
+
+  EXPECT_EQ(0x10u, pMap->ReverseLookup(L'a'));
+  EXPECT_EQ(0x13u, pMap->ReverseLookup(L'X'));
+  EXPECT_EQ(0x14u, pMap->ReverseLookup(L'e'));
+  EXPECT_EQ(0u, pMap->ReverseLookup(L'd'));
+  EXPECT_TRUE(cache.ReleaseToUnicodeMap(pMap));
+}
+
+TEST(cpdf_cmapcache, SharedByContent) {
+  CPDF_CMapCache cache;
+  std::string data = kCMap;
+  const CPDF_CMap* pCMap1 = cache.GetEmbeddedCMap(ToData(data), data.size());
+
+  // The same CMap, as embedded in another document.
+  std::string copy = data;
+  EXPECT_EQ(pCMap1, cache.GetEmbeddedCMap(ToData(copy), copy.size()));
+
+  // A CMap that differs in a single byte is not the same.
+  copy[copy.find("500")] = '6';
+  const CPDF_CMap* pCMap2 = cache.GetEmbeddedCMap(ToData(copy), copy.size());
+  EXPECT_NE(pCMap1, pCMap2);
+  EXPECT_EQ(600, pCMap2->CIDFromCharCode(0x41));
+
+  // Nor is a ToUnicode map of the same content.
+  const CPDF_ToUnicodeMap* pMap =
+      cache.GetToUnicodeMap(ToData(data), data.size());
+  EXPECT_NE(static_cast<const void*>(pCMap1), pMap);
+
+  CPDF_CMapCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(1u, stats.nHits);
+  EXPECT_EQ(3u, stats.nMisses);
+  EXPECT_EQ(3u, stats.nMaps);
+
+  // Maps stay once released, for the next document to use.
+  EXPECT_TRUE(cache.ReleaseCMap(pCMap1));
+  EXPECT_TRUE(cache.ReleaseCMap(pCMap1));
+  EXPECT_TRUE(cache.ReleaseCMap(pCMap2));
+  EXPECT_TRUE(cache.ReleaseToUnicodeMap(pMap));
+  EXPECT_FALSE(cache.ReleaseCMap(nullptr));
+  EXPECT_EQ(pCMap1, cache.GetEmbeddedCMap(ToData(data), data.size()));
+  stats = cache.GetStats();
+  EXPECT_EQ(2u, stats.nHits);
+  EXPECT_EQ(0u, stats.nEvictions);
+  EXPECT_EQ(3u, stats.nMaps);
+  EXPECT_TRUE(cache.ReleaseCMap(pCMap1));
+}
+
+TEST(cpdf_cmapcache, Eviction) {
+  CPDF_CMapCache cache;
+  std::string data1 = kCMap;
+  std::string data2 = kMixedCMap;
+  const CPDF_CMap* pCMap1 = cache.GetEmbeddedCMap(ToData(data1), data1.size());
+  const CPDF_CMap* pCMap2 = cache.GetEmbeddedCMap(ToData(data2), data2.size());
+  EXPECT_EQ(pCMap1->GetMemorySize() + pCMap2->GetMemorySize(),
+            cache.GetStats().nBytes);
+
+  // Maps in use are never evicted.
+  cache.SetMaxBytes(0);
+  CPDF_CMapCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(0u, stats.nEvictions);
+  EXPECT_EQ(2u, stats.nMaps);
+
+  // Once released, they go.
+  EXPECT_TRUE(cache.ReleaseCMap(pCMap1));
+  stats = cache.GetStats();
+  EXPECT_EQ(1u, stats.nEvictions);
+  EXPECT_EQ(1u, stats.nMaps);
+  EXPECT_EQ(pCMap2->GetMemorySize(), stats.nBytes);
+  EXPECT_FALSE(cache.ReleaseCMap(pCMap1));
+
+  // The least recently used goes first.
+  cache.SetMaxBytes(CPDF_CMapCache::kDefaultMaxBytes);
+  pCMap1 = cache.GetEmbeddedCMap(ToData(data1), data1.size());
+  EXPECT_TRUE(cache.ReleaseCMap(pCMap1));
+  EXPECT_TRUE(cache.ReleaseCMap(pCMap2));
+  pCMap1 = cache.GetEmbeddedCMap(ToData(data1), data1.size());
+  EXPECT_TRUE(cache.ReleaseCMap(pCMap1));
+  cache.SetMaxBytes(cache.GetStats().nBytes - 1);
+  stats = cache.GetStats();
+  EXPECT_EQ(2u, stats.nEvictions);
+  EXPECT_EQ(1u, stats.nMaps);
+  pCMap1 = cache.GetEmbeddedCMap(ToData(data1), data1.size());
+  EXPECT_EQ(2u, cache.GetStats().nHits);
+  EXPECT_TRUE(cache.ReleaseCMap(pCMap1));
+}
@@ -52,6 +52,7 @@ void GetPredefinedEncoding(const CFX_ByteString& value, int* basemap) {
 CPDF_Font::CPDF_Font()
     : m_pFontFile(nullptr),
       m_pFontDict(nullptr),
+      m_pToUnicodeMap(nullptr),
       m_bToUnicodeLoaded(false),
       m_Flags(0),
       m_StemV(0),
@@ -60,6 +61,12 @@ CPDF_Font::CPDF_Font()
       m_ItalicAngle(0) {}
 
 CPDF_Font::~CPDF_Font() {
+  if (m_pToUnicodeMap) {
+    CPDF_ModuleMgr::Get()
+        ->GetPageModule()
+        ->GetFontGlobals()
+        ->m_CMapCache.ReleaseToUnicodeMap(m_pToUnicodeMap);
+  }
   if (m_pFontFile) {
     m_pDocument->GetPageData()->ReleaseFontFileStreamAcc(
         m_pFontFile->GetStream()->AsStream());
@@ -274,13 +281,30 @@ void CPDF_Font::CheckFontMetrics() {
 }
 
 void CPDF_Font::LoadUnicodeMap() const {
-  m_bToUnicodeLoaded = true;
-  CPDF_Stream* pStream = m_pFontDict->GetStreamFor("ToUnicode");
-  if (!pStream) {
+  CFX_AutoLock lock(GetLock());
+  if (m_bToUnicodeLoaded)
     return;
+
+  CPDF_Stream* pStream = m_pFontDict->GetStreamFor("ToUnicode");
+  if (pStream) {
+    CPDF_StreamAcc stream;
+    stream.LoadAllData(pStream, false);
+    m_pToUnicodeMap = CPDF_ModuleMgr::Get()
+                          ->GetPageModule()
+                          ->GetFontGlobals()
+                          ->m_CMapCache.GetToUnicodeMap(stream.GetData(),
+                                                        stream.GetSize());
   }
-  m_pToUnicodeMap = pdfium::MakeUnique<CPDF_ToUnicodeMap>();
-  m_pToUnicodeMap->Load(pStream);
+  m_bToUnicodeLoaded = true;
+}
+
+CFX_Mutex* CPDF_Font::GetLock() const {
+  if (m_pDocument)
+    return m_pDocument->GetLock();
+
+  // Stock fonts belong to no document.
+  static CFX_Mutex* s_pStockFontLock = new CFX_Mutex;
+  return s_pStockFontLock;
 }
 
 int CPDF_Font::GetStringWidth(const FX_CHAR* pString, int size) {
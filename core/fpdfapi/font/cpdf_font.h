@@ -7,9 +7,11 @@
 #ifndef CORE_FPDFAPI_FONT_CPDF_FONT_H_
 #define CORE_FPDFAPI_FONT_CPDF_FONT_H_
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
+#include "core/fxcrt/cfx_mutex.h"
 #include "core/fxcrt/fx_string.h"
 #include "core/fxcrt/fx_system.h"
 #include "core/fxge/fx_font.h"
@@ -99,6 +101,11 @@ class CPDF_Font {
   virtual bool Load() = 0;
 
   void LoadUnicodeMap() const;  // logically const only.
+
+  // Guards what fonts load on first use, so that several pages of the
+  // document can be handled at once. This is the document's lock, as the
+  // document's fonts share FreeType faces with its content parsing.
+  CFX_Mutex* GetLock() const;
   void LoadPDFEncoding(CPDF_Object* pEncoding,
                        int& iBaseEncoding,
                        std::vector<CFX_ByteString>* pCharNames,
@@ -114,8 +121,9 @@ class CPDF_Font {
   CFX_ByteString m_BaseFont;
   CPDF_StreamAcc* m_pFontFile;
   CPDF_Dictionary* m_pFontDict;
-  mutable std::unique_ptr<CPDF_ToUnicodeMap> m_pToUnicodeMap;
-  mutable bool m_bToUnicodeLoaded;
+  // Shared with other fonts through the CMap cache.
+  mutable const CPDF_ToUnicodeMap* m_pToUnicodeMap;
+  mutable std::atomic<bool> m_bToUnicodeLoaded;
   int m_Flags;
   FX_RECT m_FontBBox;
   int m_StemV;
@@ -0,0 +1,101 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/font/cpdf_rangetable.h"
+
+#include <algorithm>
+#include <iterator>
+
+CPDF_RangeTable::Builder::Builder() {}
+
+CPDF_RangeTable::Builder::~Builder() {}
+
+void CPDF_RangeTable::Builder::Add(uint32_t first,
+                                   uint32_t last,
+                                   uint32_t value) {
+  if (last < first)
+    return;
+
+  // Cut the ranges overlapping [first, last] down to the parts outside it.
+  auto it = m_Ranges.upper_bound(first);
+  if (it != m_Ranges.begin()) {
+    auto prev = std::prev(it);
+    Range range = prev->second;
+    if (range.m_Last >= first) {
+      if (range.m_First < first)
+        prev->second.m_Last = first - 1;
+      else
+        m_Ranges.erase(prev);
+      if (range.m_Last > last) {
+        m_Ranges[last + 1] = {last + 1, range.m_Last,
+                              range.m_Value + (last + 1 - range.m_First)};
+      }
+    }
+  }
+  it = m_Ranges.upper_bound(first);
+  while (it != m_Ranges.end() && it->first <= last) {
+    Range range = it->second;
+    it = m_Ranges.erase(it);
+    if (range.m_Last > last) {
+      m_Ranges[last + 1] = {last + 1, range.m_Last,
+                            range.m_Value + (last + 1 - range.m_First)};
+      break;
+    }
+  }
+  m_Ranges[first] = {first, last, value};
+}
+
+void CPDF_RangeTable::Builder::Build(CPDF_RangeTable* pTable) const {
+  std::vector<Range> ranges;
+  for (const auto& pair : m_Ranges) {
+    const Range& range = pair.second;
+    if (!ranges.empty()) {
+      Range& back = ranges.back();
+      if (back.m_Last + 1 == range.m_First &&
+          back.m_Value + (range.m_First - back.m_First) == range.m_Value) {
+        back.m_Last = range.m_Last;
+        continue;
+      }
+    }
+    ranges.push_back(range);
+  }
+  ranges.shrink_to_fit();
+  pTable->m_Ranges.swap(ranges);
+}
+
+CPDF_RangeTable::CPDF_RangeTable() {}
+
+CPDF_RangeTable::~CPDF_RangeTable() {}
+
+size_t CPDF_RangeTable::GetMemorySize() const {
+  return m_Ranges.capacity() * sizeof(Range);
+}
+
+bool CPDF_RangeTable::Lookup(uint32_t code, uint32_t* pValue) const {
+  auto it = std::upper_bound(
+      m_Ranges.begin(), m_Ranges.end(), code,
+      [](uint32_t code, const Range& range) { return code < range.m_First; });
+  if (it == m_Ranges.begin())
+    return false;
+
+  --it;
+  if (code > it->m_Last)
+    return false;
+
+  *pValue = it->m_Value + (code - it->m_First);
+  return true;
+}
+
+bool CPDF_RangeTable::ReverseLookup(uint32_t value, uint32_t* pCode) const {
+  // Ranges are in code order, and their values go up with the code, so the
+  // first range that holds |value| has the lowest code for it.
+  for (const Range& range : m_Ranges) {
+    uint32_t offset = value - range.m_Value;
+    if (offset <= range.m_Last - range.m_First) {
+      *pCode = range.m_First + offset;
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,60 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFAPI_FONT_CPDF_RANGETABLE_H_
+#define CORE_FPDFAPI_FONT_CPDF_RANGETABLE_H_
+
+#include <map>
+#include <vector>
+
+#include "core/fxcrt/fx_system.h"
+
+// A map from char codes to values, as CMaps and ToUnicode maps hold,
+// compiled into sorted, disjoint ranges over which the value goes up by one
+// with the code. Lookups are binary searches over a flat array.
+class CPDF_RangeTable {
+ public:
+  struct Range {
+    uint32_t m_First;
+    uint32_t m_Last;
+    uint32_t m_Value;  // For |m_First|.
+  };
+
+  // Collects the mappings of a map as it is parsed. Mappings override the
+  // ones added before them for the codes they share, as the maps are read.
+  class Builder {
+   public:
+    Builder();
+    ~Builder();
+
+    // Maps |first| to |value|, |first| + 1 to |value| + 1, and so on up to
+    // |last|. Does nothing if |last| is less than |first|.
+    void Add(uint32_t first, uint32_t last, uint32_t value);
+    // Compiles what was added into |pTable|, merging ranges where the
+    // values carry on from one to the next.
+    void Build(CPDF_RangeTable* pTable) const;
+
+   private:
+    std::map<uint32_t, Range> m_Ranges;  // Disjoint, by |m_First|.
+  };
+
+  CPDF_RangeTable();
+  ~CPDF_RangeTable();
+
+  bool IsEmpty() const { return m_Ranges.empty(); }
+  size_t GetRangeCount() const { return m_Ranges.size(); }
+  // The memory the ranges take, besides the table itself.
+  size_t GetMemorySize() const;
+
+  // Looks up the value for |code|, returning false if it is not mapped.
+  bool Lookup(uint32_t code, uint32_t* pValue) const;
+  // Looks up the lowest code mapped to |value|, returning false if there
+  // is none.
+  bool ReverseLookup(uint32_t value, uint32_t* pCode) const;
+
+ private:
+  std::vector<Range> m_Ranges;
+};
+
+#endif  // CORE_FPDFAPI_FONT_CPDF_RANGETABLE_H_
@@ -0,0 +1,117 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/font/cpdf_rangetable.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+uint32_t LookupOrZero(const CPDF_RangeTable& table, uint32_t code) {
+  uint32_t value = 0;
+  return table.Lookup(code, &value) ? value : 0;
+}
+
+}  // namespace
+
+TEST(cpdf_rangetable, Empty) {
+  CPDF_RangeTable table;
+  CPDF_RangeTable::Builder().Build(&table);
+  EXPECT_TRUE(table.IsEmpty());
+  uint32_t value = 0;
+  EXPECT_FALSE(table.Lookup(0, &value));
+  EXPECT_FALSE(table.Lookup(0xffffffff, &value));
+  EXPECT_FALSE(table.ReverseLookup(0, &value));
+}
+
+TEST(cpdf_rangetable, Lookup) {
+  CPDF_RangeTable::Builder builder;
+  builder.Add(0x20, 0x7e, 1);
+  builder.Add(0x8140, 0x817e, 633);
+  builder.Add(0xfffffff0, 0xffffffff, 10);
+  builder.Add(0x90, 0x80, 5);  // Backwards, so nothing.
+  CPDF_RangeTable table;
+  builder.Build(&table);
+  EXPECT_EQ(3u, table.GetRangeCount());
+
+  uint32_t value = 0;
+  EXPECT_FALSE(table.Lookup(0x1f, &value));
+  EXPECT_TRUE(table.Lookup(0x20, &value));
+  EXPECT_EQ(1u, value);
+  EXPECT_EQ(0x5fu, LookupOrZero(table, 0x7e));
+  EXPECT_FALSE(table.Lookup(0x7f, &value));
+  EXPECT_FALSE(table.Lookup(0x85, &value));
+  EXPECT_EQ(650u, LookupOrZero(table, 0x8151));
+  EXPECT_FALSE(table.Lookup(0x10000, &value));
+  EXPECT_EQ(25u, LookupOrZero(table, 0xffffffff));
+}
+
+TEST(cpdf_rangetable, LaterMappingsWin) {
+  CPDF_RangeTable::Builder builder;
+  builder.Add(10, 29, 100);
+  builder.Add(15, 15, 7);  // Splits the range.
+  builder.Add(25, 34, 200);  // Overlaps its end.
+  builder.Add(5, 11, 300);  // Overlaps its start.
+  builder.Add(40, 44, 400);
+  builder.Add(41, 43, 500);
+  builder.Add(38, 46, 600);  // Covers whole ranges.
+  builder.Add(16, 16, 106);  // Carries on from 17.
+  CPDF_RangeTable table;
+  builder.Build(&table);
+
+  EXPECT_EQ(300u, LookupOrZero(table, 5));
+  EXPECT_EQ(306u, LookupOrZero(table, 11));
+  EXPECT_EQ(102u, LookupOrZero(table, 12));
+  EXPECT_EQ(104u, LookupOrZero(table, 14));
+  EXPECT_EQ(7u, LookupOrZero(table, 15));
+  EXPECT_EQ(106u, LookupOrZero(table, 16));
+  EXPECT_EQ(114u, LookupOrZero(table, 24));
+  EXPECT_EQ(200u, LookupOrZero(table, 25));
+  EXPECT_EQ(209u, LookupOrZero(table, 34));
+  uint32_t value = 0;
+  EXPECT_FALSE(table.Lookup(35, &value));
+  EXPECT_FALSE(table.Lookup(37, &value));
+  for (uint32_t code = 38; code <= 46; ++code)
+    EXPECT_EQ(600 + code - 38, LookupOrZero(table, code));
+
+  // 5-11, 12-14, 15, 16-24, 25-34 and 38-46.
+  EXPECT_EQ(6u, table.GetRangeCount());
+}
+
+TEST(cpdf_rangetable, MergesRanges) {
+  CPDF_RangeTable::Builder builder;
+  for (uint32_t code = 0; code < 1000; ++code)
+    builder.Add(code, code, code + 0x4e00);
+  builder.Add(1000, 1000, 0);
+  builder.Add(1001, 1002, 1001 + 0x4e00);
+  CPDF_RangeTable table;
+  builder.Build(&table);
+  EXPECT_EQ(3u, table.GetRangeCount());
+  EXPECT_EQ(0x4e00u + 999, LookupOrZero(table, 999));
+  EXPECT_EQ(0x4e00u + 1002, LookupOrZero(table, 1002));
+}
+
+TEST(cpdf_rangetable, ReverseLookup) {
+  CPDF_RangeTable::Builder builder;
+  builder.Add(0x30, 0x39, 0x30);
+  builder.Add(0x10, 0x19, 0x35);
+  builder.Add(0x50, 0x5f, 0xfffffff8);  // Values wrap around.
+  CPDF_RangeTable table;
+  builder.Build(&table);
+
+  uint32_t code = 0;
+  EXPECT_TRUE(table.ReverseLookup(0x30, &code));
+  EXPECT_EQ(0x30u, code);
+  // Both map to it, the lowest code wins.
+  EXPECT_TRUE(table.ReverseLookup(0x36, &code));
+  EXPECT_EQ(0x11u, code);
+  EXPECT_TRUE(table.ReverseLookup(0x3e, &code));
+  EXPECT_EQ(0x19u, code);
+  EXPECT_TRUE(table.ReverseLookup(0xfffffff9, &code));
+  EXPECT_EQ(0x51u, code);
+  EXPECT_TRUE(table.ReverseLookup(2, &code));
+  EXPECT_EQ(0x5au, code);
+  EXPECT_FALSE(table.ReverseLookup(0x3f, &code));
+  EXPECT_FALSE(table.ReverseLookup(0x2f, &code));
+}
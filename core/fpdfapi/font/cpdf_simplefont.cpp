@@ -12,7 +12,8 @@
 #include "core/fxge/fx_freetype.h"
 #include "third_party/base/numerics/safe_math.h"
 
-CPDF_SimpleFont::CPDF_SimpleFont() : m_BaseEncoding(PDFFONT_ENCODING_BUILTIN) {
+CPDF_SimpleFont::CPDF_SimpleFont()
+    : m_BaseEncoding(PDFFONT_ENCODING_BUILTIN), m_bMetricsPreloaded(false) {
   FXSYS_memset(m_CharWidth, 0xff, sizeof(m_CharWidth));
   FXSYS_memset(m_GlyphIndex, 0xff, sizeof(m_GlyphIndex));
   FXSYS_memset(m_ExtGID, 0xff, sizeof(m_ExtGID));
@@ -82,7 +83,10 @@ int CPDF_SimpleFont::GetCharWidthF(uint32_t charcode) {
   if (charcode > 0xff)
     charcode = 0;
 
-  if (m_CharWidth[charcode] == 0xffff) {
+  // Metrics are loaded on first use only without threads. With them,
+  // PreloadCharMetrics() has loaded them all before the font is handed out,
+  // and they are only read from then on, so this takes no lock.
+  if (m_CharWidth[charcode] == 0xffff && !m_bMetricsPreloaded) {
     LoadCharMetrics(charcode);
     if (m_CharWidth[charcode] == 0xffff) {
       m_CharWidth[charcode] = 0;
@@ -95,12 +99,26 @@ FX_RECT CPDF_SimpleFont::GetCharBBox(uint32_t charcode) {
   if (charcode > 0xff)
     charcode = 0;
 
-  if (m_CharBBox[charcode].left == -1)
+  // See GetCharWidthF(). Boxes that did not load are not tried again once
+  // preloaded.
+  if (m_CharBBox[charcode].left == -1 && !m_bMetricsPreloaded)
     LoadCharMetrics(charcode);
-
   return m_CharBBox[charcode];
 }
 
+void CPDF_SimpleFont::PreloadCharMetrics() {
+  // With several threads, load all the metrics now so that the getters
+  // above only ever read them later on.
+  if (!CFX_Mutex::IsThreadSafeMode())
+    return;
+
+  for (uint32_t charcode = 0; charcode < 256; ++charcode) {
+    GetCharWidthF(charcode);
+    GetCharBBox(charcode);
+  }
+  m_bMetricsPreloaded = true;
+}
+
 bool CPDF_SimpleFont::LoadCommon() {
   CPDF_Dictionary* pFontDesc = m_pFontDict->GetDictFor("FontDescriptor");
   if (pFontDesc) {
@@ -141,8 +159,10 @@ bool CPDF_SimpleFont::LoadCommon() {
                   m_Font.IsTTFont());
   LoadGlyphMap();
   m_CharNames.clear();
-  if (!m_Font.GetFace())
+  if (!m_Font.GetFace()) {
+    PreloadCharMetrics();
     return true;
+  }
 
   if (m_Flags & PDFFONT_ALLCAP) {
     unsigned char kLowercases[][2] = {{'a', 'z'}, {0xe0, 0xf6}, {0xf8, 0xfd}};
@@ -162,6 +182,7 @@ bool CPDF_SimpleFont::LoadCommon() {
     }
   }
   CheckFontMetrics();
+  PreloadCharMetrics();
   return true;
 }
 
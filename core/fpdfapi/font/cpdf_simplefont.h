@@ -35,6 +35,7 @@ class CPDF_SimpleFont : public CPDF_Font {
   bool LoadCommon();
   void LoadSubstFont();
   void LoadCharMetrics(int charcode);
+  void PreloadCharMetrics();
 
   CPDF_FontEncoding m_Encoding;
   uint16_t m_GlyphIndex[256];
@@ -44,6 +45,7 @@ class CPDF_SimpleFont : public CPDF_Font {
   uint16_t m_CharWidth[256];
   FX_RECT m_CharBBox[256];
   bool m_bUseFontWidth;
+  bool m_bMetricsPreloaded;
 };
 
 #endif  // CORE_FPDFAPI_FONT_CPDF_SIMPLEFONT_H_
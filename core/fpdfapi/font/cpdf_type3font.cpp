@@ -13,6 +13,7 @@
 #include "core/fpdfapi/page/pageint.h"
 #include "core/fpdfapi/parser/cpdf_array.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/parser/cpdf_stream.h"
 #include "core/fxcrt/fx_system.h"
 #include "third_party/base/stl_util.h"
@@ -92,6 +93,7 @@ void CPDF_Type3Font::CheckType3FontMetrics() {
 }
 
 CPDF_Type3Char* CPDF_Type3Font::LoadChar(uint32_t charcode) {
+  CFX_AutoLock lock(m_pDocument->GetLock());
   if (m_CharLoadingDepth >= FPDF_MAX_TYPE3_FORM_LEVEL)
     return nullptr;
 
@@ -12,12 +12,13 @@
 #include <vector>
 
 #include "core/fpdfapi/font/cpdf_cidfont.h"
+#include "core/fpdfapi/font/cpdf_cmapcache.h"
+#include "core/fpdfapi/font/cpdf_rangetable.h"
 #include "core/fxcrt/fx_basic.h"
 
 class CPDF_CID2UnicodeMap;
 class CPDF_CMap;
 class CPDF_Font;
-class CPDF_Stream;
 
 using FXFT_Library = void*;
 
@@ -68,6 +69,7 @@ class CPDF_FontGlobals {
                  std::unique_ptr<CPDF_Font> pFont);
 
   CPDF_CMapManager m_CMapManager;
+  CPDF_CMapCache m_CMapCache;
   struct {
     const struct FXCMAP_CMap* m_pMapList;
     uint32_t m_Count;
@@ -93,7 +95,10 @@ class CPDF_CMapParser {
   ~CPDF_CMapParser();
   void Initialize(CPDF_CMap* pMap);
   void ParseWord(const CFX_ByteStringC& str);
-  CFX_BinaryBuf m_AddMaps;
+
+  CPDF_RangeTable::Builder m_Maps;
+  // The mappings of codes beyond 16 bits.
+  CPDF_RangeTable::Builder m_AddMaps;
 
  private:
   friend class fpdf_font_cid_CMap_GetCode_Test;
@@ -148,6 +153,11 @@ class CPDF_CMap {
   int CountChar(const FX_CHAR* pString, int size) const;
   int AppendChar(FX_CHAR* str, uint32_t charcode) const;
 
+  // Whether this is a CMap embedded in the document rather than a
+  // predefined one.
+  bool IsEmbedded() const { return m_bEmbedded; }
+  size_t GetMemorySize() const;
+
  private:
   friend class CPDF_CMapParser;
   friend class CPDF_CIDFont;
@@ -159,8 +169,9 @@ class CPDF_CMap {
   CodingScheme m_CodingScheme;
   int m_nCodeRanges;
   uint8_t* m_pLeadingBytes;
-  uint16_t* m_pMapping;
-  uint8_t* m_pAddMapping;
+  bool m_bEmbedded;
+  CPDF_RangeTable m_Mapping;
+  CPDF_RangeTable m_AddMapping;
   bool m_bLoaded;
   const FXCMAP_CMap* m_pEmbedMap;
 };
@@ -185,10 +196,11 @@ class CPDF_ToUnicodeMap {
   CPDF_ToUnicodeMap();
   ~CPDF_ToUnicodeMap();
 
-  void Load(CPDF_Stream* pStream);
+  void Load(const uint8_t* pData, uint32_t size);
 
   CFX_WideString Lookup(uint32_t charcode) const;
   uint32_t ReverseLookup(FX_WCHAR unicode) const;
+  size_t GetMemorySize() const;
 
  private:
   friend class fpdf_font_StringToCode_Test;
@@ -199,7 +211,9 @@ class CPDF_ToUnicodeMap {
 
   uint32_t GetUnicode();
 
-  std::map<uint32_t, uint32_t> m_Map;
+  // Codes map to a char, or to (offset << 16) | 0xffff for a string at
+  // |offset| in |m_MultiCharBuf|, preceded by its length.
+  CPDF_RangeTable m_Map;
   CPDF_CID2UnicodeMap* m_pBaseMap;
   CFX_WideTextBuf m_MultiCharBuf;
 };
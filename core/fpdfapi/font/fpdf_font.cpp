@@ -19,7 +19,6 @@
 #include "core/fpdfapi/parser/cpdf_name.h"
 #include "core/fpdfapi/parser/cpdf_number.h"
 #include "core/fpdfapi/parser/cpdf_simple_parser.h"
-#include "core/fpdfapi/parser/cpdf_stream_acc.h"
 #include "core/fxcrt/fx_ext.h"
 #include "core/fxcrt/fx_safe_types.h"
 #include "core/fxge/fx_freetype.h"
@@ -97,9 +96,8 @@ void CPDF_FontGlobals::Clear(CPDF_Document* pDoc) {
 }
 
 CFX_WideString CPDF_ToUnicodeMap::Lookup(uint32_t charcode) const {
-  auto it = m_Map.find(charcode);
-  if (it != m_Map.end()) {
-    uint32_t value = it->second;
+  uint32_t value;
+  if (m_Map.Lookup(charcode, &value)) {
     FX_WCHAR unicode = (FX_WCHAR)(value & 0xffff);
     if (unicode != 0xffff) {
       return unicode;
@@ -126,11 +124,15 @@ CFX_WideString CPDF_ToUnicodeMap::Lookup(uint32_t charcode) const {
 }
 
 uint32_t CPDF_ToUnicodeMap::ReverseLookup(FX_WCHAR unicode) const {
-  for (const auto& pair : m_Map) {
-    if (pair.second == static_cast<uint32_t>(unicode))
-      return pair.first;
-  }
-  return 0;
+  uint32_t charcode;
+  if (!m_Map.ReverseLookup(static_cast<uint32_t>(unicode), &charcode))
+    return 0;
+  return charcode;
+}
+
+size_t CPDF_ToUnicodeMap::GetMemorySize() const {
+  return sizeof(*this) + m_Map.GetMemorySize() +
+         m_MultiCharBuf.GetLength() * sizeof(FX_WCHAR);
 }
 
 // Static.
@@ -206,11 +208,10 @@ uint32_t CPDF_ToUnicodeMap::GetUnicode() {
   return uni.ValueOrDefault(0);
 }
 
-void CPDF_ToUnicodeMap::Load(CPDF_Stream* pStream) {
+void CPDF_ToUnicodeMap::Load(const uint8_t* pData, uint32_t size) {
   CIDSet cid_set = CIDSET_UNKNOWN;
-  CPDF_StreamAcc stream;
-  stream.LoadAllData(pStream, false);
-  CPDF_SimpleParser parser(stream.GetData(), stream.GetSize());
+  CPDF_RangeTable::Builder map;
+  CPDF_SimpleParser parser(pData, size);
   while (1) {
     CFX_ByteStringC word = parser.GetWord();
     if (word.IsEmpty()) {
@@ -230,9 +231,9 @@ void CPDF_ToUnicodeMap::Load(CPDF_Stream* pStream) {
           continue;
         }
         if (len == 1) {
-          m_Map[srccode] = destcode.GetAt(0);
+          map.Add(srccode, srccode, destcode.GetAt(0));
         } else {
-          m_Map[srccode] = GetUnicode();
+          map.Add(srccode, srccode, GetUnicode());
           m_MultiCharBuf.AppendChar(destcode.GetLength());
           m_MultiCharBuf << destcode;
         }
@@ -261,9 +262,9 @@ void CPDF_ToUnicodeMap::Load(CPDF_Stream* pStream) {
               continue;
             }
             if (len == 1) {
-              m_Map[code] = destcode.GetAt(0);
+              map.Add(code, code, destcode.GetAt(0));
             } else {
-              m_Map[code] = GetUnicode();
+              map.Add(code, code, GetUnicode());
               m_MultiCharBuf.AppendChar(destcode.GetLength());
               m_MultiCharBuf << destcode;
             }
@@ -272,12 +273,8 @@ void CPDF_ToUnicodeMap::Load(CPDF_Stream* pStream) {
         } else {
           CFX_WideString destcode = StringToWideString(start.AsStringC());
           int len = destcode.GetLength();
-          uint32_t value = 0;
           if (len == 1) {
-            value = StringToCode(start.AsStringC());
-            for (uint32_t code = lowcode; code <= highcode; code++) {
-              m_Map[code] = value++;
-            }
+            map.Add(lowcode, highcode, StringToCode(start.AsStringC()));
           } else {
             for (uint32_t code = lowcode; code <= highcode; code++) {
               CFX_WideString retcode;
@@ -286,7 +283,7 @@ void CPDF_ToUnicodeMap::Load(CPDF_Stream* pStream) {
               } else {
                 retcode = StringDataAdd(destcode);
               }
-              m_Map[code] = GetUnicode();
+              map.Add(code, code, GetUnicode());
               m_MultiCharBuf.AppendChar(retcode.GetLength());
               m_MultiCharBuf << retcode;
               destcode = retcode;
@@ -304,6 +301,7 @@ void CPDF_ToUnicodeMap::Load(CPDF_Stream* pStream) {
       cid_set = CIDSET_GB1;
     }
   }
+  map.Build(&m_Map);
   if (cid_set) {
     m_pBaseMap = CPDF_ModuleMgr::Get()
                      ->GetPageModule()
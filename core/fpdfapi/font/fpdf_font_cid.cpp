@@ -196,21 +196,6 @@ CFX_ByteStringC CMap_GetString(const CFX_ByteStringC& word) {
   return CFX_ByteStringC(&word[1], word.GetLength() - 2);
 }
 
-int CompareDWORD(const void* data1, const void* data2) {
-  return (*(uint32_t*)data1) - (*(uint32_t*)data2);
-}
-
-int CompareCID(const void* key, const void* element) {
-  if ((*(uint32_t*)key) < (*(uint32_t*)element)) {
-    return -1;
-  }
-  if ((*(uint32_t*)key) >
-      (*(uint32_t*)element) + ((uint32_t*)element)[1] / 65536) {
-    return 1;
-  }
-  return 0;
-}
-
 int CheckCodeRange(uint8_t* codes,
                    int size,
                    CMap_CodeRange* pRanges,
@@ -335,7 +320,6 @@ void CPDF_CMapParser::Initialize(CPDF_CMap* pCMap) {
   m_pCMap = pCMap;
   m_Status = 0;
   m_CodeSeq = 0;
-  m_AddMaps.EstimateSize(0, 10240);
 }
 
 void CPDF_CMapParser::ParseWord(const CFX_ByteStringC& word) {
@@ -382,14 +366,11 @@ void CPDF_CMapParser::ParseWord(const CFX_ByteStringC& word) {
       StartCID = (uint16_t)m_CodePoints[2];
     }
     if (EndCode < 0x10000) {
-      for (uint32_t code = StartCode; code <= EndCode; code++) {
-        m_pCMap->m_pMapping[code] = (uint16_t)(StartCID + code - StartCode);
-      }
+      m_Maps.Add(StartCode, EndCode, StartCID);
     } else {
-      uint32_t buf[2];
-      buf[0] = StartCode;
-      buf[1] = ((EndCode - StartCode) << 16) + StartCID;
-      m_AddMaps.AppendBlock(buf, sizeof buf);
+      // Ranges of longer codes run for 16 bits' worth of codes at most.
+      m_AddMaps.Add(StartCode, StartCode + ((EndCode - StartCode) & 0xffff),
+                    StartCID);
     }
     m_CodeSeq = 0;
   } else if (m_Status == 3) {
@@ -496,15 +477,12 @@ CPDF_CMap::CPDF_CMap() {
   m_CodingScheme = TwoBytes;
   m_bVertical = false;
   m_bLoaded = false;
-  m_pMapping = nullptr;
   m_pLeadingBytes = nullptr;
-  m_pAddMapping = nullptr;
+  m_bEmbedded = false;
   m_pEmbedMap = nullptr;
   m_nCodeRanges = 0;
 }
 CPDF_CMap::~CPDF_CMap() {
-  FX_Free(m_pMapping);
-  FX_Free(m_pAddMapping);
   FX_Free(m_pLeadingBytes);
 }
 
@@ -561,7 +539,7 @@ void CPDF_CMap::LoadPredefined(CPDF_CMapManager* pMgr,
 }
 
 void CPDF_CMap::LoadEmbedded(const uint8_t* pData, uint32_t size) {
-  m_pMapping = FX_Alloc(uint16_t, 65536);
+  m_bEmbedded = true;
   CPDF_CMapParser parser;
   parser.Initialize(this);
   CPDF_SimpleParser syntax(pData, size);
@@ -572,14 +550,17 @@ void CPDF_CMap::LoadEmbedded(const uint8_t* pData, uint32_t size) {
     }
     parser.ParseWord(word);
   }
-  if (m_CodingScheme == MixedFourBytes && parser.m_AddMaps.GetSize()) {
-    m_pAddMapping = FX_Alloc(uint8_t, parser.m_AddMaps.GetSize() + 4);
-    *(uint32_t*)m_pAddMapping = parser.m_AddMaps.GetSize() / 8;
-    FXSYS_memcpy(m_pAddMapping + 4, parser.m_AddMaps.GetBuffer(),
-                 parser.m_AddMaps.GetSize());
-    FXSYS_qsort(m_pAddMapping + 4, parser.m_AddMaps.GetSize() / 8, 8,
-                CompareDWORD);
-  }
+  parser.m_Maps.Build(&m_Mapping);
+  if (m_CodingScheme == MixedFourBytes)
+    parser.m_AddMaps.Build(&m_AddMapping);
+}
+
+size_t CPDF_CMap::GetMemorySize() const {
+  size_t size =
+      sizeof(*this) + m_Mapping.GetMemorySize() + m_AddMapping.GetMemorySize();
+  if (m_pLeadingBytes)
+    size += m_nCodeRanges ? m_nCodeRanges * sizeof(CMap_CodeRange) : 256;
+  return size;
 }
 
 uint16_t CPDF_CMap::CIDFromCharCode(uint32_t charcode) const {
@@ -589,21 +570,15 @@ uint16_t CPDF_CMap::CIDFromCharCode(uint32_t charcode) const {
   if (m_pEmbedMap) {
     return FPDFAPI_CIDFromCharCode(m_pEmbedMap, charcode);
   }
-  if (!m_pMapping) {
+  if (!m_bEmbedded) {
     return (uint16_t)charcode;
   }
-  if (charcode >> 16) {
-    if (m_pAddMapping) {
-      void* found = FXSYS_bsearch(&charcode, m_pAddMapping + 4,
-                                  *(uint32_t*)m_pAddMapping, 8, CompareCID);
-      if (!found)
-        return 0;
-      return (uint16_t)(((uint32_t*)found)[1] % 65536 + charcode -
-                        *(uint32_t*)found);
-    }
-    return 0;
-  }
-  return m_pMapping[charcode];
+  uint32_t cid = 0;
+  if (charcode >> 16)
+    m_AddMapping.Lookup(charcode, &cid);
+  else
+    m_Mapping.Lookup(charcode, &cid);
+  return static_cast<uint16_t>(cid);
 }
 
 uint32_t CPDF_CMap::GetNextChar(const FX_CHAR* pString,
@@ -7,6 +7,7 @@
 #ifndef CORE_FPDFAPI_PAGE_CPDF_COLORSPACE_H_
 #define CORE_FPDFAPI_PAGE_CPDF_COLORSPACE_H_
 
+#include <atomic>
 #include <memory>
 
 #include "core/fxcrt/fx_string.h"
@@ -98,7 +99,7 @@ class CPDF_ColorSpace {
   int m_Family;
   uint32_t m_nComponents;
   CPDF_Array* m_pArray;
-  uint32_t m_dwStdConversion;
+  std::atomic<uint32_t> m_dwStdConversion;
 };
 
 namespace std {
@@ -48,6 +48,7 @@ CPDF_DocPageData::~CPDF_DocPageData() {
 }
 
 void CPDF_DocPageData::Clear(bool bForceRelease) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   m_bForceClear = bForceRelease;
 
   for (auto& it : m_PatternMap) {
@@ -128,6 +129,7 @@ void CPDF_DocPageData::Clear(bool bForceRelease) {
 }
 
 CPDF_Font* CPDF_DocPageData::GetFont(CPDF_Dictionary* pFontDict) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   if (!pFontDict)
     return nullptr;
 
@@ -154,6 +156,7 @@ CPDF_Font* CPDF_DocPageData::GetFont(CPDF_Dictionary* pFontDict) {
 
 CPDF_Font* CPDF_DocPageData::GetStandardFont(const CFX_ByteString& fontName,
                                              CPDF_FontEncoding* pEncoding) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   if (fontName.IsEmpty())
     return nullptr;
 
@@ -197,6 +200,7 @@ CPDF_Font* CPDF_DocPageData::GetStandardFont(const CFX_ByteString& fontName,
 }
 
 void CPDF_DocPageData::ReleaseFont(const CPDF_Dictionary* pFontDict) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   if (!pFontDict)
     return;
 
@@ -219,6 +223,7 @@ void CPDF_DocPageData::ReleaseFont(const CPDF_Dictionary* pFontDict) {
 CPDF_ColorSpace* CPDF_DocPageData::GetColorSpace(
     CPDF_Object* pCSObj,
     const CPDF_Dictionary* pResources) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   std::set<CPDF_Object*> visited;
   return GetColorSpaceImpl(pCSObj, pResources, &visited);
 }
@@ -304,6 +309,7 @@ CPDF_ColorSpace* CPDF_DocPageData::GetColorSpaceImpl(
 }
 
 CPDF_ColorSpace* CPDF_DocPageData::GetCopiedColorSpace(CPDF_Object* pCSObj) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   if (!pCSObj)
     return nullptr;
 
@@ -315,6 +321,7 @@ CPDF_ColorSpace* CPDF_DocPageData::GetCopiedColorSpace(CPDF_Object* pCSObj) {
 }
 
 void CPDF_DocPageData::ReleaseColorSpace(const CPDF_Object* pColorSpace) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   if (!pColorSpace)
     return;
 
@@ -338,6 +345,7 @@ void CPDF_DocPageData::ReleaseColorSpace(const CPDF_Object* pColorSpace) {
 CPDF_Pattern* CPDF_DocPageData::GetPattern(CPDF_Object* pPatternObj,
                                            bool bShading,
                                            const CFX_Matrix& matrix) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   if (!pPatternObj)
     return nullptr;
 
@@ -379,6 +387,7 @@ CPDF_Pattern* CPDF_DocPageData::GetPattern(CPDF_Object* pPatternObj,
 }
 
 void CPDF_DocPageData::ReleasePattern(const CPDF_Object* pPatternObj) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   if (!pPatternObj)
     return;
 
@@ -399,6 +408,7 @@ void CPDF_DocPageData::ReleasePattern(const CPDF_Object* pPatternObj) {
 }
 
 CPDF_Image* CPDF_DocPageData::GetImage(uint32_t dwStreamObjNum) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   ASSERT(dwStreamObjNum);
   auto it = m_ImageMap.find(dwStreamObjNum);
   if (it != m_ImageMap.end())
@@ -411,6 +421,7 @@ CPDF_Image* CPDF_DocPageData::GetImage(uint32_t dwStreamObjNum) {
 }
 
 void CPDF_DocPageData::ReleaseImage(uint32_t dwStreamObjNum) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   ASSERT(dwStreamObjNum);
   auto it = m_ImageMap.find(dwStreamObjNum);
   if (it == m_ImageMap.end())
@@ -432,6 +443,7 @@ void CPDF_DocPageData::ReleaseImage(uint32_t dwStreamObjNum) {
 
 CPDF_IccProfile* CPDF_DocPageData::GetIccProfile(
     CPDF_Stream* pIccProfileStream) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   if (!pIccProfileStream)
     return nullptr;
 
@@ -458,6 +470,7 @@ CPDF_IccProfile* CPDF_DocPageData::GetIccProfile(
 }
 
 void CPDF_DocPageData::ReleaseIccProfile(const CPDF_IccProfile* pIccProfile) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   ASSERT(pIccProfile);
 
   for (auto it = m_IccProfileMap.begin(); it != m_IccProfileMap.end(); ++it) {
@@ -478,6 +491,7 @@ void CPDF_DocPageData::ReleaseIccProfile(const CPDF_IccProfile* pIccProfile) {
 
 CPDF_StreamAcc* CPDF_DocPageData::GetFontFileStreamAcc(
     CPDF_Stream* pFontStream) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   ASSERT(pFontStream);
 
   auto it = m_FontFileMap.find(pFontStream);
@@ -501,6 +515,7 @@ CPDF_StreamAcc* CPDF_DocPageData::GetFontFileStreamAcc(
 
 void CPDF_DocPageData::ReleaseFontFileStreamAcc(
     const CPDF_Stream* pFontStream) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   if (!pFontStream)
     return;
 
@@ -524,6 +539,7 @@ void CPDF_DocPageData::ReleaseFontFileStreamAcc(
 
 CPDF_CountedColorSpace* CPDF_DocPageData::FindColorSpacePtr(
     CPDF_Object* pCSObj) const {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   if (!pCSObj)
     return nullptr;
 
@@ -533,6 +549,7 @@ CPDF_CountedColorSpace* CPDF_DocPageData::FindColorSpacePtr(
 
 CPDF_CountedPattern* CPDF_DocPageData::FindPatternPtr(
     CPDF_Object* pPatternObj) const {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   if (!pPatternObj)
     return nullptr;
 
@@ -22,6 +22,7 @@ CPDF_PageObjectHolder::CPDF_PageObjectHolder()
       m_Transparency(0),
       m_bBackgroundAlphaNeeded(false),
       m_bHasImageMask(false),
+      m_bTextOnly(false),
       m_ParseState(CONTENT_NOT_PARSED) {}
 
 CPDF_PageObjectHolder::~CPDF_PageObjectHolder() {}
@@ -44,6 +44,12 @@ class CPDF_PageObjectHolder {
   bool HasImageMask() const { return m_bHasImageMask; }
   void SetHasImageMask(bool value) { m_bHasImageMask = value; }
 
+  // Set before parsing to only create text objects, and the form objects
+  // that hold them, for callers that just want the text. Paths, clips,
+  // colors, images and shadings are skipped.
+  bool IsTextOnly() const { return m_bTextOnly; }
+  void SetTextOnly(bool value) { m_bTextOnly = value; }
+
   void Transform(const CFX_Matrix& matrix);
   CFX_FloatRect CalcBoundingBox() const;
 
@@ -62,6 +68,7 @@ class CPDF_PageObjectHolder {
 
   bool m_bBackgroundAlphaNeeded;
   bool m_bHasImageMask;
+  bool m_bTextOnly;
   ParseState m_ParseState;
   std::unique_ptr<CPDF_ContentParser> m_pParser;
   CPDF_PageObjectList m_PageObjectList;
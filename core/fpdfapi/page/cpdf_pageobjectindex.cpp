@@ -0,0 +1,143 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/page/cpdf_pageobjectindex.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/fpdfapi/page/cpdf_pageobject.h"
+#include "core/fpdfapi/page/cpdf_pageobjectlist.h"
+
+namespace {
+
+const size_t kNodeCapacity = 16;
+
+}  // namespace
+
+CPDF_PageObjectIndex::CPDF_PageObjectIndex(
+    const CPDF_PageObjectList* pObjectList) {
+  std::vector<Entry> entries;
+  for (const auto& pObj : *pObjectList) {
+    if (!pObj)
+      continue;
+
+    uint32_t index = static_cast<uint32_t>(m_Objects.size());
+    m_Objects.push_back(pObj.get());
+    CFX_FloatRect box(pObj->m_Left, pObj->m_Bottom, pObj->m_Right,
+                      pObj->m_Top);
+    if (box.left <= box.right && box.bottom <= box.top)
+      entries.push_back({box, index});
+    else
+      m_Unindexed.push_back(index);
+  }
+  if (entries.empty())
+    return;
+
+  SortTileRecursive(&entries);
+  m_Entries = entries;
+  std::vector<Entry> level = AddNodes(m_Entries, true);
+  while (level.size() > 1) {
+    SortTileRecursive(&level);
+    level = AddNodes(level, false);
+  }
+}
+
+CPDF_PageObjectIndex::~CPDF_PageObjectIndex() {}
+
+std::vector<CPDF_PageObject*> CPDF_PageObjectIndex::Query(
+    const CFX_FloatRect& rect) const {
+  std::vector<uint32_t> hits;
+  for (uint32_t index : m_Unindexed) {
+    const CPDF_PageObject* pObj = m_Objects[index];
+    if (Intersects(CFX_FloatRect(pObj->m_Left, pObj->m_Bottom, pObj->m_Right,
+                                 pObj->m_Top),
+                   rect)) {
+      hits.push_back(index);
+    }
+  }
+  if (!m_Nodes.empty()) {
+    std::vector<uint32_t> pending(1, m_Nodes.size() - 1);
+    while (!pending.empty()) {
+      const Node& node = m_Nodes[pending.back()];
+      pending.pop_back();
+      if (!Intersects(node.m_Box, rect))
+        continue;
+
+      for (uint32_t i = node.m_nFirst; i < node.m_nFirst + node.m_nCount;
+           ++i) {
+        if (!node.m_bLeaf) {
+          pending.push_back(m_Children[i]);
+          continue;
+        }
+        if (Intersects(m_Entries[i].m_Box, rect))
+          hits.push_back(m_Entries[i].m_nIndex);
+      }
+    }
+  }
+  std::sort(hits.begin(), hits.end());
+
+  std::vector<CPDF_PageObject*> result;
+  result.reserve(hits.size());
+  for (uint32_t index : hits)
+    result.push_back(m_Objects[index]);
+  return result;
+}
+
+// static
+void CPDF_PageObjectIndex::SortTileRecursive(std::vector<Entry>* pEntries) {
+  // Sort-Tile-Recursive packing: cut the boxes into vertical slices by
+  // centre x, then order each slice by centre y, so that every run of
+  // kNodeCapacity entries covers a compact area.
+  size_t nCount = pEntries->size();
+  size_t nNodes = (nCount + kNodeCapacity - 1) / kNodeCapacity;
+  size_t nSlices = static_cast<size_t>(std::ceil(std::sqrt(nNodes)));
+  size_t nSliceSize = nSlices * kNodeCapacity;
+  std::sort(pEntries->begin(), pEntries->end(),
+            [](const Entry& a, const Entry& b) {
+              return a.m_Box.left + a.m_Box.right <
+                     b.m_Box.left + b.m_Box.right;
+            });
+  for (size_t start = 0; start < nCount; start += nSliceSize) {
+    size_t end = std::min(start + nSliceSize, nCount);
+    std::sort(pEntries->begin() + start, pEntries->begin() + end,
+              [](const Entry& a, const Entry& b) {
+                return a.m_Box.bottom + a.m_Box.top <
+                       b.m_Box.bottom + b.m_Box.top;
+              });
+  }
+}
+
+// static
+bool CPDF_PageObjectIndex::Intersects(const CFX_FloatRect& box,
+                                      const CFX_FloatRect& rect) {
+  return !(box.left > rect.right || box.right < rect.left ||
+           box.bottom > rect.top || box.top < rect.bottom);
+}
+
+std::vector<CPDF_PageObjectIndex::Entry> CPDF_PageObjectIndex::AddNodes(
+    const std::vector<Entry>& children,
+    bool bLeaf) {
+  std::vector<Entry> parents;
+  for (size_t start = 0; start < children.size(); start += kNodeCapacity) {
+    size_t end = std::min(start + kNodeCapacity, children.size());
+    Node node;
+    node.m_Box = children[start].m_Box;
+    node.m_nCount = static_cast<uint32_t>(end - start);
+    node.m_bLeaf = bLeaf;
+    node.m_nFirst = static_cast<uint32_t>(bLeaf ? start : m_Children.size());
+    for (size_t i = start; i < end; ++i) {
+      const CFX_FloatRect& box = children[i].m_Box;
+      node.m_Box.left = std::min(node.m_Box.left, box.left);
+      node.m_Box.bottom = std::min(node.m_Box.bottom, box.bottom);
+      node.m_Box.right = std::max(node.m_Box.right, box.right);
+      node.m_Box.top = std::max(node.m_Box.top, box.top);
+      if (!bLeaf)
+        m_Children.push_back(children[i].m_nIndex);
+    }
+    parents.push_back({node.m_Box, static_cast<uint32_t>(m_Nodes.size())});
+    m_Nodes.push_back(node);
+  }
+  return parents;
+}
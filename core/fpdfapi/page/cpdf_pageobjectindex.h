@@ -0,0 +1,61 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFAPI_PAGE_CPDF_PAGEOBJECTINDEX_H_
+#define CORE_FPDFAPI_PAGE_CPDF_PAGEOBJECTINDEX_H_
+
+#include <vector>
+
+#include "core/fxcrt/fx_coordinates.h"
+#include "core/fxcrt/fx_system.h"
+
+class CPDF_PageObject;
+class CPDF_PageObjectList;
+
+// Static R-tree over the bounding boxes of a page object list, so that the
+// objects visible in a small part of a large page can be found without
+// testing every object. The index is a snapshot: it must be rebuilt if the
+// list or any object's bounding box changes. Queries may run concurrently.
+class CPDF_PageObjectIndex {
+ public:
+  explicit CPDF_PageObjectIndex(const CPDF_PageObjectList* pObjectList);
+  ~CPDF_PageObjectIndex();
+
+  // Returns, in list (and thus painting) order, the objects whose bounding
+  // boxes intersect |rect|, which is in object space. The intersection test
+  // is the one the renderer applies to every object.
+  std::vector<CPDF_PageObject*> Query(const CFX_FloatRect& rect) const;
+
+  size_t GetObjectCount() const { return m_Objects.size(); }
+
+ private:
+  struct Node {
+    CFX_FloatRect m_Box;
+    uint32_t m_nFirst;  // Into |m_Entries| for leaves, else |m_Children|.
+    uint32_t m_nCount;
+    bool m_bLeaf;
+  };
+
+  struct Entry {
+    CFX_FloatRect m_Box;
+    uint32_t m_nIndex;  // Into |m_Objects| or |m_Nodes|.
+  };
+
+  static void SortTileRecursive(std::vector<Entry>* pEntries);
+  static bool Intersects(const CFX_FloatRect& box, const CFX_FloatRect& rect);
+
+  // Groups |children|, which are |m_Entries| if |bLeaf| and nodes
+  // otherwise, under new nodes and returns entries for those.
+  std::vector<Entry> AddNodes(const std::vector<Entry>& children, bool bLeaf);
+
+  std::vector<CPDF_PageObject*> m_Objects;
+  std::vector<Entry> m_Entries;
+  std::vector<uint32_t> m_Children;
+  std::vector<Node> m_Nodes;  // The root, if any, is last.
+
+  // Objects with inverted or NaN boxes, which are tested one by one.
+  std::vector<uint32_t> m_Unindexed;
+};
+
+#endif  // CORE_FPDFAPI_PAGE_CPDF_PAGEOBJECTINDEX_H_
@@ -0,0 +1,114 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/page/cpdf_pageobjectindex.h"
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "core/fpdfapi/page/cpdf_pageobjectlist.h"
+#include "core/fpdfapi/page/cpdf_pathobject.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+CPDF_PageObject* AddObject(CPDF_PageObjectList* pList,
+                           FX_FLOAT left,
+                           FX_FLOAT bottom,
+                           FX_FLOAT right,
+                           FX_FLOAT top) {
+  auto pObj = pdfium::MakeUnique<CPDF_PathObject>();
+  pObj->m_Left = left;
+  pObj->m_Bottom = bottom;
+  pObj->m_Right = right;
+  pObj->m_Top = top;
+  pList->push_back(std::move(pObj));
+  return pList->back().get();
+}
+
+// What the renderer does without an index.
+std::vector<CPDF_PageObject*> LinearQuery(const CPDF_PageObjectList& list,
+                                          const CFX_FloatRect& rect) {
+  std::vector<CPDF_PageObject*> result;
+  for (const auto& pObj : list) {
+    if (!pObj || pObj->m_Left > rect.right || pObj->m_Right < rect.left ||
+        pObj->m_Bottom > rect.top || pObj->m_Top < rect.bottom) {
+      continue;
+    }
+    result.push_back(pObj.get());
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(cpdf_pageobjectindex, Empty) {
+  CPDF_PageObjectList list;
+  CPDF_PageObjectIndex index(&list);
+  EXPECT_EQ(0u, index.GetObjectCount());
+  EXPECT_TRUE(index.Query(CFX_FloatRect(0, 0, 100, 100)).empty());
+}
+
+TEST(cpdf_pageobjectindex, PaintOrder) {
+  CPDF_PageObjectList list;
+  CPDF_PageObject* pTop = AddObject(&list, 50, 50, 60, 60);
+  CPDF_PageObject* pBackground = AddObject(&list, 0, 0, 100, 100);
+  list.push_back(nullptr);
+  CPDF_PageObject* pEdge = AddObject(&list, 100, 100, 110, 110);
+  AddObject(&list, 200, 200, 210, 210);
+
+  CPDF_PageObjectIndex index(&list);
+  EXPECT_EQ(4u, index.GetObjectCount());
+  std::vector<CPDF_PageObject*> expected = {pTop, pBackground, pEdge};
+  EXPECT_EQ(expected, index.Query(CFX_FloatRect(55, 55, 100, 100)));
+  expected = {pBackground};
+  EXPECT_EQ(expected, index.Query(CFX_FloatRect(10, 10, 20, 20)));
+  EXPECT_TRUE(index.Query(CFX_FloatRect(120, 120, 190, 190)).empty());
+}
+
+TEST(cpdf_pageobjectindex, OddBoxes) {
+  const FX_FLOAT kNaN = std::numeric_limits<FX_FLOAT>::quiet_NaN();
+  CPDF_PageObjectList list;
+  AddObject(&list, kNaN, kNaN, kNaN, kNaN);
+  AddObject(&list, 30, 30, 20, 20);
+  AddObject(&list, 5, 5, 5, 5);
+  for (int i = 0; i < 100; ++i)
+    AddObject(&list, i, i, i + 1, i + 1);
+
+  CPDF_PageObjectIndex index(&list);
+  CFX_FloatRect rects[] = {CFX_FloatRect(0, 0, 10, 10),
+                           CFX_FloatRect(25, 25, 26, 26),
+                           CFX_FloatRect(500, 500, 600, 600)};
+  for (const auto& rect : rects)
+    EXPECT_EQ(LinearQuery(list, rect), index.Query(rect));
+}
+
+TEST(cpdf_pageobjectindex, MatchesLinearScan) {
+  CPDF_PageObjectList list;
+  // A deterministic scatter of small and large objects over a large page.
+  uint32_t seed = 1;
+  auto next = [&seed]() {
+    seed = seed * 1103515245 + 12345;
+    return static_cast<int>((seed >> 16) & 0x7fff);
+  };
+  for (int i = 0; i < 5000; ++i) {
+    FX_FLOAT x = next() % 2000;
+    FX_FLOAT y = next() % 2000;
+    FX_FLOAT size = i % 100 ? next() % 20 : next() % 1000;
+    AddObject(&list, x, y, x + size, y + size);
+  }
+
+  CPDF_PageObjectIndex index(&list);
+  EXPECT_EQ(5000u, index.GetObjectCount());
+  for (int y = 0; y < 2000; y += 256) {
+    for (int x = 0; x < 2000; x += 256) {
+      CFX_FloatRect tile(x, y, x + 256, y + 256);
+      EXPECT_EQ(LinearQuery(list, tile), index.Query(tile));
+    }
+  }
+  CFX_FloatRect page(0, 0, 2000, 2000);
+  EXPECT_EQ(5000u, index.Query(page).size());
+}
@@ -256,6 +256,7 @@ CPDF_StreamContentParser::CPDF_StreamContentParser(
       m_pParentResources(pParentResources),
       m_pResources(pResources),
       m_pObjectHolder(pObjHolder),
+      m_bTextOnly(pObjHolder->IsTextOnly()),
       m_Level(level),
       m_ParamStartPos(0),
       m_ParamCount(0),
@@ -570,6 +571,39 @@ CPDF_StreamContentParser::InitializeOpCodes() {
   });
 }
 
+// static
+CPDF_StreamContentParser::OpCodes
+CPDF_StreamContentParser::InitializeTextOnlyOpCodes() {
+  // Operators that build paths, clips and colors, set how lines are drawn,
+  // or paint shadings. Text objects do not depend on any of these.
+  static const uint32_t kGraphicsOpCodes[] = {
+      FXBSTR_ID('B', 0, 0, 0),   FXBSTR_ID('B', '*', 0, 0),
+      FXBSTR_ID('C', 'S', 0, 0), FXBSTR_ID('F', 0, 0, 0),
+      FXBSTR_ID('G', 0, 0, 0),   FXBSTR_ID('J', 0, 0, 0),
+      FXBSTR_ID('K', 0, 0, 0),   FXBSTR_ID('M', 0, 0, 0),
+      FXBSTR_ID('R', 'G', 0, 0), FXBSTR_ID('S', 0, 0, 0),
+      FXBSTR_ID('S', 'C', 0, 0), FXBSTR_ID('S', 'C', 'N', 0),
+      FXBSTR_ID('W', 0, 0, 0),   FXBSTR_ID('W', '*', 0, 0),
+      FXBSTR_ID('b', 0, 0, 0),   FXBSTR_ID('b', '*', 0, 0),
+      FXBSTR_ID('c', 0, 0, 0),   FXBSTR_ID('c', 's', 0, 0),
+      FXBSTR_ID('d', 0, 0, 0),   FXBSTR_ID('f', 0, 0, 0),
+      FXBSTR_ID('f', '*', 0, 0), FXBSTR_ID('g', 0, 0, 0),
+      FXBSTR_ID('h', 0, 0, 0),   FXBSTR_ID('i', 0, 0, 0),
+      FXBSTR_ID('j', 0, 0, 0),   FXBSTR_ID('k', 0, 0, 0),
+      FXBSTR_ID('l', 0, 0, 0),   FXBSTR_ID('m', 0, 0, 0),
+      FXBSTR_ID('n', 0, 0, 0),   FXBSTR_ID('r', 'e', 0, 0),
+      FXBSTR_ID('r', 'g', 0, 0), FXBSTR_ID('r', 'i', 0, 0),
+      FXBSTR_ID('s', 0, 0, 0),   FXBSTR_ID('s', 'c', 0, 0),
+      FXBSTR_ID('s', 'c', 'n', 0), FXBSTR_ID('s', 'h', 0, 0),
+      FXBSTR_ID('v', 0, 0, 0),   FXBSTR_ID('w', 0, 0, 0),
+      FXBSTR_ID('y', 0, 0, 0),
+  };
+  OpCodes opcodes = InitializeOpCodes();
+  for (uint32_t opid : kGraphicsOpCodes)
+    opcodes.erase(opid);
+  return opcodes;
+}
+
 void CPDF_StreamContentParser::OnOperator(const FX_CHAR* op) {
   int i = 0;
   uint32_t opid = 0;
@@ -583,9 +617,11 @@ void CPDF_StreamContentParser::OnOperator(const FX_CHAR* op) {
   }
 
   static const OpCodes s_OpCodes = InitializeOpCodes();
+  static const OpCodes s_TextOnlyOpCodes = InitializeTextOnlyOpCodes();
 
-  auto it = s_OpCodes.find(opid);
-  if (it != s_OpCodes.end())
+  const OpCodes& opcodes = m_bTextOnly ? s_TextOnlyOpCodes : s_OpCodes;
+  auto it = opcodes.find(opid);
+  if (it != opcodes.end())
     (this->*it->second)();
 }
 
@@ -682,7 +718,10 @@ void CPDF_StreamContentParser::Handle_BeginImage() {
       break;
     }
   }
-  AddImage(std::move(pStream));
+  // The data still has to be read to find where it ends, but no image is
+  // made of it.
+  if (!m_bTextOnly)
+    AddImage(std::move(pStream));
 }
 
 void CPDF_StreamContentParser::Handle_BeginMarkedContent() {
@@ -768,6 +807,9 @@ void CPDF_StreamContentParser::Handle_ExecuteXObject() {
     type = pXObject->GetDict()->GetStringFor("Subtype");
 
   if (type == "Image") {
+    if (m_bTextOnly)
+      return;
+
     CPDF_ImageObject* pObj = pXObject->IsInline()
                                  ? AddImage(std::unique_ptr<CPDF_Stream>(
                                        ToStream(pXObject->Clone())))
@@ -786,6 +828,7 @@ void CPDF_StreamContentParser::AddForm(CPDF_Stream* pStream) {
   std::unique_ptr<CPDF_FormObject> pFormObj(new CPDF_FormObject);
   pFormObj->m_pForm.reset(
       new CPDF_Form(m_pDocument, m_pPageResources, pStream, m_pResources));
+  pFormObj->m_pForm->SetTextOnly(m_bTextOnly);
   pFormObj->m_FormMatrix = m_pCurStates->m_CTM;
   pFormObj->m_FormMatrix.Concat(m_mtContentToUser);
   CPDF_AllStates status;
@@ -76,6 +76,7 @@ class CPDF_StreamContentParser {
   using OpCodes =
       std::unordered_map<uint32_t, void (CPDF_StreamContentParser::*)()>;
   static OpCodes InitializeOpCodes();
+  static OpCodes InitializeTextOnlyOpCodes();
 
   void AddNumberParam(const FX_CHAR* str, int len);
   void AddObjectParam(std::unique_ptr<CPDF_Object> pObj);
@@ -194,6 +195,7 @@ class CPDF_StreamContentParser {
   CPDF_Dictionary* m_pParentResources;
   CPDF_Dictionary* m_pResources;
   CPDF_PageObjectHolder* m_pObjectHolder;
+  const bool m_bTextOnly;
   int m_Level;
   CFX_Matrix m_mtContentToUser;
   CFX_FloatRect m_BBox;
@@ -651,6 +651,28 @@ bool CPDF_ExpIntFunc::v_Call(FX_FLOAT* inputs, FX_FLOAT* results) const {
   return true;
 }
 
+void CPDF_ExpIntFunc::v_CallBatch(FX_FLOAT* inputs,
+                                  size_t count,
+                                  FX_FLOAT* results) const {
+  CFX_FixedBufGrow<FX_FLOAT, 16> diff_buf(m_nOrigOutputs);
+  FX_FLOAT* diffs = diff_buf;
+  for (uint32_t j = 0; j < m_nOrigOutputs; j++)
+    diffs[j] = m_pEndValues[j] - m_pBeginValues[j];
+
+  // Every input yields m_nOrigOutputs results, so the points' inputs can be
+  // walked as one flat array. Linear interpolation, the usual case, skips
+  // pow() altogether since x^1 is exactly x.
+  size_t total = count * m_nInputs;
+  for (size_t i = 0; i < total; i++) {
+    FX_FLOAT t = m_Exponent == 1.0f
+                     ? inputs[i]
+                     : (FX_FLOAT)FXSYS_pow(inputs[i], m_Exponent);
+    FX_FLOAT* pResults = results + i * m_nOrigOutputs;
+    for (uint32_t j = 0; j < m_nOrigOutputs; j++)
+      pResults[j] = m_pBeginValues[j] + t * diffs[j];
+  }
+}
+
 CPDF_StitchFunc::CPDF_StitchFunc()
     : CPDF_Function(Type::kType3Stitching),
       m_pBounds(nullptr),
@@ -841,6 +863,49 @@ bool CPDF_Function::Call(FX_FLOAT* inputs,
   return true;
 }
 
+bool CPDF_Function::CallBatch(FX_FLOAT* inputs,
+                              uint32_t ninputs,
+                              size_t count,
+                              FX_FLOAT* results) const {
+  if (m_nInputs != ninputs)
+    return false;
+
+  for (size_t k = 0; k < count; k++) {
+    FX_FLOAT* pInputs = inputs + k * m_nInputs;
+    for (uint32_t i = 0; i < m_nInputs; i++) {
+      if (pInputs[i] < m_pDomains[i * 2])
+        pInputs[i] = m_pDomains[i * 2];
+      else if (pInputs[i] > m_pDomains[i * 2 + 1])
+        pInputs[i] = m_pDomains[i * 2] + 1;
+    }
+  }
+  v_CallBatch(inputs, count, results);
+  if (m_pRanges) {
+    for (size_t k = 0; k < count; k++) {
+      FX_FLOAT* pResults = results + k * m_nOutputs;
+      for (uint32_t i = 0; i < m_nOutputs; i++) {
+        if (pResults[i] < m_pRanges[i * 2])
+          pResults[i] = m_pRanges[i * 2];
+        else if (pResults[i] > m_pRanges[i * 2 + 1])
+          pResults[i] = m_pRanges[i * 2 + 1];
+      }
+    }
+  }
+  return true;
+}
+
+void CPDF_Function::v_CallBatch(FX_FLOAT* inputs,
+                                size_t count,
+                                FX_FLOAT* results) const {
+  for (size_t k = 0; k < count; k++) {
+    FX_FLOAT* pResults = results + k * m_nOutputs;
+    if (k)
+      FXSYS_memcpy(pResults, pResults - m_nOutputs,
+                   m_nOutputs * sizeof(FX_FLOAT));
+    v_Call(inputs + k * m_nInputs, pResults);
+  }
+}
+
 const CPDF_SampledFunc* CPDF_Function::ToSampledFunc() const {
   return m_Type == Type::kType0Sampled
              ? static_cast<const CPDF_SampledFunc*>(this)
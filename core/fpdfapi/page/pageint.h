@@ -37,6 +37,18 @@ class CPDF_Function {
             uint32_t ninputs,
             FX_FLOAT* results,
             int& nresults) const;
+
+  // Evaluates the function at |count| points at once. |inputs| holds
+  // |ninputs| values per point, which are clamped to the domain in place as
+  // Call() does, and |results| receives CountOutputs() values per point.
+  // Each point's results start out as those of the point before it, and the
+  // first point's as whatever |results| holds, so a point that fails to
+  // evaluate repeats the previous values just as a buffer reused across
+  // Call()s would.
+  bool CallBatch(FX_FLOAT* inputs,
+                 uint32_t ninputs,
+                 size_t count,
+                 FX_FLOAT* results) const;
   uint32_t CountInputs() const { return m_nInputs; }
   uint32_t CountOutputs() const { return m_nOutputs; }
   FX_FLOAT GetDomain(int i) const { return m_pDomains[i]; }
@@ -53,6 +65,11 @@ class CPDF_Function {
   virtual bool v_Init(CPDF_Object* pObj) = 0;
   virtual bool v_Call(FX_FLOAT* inputs, FX_FLOAT* results) const = 0;
 
+  // Evaluates |count| points whose inputs have been clamped to the domain.
+  virtual void v_CallBatch(FX_FLOAT* inputs,
+                           size_t count,
+                           FX_FLOAT* results) const;
+
   uint32_t m_nInputs;
   uint32_t m_nOutputs;
   FX_FLOAT* m_pDomains;
@@ -68,6 +85,9 @@ class CPDF_ExpIntFunc : public CPDF_Function {
   // CPDF_Function
   bool v_Init(CPDF_Object* pObj) override;
   bool v_Call(FX_FLOAT* inputs, FX_FLOAT* results) const override;
+  void v_CallBatch(FX_FLOAT* inputs,
+                   size_t count,
+                   FX_FLOAT* results) const override;
 
   uint32_t m_nOrigOutputs;
   FX_FLOAT m_Exponent;
@@ -6,6 +6,7 @@
 
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 
+#include <algorithm>
 #include <set>
 #include <utility>
 
@@ -19,6 +20,22 @@
 #include "third_party/base/logging.h"
 #include "third_party/base/stl_util.h"
 
+namespace {
+
+template <typename FlatMap>
+typename FlatMap::const_iterator LowerBound(const FlatMap& map,
+                                            const CFX_ByteString& key) {
+  return std::lower_bound(
+      map.begin(), map.end(), key,
+      [](const typename FlatMap::value_type& entry,
+         const CFX_ByteString& key) { return entry.m_Key < key; });
+}
+
+}  // namespace
+
+// static
+const size_t CPDF_Dictionary::kMaxFlatSize;
+
 CPDF_Dictionary::CPDF_Dictionary()
     : CPDF_Dictionary(CFX_WeakPtr<CFX_ByteStringPool>()) {}
 
@@ -29,9 +46,15 @@ CPDF_Dictionary::~CPDF_Dictionary() {
   // Mark the object as deleted so that it will not be deleted again,
   // and break cyclic references.
   m_ObjNum = kInvalidObjNum;
-  for (auto& it : m_Map) {
-    if (it.second && it.second->GetObjNum() == kInvalidObjNum)
-      it.second.release();
+  auto release_deleted = [](std::unique_ptr<CPDF_Object>& pObj) {
+    if (pObj && pObj->GetObjNum() == kInvalidObjNum)
+      pObj.release();
+  };
+  for (auto& entry : m_Flat)
+    release_deleted(entry.m_pObj);
+  if (m_pTree) {
+    for (auto& it : m_pTree->m_Map)
+      release_deleted(it.second);
   }
 }
 
@@ -68,16 +91,16 @@ std::unique_ptr<CPDF_Object> CPDF_Dictionary::CloneNonCyclic(
   auto pCopy = pdfium::MakeUnique<CPDF_Dictionary>(m_pPool);
   for (const auto& it : *this) {
     if (!pdfium::ContainsKey(*pVisited, it.second.get())) {
-      pCopy->m_Map.insert(std::make_pair(
-          it.first, it.second->CloneNonCyclic(bDirect, pVisited)));
+      pCopy->GetOrAddSlot(it.first) =
+          it.second->CloneNonCyclic(bDirect, pVisited);
     }
   }
   return std::move(pCopy);
 }
 
 CPDF_Object* CPDF_Dictionary::GetObjectFor(const CFX_ByteString& key) const {
-  auto it = m_Map.find(key);
-  return it != m_Map.end() ? it->second.get() : nullptr;
+  const std::unique_ptr<CPDF_Object>* pSlot = FindSlot(key);
+  return pSlot ? pSlot->get() : nullptr;
 }
 
 CPDF_Object* CPDF_Dictionary::GetDirectObjectFor(
@@ -162,7 +185,7 @@ CFX_Matrix CPDF_Dictionary::GetMatrixFor(const CFX_ByteString& key) const {
 }
 
 bool CPDF_Dictionary::KeyExist(const CFX_ByteString& key) const {
-  return pdfium::ContainsKey(m_Map, key);
+  return !!FindSlot(key);
 }
 
 bool CPDF_Dictionary::IsSignatureDict() const {
@@ -175,42 +198,40 @@ bool CPDF_Dictionary::IsSignatureDict() const {
 CPDF_Object* CPDF_Dictionary::SetFor(const CFX_ByteString& key,
                                      std::unique_ptr<CPDF_Object> pObj) {
   if (!pObj) {
-    m_Map.erase(key);
+    EraseKey(key);
     return nullptr;
   }
   ASSERT(pObj->IsInline());
   CPDF_Object* pRet = pObj.get();
-  m_Map[MaybeIntern(key)] = std::move(pObj);
+  GetOrAddSlot(MaybeIntern(key)) = std::move(pObj);
   return pRet;
 }
 
 void CPDF_Dictionary::ConvertToIndirectObjectFor(
     const CFX_ByteString& key,
     CPDF_IndirectObjectHolder* pHolder) {
-  auto it = m_Map.find(key);
-  if (it == m_Map.end() || it->second->IsReference())
+  std::unique_ptr<CPDF_Object>* pSlot = FindSlot(key);
+  if (!pSlot || (*pSlot)->IsReference())
     return;
 
-  CPDF_Object* pObj = pHolder->AddIndirectObject(std::move(it->second));
-  it->second = pdfium::MakeUnique<CPDF_Reference>(pHolder, pObj->GetObjNum());
+  CPDF_Object* pObj = pHolder->AddIndirectObject(std::move(*pSlot));
+  *pSlot = pdfium::MakeUnique<CPDF_Reference>(pHolder, pObj->GetObjNum());
 }
 
 void CPDF_Dictionary::RemoveFor(const CFX_ByteString& key) {
-  m_Map.erase(key);
+  EraseKey(key);
 }
 
 void CPDF_Dictionary::ReplaceKey(const CFX_ByteString& oldkey,
                                  const CFX_ByteString& newkey) {
-  auto old_it = m_Map.find(oldkey);
-  if (old_it == m_Map.end())
-    return;
-
-  auto new_it = m_Map.find(newkey);
-  if (new_it == old_it)
+  std::unique_ptr<CPDF_Object>* pOldSlot = FindSlot(oldkey);
+  if (!pOldSlot || FindSlot(newkey) == pOldSlot)
     return;
 
-  m_Map[MaybeIntern(newkey)] = std::move(old_it->second);
-  m_Map.erase(old_it);
+  // |oldkey| may refer to the key being removed, so it is not used after.
+  std::unique_ptr<CPDF_Object> pObj = std::move(*pOldSlot);
+  EraseKey(oldkey);
+  GetOrAddSlot(MaybeIntern(newkey)) = std::move(pObj);
 }
 
 void CPDF_Dictionary::SetRectFor(const CFX_ByteString& key,
@@ -236,3 +257,64 @@ void CPDF_Dictionary::SetMatrixFor(const CFX_ByteString& key,
 CFX_ByteString CPDF_Dictionary::MaybeIntern(const CFX_ByteString& str) {
   return m_pPool ? m_pPool->Intern(str) : str;
 }
+
+const std::unique_ptr<CPDF_Object>* CPDF_Dictionary::FindSlot(
+    const CFX_ByteString& key) const {
+  if (m_pTree) {
+    auto it = m_pTree->m_Index.find(key);
+    return it != m_pTree->m_Index.end() ? it->second : nullptr;
+  }
+  uint32_t hash = FX_HashCode_GetA(key.AsStringC(), false);
+  for (const FlatEntry& entry : m_Flat) {
+    if (entry.m_Hash == hash && entry.m_Key == key)
+      return &entry.m_pObj;
+  }
+  return nullptr;
+}
+
+std::unique_ptr<CPDF_Object>* CPDF_Dictionary::FindSlot(
+    const CFX_ByteString& key) {
+  return const_cast<std::unique_ptr<CPDF_Object>*>(
+      static_cast<const CPDF_Dictionary*>(this)->FindSlot(key));
+}
+
+std::unique_ptr<CPDF_Object>& CPDF_Dictionary::GetOrAddSlot(
+    const CFX_ByteString& key) {
+  if (m_pTree) {
+    std::unique_ptr<CPDF_Object>*& pSlot = m_pTree->m_Index[key];
+    if (!pSlot)
+      pSlot = &m_pTree->m_Map[key];
+    return *pSlot;
+  }
+
+  auto it = m_Flat.begin() + (LowerBound(m_Flat, key) - m_Flat.cbegin());
+  if (it != m_Flat.end() && it->m_Key == key)
+    return it->m_pObj;
+
+  if (m_Flat.size() < kMaxFlatSize) {
+    uint32_t hash = FX_HashCode_GetA(key.AsStringC(), false);
+    return m_Flat.insert(it, FlatEntry{key, nullptr, hash})->m_pObj;
+  }
+
+  m_pTree = pdfium::MakeUnique<Tree>();
+  for (FlatEntry& entry : m_Flat) {
+    auto tree_it = m_pTree->m_Map.emplace_hint(
+        m_pTree->m_Map.end(), entry.m_Key, std::move(entry.m_pObj));
+    m_pTree->m_Index[entry.m_Key] = &tree_it->second;
+  }
+  m_Flat.clear();
+  m_Flat.shrink_to_fit();
+  return GetOrAddSlot(key);
+}
+
+void CPDF_Dictionary::EraseKey(const CFX_ByteString& key) {
+  if (m_pTree) {
+    // |key| may be the key being erased from the map, so erase it last.
+    m_pTree->m_Index.erase(key);
+    m_pTree->m_Map.erase(key);
+    return;
+  }
+  auto it = m_Flat.begin() + (LowerBound(m_Flat, key) - m_Flat.cbegin());
+  if (it != m_Flat.end() && it->m_Key == key)
+    m_Flat.erase(it);
+}
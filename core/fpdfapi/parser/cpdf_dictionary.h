@@ -10,7 +10,9 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "core/fpdfapi/parser/cpdf_object.h"
 #include "core/fxcrt/cfx_string_pool_template.h"
@@ -22,9 +24,74 @@
 class CPDF_IndirectObjectHolder;
 
 class CPDF_Dictionary : public CPDF_Object {
+ private:
+  // Most dictionaries have a handful of keys, which are kept in a vector
+  // sorted by key along with their hash codes, so that a lookup compares
+  // hash codes rather than strings. Past |kMaxFlatSize| keys the dictionary
+  // switches for good to a tree, indexed by a hash map for lookups. Both
+  // keep keys ordered, which iteration relies on.
+  struct FlatEntry {
+    CFX_ByteString m_Key;
+    std::unique_ptr<CPDF_Object> m_pObj;
+    uint32_t m_Hash;
+  };
+  using FlatMap = std::vector<FlatEntry>;
+  using TreeMap = std::map<CFX_ByteString, std::unique_ptr<CPDF_Object>>;
+  struct Tree {
+    TreeMap m_Map;
+    std::unordered_map<CFX_ByteString, std::unique_ptr<CPDF_Object>*> m_Index;
+  };
+
  public:
-  using const_iterator =
-      std::map<CFX_ByteString, std::unique_ptr<CPDF_Object>>::const_iterator;
+  static const size_t kMaxFlatSize = 32;
+
+  // What iteration yields, whichever way the keys are stored.
+  struct Entry {
+    const CFX_ByteString& first;
+    const std::unique_ptr<CPDF_Object>& second;
+  };
+
+  class const_iterator {
+   public:
+    // Lets |it->first| work even though dereferencing makes a temporary.
+    class Arrow {
+     public:
+      explicit Arrow(const Entry& entry) : m_Entry(entry) {}
+      const Entry* operator->() const { return &m_Entry; }
+
+     private:
+      const Entry m_Entry;
+    };
+
+    explicit const_iterator(FlatMap::const_iterator it)
+        : m_bTree(false), m_FlatIt(it) {}
+    explicit const_iterator(TreeMap::const_iterator it)
+        : m_bTree(true), m_TreeIt(it) {}
+
+    Entry operator*() const {
+      return m_bTree ? Entry{m_TreeIt->first, m_TreeIt->second}
+                     : Entry{m_FlatIt->m_Key, m_FlatIt->m_pObj};
+    }
+    Arrow operator->() const { return Arrow(**this); }
+    const_iterator& operator++() {
+      if (m_bTree)
+        ++m_TreeIt;
+      else
+        ++m_FlatIt;
+      return *this;
+    }
+    bool operator==(const const_iterator& that) const {
+      return m_bTree ? m_TreeIt == that.m_TreeIt : m_FlatIt == that.m_FlatIt;
+    }
+    bool operator!=(const const_iterator& that) const {
+      return !(*this == that);
+    }
+
+   private:
+    bool m_bTree;
+    FlatMap::const_iterator m_FlatIt;
+    TreeMap::const_iterator m_TreeIt;
+  };
 
   CPDF_Dictionary();
   explicit CPDF_Dictionary(const CFX_WeakPtr<CFX_ByteStringPool>& pPool);
@@ -38,7 +105,9 @@ class CPDF_Dictionary : public CPDF_Object {
   CPDF_Dictionary* AsDictionary() override;
   const CPDF_Dictionary* AsDictionary() const override;
 
-  size_t GetCount() const { return m_Map.size(); }
+  size_t GetCount() const {
+    return m_pTree ? m_pTree->m_Map.size() : m_Flat.size();
+  }
   CPDF_Object* GetObjectFor(const CFX_ByteString& key) const;
   CPDF_Object* GetDirectObjectFor(const CFX_ByteString& key) const;
   CFX_ByteString GetStringFor(const CFX_ByteString& key) const;
@@ -61,7 +130,7 @@ class CPDF_Dictionary : public CPDF_Object {
   bool KeyExist(const CFX_ByteString& key) const;
   bool IsSignatureDict() const;
 
-  // Set* functions invalidate iterators for the element with the key |key|.
+  // Set* functions invalidate iterators.
   // Takes ownership of |pObj|, returns an unowned pointer to it.
   CPDF_Object* SetFor(const CFX_ByteString& key,
                       std::unique_ptr<CPDF_Object> pObj);
@@ -90,14 +159,20 @@ class CPDF_Dictionary : public CPDF_Object {
   void ConvertToIndirectObjectFor(const CFX_ByteString& key,
                                   CPDF_IndirectObjectHolder* pHolder);
 
-  // Invalidates iterators for the element with the key |key|.
+  // Invalidates iterators.
   void RemoveFor(const CFX_ByteString& key);
 
-  // Invalidates iterators for the element with the key |oldkey|.
+  // Invalidates iterators.
   void ReplaceKey(const CFX_ByteString& oldkey, const CFX_ByteString& newkey);
 
-  const_iterator begin() const { return m_Map.begin(); }
-  const_iterator end() const { return m_Map.end(); }
+  const_iterator begin() const {
+    return m_pTree ? const_iterator(m_pTree->m_Map.cbegin())
+                   : const_iterator(m_Flat.cbegin());
+  }
+  const_iterator end() const {
+    return m_pTree ? const_iterator(m_pTree->m_Map.cend())
+                   : const_iterator(m_Flat.cend());
+  }
 
   CFX_WeakPtr<CFX_ByteStringPool> GetByteStringPool() const { return m_pPool; }
 
@@ -107,8 +182,18 @@ class CPDF_Dictionary : public CPDF_Object {
       bool bDirect,
       std::set<const CPDF_Object*>* visited) const override;
 
+  // Returns the slot holding the value for |key|, or nullptr.
+  const std::unique_ptr<CPDF_Object>* FindSlot(const CFX_ByteString& key) const;
+  std::unique_ptr<CPDF_Object>* FindSlot(const CFX_ByteString& key);
+
+  // Returns the slot for |key|, adding an empty one if there is none.
+  std::unique_ptr<CPDF_Object>& GetOrAddSlot(const CFX_ByteString& key);
+
+  void EraseKey(const CFX_ByteString& key);
+
   CFX_WeakPtr<CFX_ByteStringPool> m_pPool;
-  std::map<CFX_ByteString, std::unique_ptr<CPDF_Object>> m_Map;
+  FlatMap m_Flat;
+  std::unique_ptr<Tree> m_pTree;  // Replaces |m_Flat| once non-null.
 };
 
 inline CPDF_Dictionary* ToDictionary(CPDF_Object* obj) {
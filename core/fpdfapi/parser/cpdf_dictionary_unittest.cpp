@@ -0,0 +1,216 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "core/fpdfapi/parser/cpdf_number.h"
+#include "core/fxcrt/cfx_string_pool_template.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+CFX_ByteString KeyFor(int i) {
+  CFX_ByteString key;
+  key.Format("K%03d", i);
+  return key;
+}
+
+std::vector<CFX_ByteString> KeysOf(const CPDF_Dictionary& dict) {
+  std::vector<CFX_ByteString> keys;
+  for (const auto& it : dict)
+    keys.push_back(it.first);
+  return keys;
+}
+
+}  // namespace
+
+TEST(cpdf_dictionary, SmallDictionary) {
+  auto pDict = pdfium::MakeUnique<CPDF_Dictionary>();
+  pDict->SetNewFor<CPDF_Number>("C", 3);
+  pDict->SetNewFor<CPDF_Number>("A", 1);
+  pDict->SetNewFor<CPDF_Number>("B", 2);
+  EXPECT_EQ(3u, pDict->GetCount());
+  EXPECT_EQ(1, pDict->GetIntegerFor("A"));
+  EXPECT_EQ(2, pDict->GetIntegerFor("B"));
+  EXPECT_EQ(3, pDict->GetIntegerFor("C"));
+  EXPECT_FALSE(pDict->KeyExist("D"));
+  EXPECT_FALSE(pDict->GetObjectFor("D"));
+
+  // Iteration is in key order.
+  std::vector<CFX_ByteString> expected = {"A", "B", "C"};
+  EXPECT_EQ(expected, KeysOf(*pDict));
+
+  // Replacing a value keeps the count.
+  pDict->SetNewFor<CPDF_Number>("B", 20);
+  EXPECT_EQ(3u, pDict->GetCount());
+  EXPECT_EQ(20, pDict->GetIntegerFor("B"));
+
+  pDict->RemoveFor("A");
+  pDict->RemoveFor("Missing");
+  EXPECT_EQ(2u, pDict->GetCount());
+  EXPECT_FALSE(pDict->KeyExist("A"));
+
+  pDict->ReplaceKey("C", "AA");
+  expected = {"AA", "B"};
+  EXPECT_EQ(expected, KeysOf(*pDict));
+  EXPECT_EQ(3, pDict->GetIntegerFor("AA"));
+
+  // Setting nullptr removes the key.
+  pDict->SetFor("B", nullptr);
+  expected = {"AA"};
+  EXPECT_EQ(expected, KeysOf(*pDict));
+}
+
+TEST(cpdf_dictionary, LargeDictionary) {
+  const int kCount = static_cast<int>(CPDF_Dictionary::kMaxFlatSize) * 3;
+  auto pDict = pdfium::MakeUnique<CPDF_Dictionary>();
+  std::vector<CFX_ByteString> expected;
+  // Insert in reverse so every insertion lands at the front.
+  for (int i = kCount - 1; i >= 0; --i)
+    pDict->SetNewFor<CPDF_Number>(KeyFor(i), i);
+  for (int i = 0; i < kCount; ++i)
+    expected.push_back(KeyFor(i));
+
+  EXPECT_EQ(static_cast<size_t>(kCount), pDict->GetCount());
+  EXPECT_EQ(expected, KeysOf(*pDict));
+  for (int i = 0; i < kCount; ++i)
+    EXPECT_EQ(i, pDict->GetIntegerFor(KeyFor(i)));
+
+  // Shrinking below the threshold keeps working lookups and order.
+  for (int i = 1; i < kCount; ++i)
+    pDict->RemoveFor(KeyFor(i));
+  EXPECT_EQ(1u, pDict->GetCount());
+  EXPECT_EQ(0, pDict->GetIntegerFor(KeyFor(0)));
+
+  pDict->ReplaceKey(KeyFor(0), "Z");
+  EXPECT_FALSE(pDict->KeyExist(KeyFor(0)));
+  EXPECT_EQ(0, pDict->GetIntegerFor("Z"));
+}
+
+TEST(cpdf_dictionary, ReplaceKeyWithOwnKey) {
+  auto pDict = pdfium::MakeUnique<CPDF_Dictionary>();
+  pDict->SetNewFor<CPDF_Number>("A", 1);
+  pDict->SetNewFor<CPDF_Number>("B", 2);
+
+  // The old key may alias the entry being replaced.
+  pDict->ReplaceKey(pDict->begin()->first, "C");
+  std::vector<CFX_ByteString> expected = {"B", "C"};
+  EXPECT_EQ(expected, KeysOf(*pDict));
+  EXPECT_EQ(1, pDict->GetIntegerFor("C"));
+
+  // Replacing a key with itself is a no-op.
+  pDict->ReplaceKey("B", "B");
+  EXPECT_EQ(2, pDict->GetIntegerFor("B"));
+}
+
+TEST(cpdf_dictionary, KeysWithSameHash) {
+  // "Aa" and "BB" hash alike.
+  auto pDict = pdfium::MakeUnique<CPDF_Dictionary>();
+  pDict->SetNewFor<CPDF_Number>("Aa", 1);
+  EXPECT_FALSE(pDict->KeyExist("BB"));
+  pDict->SetNewFor<CPDF_Number>("BB", 2);
+  EXPECT_EQ(1, pDict->GetIntegerFor("Aa"));
+  EXPECT_EQ(2, pDict->GetIntegerFor("BB"));
+  pDict->RemoveFor("Aa");
+  EXPECT_FALSE(pDict->KeyExist("Aa"));
+  EXPECT_EQ(2, pDict->GetIntegerFor("BB"));
+}
+
+TEST(cpdf_dictionary, Clone) {
+  const int kCount = static_cast<int>(CPDF_Dictionary::kMaxFlatSize) + 1;
+  auto pDict = pdfium::MakeUnique<CPDF_Dictionary>();
+  for (int i = 0; i < kCount; ++i)
+    pDict->SetNewFor<CPDF_Number>(KeyFor(i), i);
+
+  std::unique_ptr<CPDF_Object> pClone = pDict->Clone();
+  CPDF_Dictionary* pCloneDict = pClone->AsDictionary();
+  ASSERT_TRUE(pCloneDict);
+  EXPECT_EQ(KeysOf(*pDict), KeysOf(*pCloneDict));
+  for (int i = 0; i < kCount; ++i)
+    EXPECT_EQ(i, pCloneDict->GetIntegerFor(KeyFor(i)));
+}
+
+// Keys of a page dictionary, followed by font resource names.
+CFX_ByteString BenchmarkKeyFor(int i) {
+  static const char* const kPageKeys[] = {
+      "Type",      "Parent",       "Resources", "Contents", "MediaBox",
+      "CropBox",   "Rotate",       "Annots",    "Group",    "Thumb",
+      "B",         "Dur",          "Trans",     "AA",       "Metadata",
+      "PieceInfo", "StructParents"};
+  if (i < static_cast<int>(FX_ArraySize(kPageKeys)))
+    return kPageKeys[i];
+  CFX_ByteString key;
+  key.Format("F%d", i);
+  return key;
+}
+
+// Compares CPDF_Dictionary with a std::map, a hash map keyed by string, and
+// a hash map keyed by interned string. Callers look keys up by literals,
+// which are not interned, so the last one has to intern the key first.
+TEST(cpdf_dictionary, DISABLED_Benchmark) {
+  const int kLookups = 4000000;
+  const char* const kMethods[] = {"dictionary", "map", "hash", "interned"};
+  for (int count : {4, 8, 16, 32, 64}) {
+    std::vector<CFX_ByteString> keys;
+    for (int i = 0; i < count; ++i)
+      keys.push_back(BenchmarkKeyFor(i));
+
+    CFX_ByteStringPool pool;
+    CPDF_Dictionary dict;
+    std::map<CFX_ByteString, CPDF_Object*> tree;
+    std::unordered_map<CFX_ByteString, CPDF_Object*> hashed;
+    std::unordered_map<const char*, CPDF_Object*> interned;
+    for (int i = 0; i < count; ++i) {
+      CPDF_Object* pObj = dict.SetNewFor<CPDF_Number>(keys[i], i);
+      tree[keys[i]] = pObj;
+      hashed[keys[i]] = pObj;
+      interned[pool.Intern(keys[i]).c_str()] = pObj;
+    }
+
+    // Look up copies, so that no lookup key shares a buffer with a stored
+    // key.
+    std::vector<CFX_ByteString> lookups;
+    for (const auto& key : keys)
+      lookups.push_back(CFX_ByteString(key.c_str()));
+
+    printf("%2d keys", count);
+    for (int method = 0; method < 4; ++method) {
+      double best = 0;
+      for (int i = 0; i < 5; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        int found = 0;
+        for (int n = 0; n < kLookups; ++n) {
+          const CFX_ByteString& key = lookups[n % count];
+          CPDF_Object* pObj = nullptr;
+          if (method == 0)
+            pObj = dict.GetObjectFor(key);
+          else if (method == 1)
+            pObj = tree.find(key)->second;
+          else if (method == 2)
+            pObj = hashed.find(key)->second;
+          else
+            pObj = interned.find(pool.Intern(key).c_str())->second;
+          found += !!pObj;
+        }
+        double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+        EXPECT_EQ(kLookups, found);
+        if (i == 0 || seconds < best)
+          best = seconds;
+      }
+      printf("  %s %5.1f ns", kMethods[method], best * 1e9 / kLookups);
+    }
+    printf("\n");
+  }
+}
@@ -27,6 +27,7 @@
 #include "core/fpdfapi/parser/cpdf_string.h"
 #include "core/fpdfapi/render/cpdf_dibsource.h"
 #include "core/fpdfapi/render/cpdf_docrenderdata.h"
+#include "core/fpdftext/cpdf_textindex.h"
 #include "core/fxcodec/JBig2_DocumentContext.h"
 #include "core/fxge/cfx_unicodeencoding.h"
 #include "core/fxge/fx_font.h"
@@ -349,11 +350,15 @@ CPDF_Document::CPDF_Document(std::unique_ptr<CPDF_Parser> pParser)
       m_dwFirstPageObjNum(0),
       m_pDocPage(new CPDF_DocPageData(this)),
       m_pDocRender(new CPDF_DocRenderData(this)) {
+  if (CPDF_ModuleMgr::Get()->GetUseObjectArena())
+    EnableObjectArena();
   if (pParser)
     SetLastObjNum(m_pParser->GetLastObjNum());
 }
 
 CPDF_Document::~CPDF_Document() {
+  // Cached images release their color spaces to the page data.
+  m_pDocRender->GetImageCache()->Clear();
   delete m_pDocPage;
   CPDF_ModuleMgr::Get()->GetPageModule()->ClearStockFont(this);
 }
@@ -365,6 +370,7 @@ std::unique_ptr<CPDF_Object> CPDF_Document::ParseIndirectObject(
 
 void CPDF_Document::LoadDocInternal() {
   SetLastObjNum(m_pParser->GetLastObjNum());
+  SetExpectedObjectCount(m_pParser->GetObjectCount());
 
   CPDF_Object* pRootObj = GetOrParseIndirectObject(m_pParser->GetRootObjNum());
   if (!pRootObj)
@@ -477,6 +483,7 @@ bool CPDF_Document::IsPageLoaded(int iPage) const {
 }
 
 CPDF_Dictionary* CPDF_Document::GetPage(int iPage) {
+  CFX_AutoLock lock(GetLock());
   if (iPage < 0 || iPage >= pdfium::CollectionSize<int>(m_PageList))
     return nullptr;
 
@@ -569,6 +576,7 @@ int CPDF_Document::FindPageIndex(CPDF_Dictionary* pNode,
 }
 
 int CPDF_Document::GetPageIndex(uint32_t objnum) {
+  CFX_AutoLock lock(GetLock());
   uint32_t nPages = m_PageList.size();
   uint32_t skip_count = 0;
   bool bSkipped = false;
@@ -31,6 +31,7 @@ class CPDF_LinearizedHeader;
 class CPDF_Parser;
 class CPDF_Pattern;
 class CPDF_StreamAcc;
+class CPDF_TextIndex;
 class JBig2_DocumentContext;
 
 #define FPDFPERM_PRINT 0x0004
@@ -66,6 +67,9 @@ class CPDF_Document : public CPDF_IndirectObjectHolder {
     return &m_pCodecContext;
   }
   std::unique_ptr<CPDF_LinkList>* LinksContext() { return &m_pLinksContext; }
+  std::unique_ptr<CPDF_TextIndex>* TextIndexContext() {
+    return &m_pTextIndexContext;
+  }
 
   CPDF_DocRenderData* GetRenderData() const { return m_pDocRender.get(); }
 
@@ -147,6 +151,7 @@ class CPDF_Document : public CPDF_IndirectObjectHolder {
   std::unique_ptr<CPDF_DocRenderData> m_pDocRender;
   std::unique_ptr<JBig2_DocumentContext> m_pCodecContext;
   std::unique_ptr<CPDF_LinkList> m_pLinksContext;
+  std::unique_ptr<CPDF_TextIndex> m_pTextIndexContext;
   std::vector<uint32_t> m_PageList;
 };
 
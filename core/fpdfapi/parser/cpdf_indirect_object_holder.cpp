@@ -14,14 +14,32 @@
 
 CPDF_IndirectObjectHolder::CPDF_IndirectObjectHolder()
     : m_LastObjNum(0),
-      m_pByteStringPool(pdfium::MakeUnique<CFX_ByteStringPool>()) {}
+      m_pByteStringPool(pdfium::MakeUnique<CFX_ByteStringPool>()),
+      m_pObjectArena(nullptr) {}
 
 CPDF_IndirectObjectHolder::~CPDF_IndirectObjectHolder() {
   m_pByteStringPool.DeleteObject();  // Make weak.
+  // The arena outlives this call until |m_IndirectObjs| and any other
+  // objects from it are gone.
+  if (m_pObjectArena)
+    m_pObjectArena->Release();
+}
+
+void CPDF_IndirectObjectHolder::EnableObjectArena() {
+  if (!m_pObjectArena)
+    m_pObjectArena = new CPDF_ObjectArena;
+}
+
+CPDF_ObjectArena::Stats CPDF_IndirectObjectHolder::GetObjectArenaStats()
+    const {
+  CFX_AutoLock lock(&m_Lock);
+  return m_pObjectArena ? m_pObjectArena->GetStats()
+                        : CPDF_ObjectArena::Stats();
 }
 
 CPDF_Object* CPDF_IndirectObjectHolder::GetIndirectObject(
     uint32_t objnum) const {
+  CFX_AutoLock lock(&m_Lock);
   auto it = m_IndirectObjs.find(objnum);
   return it != m_IndirectObjs.end() ? it->second.get() : nullptr;
 }
@@ -31,6 +49,7 @@ CPDF_Object* CPDF_IndirectObjectHolder::GetOrParseIndirectObject(
   if (objnum == 0)
     return nullptr;
 
+  CFX_AutoLock lock(&m_Lock);
   CPDF_Object* pObj = GetIndirectObject(objnum);
   if (pObj)
     return pObj->GetObjNum() != CPDF_Object::kInvalidObjNum ? pObj : nullptr;
@@ -53,6 +72,7 @@ std::unique_ptr<CPDF_Object> CPDF_IndirectObjectHolder::ParseIndirectObject(
 CPDF_Object* CPDF_IndirectObjectHolder::AddIndirectObject(
     std::unique_ptr<CPDF_Object> pObj) {
   CHECK(!pObj->m_ObjNum);
+  CFX_AutoLock lock(&m_Lock);
   CPDF_Object* pUnowned = pObj.get();
   pObj->m_ObjNum = ++m_LastObjNum;
   m_IndirectObjs[m_LastObjNum].release();  // TODO(tsepez): stop this leak.
@@ -67,6 +87,7 @@ bool CPDF_IndirectObjectHolder::ReplaceIndirectObjectIfHigherGeneration(
   if (!pObj)
     return false;
 
+  CFX_AutoLock lock(&m_Lock);
   CPDF_Object* pOldObj = GetIndirectObject(objnum);
   if (pOldObj && pObj->GetGenNum() <= pOldObj->GetGenNum())
     return false;
@@ -78,6 +99,7 @@ bool CPDF_IndirectObjectHolder::ReplaceIndirectObjectIfHigherGeneration(
 }
 
 void CPDF_IndirectObjectHolder::DeleteIndirectObject(uint32_t objnum) {
+  CFX_AutoLock lock(&m_Lock);
   CPDF_Object* pObj = GetIndirectObject(objnum);
   if (!pObj || pObj->GetObjNum() == CPDF_Object::kInvalidObjNum)
     return;
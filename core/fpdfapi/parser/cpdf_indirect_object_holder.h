@@ -7,12 +7,14 @@
 #ifndef CORE_FPDFAPI_PARSER_CPDF_INDIRECT_OBJECT_HOLDER_H_
 #define CORE_FPDFAPI_PARSER_CPDF_INDIRECT_OBJECT_HOLDER_H_
 
-#include <map>
 #include <memory>
 #include <type_traits>
 #include <utility>
 
 #include "core/fpdfapi/parser/cpdf_object.h"
+#include "core/fpdfapi/parser/cpdf_object_arena.h"
+#include "core/fxcrt/cfx_dense_map.h"
+#include "core/fxcrt/cfx_mutex.h"
 #include "core/fxcrt/cfx_string_pool_template.h"
 #include "core/fxcrt/cfx_weak_ptr.h"
 #include "core/fxcrt/fx_system.h"
@@ -20,8 +22,8 @@
 
 class CPDF_IndirectObjectHolder {
  public:
-  using const_iterator =
-      std::map<uint32_t, std::unique_ptr<CPDF_Object>>::const_iterator;
+  using ObjectMap = CFX_DenseMap<std::unique_ptr<CPDF_Object>>;
+  using const_iterator = ObjectMap::const_iterator;
 
   CPDF_IndirectObjectHolder();
   virtual ~CPDF_IndirectObjectHolder();
@@ -57,10 +59,29 @@ class CPDF_IndirectObjectHolder {
   uint32_t GetLastObjNum() const { return m_LastObjNum; }
   void SetLastObjNum(uint32_t objnum) { m_LastObjNum = objnum; }
 
+  // Hint for how many objects the document holds, so that lookups stay in
+  // the flat table even when objects are parsed in random order.
+  void SetExpectedObjectCount(size_t count) {
+    m_IndirectObjs.SetExpectedSize(count);
+  }
+
   CFX_WeakPtr<CFX_ByteStringPool> GetByteStringPool() const {
     return m_pByteStringPool;
   }
 
+  // Makes objects parsed from now on come from an arena owned by this
+  // holder, which frees them in bulk. Call before parsing anything.
+  void EnableObjectArena();
+
+  // Returns nullptr unless EnableObjectArena() was called.
+  CPDF_ObjectArena* GetObjectArena() const { return m_pObjectArena; }
+  CPDF_ObjectArena::Stats GetObjectArenaStats() const;
+
+  // Guards the object table and everything lazily built from it. Taken by
+  // the page and render data caches as well, so that pages of the same
+  // document can be loaded and rendered from several threads.
+  CFX_Mutex* GetLock() const { return &m_Lock; }
+
   const_iterator begin() const { return m_IndirectObjs.begin(); }
   const_iterator end() const { return m_IndirectObjs.end(); }
 
@@ -68,9 +89,11 @@ class CPDF_IndirectObjectHolder {
   virtual std::unique_ptr<CPDF_Object> ParseIndirectObject(uint32_t objnum);
 
  private:
+  mutable CFX_Mutex m_Lock;
   uint32_t m_LastObjNum;
-  std::map<uint32_t, std::unique_ptr<CPDF_Object>> m_IndirectObjs;
+  ObjectMap m_IndirectObjs;
   CFX_WeakPtr<CFX_ByteStringPool> m_pByteStringPool;
+  CPDF_ObjectArena* m_pObjectArena;  // Released, not deleted.
 };
 
 #endif  // CORE_FPDFAPI_PARSER_CPDF_INDIRECT_OBJECT_HOLDER_H_
@@ -11,11 +11,32 @@
 #include "core/fpdfapi/parser/cpdf_array.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_indirect_object_holder.h"
+#include "core/fpdfapi/parser/cpdf_object_arena.h"
 #include "core/fpdfapi/parser/cpdf_parser.h"
 #include "core/fpdfapi/parser/fpdf_parser_decode.h"
 #include "core/fxcrt/fx_string.h"
 #include "third_party/base/stl_util.h"
 
+// static
+void* CPDF_Object::operator new(size_t size) {
+  return CPDF_ObjectArena::Allocate(nullptr, size);
+}
+
+// static
+void* CPDF_Object::operator new(size_t size, CPDF_ObjectArena* pArena) {
+  return CPDF_ObjectArena::Allocate(pArena, size);
+}
+
+// static
+void CPDF_Object::operator delete(void* p) {
+  CPDF_ObjectArena::Free(p);
+}
+
+// static
+void CPDF_Object::operator delete(void* p, CPDF_ObjectArena* pArena) {
+  CPDF_ObjectArena::Free(p);
+}
+
 CPDF_Object::~CPDF_Object() {}
 
 CPDF_Object* CPDF_Object::GetDirect() const {
@@ -20,6 +20,7 @@ class CPDF_Dictionary;
 class CPDF_Name;
 class CPDF_Null;
 class CPDF_Number;
+class CPDF_ObjectArena;
 class CPDF_Reference;
 class CPDF_Stream;
 class CPDF_String;
@@ -39,6 +40,13 @@ class CPDF_Object {
     REFERENCE
   };
 
+  // Objects may come from a document's CPDF_ObjectArena rather than the
+  // heap; see NewArenaObject(). Either kind is freed with plain delete.
+  static void* operator new(size_t size);
+  static void* operator new(size_t size, CPDF_ObjectArena* pArena);
+  static void operator delete(void* p);
+  static void operator delete(void* p, CPDF_ObjectArena* pArena);
+
   virtual ~CPDF_Object();
 
   virtual Type GetType() const = 0;
@@ -0,0 +1,94 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/parser/cpdf_object_arena.h"
+
+namespace {
+
+// Precedes every object and records the arena it came from, or nullptr for
+// the heap. The union keeps objects 8-byte aligned on all platforms.
+union ObjectHeader {
+  CPDF_ObjectArena* pArena;
+  uint64_t unused;
+};
+
+const size_t kChunkSize = 64 * 1024;
+
+// Larger objects go to the heap rather than waste the rest of a chunk.
+const size_t kMaxArenaObjectSize = kChunkSize / 16;
+
+size_t AlignSize(size_t size) {
+  const size_t kAlignment = sizeof(ObjectHeader);
+  return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+}  // namespace
+
+// static
+void* CPDF_ObjectArena::Allocate(CPDF_ObjectArena* pArena, size_t size) {
+  size_t total = sizeof(ObjectHeader) + AlignSize(size);
+  ObjectHeader* pHeader;
+  if (pArena && size <= kMaxArenaObjectSize) {
+    pHeader = static_cast<ObjectHeader*>(pArena->AllocateFromChunk(total));
+  } else {
+    pHeader = reinterpret_cast<ObjectHeader*>(FX_Alloc(uint8_t, total));
+    pArena = nullptr;
+  }
+  pHeader->pArena = pArena;
+  return pHeader + 1;
+}
+
+// static
+void CPDF_ObjectArena::Free(void* p) {
+  if (!p)
+    return;
+
+  ObjectHeader* pHeader = static_cast<ObjectHeader*>(p) - 1;
+  if (pHeader->pArena)
+    pHeader->pArena->ReleaseRef();
+  else
+    FX_Free(pHeader);
+}
+
+CPDF_ObjectArena::CPDF_ObjectArena()
+    : m_pCur(nullptr),
+      m_pEnd(nullptr),
+      m_nRefs(1),
+      m_nAllocations(0),
+      m_nBytesAllocated(0) {}
+
+CPDF_ObjectArena::~CPDF_ObjectArena() {}
+
+void CPDF_ObjectArena::Release() {
+  ReleaseRef();
+}
+
+CPDF_ObjectArena::Stats CPDF_ObjectArena::GetStats() const {
+  Stats stats;
+  stats.nAllocations = m_nAllocations;
+  stats.nLiveObjects = m_nRefs - 1;
+  stats.nChunks = m_Chunks.size();
+  stats.nBytesAllocated = m_nBytesAllocated;
+  stats.nBytesReserved = m_Chunks.size() * kChunkSize;
+  return stats;
+}
+
+void* CPDF_ObjectArena::AllocateFromChunk(size_t size) {
+  if (static_cast<size_t>(m_pEnd - m_pCur) < size) {
+    m_Chunks.emplace_back(FX_Alloc(uint8_t, kChunkSize));
+    m_pCur = m_Chunks.back().get();
+    m_pEnd = m_pCur + kChunkSize;
+  }
+  void* p = m_pCur;
+  m_pCur += size;
+  ++m_nRefs;
+  ++m_nAllocations;
+  m_nBytesAllocated += size;
+  return p;
+}
+
+void CPDF_ObjectArena::ReleaseRef() {
+  if (--m_nRefs == 0)
+    delete this;
+}
@@ -0,0 +1,84 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFAPI_PARSER_CPDF_OBJECT_ARENA_H_
+#define CORE_FPDFAPI_PARSER_CPDF_OBJECT_ARENA_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "core/fxcrt/fx_memory.h"
+#include "core/fxcrt/fx_system.h"
+
+// Bump allocator for the objects parsed from one document. Objects are
+// carved out of large chunks, and a chunk is never handed back piecemeal:
+// destroying an object only drops a count, and the chunks are freed together
+// once the owner has released the arena and the last object is gone. So
+// closing a document returns a handful of chunks to the system instead of
+// every object separately, and objects that outlive their document stay
+// valid.
+//
+// Allocation is not thread safe; callers parse with the document lock held.
+// Objects may be destroyed on any thread.
+class CPDF_ObjectArena {
+ public:
+  struct Stats {
+    Stats()
+        : nAllocations(0),
+          nLiveObjects(0),
+          nChunks(0),
+          nBytesAllocated(0),
+          nBytesReserved(0) {}
+
+    size_t nAllocations;     // Objects allocated from the arena so far.
+    size_t nLiveObjects;     // Of those, the ones not destroyed yet.
+    size_t nChunks;          // Chunks obtained from the system.
+    size_t nBytesAllocated;  // Bytes handed out, including headers.
+    size_t nBytesReserved;   // Bytes held in chunks.
+  };
+
+  // Returns |size| bytes for an object, from |pArena| or, if it is null or
+  // the object is unusually large, from the heap. The result is suitably
+  // aligned for any CPDF_Object.
+  static void* Allocate(CPDF_ObjectArena* pArena, size_t size);
+
+  // Frees memory returned by Allocate(), whichever way it was obtained.
+  static void Free(void* p);
+
+  CPDF_ObjectArena();
+  CPDF_ObjectArena(const CPDF_ObjectArena&) = delete;
+  CPDF_ObjectArena& operator=(const CPDF_ObjectArena&) = delete;
+
+  // Drops the owner's reference, which the arena starts out with, in place
+  // of deleting it.
+  void Release();
+
+  Stats GetStats() const;
+
+ private:
+  ~CPDF_ObjectArena();
+
+  void* AllocateFromChunk(size_t size);
+  void ReleaseRef();
+
+  std::vector<std::unique_ptr<uint8_t, FxFreeDeleter>> m_Chunks;
+  uint8_t* m_pCur;
+  uint8_t* m_pEnd;
+
+  // One for the owner plus one for every live object.
+  std::atomic<size_t> m_nRefs;
+  size_t m_nAllocations;
+  size_t m_nBytesAllocated;
+};
+
+// Creates a T in |pArena|, or on the heap if |pArena| is null. The result
+// may be freed with plain delete either way.
+template <typename T, typename... Args>
+std::unique_ptr<T> NewArenaObject(CPDF_ObjectArena* pArena, Args&&... args) {
+  return std::unique_ptr<T>(new (pArena) T(std::forward<Args>(args)...));
+}
+
+#endif  // CORE_FPDFAPI_PARSER_CPDF_OBJECT_ARENA_H_
@@ -0,0 +1,97 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/parser/cpdf_object_arena.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "core/fpdfapi/parser/cpdf_array.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_indirect_object_holder.h"
+#include "core/fpdfapi/parser/cpdf_name.h"
+#include "core/fpdfapi/parser/cpdf_number.h"
+#include "core/fpdfapi/parser/cpdf_syntax_parser.h"
+#include "core/fxcrt/fx_stream.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/ptr_util.h"
+
+TEST(cpdf_object_arena, HeapObjects) {
+  std::unique_ptr<CPDF_Number> pNumber =
+      NewArenaObject<CPDF_Number>(nullptr, 42);
+  EXPECT_EQ(42, pNumber->GetInteger());
+
+  // Objects created the usual way are unaffected.
+  auto pName = pdfium::MakeUnique<CPDF_Name>(nullptr, "Name");
+  EXPECT_EQ("Name", pName->GetString());
+}
+
+TEST(cpdf_object_arena, Stats) {
+  CPDF_IndirectObjectHolder holder;
+  holder.EnableObjectArena();
+  CPDF_ObjectArena* pArena = holder.GetObjectArena();
+  ASSERT_TRUE(pArena);
+
+  std::vector<std::unique_ptr<CPDF_Object>> objects;
+  for (int i = 0; i < 10000; ++i)
+    objects.push_back(NewArenaObject<CPDF_Number>(pArena, i));
+
+  CPDF_ObjectArena::Stats stats = holder.GetObjectArenaStats();
+  EXPECT_EQ(10000u, stats.nAllocations);
+  EXPECT_EQ(10000u, stats.nLiveObjects);
+  EXPECT_LT(1u, stats.nChunks);
+  EXPECT_LE(10000 * sizeof(CPDF_Number), stats.nBytesAllocated);
+  EXPECT_LE(stats.nBytesAllocated, stats.nBytesReserved);
+
+  for (int i = 0; i < 10000; ++i)
+    EXPECT_EQ(i, objects[i]->GetInteger());
+
+  objects.resize(5000);
+  stats = holder.GetObjectArenaStats();
+  EXPECT_EQ(10000u, stats.nAllocations);
+  EXPECT_EQ(5000u, stats.nLiveObjects);
+}
+
+TEST(cpdf_object_arena, ObjectsOutliveHolder) {
+  std::unique_ptr<CPDF_Object> pObj;
+  {
+    CPDF_IndirectObjectHolder holder;
+    holder.EnableObjectArena();
+    auto pArray = NewArenaObject<CPDF_Array>(holder.GetObjectArena());
+    pArray->AddNew<CPDF_Number>(7);
+    pObj = std::move(pArray);
+  }
+  // The arena memory stays valid until the last object is destroyed.
+  ASSERT_TRUE(pObj->IsArray());
+  EXPECT_EQ(7, pObj->AsArray()->GetIntegerAt(0));
+}
+
+TEST(cpdf_object_arena, ParsedObjects) {
+  const char kData[] = "<< /Type /Page /Kids [1 0 R 2 0 R] /Count 2 >>";
+  CPDF_IndirectObjectHolder holder;
+  holder.EnableObjectArena();
+
+  CPDF_SyntaxParser parser;
+  parser.InitParser(IFX_MemoryStream::Create(
+                        reinterpret_cast<uint8_t*>(const_cast<char*>(kData)),
+                        sizeof(kData) - 1, false),
+                    0);
+  std::unique_ptr<CPDF_Object> pObj = parser.GetObject(&holder, 0, 0, false);
+  ASSERT_TRUE(pObj);
+  CPDF_Dictionary* pDict = pObj->AsDictionary();
+  ASSERT_TRUE(pDict);
+  EXPECT_EQ("Page", pDict->GetStringFor("Type"));
+  EXPECT_EQ(2, pDict->GetIntegerFor("Count"));
+  ASSERT_TRUE(pDict->GetArrayFor("Kids"));
+  EXPECT_EQ(2u, pDict->GetArrayFor("Kids")->GetCount());
+
+  // The dictionary, a name, the array, two references and a number.
+  CPDF_ObjectArena::Stats stats = holder.GetObjectArenaStats();
+  EXPECT_EQ(6u, stats.nAllocations);
+  EXPECT_EQ(6u, stats.nLiveObjects);
+
+  pObj.reset();
+  EXPECT_EQ(0u, holder.GetObjectArenaStats().nLiveObjects);
+}
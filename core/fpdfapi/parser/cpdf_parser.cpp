@@ -10,18 +10,23 @@
 #include <utility>
 #include <vector>
 
+#include "core/fpdfapi/cpdf_modulemgr.h"
 #include "core/fpdfapi/parser/cpdf_array.h"
 #include "core/fpdfapi/parser/cpdf_crypto_handler.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/parser/cpdf_linearized_header.h"
+#include "core/fpdfapi/parser/cpdf_name.h"
+#include "core/fpdfapi/parser/cpdf_null.h"
 #include "core/fpdfapi/parser/cpdf_number.h"
 #include "core/fpdfapi/parser/cpdf_reference.h"
 #include "core/fpdfapi/parser/cpdf_security_handler.h"
 #include "core/fpdfapi/parser/cpdf_stream.h"
 #include "core/fpdfapi/parser/cpdf_stream_acc.h"
 #include "core/fpdfapi/parser/cpdf_syntax_parser.h"
+#include "core/fpdfapi/parser/fpdf_parser_decode.h"
 #include "core/fpdfapi/parser/fpdf_parser_utility.h"
+#include "core/fxcrt/cfx_threadpool.h"
 #include "core/fxcrt/fx_ext.h"
 #include "core/fxcrt/fx_safe_types.h"
 #include "third_party/base/ptr_util.h"
@@ -48,8 +53,74 @@ int32_t GetStreamFirst(CPDF_StreamAcc* pObjStream) {
   return pObjStream->GetDict()->GetIntegerFor("First");
 }
 
+// The DecodeParms entries that the non-image filters read.
+const char* const kDecodeParmsKeys[] = {"Predictor", "Colors",
+                                        "BitsPerComponent", "Columns",
+                                        "EarlyChange"};
+
+std::unique_ptr<CPDF_Object> CopyDecodeParms(const CPDF_Dictionary* pParams) {
+  if (!pParams)
+    return pdfium::MakeUnique<CPDF_Null>();
+
+  auto pCopy = pdfium::MakeUnique<CPDF_Dictionary>();
+  for (const char* key : kDecodeParmsKeys) {
+    if (pParams->KeyExist(key))
+      pCopy->SetNewFor<CPDF_Number>(key, pParams->GetIntegerFor(key));
+  }
+  return std::move(pCopy);
+}
+
+// Returns a dictionary holding the Filter and DecodeParms of |pDict| that
+// shares no strings or objects with the document, so that it can be handed
+// to PDF_DataDecode() on another thread. Returns nullptr if the stream has
+// no usable filter.
+std::unique_ptr<CPDF_Dictionary> CopyFilters(const CPDF_Dictionary* pDict) {
+  CPDF_Object* pFilter = pDict->GetDirectObjectFor("Filter");
+  if (!pFilter || (!pFilter->IsArray() && !pFilter->IsName()))
+    return nullptr;
+
+  // Names are copied through CFX_ByteStringC so that they get their own
+  // buffers rather than sharing the document's interned ones.
+  CPDF_Object* pParams = pDict->GetDirectObjectFor("DecodeParms");
+  auto pCopy = pdfium::MakeUnique<CPDF_Dictionary>();
+  if (CPDF_Array* pFilters = pFilter->AsArray()) {
+    CPDF_Array* pParamsArray = ToArray(pParams);
+    CPDF_Array* pFiltersCopy = pCopy->SetNewFor<CPDF_Array>("Filter");
+    CPDF_Array* pParamsCopy =
+        pParamsArray ? pCopy->SetNewFor<CPDF_Array>("DecodeParms") : nullptr;
+    for (size_t i = 0; i < pFilters->GetCount(); ++i) {
+      pFiltersCopy->AddNew<CPDF_Name>(
+          CFX_ByteString(pFilters->GetStringAt(i).AsStringC()));
+      if (pParamsCopy)
+        pParamsCopy->Add(CopyDecodeParms(pParamsArray->GetDictAt(i)));
+    }
+  } else {
+    pCopy->SetNewFor<CPDF_Name>(
+        "Filter", CFX_ByteString(pFilter->GetString().AsStringC()));
+    if (pParams && pParams->GetDict())
+      pCopy->SetFor("DecodeParms", CopyDecodeParms(pParams->GetDict()));
+  }
+  return pCopy;
+}
+
+// An object stream decoded by PrefetchObjectStreams() on a worker thread.
+struct PrefetchJob {
+  uint32_t number;
+  const CPDF_Stream* pStream;
+  std::unique_ptr<CPDF_Dictionary> pFilters;
+  const uint8_t* pSrcData;
+  uint32_t dwSrcSize;
+  uint8_t* pDecodedData;
+  uint32_t dwDecodedSize;
+};
+
 }  // namespace
 
+CPDF_Parser::ObjectStreamEntry::ObjectStreamEntry()
+    : bOffsetsLoaded(false), nPins(0) {}
+
+CPDF_Parser::ObjectStreamEntry::~ObjectStreamEntry() {}
+
 CPDF_Parser::CPDF_Parser()
     : m_pDocument(nullptr),
       m_bHasParsed(false),
@@ -57,7 +128,11 @@ CPDF_Parser::CPDF_Parser()
       m_bVersionUpdated(false),
       m_FileVersion(0),
       m_pEncryptDict(nullptr),
-      m_dwXrefStartObjNum(0) {
+      m_dwXrefStartObjNum(0),
+      m_bPrefetchObjectStreams(
+          CPDF_ModuleMgr::Get()->GetPrefetchObjectStreams()),
+      m_nObjectStreamCacheLimit(
+          CPDF_ModuleMgr::Get()->GetObjectStreamCacheLimit()) {
   m_pSyntax = pdfium::MakeUnique<CPDF_SyntaxParser>();
 }
 
@@ -67,11 +142,11 @@ CPDF_Parser::~CPDF_Parser() {
 }
 
 uint32_t CPDF_Parser::GetLastObjNum() const {
-  return m_ObjectInfo.empty() ? 0 : m_ObjectInfo.rbegin()->first;
+  return m_ObjectInfo.empty() ? 0 : m_ObjectInfo.LastKey();
 }
 
 bool CPDF_Parser::IsValidObjectNumber(uint32_t objnum) const {
-  return !m_ObjectInfo.empty() && objnum <= m_ObjectInfo.rbegin()->first;
+  return !m_ObjectInfo.empty() && objnum <= m_ObjectInfo.LastKey();
 }
 
 FX_FILESIZE CPDF_Parser::GetObjectPositionOrZero(uint32_t objnum) const {
@@ -114,12 +189,7 @@ void CPDF_Parser::ShrinkObjectMap(uint32_t objnum) {
     return;
   }
 
-  auto it = m_ObjectInfo.lower_bound(objnum);
-  while (it != m_ObjectInfo.end()) {
-    auto saved_it = it++;
-    m_ObjectInfo.erase(saved_it);
-  }
-
+  m_ObjectInfo.EraseFrom(objnum);
   if (!pdfium::ContainsKey(m_ObjectInfo, objnum - 1))
     m_ObjectInfo[objnum - 1].pos = 0;
 }
@@ -186,6 +256,9 @@ CPDF_Parser::Error CPDF_Parser::StartParse(
   if (eRet != SUCCESS)
     return eRet;
 
+  if (m_bPrefetchObjectStreams)
+    PrefetchObjectStreams();
+
   m_pDocument->LoadDoc();
   if (!m_pDocument->GetRoot() || m_pDocument->GetPageCount() == 0) {
     if (bXRefRebuilt)
@@ -564,7 +637,7 @@ bool CPDF_Parser::LoadAllCrossRefV5(FX_FILESIZE xrefpos) {
     if (pdfium::ContainsKey(seen_xrefpos, xrefpos))
       return false;
   }
-  m_ObjectStreamMap.clear();
+  ClearObjectStreams();
   m_bXRefStream = true;
   return true;
 }
@@ -764,7 +837,7 @@ bool CPDF_Parser::RebuildCrossRef() {
                     if (oldgen != gennum)
                       m_bVersionUpdated = true;
                   }
-                } else {
+                } else if (objnum < kMaxObjectNumber) {
                   m_ObjectInfo[objnum].pos = obj_pos;
                   m_ObjectInfo[objnum].type = 1;
                   m_ObjectInfo[objnum].gennum = gennum;
@@ -1114,37 +1187,55 @@ std::unique_ptr<CPDF_Object> CPDF_Parser::ParseIndirectObject(
   if (GetObjectType(objnum) != 2)
     return nullptr;
 
-  CPDF_StreamAcc* pObjStream = GetObjectStream(m_ObjectInfo[objnum].pos);
+  const uint32_t stream_num = static_cast<uint32_t>(m_ObjectInfo[objnum].pos);
+  CPDF_StreamAcc* pObjStream = GetObjectStream(stream_num);
   if (!pObjStream)
     return nullptr;
 
+  ObjectStreamEntry& entry = m_ObjectStreams[stream_num];
   CFX_RetainPtr<IFX_MemoryStream> file = IFX_MemoryStream::Create(
       (uint8_t*)pObjStream->GetData(), (size_t)pObjStream->GetSize(), false);
   CPDF_SyntaxParser syntax;
   syntax.InitParser(file, 0);
   const int32_t offset = GetStreamFirst(pObjStream);
 
-  // Read object numbers from |pObjStream| into a cache.
-  if (!pdfium::ContainsKey(m_ObjCache, pObjStream)) {
+  // Read the numbers of the objects that the xref places in |pObjStream|
+  // into a cache.
+  if (!entry.bOffsetsLoaded) {
     for (int32_t i = GetStreamNCount(pObjStream); i > 0; --i) {
       uint32_t thisnum = syntax.GetDirectNum();
       uint32_t thisoff = syntax.GetDirectNum();
-      m_ObjCache[pObjStream][thisnum] = thisoff;
+      auto info_it = m_ObjectInfo.find(thisnum);
+      if (info_it != m_ObjectInfo.end() && info_it->second.type == 2 &&
+          info_it->second.pos == stream_num) {
+        entry.Offsets[thisnum] = thisoff;
+      }
     }
+    entry.bOffsetsLoaded = true;
   }
 
-  const auto it = m_ObjCache[pObjStream].find(objnum);
-  if (it == m_ObjCache[pObjStream].end())
+  const auto it = entry.Offsets.find(objnum);
+  if (it == entry.Offsets.end())
     return nullptr;
 
+  // Parsing may recurse into other object streams, e.g. for a stream length,
+  // which must not release the data |syntax| is reading from.
   syntax.RestorePos(offset + it->second);
-  return syntax.GetObject(pObjList, 0, 0, true);
+  ++entry.nPins;
+  std::unique_ptr<CPDF_Object> pObj = syntax.GetObject(pObjList, 0, 0, true);
+  --entry.nPins;
+  MarkObjectStreamParsed(stream_num, objnum);
+  return pObj;
 }
 
 CPDF_StreamAcc* CPDF_Parser::GetObjectStream(uint32_t objnum) {
-  auto it = m_ObjectStreamMap.find(objnum);
-  if (it != m_ObjectStreamMap.end())
-    return it->second.get();
+  auto it = m_ObjectStreams.find(objnum);
+  if (it != m_ObjectStreams.end()) {
+    ++m_ObjectStreamStats.nHits;
+    m_ObjectStreamLRU.splice(m_ObjectStreamLRU.begin(), m_ObjectStreamLRU,
+                             it->second.LRUPos);
+    return it->second.pAcc.get();
+  }
 
   if (!m_pDocument)
     return nullptr;
@@ -1154,10 +1245,143 @@ CPDF_StreamAcc* CPDF_Parser::GetObjectStream(uint32_t objnum) {
   if (!pStream)
     return nullptr;
 
-  CPDF_StreamAcc* pStreamAcc = new CPDF_StreamAcc;
+  ++m_ObjectStreamStats.nMisses;
+  auto pStreamAcc = pdfium::MakeUnique<CPDF_StreamAcc>();
   pStreamAcc->LoadAllData(pStream);
-  m_ObjectStreamMap[objnum].reset(pStreamAcc);
-  return pStreamAcc;
+  return AddObjectStream(objnum, std::move(pStreamAcc));
+}
+
+void CPDF_Parser::PrefetchObjectStreams() {
+  CFX_ThreadPool* pPool = CFX_ThreadPool::Get();
+  if (!pPool || !m_pDocument)
+    return;
+
+  std::set<uint32_t> stream_nums;
+  for (const auto& info : m_ObjectInfo) {
+    if (info.second.type == 2)
+      stream_nums.insert(static_cast<uint32_t>(info.second.pos));
+  }
+
+  // Loading the streams themselves parses objects, so it stays on this
+  // thread. The compressed sizes stand in for the decoded ones when deciding
+  // how much to prefetch.
+  std::vector<PrefetchJob> jobs;
+  size_t total_size = 0;
+  for (uint32_t number : stream_nums) {
+    if (pdfium::ContainsKey(m_ObjectStreams, number))
+      continue;
+
+    const CPDF_Stream* pStream =
+        ToStream(m_pDocument->GetOrParseIndirectObject(number));
+    if (!pStream || !pStream->IsMemoryBased() || !pStream->HasFilter() ||
+        pStream->GetRawSize() == 0) {
+      continue;
+    }
+    std::unique_ptr<CPDF_Dictionary> pFilters = CopyFilters(pStream->GetDict());
+    if (!pFilters)
+      continue;
+
+    total_size += pStream->GetRawSize();
+    if (m_nObjectStreamCacheLimit && total_size > m_nObjectStreamCacheLimit)
+      break;
+
+    jobs.push_back({number, pStream, std::move(pFilters),
+                    pStream->GetRawData(), pStream->GetRawSize(), nullptr, 0});
+  }
+  if (jobs.empty())
+    return;
+
+  pPool->ParallelFor(jobs.size(), [&jobs](size_t i) {
+    PrefetchJob& job = jobs[i];
+    CFX_ByteString image_encoding;
+    CPDF_Dictionary* pImageParms = nullptr;
+    if (!PDF_DataDecode(job.pSrcData, job.dwSrcSize, job.pFilters.get(),
+                        job.pDecodedData, job.dwDecodedSize, image_encoding,
+                        pImageParms, 0, false)) {
+      job.pDecodedData = nullptr;
+      return;
+    }
+    // Leave anything unusual to the regular path in GetObjectStream().
+    if (!image_encoding.IsEmpty() || job.pDecodedData == job.pSrcData) {
+      if (job.pDecodedData != job.pSrcData)
+        FX_Free(job.pDecodedData);
+      job.pDecodedData = nullptr;
+    }
+  });
+
+  for (PrefetchJob& job : jobs) {
+    std::unique_ptr<uint8_t, FxFreeDeleter> pData(job.pDecodedData);
+    if (!pData)
+      continue;
+    if (m_nObjectStreamCacheLimit &&
+        m_ObjectStreamStats.nBytesHeld + job.dwDecodedSize >
+            m_nObjectStreamCacheLimit) {
+      continue;
+    }
+    auto pStreamAcc = pdfium::MakeUnique<CPDF_StreamAcc>();
+    pStreamAcc->SetDecodedData(job.pStream, std::move(pData),
+                               job.dwDecodedSize);
+    AddObjectStream(job.number, std::move(pStreamAcc));
+    ++m_ObjectStreamStats.nPrefetched;
+  }
+}
+
+CPDF_StreamAcc* CPDF_Parser::AddObjectStream(
+    uint32_t number,
+    std::unique_ptr<CPDF_StreamAcc> pStreamAcc) {
+  auto it = m_ObjectStreams.find(number);
+  if (it != m_ObjectStreams.end())
+    return it->second.pAcc.get();
+
+  ObjectStreamEntry& entry = m_ObjectStreams[number];
+  entry.pAcc = std::move(pStreamAcc);
+  m_ObjectStreamLRU.push_front(number);
+  entry.LRUPos = m_ObjectStreamLRU.begin();
+  m_ObjectStreamStats.nBytesHeld += entry.pAcc->GetSize();
+  if (!m_nObjectStreamCacheLimit)
+    return entry.pAcc.get();
+
+  // Drop the least recently used streams, but never the one just added,
+  // which the caller is about to read.
+  auto lru_it = std::prev(m_ObjectStreamLRU.end());
+  while (m_ObjectStreamStats.nBytesHeld > m_nObjectStreamCacheLimit &&
+         lru_it != m_ObjectStreamLRU.begin()) {
+    uint32_t victim = *lru_it--;
+    if (!m_ObjectStreams[victim].nPins)
+      ReleaseObjectStream(victim);
+  }
+  return entry.pAcc.get();
+}
+
+void CPDF_Parser::MarkObjectStreamParsed(uint32_t number, uint32_t objnum) {
+  if (!m_nObjectStreamCacheLimit)
+    return;
+
+  auto it = m_ObjectStreams.find(number);
+  if (it == m_ObjectStreams.end())
+    return;
+
+  ObjectStreamEntry& entry = it->second;
+  entry.ParsedObjNums.insert(objnum);
+  if (!entry.nPins && entry.ParsedObjNums.size() >= entry.Offsets.size())
+    ReleaseObjectStream(number);
+}
+
+void CPDF_Parser::ReleaseObjectStream(uint32_t number) {
+  auto it = m_ObjectStreams.find(number);
+  if (it == m_ObjectStreams.end())
+    return;
+
+  m_ObjectStreamStats.nBytesHeld -= it->second.pAcc->GetSize();
+  ++m_ObjectStreamStats.nReleased;
+  m_ObjectStreamLRU.erase(it->second.LRUPos);
+  m_ObjectStreams.erase(it);
+}
+
+void CPDF_Parser::ClearObjectStreams() {
+  m_ObjectStreams.clear();
+  m_ObjectStreamLRU.clear();
+  m_ObjectStreamStats.nBytesHeld = 0;
 }
 
 FX_FILESIZE CPDF_Parser::GetObjectSize(uint32_t objnum) const {
@@ -1541,7 +1765,7 @@ bool CPDF_Parser::LoadLinearizedAllCrossRefV5(FX_FILESIZE xrefpos) {
     if (pdfium::ContainsKey(seen_xrefpos, xrefpos))
       return false;
   }
-  m_ObjectStreamMap.clear();
+  ClearObjectStreams();
   m_bXRefStream = true;
   return true;
 }
@@ -1564,8 +1788,7 @@ CPDF_Parser::Error CPDF_Parser::LoadLinearizedMainXRefTable() {
     m_pSyntax->GetNextChar(ch);
   }
   m_LastXRefOffset += dwCount;
-  m_ObjectStreamMap.clear();
-  m_ObjCache.clear();
+  ClearObjectStreams();
 
   if (!LoadLinearizedAllCrossRefV4(m_LastXRefOffset, m_dwXrefStartObjNum) &&
       !LoadLinearizedAllCrossRefV5(m_LastXRefOffset)) {
@@ -7,11 +7,13 @@
 #ifndef CORE_FPDFAPI_PARSER_CPDF_PARSER_H_
 #define CORE_FPDFAPI_PARSER_CPDF_PARSER_H_
 
+#include <list>
 #include <map>
 #include <memory>
 #include <set>
 #include <vector>
 
+#include "core/fxcrt/cfx_dense_map.h"
 #include "core/fxcrt/fx_basic.h"
 
 class CPDF_Array;
@@ -40,6 +42,17 @@ class CPDF_Parser {
   // are higher, but this may be large enough in practice.
   static const uint32_t kMaxObjectNumber = 1048576;
 
+  struct ObjectStreamStats {
+    ObjectStreamStats()
+        : nHits(0), nMisses(0), nPrefetched(0), nReleased(0), nBytesHeld(0) {}
+
+    size_t nHits;        // Lookups that found the stream already decoded.
+    size_t nMisses;      // Lookups that had to decode the stream.
+    size_t nPrefetched;  // Streams decoded ahead of time by StartParse().
+    size_t nReleased;    // Decoded streams dropped to stay within the limit.
+    size_t nBytesHeld;   // Decoded bytes currently kept.
+  };
+
   CPDF_Parser();
   ~CPDF_Parser();
 
@@ -48,6 +61,23 @@ class CPDF_Parser {
   Error StartLinearizedParse(const CFX_RetainPtr<IFX_SeekableReadStream>& pFile,
                              CPDF_Document* pDocument);
 
+  // Whether StartParse() decodes all object streams up front, spread over the
+  // worker threads of CFX_ThreadPool::Get(). Defaults to the CPDF_ModuleMgr
+  // setting.
+  void SetPrefetchObjectStreams(bool bPrefetch) {
+    m_bPrefetchObjectStreams = bPrefetch;
+  }
+
+  // Upper bound on the decoded object stream bytes kept for later lookups, or
+  // 0 to keep all of them. When set, a stream is also dropped as soon as each
+  // of its objects has been parsed. Defaults to the CPDF_ModuleMgr setting.
+  void SetObjectStreamCacheLimit(size_t nBytes) {
+    m_nObjectStreamCacheLimit = nBytes;
+  }
+  const ObjectStreamStats& GetObjectStreamStats() const {
+    return m_ObjectStreamStats;
+  }
+
   void SetPassword(const FX_CHAR* password) { m_Password = password; }
   CFX_ByteString GetPassword() { return m_Password; }
   CPDF_Dictionary* GetTrailer() const { return m_pTrailer.get(); }
@@ -65,6 +95,7 @@ class CPDF_Parser {
       uint32_t objnum);
 
   uint32_t GetLastObjNum() const;
+  size_t GetObjectCount() const { return m_ObjectInfo.size(); }
   bool IsValidObjectNumber(uint32_t objnum) const;
   FX_FILESIZE GetObjectPositionOrZero(uint32_t objnum) const;
   uint8_t GetObjectType(uint32_t objnum) const;
@@ -104,7 +135,7 @@ class CPDF_Parser {
   };
 
   std::unique_ptr<CPDF_SyntaxParser> m_pSyntax;
-  std::map<uint32_t, ObjectInfo> m_ObjectInfo;
+  CFX_DenseMap<ObjectInfo> m_ObjectInfo;
 
   bool LoadCrossRefV4(FX_FILESIZE pos, FX_FILESIZE streampos, bool bSkip);
   bool RebuildCrossRef();
@@ -141,6 +172,12 @@ class CPDF_Parser {
   bool LoadLinearizedAllCrossRefV5(FX_FILESIZE pos);
   Error LoadLinearizedMainXRefTable();
   CPDF_StreamAcc* GetObjectStream(uint32_t number);
+  void PrefetchObjectStreams();
+  CPDF_StreamAcc* AddObjectStream(uint32_t number,
+                                  std::unique_ptr<CPDF_StreamAcc> pStreamAcc);
+  void MarkObjectStreamParsed(uint32_t number, uint32_t objnum);
+  void ReleaseObjectStream(uint32_t number);
+  void ClearObjectStreams();
   bool IsLinearizedFile(
       const CFX_RetainPtr<IFX_SeekableReadStream>& pFileAccess,
       uint32_t offset);
@@ -165,16 +202,35 @@ class CPDF_Parser {
   std::unique_ptr<CPDF_LinearizedHeader> m_pLinearized;
   uint32_t m_dwXrefStartObjNum;
 
-  // A map of object numbers to indirect streams. Map owns the streams.
-  std::map<uint32_t, std::unique_ptr<CPDF_StreamAcc>> m_ObjectStreamMap;
+  struct ObjectStreamEntry {
+    ObjectStreamEntry();
+    ~ObjectStreamEntry();
+
+    std::unique_ptr<CPDF_StreamAcc> pAcc;
+
+    // Mapping of object numbers to offsets. The offsets are relative to the
+    // first object in the stream. Filled in on first use.
+    std::map<uint32_t, uint32_t> Offsets;
+    bool bOffsetsLoaded;
+
+    // Objects of the stream that have been parsed so far.
+    std::set<uint32_t> ParsedObjNums;
+
+    // Number of parses currently reading from |pAcc|, which keep it alive.
+    int nPins;
+
+    // Position in |m_ObjectStreamLRU|.
+    std::list<uint32_t>::iterator LRUPos;
+  };
 
-  // Mapping of object numbers to offsets. The offsets are relative to the first
-  // object in the stream.
-  using StreamObjectCache = std::map<uint32_t, uint32_t>;
+  // A map of object numbers to decoded object streams.
+  std::map<uint32_t, ObjectStreamEntry> m_ObjectStreams;
 
-  // Mapping of streams to their object caches. This is valid as long as the
-  // streams in |m_ObjectStreamMap| are valid.
-  std::map<CPDF_StreamAcc*, StreamObjectCache> m_ObjCache;
+  // Numbers of the streams in |m_ObjectStreams|, most recently used first.
+  std::list<uint32_t> m_ObjectStreamLRU;
+  bool m_bPrefetchObjectStreams;
+  size_t m_nObjectStreamCacheLimit;
+  ObjectStreamStats m_ObjectStreamStats;
 
   // All indirect object numbers that are being parsed.
   std::set<uint32_t> m_ParsingObjNums;
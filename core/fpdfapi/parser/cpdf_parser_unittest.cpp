@@ -3,15 +3,22 @@
 // found in the LICENSE file.
 
 #include <limits>
+#include <memory>
 #include <string>
+#include <utility>
 
+#include "core/fpdfapi/cpdf_modulemgr.h"
+#include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/parser/cpdf_parser.h"
 #include "core/fpdfapi/parser/cpdf_syntax_parser.h"
+#include "core/fxcodec/fx_codec.h"
 #include "core/fxcrt/cfx_retain_ptr.h"
+#include "core/fxcrt/cfx_threadpool.h"
 #include "core/fxcrt/fx_ext.h"
 #include "core/fxcrt/fx_stream.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/utils/path_service.h"
+#include "third_party/base/ptr_util.h"
 
 // Provide a way to read test data from a buffer instead of a file.
 class CFX_TestBufferRead : public IFX_SeekableReadStream {
@@ -207,3 +214,94 @@ TEST(cpdf_parser, LoadCrossRefV4) {
     }
   }
 }
+
+namespace {
+
+std::unique_ptr<CPDF_Document> LoadDocument(const std::string& path,
+                                            bool bPrefetch,
+                                            size_t cache_limit) {
+  CFX_RetainPtr<IFX_SeekableReadStream> pFileAccess =
+      IFX_SeekableReadStream::CreateFromFilename(path.c_str());
+  if (!pFileAccess)
+    return nullptr;
+
+  auto pParser = pdfium::MakeUnique<CPDF_Parser>();
+  pParser->SetPrefetchObjectStreams(bPrefetch);
+  pParser->SetObjectStreamCacheLimit(cache_limit);
+  auto pDocument = pdfium::MakeUnique<CPDF_Document>(std::move(pParser));
+  if (pDocument->GetParser()->StartParse(pFileAccess, pDocument.get()) !=
+      CPDF_Parser::SUCCESS) {
+    return nullptr;
+  }
+  return pDocument;
+}
+
+}  // namespace
+
+TEST(cpdf_parser, ObjectStreamCache) {
+  CCodec_ModuleMgr codec_module;
+  CPDF_ModuleMgr* module_mgr = CPDF_ModuleMgr::Get();
+  module_mgr->SetCodecModule(&codec_module);
+  module_mgr->InitPageModule();
+  CFX_ThreadPool::Create(2);
+
+  std::string test_file;
+  ASSERT_TRUE(PathService::GetTestFilePath("page_labels.pdf", &test_file));
+  std::unique_ptr<CPDF_Document> pExpected =
+      LoadDocument(test_file, false, 0);
+  ASSERT_TRUE(pExpected);
+  CPDF_Parser* pExpectedParser = pExpected->GetParser();
+
+  // Prefetching decodes the object streams up front, so parsing the rest of
+  // the objects never misses.
+  std::unique_ptr<CPDF_Document> pPrefetched =
+      LoadDocument(test_file, true, 0);
+  ASSERT_TRUE(pPrefetched);
+  CPDF_Parser* pPrefetchedParser = pPrefetched->GetParser();
+  EXPECT_LT(0u, pPrefetchedParser->GetObjectStreamStats().nPrefetched);
+
+  // With a tiny limit, streams get released and decoded again as needed.
+  std::unique_ptr<CPDF_Document> pLimited = LoadDocument(test_file, false, 1);
+  ASSERT_TRUE(pLimited);
+  CPDF_Parser* pLimitedParser = pLimited->GetParser();
+
+  ASSERT_EQ(pExpectedParser->GetLastObjNum(),
+            pPrefetchedParser->GetLastObjNum());
+  ASSERT_EQ(pExpectedParser->GetLastObjNum(), pLimitedParser->GetLastObjNum());
+  for (uint32_t i = 1; i <= pExpectedParser->GetLastObjNum(); ++i) {
+    CPDF_Object* pObj = pExpected->GetOrParseIndirectObject(i);
+    CPDF_Object* pPrefetchedObj = pPrefetched->GetOrParseIndirectObject(i);
+    CPDF_Object* pLimitedObj = pLimited->GetOrParseIndirectObject(i);
+    if (!pObj) {
+      EXPECT_FALSE(pPrefetchedObj);
+      EXPECT_FALSE(pLimitedObj);
+      continue;
+    }
+    ASSERT_TRUE(pPrefetchedObj);
+    ASSERT_TRUE(pLimitedObj);
+    EXPECT_EQ(pObj->GetType(), pPrefetchedObj->GetType());
+    EXPECT_EQ(pObj->GetType(), pLimitedObj->GetType());
+  }
+
+  const CPDF_Parser::ObjectStreamStats& expected_stats =
+      pExpectedParser->GetObjectStreamStats();
+  EXPECT_LT(0u, expected_stats.nMisses);
+  EXPECT_EQ(0u, expected_stats.nReleased);
+  EXPECT_LT(0u, expected_stats.nBytesHeld);
+
+  const CPDF_Parser::ObjectStreamStats& prefetched_stats =
+      pPrefetchedParser->GetObjectStreamStats();
+  EXPECT_EQ(0u, prefetched_stats.nMisses);
+  EXPECT_EQ(expected_stats.nBytesHeld, prefetched_stats.nBytesHeld);
+
+  const CPDF_Parser::ObjectStreamStats& limited_stats =
+      pLimitedParser->GetObjectStreamStats();
+  EXPECT_LT(0u, limited_stats.nReleased);
+  EXPECT_EQ(0u, limited_stats.nBytesHeld);
+
+  pExpected.reset();
+  pPrefetched.reset();
+  pLimited.reset();
+  CFX_ThreadPool::Destroy();
+  CPDF_ModuleMgr::Destroy();
+}
@@ -23,6 +23,18 @@ CPDF_Stream::CPDF_Stream(std::unique_ptr<uint8_t, FxFreeDeleter> pData,
                          std::unique_ptr<CPDF_Dictionary> pDict)
     : m_dwSize(size), m_pDict(std::move(pDict)), m_pDataBuf(std::move(pData)) {}
 
+CPDF_Stream::CPDF_Stream(const CFX_RetainPtr<IFX_SeekableReadStream>& pFile,
+                         const uint8_t* pData,
+                         uint32_t size,
+                         std::unique_ptr<CPDF_Dictionary> pDict)
+    : m_dwSize(size),
+      m_pDict(std::move(pDict)),
+      m_pMappedData(pData),
+      m_pMappedFile(pFile) {
+  ASSERT(pFile->GetMappedData() && pData >= pFile->GetMappedData() &&
+         pData + size <= pFile->GetMappedData() + pFile->GetSize());
+}
+
 CPDF_Stream::~CPDF_Stream() {
   m_ObjNum = kInvalidObjNum;
   if (m_pDict && m_pDict->GetObjNum() == kInvalidObjNum)
@@ -58,6 +70,7 @@ void CPDF_Stream::InitStream(const uint8_t* pData,
   m_pDataBuf.reset(FX_Alloc(uint8_t, size));
   if (pData)
     FXSYS_memcpy(m_pDataBuf.get(), pData, size);
+  ReleaseMappedData();
   m_dwSize = size;
   if (m_pDict)
     m_pDict->SetNewFor<CPDF_Number>("Length", static_cast<int>(m_dwSize));
@@ -69,6 +82,7 @@ void CPDF_Stream::InitStreamFromFile(
   m_pDict = std::move(pDict);
   m_bMemoryBased = false;
   m_pDataBuf.reset();
+  ReleaseMappedData();
   m_pFile = pFile;
   m_dwSize = pdfium::base::checked_cast<uint32_t>(pFile->GetSize());
   if (m_pDict)
@@ -102,6 +116,7 @@ void CPDF_Stream::SetData(const uint8_t* pData, uint32_t size) {
   m_pDataBuf.reset(FX_Alloc(uint8_t, size));
   if (pData)
     FXSYS_memcpy(m_pDataBuf.get(), pData, size);
+  ReleaseMappedData();
   m_dwSize = size;
   if (!m_pDict)
     m_pDict = pdfium::MakeUnique<CPDF_Dictionary>();
@@ -116,12 +131,17 @@ bool CPDF_Stream::ReadRawData(FX_FILESIZE offset,
   if (m_bMemoryBased && m_pFile)
     return m_pFile->ReadBlock(buf, offset, size);
 
-  if (m_pDataBuf)
-    FXSYS_memcpy(buf, m_pDataBuf.get() + offset, size);
+  if (const uint8_t* pData = GetRawData())
+    FXSYS_memcpy(buf, pData + offset, size);
 
   return true;
 }
 
+void CPDF_Stream::ReleaseMappedData() {
+  m_pMappedData = nullptr;
+  m_pMappedFile = nullptr;
+}
+
 bool CPDF_Stream::HasFilter() const {
   return m_pDict && m_pDict->KeyExist("Filter");
 }
@@ -23,6 +23,13 @@ class CPDF_Stream : public CPDF_Object {
               uint32_t size,
               std::unique_ptr<CPDF_Dictionary> pDict);
 
+  // Refers to |size| bytes at |pData| in place. |pData| must point into the
+  // mapped data of |pFile|, which is kept alive for as long as it is used.
+  CPDF_Stream(const CFX_RetainPtr<IFX_SeekableReadStream>& pFile,
+              const uint8_t* pData,
+              uint32_t size,
+              std::unique_ptr<CPDF_Dictionary> pDict);
+
   ~CPDF_Stream() override;
 
   // CPDF_Object:
@@ -35,7 +42,9 @@ class CPDF_Stream : public CPDF_Object {
   const CPDF_Stream* AsStream() const override;
 
   uint32_t GetRawSize() const { return m_dwSize; }
-  uint8_t* GetRawData() const { return m_pDataBuf.get(); }
+  const uint8_t* GetRawData() const {
+    return m_pDataBuf ? m_pDataBuf.get() : m_pMappedData;
+  }
 
   // Does not takes onwership of |pData|, copies into internally-owned buffer.
   void SetData(const uint8_t* pData, uint32_t size);
@@ -58,10 +67,14 @@ class CPDF_Stream : public CPDF_Object {
       bool bDirect,
       std::set<const CPDF_Object*>* pVisited) const override;
 
+  void ReleaseMappedData();
+
   bool m_bMemoryBased = true;
   uint32_t m_dwSize = 0;
   std::unique_ptr<CPDF_Dictionary> m_pDict;
   std::unique_ptr<uint8_t, FxFreeDeleter> m_pDataBuf;
+  const uint8_t* m_pMappedData = nullptr;
+  CFX_RetainPtr<IFX_SeekableReadStream> m_pMappedFile;
   CFX_RetainPtr<IFX_SeekableReadStream> m_pFile;
 };
 
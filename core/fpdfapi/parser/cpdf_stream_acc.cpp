@@ -25,8 +25,9 @@ void CPDF_StreamAcc::LoadAllData(const CPDF_Stream* pStream,
 
   m_pStream = pStream;
   if (pStream->IsMemoryBased() && (!pStream->HasFilter() || bRawAccess)) {
+    // |m_pData| is never written through, and is only freed if |m_bNewBuf|.
     m_dwSize = pStream->GetRawSize();
-    m_pData = pStream->GetRawData();
+    m_pData = const_cast<uint8_t*>(pStream->GetRawData());
     return;
   }
   uint32_t dwSrcSize = pStream->GetRawSize();
@@ -39,7 +40,16 @@ void CPDF_StreamAcc::LoadAllData(const CPDF_Stream* pStream,
     if (!pStream->ReadRawData(0, pSrcData, dwSrcSize))
       return;
   } else {
-    pSrcData = pStream->GetRawData();
+    pSrcData = const_cast<uint8_t*>(pStream->GetRawData());
+  }
+  // /DL gives the size of the fully decoded data. PDF_DataDecode() only uses
+  // it for the last filter in the chain, as that is what it sizes, however
+  // many filters there are. Image streams stop short of their last filter,
+  // so the hint does not apply to them.
+  if (!estimated_size && !bImageAcc && pStream->GetDict()) {
+    int decoded_size = pStream->GetDict()->GetIntegerFor("DL");
+    if (decoded_size > 0)
+      estimated_size = decoded_size;
   }
   if (!pStream->HasFilter() || bRawAccess) {
     m_pData = pSrcData;
@@ -56,6 +66,17 @@ void CPDF_StreamAcc::LoadAllData(const CPDF_Stream* pStream,
   m_bNewBuf = m_pData != pStream->GetRawData();
 }
 
+void CPDF_StreamAcc::SetDecodedData(
+    const CPDF_Stream* pStream,
+    std::unique_ptr<uint8_t, FxFreeDeleter> pData,
+    uint32_t dwSize) {
+  ASSERT(!m_pStream);
+  m_pStream = pStream;
+  m_pData = pData.release();
+  m_dwSize = dwSize;
+  m_bNewBuf = true;
+}
+
 CPDF_StreamAcc::~CPDF_StreamAcc() {
   if (m_bNewBuf)
     FX_Free(m_pData);
@@ -27,6 +27,12 @@ class CPDF_StreamAcc {
                    uint32_t estimated_size = 0,
                    bool bImageAcc = false);
 
+  // Like LoadAllData(), but with |pData| already decoded from |pStream|,
+  // e.g. on another thread. Takes ownership of |pData|.
+  void SetDecodedData(const CPDF_Stream* pStream,
+                      std::unique_ptr<uint8_t, FxFreeDeleter> pData,
+                      uint32_t dwSize);
+
   const CPDF_Stream* GetStream() const { return m_pStream; }
   CPDF_Dictionary* GetDict() const {
     return m_pStream ? m_pStream->GetDict() : nullptr;
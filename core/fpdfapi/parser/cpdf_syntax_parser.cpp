@@ -17,7 +17,9 @@
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_name.h"
 #include "core/fpdfapi/parser/cpdf_null.h"
+#include "core/fpdfapi/parser/cpdf_indirect_object_holder.h"
 #include "core/fpdfapi/parser/cpdf_number.h"
+#include "core/fpdfapi/parser/cpdf_object_arena.h"
 #include "core/fpdfapi/parser/cpdf_reference.h"
 #include "core/fpdfapi/parser/cpdf_stream.h"
 #include "core/fpdfapi/parser/cpdf_string.h"
@@ -31,10 +33,14 @@ namespace {
 
 enum class ReadStatus { Normal, Backslash, Octal, FinishOctal, CarriageReturn };
 
+CPDF_ObjectArena* GetObjectArena(CPDF_IndirectObjectHolder* pObjList) {
+  return pObjList ? pObjList->GetObjectArena() : nullptr;
+}
+
 }  // namespace
 
 // static
-int CPDF_SyntaxParser::s_CurrentRecursionDepth = 0;
+thread_local int CPDF_SyntaxParser::s_CurrentRecursionDepth = 0;
 
 CPDF_SyntaxParser::CPDF_SyntaxParser()
     : CPDF_SyntaxParser(CFX_WeakPtr<CFX_ByteStringPool>()) {}
@@ -43,6 +49,7 @@ CPDF_SyntaxParser::CPDF_SyntaxParser(
     const CFX_WeakPtr<CFX_ByteStringPool>& pPool)
     : m_MetadataObjnum(0),
       m_pFileAccess(nullptr),
+      m_pMappedData(nullptr),
       m_pFileBuf(nullptr),
       m_BufSize(CPDF_ModuleMgr::kFileBufSize),
       m_pPool(pPool) {}
@@ -78,6 +85,14 @@ bool CPDF_SyntaxParser::GetNextChar(uint8_t& ch) {
   if (pos >= m_FileLen)
     return false;
 
+  if (m_pMappedData) {
+    if (pos < 0)
+      return false;
+    ch = m_pMappedData[pos];
+    m_Pos++;
+    return true;
+  }
+
   if (CheckPosition(pos)) {
     FX_FILESIZE read_pos = pos;
     uint32_t read_size = m_BufSize;
@@ -95,6 +110,13 @@ bool CPDF_SyntaxParser::GetCharAtBackward(FX_FILESIZE pos, uint8_t& ch) {
   if (pos >= m_FileLen)
     return false;
 
+  if (m_pMappedData) {
+    if (pos < 0)
+      return false;
+    ch = m_pMappedData[pos];
+    return true;
+  }
+
   if (CheckPosition(pos)) {
     FX_FILESIZE read_pos;
     if (pos < static_cast<FX_FILESIZE>(m_BufSize))
@@ -110,12 +132,27 @@ bool CPDF_SyntaxParser::GetCharAtBackward(FX_FILESIZE pos, uint8_t& ch) {
 }
 
 bool CPDF_SyntaxParser::ReadBlock(uint8_t* pBuf, uint32_t size) {
-  if (!m_pFileAccess->ReadBlock(pBuf, m_Pos + m_HeaderOffset, size))
+  if (m_pMappedData) {
+    const uint8_t* pData = GetMappedBlock(size);
+    if (!pData)
+      return false;
+    FXSYS_memcpy(pBuf, pData, size);
+  } else if (!m_pFileAccess->ReadBlock(pBuf, m_Pos + m_HeaderOffset, size)) {
     return false;
+  }
   m_Pos += size;
   return true;
 }
 
+const uint8_t* CPDF_SyntaxParser::GetMappedBlock(uint32_t size) const {
+  FX_FILESIZE pos = m_Pos + m_HeaderOffset;
+  if (!m_pMappedData || pos < 0 || pos > m_FileLen ||
+      static_cast<FX_FILESIZE>(size) > m_FileLen - pos) {
+    return nullptr;
+  }
+  return m_pMappedData + pos;
+}
+
 void CPDF_SyntaxParser::GetNextWordInternal(bool* bIsNumber) {
   m_WordSize = 0;
   if (bIsNumber)
@@ -374,6 +411,7 @@ std::unique_ptr<CPDF_Object> CPDF_SyntaxParser::GetObject(
   if (++s_CurrentRecursionDepth > kParserMaxRecursionDepth)
     return nullptr;
 
+  CPDF_ObjectArena* pArena = GetObjectArena(pObjList);
   FX_FILESIZE SavedObjPos = m_Pos;
   bool bIsNumber;
   CFX_ByteString word = GetNextWord(&bIsNumber);
@@ -389,33 +427,33 @@ std::unique_ptr<CPDF_Object> CPDF_SyntaxParser::GetObject(
         uint32_t objnum = FXSYS_atoui(word.c_str());
         if (objnum == CPDF_Object::kInvalidObjNum)
           return nullptr;
-        return pdfium::MakeUnique<CPDF_Reference>(pObjList, objnum);
+        return NewArenaObject<CPDF_Reference>(pArena, pObjList, objnum);
       }
     }
     m_Pos = SavedPos;
-    return pdfium::MakeUnique<CPDF_Number>(word.AsStringC());
+    return NewArenaObject<CPDF_Number>(pArena, word.AsStringC());
   }
 
   if (word == "true" || word == "false")
-    return pdfium::MakeUnique<CPDF_Boolean>(word == "true");
+    return NewArenaObject<CPDF_Boolean>(pArena, word == "true");
 
   if (word == "null")
-    return pdfium::MakeUnique<CPDF_Null>();
+    return NewArenaObject<CPDF_Null>(pArena);
 
   if (word == "(") {
     CFX_ByteString str = ReadString();
     if (m_pCryptoHandler && bDecrypt)
       m_pCryptoHandler->Decrypt(objnum, gennum, str);
-    return pdfium::MakeUnique<CPDF_String>(m_pPool, str, false);
+    return NewArenaObject<CPDF_String>(pArena, m_pPool, str, false);
   }
   if (word == "<") {
     CFX_ByteString str = ReadHexString();
     if (m_pCryptoHandler && bDecrypt)
       m_pCryptoHandler->Decrypt(objnum, gennum, str);
-    return pdfium::MakeUnique<CPDF_String>(m_pPool, str, true);
+    return NewArenaObject<CPDF_String>(pArena, m_pPool, str, true);
   }
   if (word == "[") {
-    std::unique_ptr<CPDF_Array> pArray = pdfium::MakeUnique<CPDF_Array>();
+    std::unique_ptr<CPDF_Array> pArray = NewArenaObject<CPDF_Array>(pArena);
     while (std::unique_ptr<CPDF_Object> pObj =
                GetObject(pObjList, objnum, gennum, true)) {
       pArray->Add(std::move(pObj));
@@ -423,15 +461,15 @@ std::unique_ptr<CPDF_Object> CPDF_SyntaxParser::GetObject(
     return std::move(pArray);
   }
   if (word[0] == '/') {
-    return pdfium::MakeUnique<CPDF_Name>(
-        m_pPool,
+    return NewArenaObject<CPDF_Name>(
+        pArena, m_pPool,
         PDF_NameDecode(CFX_ByteStringC(m_WordBuffer + 1, m_WordSize - 1)));
   }
   if (word == "<<") {
     int32_t nKeys = 0;
     FX_FILESIZE dwSignValuePos = 0;
     std::unique_ptr<CPDF_Dictionary> pDict =
-        pdfium::MakeUnique<CPDF_Dictionary>(m_pPool);
+        NewArenaObject<CPDF_Dictionary>(pArena, m_pPool);
     while (1) {
       CFX_ByteString key = GetNextWord(nullptr);
       if (key.IsEmpty())
@@ -479,7 +517,7 @@ std::unique_ptr<CPDF_Object> CPDF_SyntaxParser::GetObject(
       m_Pos = SavedPos;
       return std::move(pDict);
     }
-    return ReadStream(std::move(pDict), objnum, gennum);
+    return ReadStream(std::move(pDict), objnum, gennum, pArena);
   }
   if (word == ">>")
     m_Pos = SavedObjPos;
@@ -495,6 +533,7 @@ std::unique_ptr<CPDF_Object> CPDF_SyntaxParser::GetObjectForStrict(
   if (++s_CurrentRecursionDepth > kParserMaxRecursionDepth)
     return nullptr;
 
+  CPDF_ObjectArena* pArena = GetObjectArena(pObjList);
   FX_FILESIZE SavedObjPos = m_Pos;
   bool bIsNumber;
   CFX_ByteString word = GetNextWord(&bIsNumber);
@@ -510,33 +549,33 @@ std::unique_ptr<CPDF_Object> CPDF_SyntaxParser::GetObjectForStrict(
         uint32_t objnum = FXSYS_atoui(word.c_str());
         if (objnum == CPDF_Object::kInvalidObjNum)
           return nullptr;
-        return pdfium::MakeUnique<CPDF_Reference>(pObjList, objnum);
+        return NewArenaObject<CPDF_Reference>(pArena, pObjList, objnum);
       }
     }
     m_Pos = SavedPos;
-    return pdfium::MakeUnique<CPDF_Number>(word.AsStringC());
+    return NewArenaObject<CPDF_Number>(pArena, word.AsStringC());
   }
 
   if (word == "true" || word == "false")
-    return pdfium::MakeUnique<CPDF_Boolean>(word == "true");
+    return NewArenaObject<CPDF_Boolean>(pArena, word == "true");
 
   if (word == "null")
-    return pdfium::MakeUnique<CPDF_Null>();
+    return NewArenaObject<CPDF_Null>(pArena);
 
   if (word == "(") {
     CFX_ByteString str = ReadString();
     if (m_pCryptoHandler)
       m_pCryptoHandler->Decrypt(objnum, gennum, str);
-    return pdfium::MakeUnique<CPDF_String>(m_pPool, str, false);
+    return NewArenaObject<CPDF_String>(pArena, m_pPool, str, false);
   }
   if (word == "<") {
     CFX_ByteString str = ReadHexString();
     if (m_pCryptoHandler)
       m_pCryptoHandler->Decrypt(objnum, gennum, str);
-    return pdfium::MakeUnique<CPDF_String>(m_pPool, str, true);
+    return NewArenaObject<CPDF_String>(pArena, m_pPool, str, true);
   }
   if (word == "[") {
-    std::unique_ptr<CPDF_Array> pArray = pdfium::MakeUnique<CPDF_Array>();
+    std::unique_ptr<CPDF_Array> pArray = NewArenaObject<CPDF_Array>(pArena);
     while (std::unique_ptr<CPDF_Object> pObj =
                GetObject(pObjList, objnum, gennum, true)) {
       pArray->Add(std::move(pObj));
@@ -544,13 +583,13 @@ std::unique_ptr<CPDF_Object> CPDF_SyntaxParser::GetObjectForStrict(
     return m_WordBuffer[0] == ']' ? std::move(pArray) : nullptr;
   }
   if (word[0] == '/') {
-    return pdfium::MakeUnique<CPDF_Name>(
-        m_pPool,
+    return NewArenaObject<CPDF_Name>(
+        pArena, m_pPool,
         PDF_NameDecode(CFX_ByteStringC(m_WordBuffer + 1, m_WordSize - 1)));
   }
   if (word == "<<") {
     std::unique_ptr<CPDF_Dictionary> pDict =
-        pdfium::MakeUnique<CPDF_Dictionary>(m_pPool);
+        NewArenaObject<CPDF_Dictionary>(pArena, m_pPool);
     while (1) {
       FX_FILESIZE SavedPos = m_Pos;
       CFX_ByteString key = GetNextWord(nullptr);
@@ -590,7 +629,7 @@ std::unique_ptr<CPDF_Object> CPDF_SyntaxParser::GetObjectForStrict(
       m_Pos = SavedPos;
       return std::move(pDict);
     }
-    return ReadStream(std::move(pDict), objnum, gennum);
+    return ReadStream(std::move(pDict), objnum, gennum, pArena);
   }
   if (word == ">>")
     m_Pos = SavedObjPos;
@@ -617,7 +656,8 @@ unsigned int CPDF_SyntaxParser::ReadEOLMarkers(FX_FILESIZE pos) {
 std::unique_ptr<CPDF_Stream> CPDF_SyntaxParser::ReadStream(
     std::unique_ptr<CPDF_Dictionary> pDict,
     uint32_t objnum,
-    uint32_t gennum) {
+    uint32_t gennum,
+    CPDF_ObjectArena* pArena) {
   CPDF_Object* pLenObj = pDict->GetObjectFor("Length");
   FX_FILESIZE len = -1;
   CPDF_Reference* pLenObjRef = ToReference(pLenObj);
@@ -727,8 +767,18 @@ std::unique_ptr<CPDF_Stream> CPDF_SyntaxParser::ReadStream(
   if (len < 0)
     return nullptr;
 
+  // Unencrypted stream data in a mapped file is used in place.
+  const uint8_t* pMappedData =
+      !pCryptoHandler && len > 0 ? GetMappedBlock(len) : nullptr;
+  std::unique_ptr<CPDF_Stream> pStream;
+  if (pMappedData) {
+    pStream = NewArenaObject<CPDF_Stream>(pArena, m_pFileAccess, pMappedData,
+                                          len, std::move(pDict));
+    m_Pos += len;
+  }
+
   std::unique_ptr<uint8_t, FxFreeDeleter> pData;
-  if (len > 0) {
+  if (!pStream && len > 0) {
     pData.reset(FX_Alloc(uint8_t, len));
     ReadBlock(pData.get(), len);
     if (pCryptoHandler) {
@@ -743,8 +793,10 @@ std::unique_ptr<CPDF_Stream> CPDF_SyntaxParser::ReadStream(
     }
   }
 
-  auto pStream =
-      pdfium::MakeUnique<CPDF_Stream>(std::move(pData), len, std::move(pDict));
+  if (!pStream) {
+    pStream = NewArenaObject<CPDF_Stream>(pArena, std::move(pData), len,
+                                          std::move(pDict));
+  }
   streamStartPos = m_Pos;
   FXSYS_memset(m_WordBuffer, 0, kEndObjStr.GetLength() + 1);
   GetNextWordInternal(nullptr);
@@ -769,7 +821,11 @@ void CPDF_SyntaxParser::InitParser(
   m_FileLen = pFileAccess->GetSize();
   m_Pos = 0;
   m_pFileAccess = pFileAccess;
+  m_pMappedData = pFileAccess->GetMappedData();
   m_BufOffset = 0;
+  if (m_pMappedData)
+    return;
+
   pFileAccess->ReadBlock(m_pFileBuf, 0,
                          std::min(m_BufSize, static_cast<uint32_t>(m_FileLen)));
 }
@@ -17,6 +17,7 @@ class CPDF_CryptoHandler;
 class CPDF_Dictionary;
 class CPDF_IndirectObjectHolder;
 class CPDF_Object;
+class CPDF_ObjectArena;
 class CPDF_Stream;
 class IFX_SeekableReadStream;
 
@@ -62,12 +63,16 @@ class CPDF_SyntaxParser {
   friend class cpdf_syntax_parser_ReadHexString_Test;
 
   static const int kParserMaxRecursionDepth = 64;
-  static int s_CurrentRecursionDepth;
+  static thread_local int s_CurrentRecursionDepth;
 
   uint32_t GetDirectNum();
   bool ReadChar(FX_FILESIZE read_pos, uint32_t read_size);
   bool GetNextChar(uint8_t& ch);
   bool GetCharAtBackward(FX_FILESIZE pos, uint8_t& ch);
+
+  // Returns |size| bytes at the current position of a mapped file, or
+  // nullptr if the file is not mapped or too short.
+  const uint8_t* GetMappedBlock(uint32_t size) const;
   void GetNextWordInternal(bool* bIsNumber);
   bool IsWholeWord(FX_FILESIZE startpos,
                    FX_FILESIZE limit,
@@ -80,7 +85,8 @@ class CPDF_SyntaxParser {
   std::unique_ptr<CPDF_Stream> ReadStream(
       std::unique_ptr<CPDF_Dictionary> pDict,
       uint32_t objnum,
-      uint32_t gennum);
+      uint32_t gennum,
+      CPDF_ObjectArena* pArena);
 
   inline bool CheckPosition(FX_FILESIZE pos) {
     return m_BufOffset >= pos ||
@@ -90,6 +96,9 @@ class CPDF_SyntaxParser {
   FX_FILESIZE m_Pos;
   uint32_t m_MetadataObjnum;
   CFX_RetainPtr<IFX_SeekableReadStream> m_pFileAccess;
+  // The whole file when it is addressable in memory, in which case
+  // |m_pFileBuf| is not used.
+  const uint8_t* m_pMappedData;
   FX_FILESIZE m_HeaderOffset;
   FX_FILESIZE m_FileLen;
   uint8_t* m_pFileBuf;
@@ -7,12 +7,44 @@
 
 #include "core/fpdfapi/parser/cpdf_object.h"
 #include "core/fpdfapi/parser/cpdf_parser.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/parser/cpdf_stream_acc.h"
 #include "core/fpdfapi/parser/cpdf_syntax_parser.h"
 #include "core/fxcrt/fx_ext.h"
 #include "core/fxcrt/fx_stream.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/utils/path_service.h"
 
+namespace {
+
+// Reads test data from a buffer that is exposed as mapped data, the way a
+// memory-mapped file is.
+class CFX_TestMappedRead : public IFX_SeekableReadStream {
+ public:
+  static CFX_RetainPtr<CFX_TestMappedRead> Create(const uint8_t* buffer_in,
+                                                  size_t buf_size) {
+    return CFX_RetainPtr<CFX_TestMappedRead>(
+        new CFX_TestMappedRead(buffer_in, buf_size));
+  }
+
+  // IFX_SeekableReadStream:
+  bool ReadBlock(void* buffer, FX_FILESIZE offset, size_t size) override {
+    ADD_FAILURE() << "Mapped data should be read in place";
+    return false;
+  }
+  FX_FILESIZE GetSize() override { return (FX_FILESIZE)total_size_; }
+  const uint8_t* GetMappedData() override { return buffer_; }
+
+ private:
+  CFX_TestMappedRead(const uint8_t* buffer_in, size_t buf_size)
+      : buffer_(buffer_in), total_size_(buf_size) {}
+
+  const uint8_t* buffer_;
+  size_t total_size_;
+};
+
+}  // namespace
+
 TEST(cpdf_syntax_parser, ReadHexString) {
   {
     // Empty string.
@@ -154,3 +186,38 @@ TEST(cpdf_syntax_parser, GetInvalidReference) {
       parser.GetObject(nullptr, CPDF_Object::kInvalidObjNum, 0, false);
   EXPECT_FALSE(ref);
 }
+
+TEST(cpdf_syntax_parser, MappedFile) {
+  {
+    // Words are read in place, including past the usual buffer size.
+    std::string data(1000, ' ');
+    data += "endobj";
+    CPDF_SyntaxParser parser;
+    parser.InitParser(
+        CFX_TestMappedRead::Create(
+            reinterpret_cast<const uint8_t*>(data.c_str()), data.size()),
+        0);
+    EXPECT_EQ("endobj", parser.GetKeyword());
+    EXPECT_EQ(1006, parser.SavePos());
+    EXPECT_EQ("", parser.GetKeyword());
+  }
+
+  {
+    // Stream data refers to the mapped bytes instead of a copy.
+    const uint8_t data[] =
+        "<</Length 5>>stream\r\nHello\r\nendstream\r\nendobj";
+    CPDF_SyntaxParser parser;
+    parser.InitParser(CFX_TestMappedRead::Create(data, sizeof(data) - 1), 0);
+    std::unique_ptr<CPDF_Object> pObj = parser.GetObject(nullptr, 1, 0, false);
+    ASSERT_TRUE(pObj);
+    CPDF_Stream* pStream = pObj->AsStream();
+    ASSERT_TRUE(pStream);
+    EXPECT_EQ(5u, pStream->GetRawSize());
+    EXPECT_EQ(data + 21, pStream->GetRawData());
+
+    CPDF_StreamAcc acc;
+    acc.LoadAllData(pStream);
+    ASSERT_EQ(5u, acc.GetSize());
+    EXPECT_EQ(0, memcmp("Hello", acc.GetData(), 5));
+  }
+}
@@ -545,21 +545,23 @@ CFX_ByteString PDF_EncodeString(const CFX_ByteString& src, bool bHex) {
 bool FlateEncode(const uint8_t* src_buf,
                  uint32_t src_size,
                  uint8_t** dest_buf,
-                 uint32_t* dest_size) {
+                 uint32_t* dest_size,
+                 int level) {
   CCodec_ModuleMgr* pEncoders = CPDF_ModuleMgr::Get()->GetCodecModule();
   return pEncoders &&
          pEncoders->GetFlateModule()->Encode(src_buf, src_size, dest_buf,
-                                             dest_size);
+                                             dest_size, level);
 }
 
 bool PngEncode(const uint8_t* src_buf,
                uint32_t src_size,
                uint8_t** dest_buf,
-               uint32_t* dest_size) {
+               uint32_t* dest_size,
+               int level) {
   CCodec_ModuleMgr* pEncoders = CPDF_ModuleMgr::Get()->GetCodecModule();
   return pEncoders &&
          pEncoders->GetFlateModule()->PngEncode(src_buf, src_size, dest_buf,
-                                                dest_size);
+                                                dest_size, level);
 }
 
 uint32_t FlateDecode(const uint8_t* src_buf,
@@ -26,10 +26,12 @@ CFX_WideString PDF_DecodeText(const CFX_ByteString& bstr);
 CFX_ByteString PDF_EncodeText(const FX_WCHAR* pString, int len = -1);
 CFX_ByteString PDF_EncodeText(const CFX_WideString& str);
 
+// |level| is a zlib compression level, from 0 to 9, or -1 for the default.
 bool FlateEncode(const uint8_t* src_buf,
                  uint32_t src_size,
                  uint8_t** dest_buf,
-                 uint32_t* dest_size);
+                 uint32_t* dest_size,
+                 int level = -1);
 
 // This used to have more parameters like the predictor and bpc, but there was
 // only one caller, so the interface has been simplified, the values are hard
@@ -37,7 +39,8 @@ bool FlateEncode(const uint8_t* src_buf,
 bool PngEncode(const uint8_t* src_buf,
                uint32_t src_size,
                uint8_t** dest_buf,
-               uint32_t* dest_size);
+               uint32_t* dest_size,
+               int level = -1);
 
 uint32_t FlateDecode(const uint8_t* src_buf,
                      uint32_t src_size,
@@ -86,6 +86,41 @@ TEST_F(FPDFParserDecodeEmbeddertest, FlateDecode) {
   }
 }
 
+TEST_F(FPDFParserDecodeEmbeddertest, FlateDecodeSizeHints) {
+  // Large enough to need several output buffers without a hint.
+  std::string input;
+  for (int i = 0; input.size() < 3 * 1024 * 1024; ++i)
+    input += std::to_string(i * 7919 % 100003) + " 0 obj ";
+
+  unsigned char* encoded = nullptr;
+  unsigned int encoded_size;
+  ASSERT_TRUE(FlateEncode(reinterpret_cast<const uint8_t*>(input.data()),
+                          input.size(), &encoded, &encoded_size));
+
+  // A missing, exact, too small, too large or impossible hint all decode the
+  // same.
+  const uint32_t kHints[] = {0,
+                             static_cast<uint32_t>(input.size()),
+                             1000,
+                             static_cast<uint32_t>(input.size()) * 3,
+                             0xfffffff0};
+  for (uint32_t hint : kHints) {
+    uint8_t* result = nullptr;
+    uint32_t result_size = 0;
+    EXPECT_EQ(encoded_size,
+              FPDFAPI_FlateOrLZWDecode(false, encoded, encoded_size, nullptr,
+                                       hint, result, result_size))
+        << " for hint " << hint;
+    ASSERT_TRUE(result);
+    EXPECT_EQ(input.size(), result_size) << " for hint " << hint;
+    EXPECT_TRUE(input == std::string(reinterpret_cast<const char*>(result),
+                                     result_size))
+        << " for hint " << hint;
+    FX_Free(result);
+  }
+  FX_Free(encoded);
+}
+
 TEST_F(FPDFParserDecodeEmbeddertest, Bug_552046) {
   // Tests specifying multiple image filters for a stream. Should not cause a
   // crash when rendered.
@@ -96,6 +96,37 @@ class JpxBitMapContext {
 
 const int kMaxImageDimension = 0x01FFFF;
 
+// libjpeg scales images down by up to 8 within the inverse DCT.
+const int kMaxJpegReduction = 3;
+
+// Halving the largest images allowed this many times leaves one pixel.
+const int kMaxJpxReduction = 17;
+
+int ReduceDimension(int size, int reduction) {
+  return (size + (1 << reduction) - 1) >> reduction;
+}
+
+// How many times, up to |max_reduction|, a |width| by |height| image can be
+// halved in size and still have a pixel for every device pixel it is drawn
+// on, when drawn |dest_width| by |dest_height|. Without a destination size,
+// the image is needed in full.
+int GetDecodeReduction(int width,
+                       int height,
+                       int dest_width,
+                       int dest_height,
+                       int max_reduction) {
+  if (dest_width <= 0 || dest_height <= 0)
+    return 0;
+
+  int reduction = 0;
+  while (reduction < max_reduction &&
+         ReduceDimension(width, reduction + 1) >= dest_width &&
+         ReduceDimension(height, reduction + 1) >= dest_height) {
+    ++reduction;
+  }
+  return reduction;
+}
+
 }  // namespace
 
 CPDF_DIBSource::CPDF_DIBSource()
@@ -116,6 +147,9 @@ CPDF_DIBSource::CPDF_DIBSource()
       m_bColorKey(false),
       m_bHasMask(false),
       m_bStdCS(false),
+      m_nDownsampleWidth(0),
+      m_nDownsampleHeight(0),
+      m_nReduction(0),
       m_pCompData(nullptr),
       m_pLineBuf(nullptr),
       m_pMaskedLine(nullptr),
@@ -247,7 +281,9 @@ int CPDF_DIBSource::StartLoadDIBSource(CPDF_Document* pDoc,
                                        CPDF_Dictionary* pPageResources,
                                        bool bStdCS,
                                        uint32_t GroupFamily,
-                                       bool bLoadMask) {
+                                       bool bLoadMask,
+                                       int32_t nDownsampleWidth,
+                                       int32_t nDownsampleHeight) {
   if (!pStream) {
     return 0;
   }
@@ -256,6 +292,8 @@ int CPDF_DIBSource::StartLoadDIBSource(CPDF_Document* pDoc,
   m_pStream = pStream;
   m_bStdCS = bStdCS;
   m_bHasMask = bHasMask;
+  m_nDownsampleWidth = nDownsampleWidth;
+  m_nDownsampleHeight = nDownsampleHeight;
   m_Width = m_pDict->GetIntegerFor("Width");
   m_Height = m_pDict->GetIntegerFor("Height");
   if (m_Width <= 0 || m_Height <= 0 || m_Width > kMaxImageDimension ||
@@ -316,6 +354,8 @@ int CPDF_DIBSource::ContinueLoadDIBSource(IFX_Pause* pPause) {
     if (decoder == "JPXDecode") {
       return 0;
     }
+    // The JBIG2 symbol dictionary cache is shared by the whole document.
+    CFX_AutoLock lock(m_pDocument->GetLock());
     CCodec_Jbig2Module* pJbig2Module = CPDF_ModuleMgr::Get()->GetJbig2Module();
     if (!m_pJbig2Context) {
       m_pJbig2Context = pdfium::MakeUnique<CCodec_Jbig2Context>();
@@ -536,9 +576,13 @@ int CPDF_DIBSource::CreateDecoder() {
                      ->CreateRunLengthDecoder(src_data, src_size, m_Width,
                                               m_Height, m_nComponents, m_bpc);
   } else if (decoder == "DCTDecode") {
+    m_nReduction =
+        GetDecodeReduction(m_Width, m_Height, m_nDownsampleWidth,
+                           m_nDownsampleHeight, kMaxJpegReduction);
     m_pDecoder = CPDF_ModuleMgr::Get()->GetJpegModule()->CreateDecoder(
         src_data, src_size, m_Width, m_Height, m_nComponents,
-        !pParams || pParams->GetIntegerFor("ColorTransform", 1));
+        !pParams || pParams->GetIntegerFor("ColorTransform", 1),
+        1 << m_nReduction);
     if (!m_pDecoder) {
       bool bTransform = false;
       int comps;
@@ -590,10 +634,16 @@ int CPDF_DIBSource::CreateDecoder() {
             return 0;
         }
         m_bpc = bpc;
+        m_nReduction =
+            GetDecodeReduction(m_Width, m_Height, m_nDownsampleWidth,
+                               m_nDownsampleHeight, kMaxJpegReduction);
         m_pDecoder = CPDF_ModuleMgr::Get()->GetJpegModule()->CreateDecoder(
-            src_data, src_size, m_Width, m_Height, m_nComponents, bTransform);
+            src_data, src_size, m_Width, m_Height, m_nComponents, bTransform,
+            1 << m_nReduction);
       }
     }
+    m_Width = ReduceDimension(m_Width, m_nReduction);
+    m_Height = ReduceDimension(m_Height, m_nReduction);
   }
   if (!m_pDecoder)
     return 0;
@@ -617,11 +667,22 @@ void CPDF_DIBSource::LoadJpxBitmap() {
     return;
 
   std::unique_ptr<JpxBitMapContext> context(new JpxBitMapContext(pJpxModule));
-  context->set_decoder(pJpxModule->CreateDecoder(
-      m_pStreamAcc->GetData(), m_pStreamAcc->GetSize(), m_pColorSpace));
+  int reduction = GetDecodeReduction(m_Width, m_Height, m_nDownsampleWidth,
+                                     m_nDownsampleHeight, kMaxJpxReduction);
+  context->set_decoder(pJpxModule->CreateDecoder(m_pStreamAcc->GetData(),
+                                                 m_pStreamAcc->GetSize(),
+                                                 m_pColorSpace, reduction));
+  // Tiles may have fewer resolution levels than the codestream header says.
+  if (!context->decoder() && reduction > 0) {
+    context->set_decoder(pJpxModule->CreateDecoder(
+        m_pStreamAcc->GetData(), m_pStreamAcc->GetSize(), m_pColorSpace, 0));
+  }
   if (!context->decoder())
     return;
 
+  m_nReduction = pJpxModule->GetReduction(context->decoder());
+  m_Width = ReduceDimension(m_Width, m_nReduction);
+  m_Height = ReduceDimension(m_Height, m_nReduction);
   uint32_t width = 0;
   uint32_t height = 0;
   uint32_t components = 0;
@@ -58,6 +58,13 @@ class CPDF_DIBSource : public CFX_DIBSource {
 
   uint32_t GetMatteColor() const { return m_MatteColor; }
 
+  // How many times the image was halved in size while decoding it.
+  int GetReduction() const { return m_nReduction; }
+
+  // JPEG and JPEG 2000 images are decoded at a lower resolution when drawn
+  // |nDownsampleWidth| by |nDownsampleHeight| device pixels needs no more.
+  // The size of the DIB is then that of the decoded image, not that in the
+  // image dictionary.
   int StartLoadDIBSource(CPDF_Document* pDoc,
                          const CPDF_Stream* pStream,
                          bool bHasMask,
@@ -65,7 +72,9 @@ class CPDF_DIBSource : public CFX_DIBSource {
                          CPDF_Dictionary* pPageResources,
                          bool bStdCS = false,
                          uint32_t GroupFamily = 0,
-                         bool bLoadMask = false);
+                         bool bLoadMask = false,
+                         int32_t nDownsampleWidth = 0,
+                         int32_t nDownsampleHeight = 0);
   int ContinueLoadDIBSource(IFX_Pause* pPause);
   int StratLoadMask();
   int StartLoadMaskDIB();
@@ -130,6 +139,9 @@ class CPDF_DIBSource : public CFX_DIBSource {
   bool m_bColorKey;
   bool m_bHasMask;
   bool m_bStdCS;
+  int32_t m_nDownsampleWidth;
+  int32_t m_nDownsampleHeight;
+  int m_nReduction;
   DIB_COMP_DATA* m_pCompData;
   uint8_t* m_pLineBuf;
   uint8_t* m_pMaskedLine;
@@ -30,6 +30,7 @@ CPDF_DocRenderData::~CPDF_DocRenderData() {
 }
 
 void CPDF_DocRenderData::Clear(bool bRelease) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   for (auto it = m_Type3FaceMap.begin(); it != m_Type3FaceMap.end();) {
     auto curr_it = it++;
     CPDF_CountedObject<CPDF_Type3Cache>* cache = curr_it->second;
@@ -52,6 +53,7 @@ void CPDF_DocRenderData::Clear(bool bRelease) {
 }
 
 CPDF_Type3Cache* CPDF_DocRenderData::GetCachedType3(CPDF_Type3Font* pFont) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   CPDF_CountedObject<CPDF_Type3Cache>* pCache;
   auto it = m_Type3FaceMap.find(pFont);
   if (it == m_Type3FaceMap.end()) {
@@ -65,6 +67,7 @@ CPDF_Type3Cache* CPDF_DocRenderData::GetCachedType3(CPDF_Type3Font* pFont) {
 }
 
 void CPDF_DocRenderData::ReleaseCachedType3(CPDF_Type3Font* pFont) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   auto it = m_Type3FaceMap.find(pFont);
   if (it != m_Type3FaceMap.end()) {
     it->second->RemoveRef();
@@ -77,6 +80,7 @@ void CPDF_DocRenderData::ReleaseCachedType3(CPDF_Type3Font* pFont) {
 }
 
 CPDF_TransferFunc* CPDF_DocRenderData::GetTransferFunc(CPDF_Object* pObj) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   if (!pObj)
     return nullptr;
 
@@ -143,6 +147,7 @@ CPDF_TransferFunc* CPDF_DocRenderData::GetTransferFunc(CPDF_Object* pObj) {
 }
 
 void CPDF_DocRenderData::ReleaseTransferFunc(CPDF_Object* pObj) {
+  CFX_AutoLock lock(m_pPDFDoc->GetLock());
   auto it = m_TransferFuncMap.find(pObj);
   if (it != m_TransferFuncMap.end()) {
     it->second->RemoveRef();
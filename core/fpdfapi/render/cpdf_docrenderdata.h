@@ -10,6 +10,7 @@
 #include <map>
 
 #include "core/fpdfapi/page/cpdf_countedobject.h"
+#include "core/fpdfapi/render/cpdf_imagecache.h"
 
 class CPDF_Document;
 class CPDF_Font;
@@ -28,6 +29,7 @@ class CPDF_DocRenderData {
   CPDF_TransferFunc* GetTransferFunc(CPDF_Object* pObj);
   void ReleaseTransferFunc(CPDF_Object* pObj);
   void Clear(bool bRelease);
+  CPDF_ImageCache* GetImageCache() { return &m_ImageCache; }
 
  private:
   using CPDF_Type3CacheMap =
@@ -38,6 +40,7 @@ class CPDF_DocRenderData {
   CPDF_Document* m_pPDFDoc;  // Not Owned
   CPDF_Type3CacheMap m_Type3FaceMap;
   CPDF_TransferFuncMap m_TransferFuncMap;
+  CPDF_ImageCache m_ImageCache;
 };
 
 #endif  // CORE_FPDFAPI_RENDER_CPDF_DOCRENDERDATA_H_
@@ -0,0 +1,151 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/render/cpdf_imagecache.h"
+
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+#include "core/fxge/fx_dib.h"
+
+bool CPDF_ImageCache::Key::operator<(const Key& that) const {
+  return std::tie(objnum, generation, bStdCS, GroupFamily, bLoadMask) <
+         std::tie(that.objnum, that.generation, that.bStdCS, that.GroupFamily,
+                  that.bLoadMask);
+}
+
+CPDF_ImageCache::Image::Image() : MatteColor(0), bReduced(false) {}
+
+CPDF_ImageCache::Image::Image(Image&& that) = default;
+
+CPDF_ImageCache::Image::~Image() {}
+
+CPDF_ImageCache::Image& CPDF_ImageCache::Image::operator=(Image&& that) =
+    default;
+
+CPDF_ImageCache::CPDF_ImageCache()
+    : m_nBytes(0),
+      m_nMaxBytes(0),
+      m_nHits(0),
+      m_nMisses(0),
+      m_nEvictions(0) {}
+
+CPDF_ImageCache::~CPDF_ImageCache() {}
+
+void CPDF_ImageCache::SetMaxBytes(uint32_t nMaxBytes) {
+  std::vector<Image> dropped;
+  CFX_AutoLock lock(&m_Lock);
+  m_nMaxBytes = nMaxBytes;
+  TrimLocked(0, &dropped);
+}
+
+CPDF_ImageCache::Stats CPDF_ImageCache::GetStats() const {
+  CFX_AutoLock lock(&m_Lock);
+  Stats stats;
+  stats.nHits = m_nHits;
+  stats.nMisses = m_nMisses;
+  stats.nEvictions = m_nEvictions;
+  stats.nImages = m_Index.size();
+  stats.nBytes = m_nBytes;
+  stats.nMaxBytes = m_nMaxBytes;
+  return stats;
+}
+
+bool CPDF_ImageCache::IsEnabled() const {
+  CFX_AutoLock lock(&m_Lock);
+  return m_nMaxBytes > 0;
+}
+
+uint32_t CPDF_ImageCache::GetGeneration(uint32_t objnum) const {
+  CFX_AutoLock lock(&m_Lock);
+  return GetGenerationLocked(objnum);
+}
+
+bool CPDF_ImageCache::Take(const Key& key, Image* pImage) {
+  return TakeIf(key, [](const Image&) { return true; }, pImage);
+}
+
+bool CPDF_ImageCache::TakeIf(const Key& key,
+                             const std::function<bool(const Image&)>& accept,
+                             Image* pImage) {
+  std::vector<Image> dropped;
+  CFX_AutoLock lock(&m_Lock);
+  if (!m_nMaxBytes)
+    return false;
+
+  auto it = key.generation == GetGenerationLocked(key.objnum)
+                ? m_Index.find(key)
+                : m_Index.end();
+  if (it == m_Index.end()) {
+    ++m_nMisses;
+    return false;
+  }
+  if (!accept(it->second->image)) {
+    ++m_nMisses;
+    EraseLocked(it->second, &dropped);
+    return false;
+  }
+  ++m_nHits;
+  EntryList::iterator entry_it = it->second;
+  *pImage = std::move(entry_it->image);
+  m_nBytes -= entry_it->nBytes;
+  m_Index.erase(it);
+  m_Entries.erase(entry_it);
+  return true;
+}
+
+void CPDF_ImageCache::Put(const Key& key, Image image, uint32_t nBytes) {
+  std::vector<Image> dropped;
+  CFX_AutoLock lock(&m_Lock);
+  // Pages that drew the image at the same time each loaded their own.
+  if (nBytes > m_nMaxBytes || m_Index.count(key) ||
+      key.generation != GetGenerationLocked(key.objnum)) {
+    dropped.push_back(std::move(image));
+    return;
+  }
+  TrimLocked(nBytes, &dropped);
+  m_Entries.push_front({key, std::move(image), nBytes});
+  m_Index[key] = m_Entries.begin();
+  m_nBytes += nBytes;
+}
+
+void CPDF_ImageCache::Invalidate(uint32_t objnum) {
+  std::vector<Image> dropped;
+  CFX_AutoLock lock(&m_Lock);
+  ++m_Generations[objnum];
+  auto it = m_Index.lower_bound({objnum, 0, false, 0, false});
+  while (it != m_Index.end() && it->first.objnum == objnum) {
+    auto curr_it = it++;
+    EraseLocked(curr_it->second, &dropped);
+  }
+}
+
+void CPDF_ImageCache::Clear() {
+  std::vector<Image> dropped;
+  CFX_AutoLock lock(&m_Lock);
+  while (!m_Entries.empty())
+    EraseLocked(m_Entries.begin(), &dropped);
+}
+
+void CPDF_ImageCache::EraseLocked(EntryList::iterator it,
+                                  std::vector<Image>* pDropped) {
+  pDropped->push_back(std::move(it->image));
+  m_nBytes -= it->nBytes;
+  m_Index.erase(it->key);
+  m_Entries.erase(it);
+}
+
+void CPDF_ImageCache::TrimLocked(uint32_t nReserve,
+                                 std::vector<Image>* pDropped) {
+  while (m_nBytes > m_nMaxBytes - nReserve) {
+    EraseLocked(std::prev(m_Entries.end()), pDropped);
+    ++m_nEvictions;
+  }
+}
+
+uint32_t CPDF_ImageCache::GetGenerationLocked(uint32_t objnum) const {
+  auto it = m_Generations.find(objnum);
+  return it != m_Generations.end() ? it->second : 0;
+}
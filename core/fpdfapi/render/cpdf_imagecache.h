@@ -0,0 +1,126 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFAPI_RENDER_CPDF_IMAGECACHE_H_
+#define CORE_FPDFAPI_RENDER_CPDF_IMAGECACHE_H_
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "core/fxcrt/cfx_mutex.h"
+#include "core/fxcrt/fx_system.h"
+
+class CFX_DIBSource;
+
+// Document-wide cache of loaded images, so that an image drawn on many pages
+// is loaded and decoded once rather than once for every CPDF_PageRenderCache.
+//
+// A loaded image cannot be drawn by two renderers at once, so the cache only
+// holds images that no page is using: a page takes an image out when it
+// first draws it and puts it back when it lets go of it. The least recently
+// used images are evicted to keep the total size within a byte budget. The
+// budget starts at 0, which disables the cache.
+class CPDF_ImageCache {
+ public:
+  // What an image loads to depends on its stream and on how it is loaded.
+  struct Key {
+    bool operator<(const Key& that) const;
+
+    uint32_t objnum;
+    // From GetGeneration(), so that keys made before the image was replaced
+    // no longer match.
+    uint32_t generation;
+    bool bStdCS;
+    uint32_t GroupFamily;
+    bool bLoadMask;
+  };
+
+  struct Image {
+    Image();
+    Image(Image&& that);
+    ~Image();
+    Image& operator=(Image&& that);
+
+    std::unique_ptr<CFX_DIBSource> pBitmap;
+    std::unique_ptr<CFX_DIBSource> pMask;
+    uint32_t MatteColor;
+    // Whether the image was decoded at a lower resolution, as it was drawn
+    // small. Drawing it larger means decoding it again.
+    bool bReduced;
+  };
+
+  struct Stats {
+    uint32_t nHits;
+    uint32_t nMisses;
+    uint32_t nEvictions;
+    uint32_t nImages;
+    uint32_t nBytes;
+    uint32_t nMaxBytes;
+  };
+
+  CPDF_ImageCache();
+  ~CPDF_ImageCache();
+
+  void SetMaxBytes(uint32_t nMaxBytes);
+  Stats GetStats() const;
+  bool IsEnabled() const;
+
+  // Counts how many times the image in object |objnum| was invalidated.
+  uint32_t GetGeneration(uint32_t objnum) const;
+
+  // Moves the image out of the cache into |pImage| and counts a hit, or
+  // counts a miss and returns false, as it does for a key of an earlier
+  // generation. Nothing is counted while disabled.
+  bool Take(const Key& key, Image* pImage);
+
+  // As Take(), but only for an image that |accept| returns true for. An
+  // image it rejects is dropped and counted as a miss, as the caller is
+  // going to load the image again.
+  bool TakeIf(const Key& key,
+              const std::function<bool(const Image&)>& accept,
+              Image* pImage);
+
+  // Stores an image no longer in use. It is dropped if it is larger than
+  // the budget, if the cache already holds the same image or if the image
+  // was invalidated since |key| was made.
+  void Put(const Key& key, Image image, uint32_t nBytes);
+
+  // Drops every variant of the image in object |objnum|, as it was replaced,
+  // and moves it to the next generation so that pages still holding the old
+  // one cannot put it back.
+  void Invalidate(uint32_t objnum);
+
+  // Drops every image, without changing the budget.
+  void Clear();
+
+ private:
+  struct Entry {
+    Key key;
+    Image image;
+    uint32_t nBytes;
+  };
+  using EntryList = std::list<Entry>;
+
+  // The lock is not held when images are destroyed, as that takes the
+  // document lock; erased images are moved to |pDropped| instead.
+  void EraseLocked(EntryList::iterator it, std::vector<Image>* pDropped);
+  // Evicts images until |nReserve| more bytes fit within the budget.
+  void TrimLocked(uint32_t nReserve, std::vector<Image>* pDropped);
+  uint32_t GetGenerationLocked(uint32_t objnum) const;
+
+  mutable CFX_Mutex m_Lock;
+  EntryList m_Entries;  // Most recently used first.
+  std::map<Key, EntryList::iterator> m_Index;
+  std::map<uint32_t, uint32_t> m_Generations;  // Objects invalidated so far.
+  uint32_t m_nBytes;
+  uint32_t m_nMaxBytes;
+  uint32_t m_nHits;
+  uint32_t m_nMisses;
+  uint32_t m_nEvictions;
+};
+
+#endif  // CORE_FPDFAPI_RENDER_CPDF_IMAGECACHE_H_
@@ -0,0 +1,225 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/render/cpdf_imagecache.h"
+
+#include <memory>
+#include <utility>
+
+#include "core/fpdfapi/page/cpdf_colorspace.h"
+#include "core/fxge/fx_dib.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+CPDF_ImageCache::Image MakeImage(uint32_t color) {
+  auto pBitmap = pdfium::MakeUnique<CFX_DIBitmap>();
+  pBitmap->Create(2, 2, FXDIB_Argb);
+  pBitmap->Clear(color);
+  CPDF_ImageCache::Image image;
+  image.pBitmap = std::move(pBitmap);
+  return image;
+}
+
+uint32_t GetPixel(const CPDF_ImageCache::Image& image, int x, int y) {
+  return static_cast<CFX_DIBitmap*>(image.pBitmap.get())->GetPixel(x, y);
+}
+
+CPDF_ImageCache::Key MakeKey(uint32_t objnum) {
+  return {objnum, 0, false, 0, false};
+}
+
+}  // namespace
+
+TEST(cpdf_imagecache, DisabledByDefault) {
+  CPDF_ImageCache cache;
+  EXPECT_FALSE(cache.IsEnabled());
+  cache.Put(MakeKey(1), MakeImage(0xff00ff00), 4);
+
+  CPDF_ImageCache::Image image;
+  EXPECT_FALSE(cache.Take(MakeKey(1), &image));
+  EXPECT_FALSE(image.pBitmap);
+
+  CPDF_ImageCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(0u, stats.nHits);
+  EXPECT_EQ(0u, stats.nMisses);
+  EXPECT_EQ(0u, stats.nImages);
+  EXPECT_EQ(0u, stats.nMaxBytes);
+}
+
+TEST(cpdf_imagecache, TakeAndPut) {
+  CPDF_ImageCache cache;
+  cache.SetMaxBytes(1000);
+  EXPECT_TRUE(cache.IsEnabled());
+
+  CPDF_ImageCache::Image image;
+  EXPECT_FALSE(cache.Take(MakeKey(1), &image));
+
+  CPDF_ImageCache::Image cached = MakeImage(0xff112233);
+  cached.pMask = pdfium::MakeUnique<CFX_DIBitmap>();
+  cached.MatteColor = 0x123;
+  cache.Put(MakeKey(1), std::move(cached), 16);
+  EXPECT_EQ(1u, cache.GetStats().nImages);
+  EXPECT_EQ(16u, cache.GetStats().nBytes);
+
+  ASSERT_TRUE(cache.Take(MakeKey(1), &image));
+  ASSERT_TRUE(image.pBitmap);
+  EXPECT_EQ(0xff112233, GetPixel(image, 1, 1));
+  EXPECT_TRUE(image.pMask);
+  EXPECT_EQ(0x123u, image.MatteColor);
+
+  // The image is checked out until it is put back.
+  CPDF_ImageCache::Image other;
+  EXPECT_FALSE(cache.Take(MakeKey(1), &other));
+  EXPECT_EQ(0u, cache.GetStats().nImages);
+  EXPECT_EQ(0u, cache.GetStats().nBytes);
+  cache.Put(MakeKey(1), std::move(image), 16);
+
+  // Loading the same stream differently is a different image.
+  CPDF_ImageCache::Key key = MakeKey(1);
+  key.bLoadMask = true;
+  EXPECT_FALSE(cache.Take(key, &other));
+  key = MakeKey(1);
+  key.GroupFamily = PDFCS_DEVICECMYK;
+  EXPECT_FALSE(cache.Take(key, &other));
+
+  CPDF_ImageCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(1u, stats.nHits);
+  EXPECT_EQ(4u, stats.nMisses);
+  EXPECT_EQ(0u, stats.nEvictions);
+  EXPECT_EQ(1u, stats.nImages);
+  EXPECT_EQ(16u, stats.nBytes);
+  EXPECT_EQ(1000u, stats.nMaxBytes);
+}
+
+TEST(cpdf_imagecache, RejectedImageIsAMiss) {
+  CPDF_ImageCache cache;
+  cache.SetMaxBytes(1000);
+  cache.Put(MakeKey(1), MakeImage(0xff112233), 16);
+
+  // The caller loads a rejected image again, so it is not a hit.
+  CPDF_ImageCache::Image image;
+  EXPECT_FALSE(cache.TakeIf(
+      MakeKey(1), [](const CPDF_ImageCache::Image&) { return false; },
+      &image));
+  EXPECT_FALSE(image.pBitmap);
+
+  CPDF_ImageCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(0u, stats.nHits);
+  EXPECT_EQ(1u, stats.nMisses);
+  EXPECT_EQ(0u, stats.nImages);
+  EXPECT_EQ(0u, stats.nBytes);
+}
+
+TEST(cpdf_imagecache, KeepsFirstCopy) {
+  CPDF_ImageCache cache;
+  cache.SetMaxBytes(1000);
+  cache.Put(MakeKey(1), MakeImage(0xff000001), 16);
+  cache.Put(MakeKey(1), MakeImage(0xff000002), 16);
+  EXPECT_EQ(1u, cache.GetStats().nImages);
+  EXPECT_EQ(16u, cache.GetStats().nBytes);
+
+  CPDF_ImageCache::Image image;
+  ASSERT_TRUE(cache.Take(MakeKey(1), &image));
+  EXPECT_EQ(0xff000001, GetPixel(image, 0, 0));
+}
+
+TEST(cpdf_imagecache, EvictsLeastRecentlyUsed) {
+  CPDF_ImageCache cache;
+  cache.SetMaxBytes(300);
+  cache.Put(MakeKey(1), MakeImage(0xff000001), 100);
+  cache.Put(MakeKey(2), MakeImage(0xff000002), 100);
+  cache.Put(MakeKey(3), MakeImage(0xff000003), 100);
+
+  CPDF_ImageCache::Image image;
+  ASSERT_TRUE(cache.Take(MakeKey(1), &image));
+  cache.Put(MakeKey(1), std::move(image), 100);
+
+  // 2 is now the least recently used.
+  cache.Put(MakeKey(4), MakeImage(0xff000004), 100);
+  CPDF_ImageCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(1u, stats.nEvictions);
+  EXPECT_EQ(3u, stats.nImages);
+  EXPECT_EQ(300u, stats.nBytes);
+  EXPECT_FALSE(cache.Take(MakeKey(2), &image));
+
+  // Too large to ever fit.
+  cache.Put(MakeKey(5), MakeImage(0xff000005), 301);
+  EXPECT_FALSE(cache.Take(MakeKey(5), &image));
+  EXPECT_EQ(1u, cache.GetStats().nEvictions);
+
+  // Shrinking the budget evicts 3, the least recently used.
+  cache.SetMaxBytes(250);
+  stats = cache.GetStats();
+  EXPECT_EQ(2u, stats.nEvictions);
+  EXPECT_EQ(2u, stats.nImages);
+  EXPECT_EQ(200u, stats.nBytes);
+  EXPECT_FALSE(cache.Take(MakeKey(3), &image));
+  EXPECT_TRUE(cache.Take(MakeKey(4), &image));
+
+  cache.SetMaxBytes(0);
+  EXPECT_EQ(0u, cache.GetStats().nImages);
+  EXPECT_EQ(0u, cache.GetStats().nBytes);
+}
+
+TEST(cpdf_imagecache, Invalidate) {
+  CPDF_ImageCache cache;
+  cache.SetMaxBytes(1000);
+  CPDF_ImageCache::Key key = MakeKey(7);
+  cache.Put(key, MakeImage(0xff000007), 10);
+  key.bStdCS = true;
+  cache.Put(key, MakeImage(0xff000007), 10);
+  cache.Put(MakeKey(6), MakeImage(0xff000006), 10);
+  cache.Put(MakeKey(8), MakeImage(0xff000008), 10);
+
+  cache.Invalidate(7);
+  EXPECT_EQ(2u, cache.GetStats().nImages);
+  EXPECT_EQ(20u, cache.GetStats().nBytes);
+  EXPECT_EQ(0u, cache.GetStats().nEvictions);
+
+  CPDF_ImageCache::Image image;
+  EXPECT_FALSE(cache.Take(MakeKey(7), &image));
+  EXPECT_FALSE(cache.Take(key, &image));
+  EXPECT_TRUE(cache.Take(MakeKey(6), &image));
+  EXPECT_TRUE(cache.Take(MakeKey(8), &image));
+}
+
+TEST(cpdf_imagecache, InvalidateRejectsStaleImages) {
+  CPDF_ImageCache cache;
+  cache.SetMaxBytes(1000);
+  CPDF_ImageCache::Key old_key = MakeKey(7);
+  EXPECT_EQ(0u, cache.GetGeneration(7));
+
+  // A page still draws the old image when it is replaced.
+  cache.Invalidate(7);
+  EXPECT_EQ(1u, cache.GetGeneration(7));
+  EXPECT_EQ(0u, cache.GetGeneration(8));
+  cache.Put(old_key, MakeImage(0xff000001), 10);
+  EXPECT_EQ(0u, cache.GetStats().nImages);
+
+  CPDF_ImageCache::Key new_key = old_key;
+  new_key.generation = cache.GetGeneration(7);
+  cache.Put(new_key, MakeImage(0xff000002), 10);
+  EXPECT_EQ(1u, cache.GetStats().nImages);
+
+  CPDF_ImageCache::Image image;
+  EXPECT_FALSE(cache.Take(old_key, &image));
+  ASSERT_TRUE(cache.Take(new_key, &image));
+  EXPECT_EQ(0xff000002, GetPixel(image, 0, 0));
+}
+
+TEST(cpdf_imagecache, Clear) {
+  CPDF_ImageCache cache;
+  cache.SetMaxBytes(1000);
+  cache.Put(MakeKey(1), MakeImage(0xff000001), 10);
+  cache.Put(MakeKey(2), MakeImage(0xff000002), 10);
+  cache.Clear();
+
+  CPDF_ImageCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(0u, stats.nImages);
+  EXPECT_EQ(0u, stats.nBytes);
+  EXPECT_EQ(0u, stats.nEvictions);
+  EXPECT_EQ(1000u, stats.nMaxBytes);
+}
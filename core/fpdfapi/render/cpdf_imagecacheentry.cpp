@@ -10,13 +10,63 @@
 #include <utility>
 
 #include "core/fpdfapi/page/cpdf_page.h"
+#include "core/fpdfapi/parser/cpdf_array.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/parser/cpdf_stream.h"
 #include "core/fpdfapi/render/cpdf_dibsource.h"
+#include "core/fpdfapi/render/cpdf_docrenderdata.h"
 #include "core/fpdfapi/render/cpdf_pagerendercache.h"
 #include "core/fpdfapi/render/cpdf_rendercontext.h"
 #include "core/fpdfapi/render/cpdf_renderstatus.h"
+#include "core/fxcrt/fx_safe_types.h"
+
+namespace {
+
+bool HasColorSpaces(const CPDF_Dictionary* pResources) {
+  return pResources && pResources->GetDictFor("ColorSpace");
+}
+
+// Whether the image in |pStream| loads the same on every page that draws it.
+// A color space given by name may be looked up in, or replaced by a default
+// from, the resources it is drawn with.
+bool IsSharable(const CPDF_Stream* pStream,
+                const CPDF_Dictionary* pFormResources,
+                const CPDF_Dictionary* pPageResources) {
+  if (pStream->IsInline() || !pStream->GetObjNum())
+    return false;
+
+  CPDF_Object* pCSObj = pStream->GetDict()->GetDirectObjectFor("ColorSpace");
+  if (!pCSObj)
+    return true;
+
+  CPDF_Array* pArray = pCSObj->AsArray();
+  if (pArray && pArray->GetCount() > 1)
+    return true;
+
+  return !HasColorSpaces(pFormResources) && !HasColorSpaces(pPageResources);
+}
+
+// The memory the image takes once decoded in full, whether or not it is yet.
+FX_SAFE_UINT32 EstimateDecodedSize(const CFX_DIBSource* pDIB) {
+  FX_SAFE_UINT32 nBytes = pDIB->GetHeight();
+  nBytes *= pDIB->GetPitch();
+  return nBytes;
+}
+
+// Whether |pDIB|, which was decoded at a lower resolution if |bReduced|,
+// has fewer pixels than drawing it |width| by |height| device pixels uses.
+bool NeedsHigherResolution(const CFX_DIBSource* pDIB,
+                           bool bReduced,
+                           int32_t width,
+                           int32_t height) {
+  if (!bReduced)
+    return false;
+  return width <= 0 || height <= 0 || width > pDIB->GetWidth() ||
+         height > pDIB->GetHeight();
+}
+
+}  // namespace
 
 CPDF_ImageCacheEntry::CPDF_ImageCacheEntry(CPDF_Document* pDoc,
                                            CPDF_Stream* pStream)
@@ -27,12 +77,32 @@ CPDF_ImageCacheEntry::CPDF_ImageCacheEntry(CPDF_Document* pDoc,
       m_pStream(pStream),
       m_pCurBitmap(nullptr),
       m_pCurMask(nullptr),
+      m_bReduced(false),
+      m_pDocImageCache(nullptr),
       m_dwCacheSize(0) {}
 
-CPDF_ImageCacheEntry::~CPDF_ImageCacheEntry() {}
+CPDF_ImageCacheEntry::~CPDF_ImageCacheEntry() {
+  if (!m_pDocImageCache || !m_pCachedBitmap)
+    return;
+
+  FX_SAFE_UINT32 nBytes = EstimateDecodedSize(m_pCachedBitmap.get());
+  if (m_pCachedMask)
+    nBytes = nBytes + EstimateDecodedSize(m_pCachedMask.get());
+  if (!nBytes.IsValid())
+    return;
+
+  CPDF_ImageCache::Image image;
+  image.pBitmap = std::move(m_pCachedBitmap);
+  image.pMask = std::move(m_pCachedMask);
+  image.MatteColor = m_MatteColor;
+  image.bReduced = m_bReduced;
+  m_pDocImageCache->Put(m_DocImageKey, std::move(image), nBytes.ValueOrDie());
+}
 
 void CPDF_ImageCacheEntry::Reset(const CFX_DIBitmap* pBitmap) {
   m_pCachedBitmap.reset();
+  m_bReduced = false;
+  m_pDocImageCache = nullptr;
   if (pBitmap)
     m_pCachedBitmap = pBitmap->Clone();
   CalcSize();
@@ -66,19 +136,54 @@ int CPDF_ImageCacheEntry::StartGetCachedBitmap(CPDF_Dictionary* pFormResources,
                                                int32_t downsampleWidth,
                                                int32_t downsampleHeight) {
   if (m_pCachedBitmap) {
-    m_pCurBitmap = m_pCachedBitmap.get();
-    m_pCurMask = m_pCachedMask.get();
-    return 1;
+    if (!NeedsHigherResolution(m_pCachedBitmap.get(), m_bReduced,
+                               downsampleWidth, downsampleHeight)) {
+      m_pCurBitmap = m_pCachedBitmap.get();
+      m_pCurMask = m_pCachedMask.get();
+      return 1;
+    }
+    // Decode the image again, now that it is drawn larger.
+    m_pCachedBitmap.reset();
+    m_pCachedMask.reset();
+    m_bReduced = false;
+    CalcSize();
   }
   if (!pRenderStatus)
     return 0;
 
   m_pRenderStatus = pRenderStatus;
+  m_pDocImageCache = nullptr;
+  if (IsSharable(m_pStream, pFormResources, pPageResources)) {
+    m_pDocImageCache = m_pDocument->GetRenderData()->GetImageCache();
+    uint32_t objnum = m_pStream->GetObjNum();
+    m_DocImageKey = {objnum, m_pDocImageCache->GetGeneration(objnum), bStdCS,
+                     GroupFamily, bLoadMask};
+    // An image decoded for a smaller size is dropped and decoded again.
+    auto accept = [downsampleWidth,
+                   downsampleHeight](const CPDF_ImageCache::Image& image) {
+      return !NeedsHigherResolution(image.pBitmap.get(), image.bReduced,
+                                    downsampleWidth, downsampleHeight);
+    };
+    CPDF_ImageCache::Image image;
+    if (m_pDocImageCache->TakeIf(m_DocImageKey, accept, &image)) {
+      m_pCachedBitmap = std::move(image.pBitmap);
+      m_pCachedMask = std::move(image.pMask);
+      m_MatteColor = image.MatteColor;
+      m_bReduced = image.bReduced;
+      m_pCurBitmap = m_pCachedBitmap.get();
+      m_pCurMask = m_pCachedMask.get();
+      m_dwTimeCount =
+          pRenderStatus->GetContext()->GetPageCache()->GetTimeCount();
+      CalcSize();
+      return 0;
+    }
+  }
   m_pCurBitmap = new CPDF_DIBSource;
-  int ret =
-      ((CPDF_DIBSource*)m_pCurBitmap)
-          ->StartLoadDIBSource(m_pDocument, m_pStream, true, pFormResources,
-                               pPageResources, bStdCS, GroupFamily, bLoadMask);
+  int ret = ((CPDF_DIBSource*)m_pCurBitmap)
+                ->StartLoadDIBSource(m_pDocument, m_pStream, true,
+                                     pFormResources, pPageResources, bStdCS,
+                                     GroupFamily, bLoadMask, downsampleWidth,
+                                     downsampleHeight);
   if (ret == 2)
     return ret;
 
@@ -93,6 +198,7 @@ int CPDF_ImageCacheEntry::StartGetCachedBitmap(CPDF_Dictionary* pFormResources,
 
 void CPDF_ImageCacheEntry::ContinueGetCachedBitmap() {
   m_MatteColor = ((CPDF_DIBSource*)m_pCurBitmap)->GetMatteColor();
+  m_bReduced = ((CPDF_DIBSource*)m_pCurBitmap)->GetReduction() > 0;
   m_pCurMask = ((CPDF_DIBSource*)m_pCurBitmap)->DetachMask();
   CPDF_RenderContext* pContext = m_pRenderStatus->GetContext();
   CPDF_PageRenderCache* pPageRenderCache = pContext->GetPageCache();
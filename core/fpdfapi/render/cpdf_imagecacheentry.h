@@ -9,6 +9,7 @@
 
 #include <memory>
 
+#include "core/fpdfapi/render/cpdf_imagecache.h"
 #include "core/fxcrt/fx_system.h"
 
 class CFX_DIBitmap;
@@ -55,6 +56,13 @@ class CPDF_ImageCacheEntry {
   CFX_DIBSource* m_pCurMask;
   std::unique_ptr<CFX_DIBSource> m_pCachedBitmap;
   std::unique_ptr<CFX_DIBSource> m_pCachedMask;
+  // Whether the cached image was decoded at a lower resolution, for the size
+  // it was drawn at.
+  bool m_bReduced;
+  // Where the cached image goes back to when this entry is destroyed, if it
+  // may be shared with other pages.
+  CPDF_ImageCache* m_pDocImageCache;
+  CPDF_ImageCache::Key m_DocImageKey;
   uint32_t m_dwCacheSize;
 };
 
@@ -35,6 +35,19 @@
 #include "core/fxge/skia/fx_skia_device.h"
 #endif
 
+namespace {
+
+// The number of device pixels an image axis |unit| long on the device
+// covers, or 0 if there are too many to count.
+int GetDrawnPixels(FX_FLOAT unit) {
+  FX_FLOAT pixels = FXSYS_ceil(unit);
+  return pdfium::base::IsValueInRangeForNumericType<int>(pixels)
+             ? static_cast<int>(pixels)
+             : 0;
+}
+
+}  // namespace
+
 CPDF_ImageRenderer::CPDF_ImageRenderer() {
   m_pRenderStatus = nullptr;
   m_pImageObject = nullptr;
@@ -59,10 +72,10 @@ bool CPDF_ImageRenderer::StartLoadDIBSource() {
   if (!image_rect.Valid())
     return false;
 
-  int dest_width =
-      m_ImageMatrix.a >= 0 ? image_rect.Width() : -image_rect.Width();
-  int dest_height =
-      m_ImageMatrix.d <= 0 ? image_rect.Height() : -image_rect.Height();
+  // Measured along the axes of the image, which need not be those of the
+  // device, so that rotated images are not decoded at too low a resolution.
+  int dest_width = GetDrawnPixels(m_ImageMatrix.GetXUnit());
+  int dest_height = GetDrawnPixels(m_ImageMatrix.GetYUnit());
   if (m_Loader.Start(
           m_pImageObject, m_pRenderStatus->m_pContext->GetPageCache(), m_bStdCS,
           m_pRenderStatus->m_GroupFamily, m_pRenderStatus->m_bLoadMask,
@@ -7,6 +7,9 @@
 #include "core/fpdfapi/render/cpdf_pagerendercache.h"
 
 #include "core/fpdfapi/page/cpdf_page.h"
+#include "core/fpdfapi/parser/cpdf_document.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/render/cpdf_docrenderdata.h"
 #include "core/fpdfapi/render/cpdf_imagecacheentry.h"
 #include "core/fpdfapi/render/cpdf_renderstatus.h"
 
@@ -91,6 +94,8 @@ bool CPDF_PageRenderCache::StartGetCachedBitmap(
   m_bCurFindCache = it != m_ImageCache.end();
   if (m_bCurFindCache) {
     m_pCurImageCacheEntry = it->second;
+    // The entry decodes the image again if it is now drawn larger.
+    m_nCacheSize -= m_pCurImageCacheEntry->EstimateSize();
   } else {
     m_pCurImageCacheEntry =
         new CPDF_ImageCacheEntry(m_pPage->m_pDocument, pStream);
@@ -105,9 +110,7 @@ bool CPDF_PageRenderCache::StartGetCachedBitmap(
   if (!m_bCurFindCache)
     m_ImageCache[pStream] = m_pCurImageCacheEntry;
 
-  if (!ret)
-    m_nCacheSize += m_pCurImageCacheEntry->EstimateSize();
-
+  m_nCacheSize += m_pCurImageCacheEntry->EstimateSize();
   return false;
 }
 
@@ -126,6 +129,10 @@ bool CPDF_PageRenderCache::Continue(IFX_Pause* pPause) {
 
 void CPDF_PageRenderCache::ResetBitmap(CPDF_Stream* pStream,
                                        const CFX_DIBitmap* pBitmap) {
+  if (pStream && pStream->GetObjNum()) {
+    m_pPage->m_pDocument->GetRenderData()->GetImageCache()->Invalidate(
+        pStream->GetObjNum());
+  }
   CPDF_ImageCacheEntry* pEntry;
   const auto it = m_ImageCache.find(pStream);
   if (it == m_ImageCache.end()) {
@@ -8,6 +8,7 @@
 
 #include "core/fpdfapi/page/cpdf_pageobject.h"
 #include "core/fpdfapi/page/cpdf_pageobjectholder.h"
+#include "core/fpdfapi/page/cpdf_pageobjectindex.h"
 #include "core/fpdfapi/render/cpdf_pagerendercache.h"
 #include "core/fpdfapi/render/cpdf_renderoptions.h"
 #include "core/fpdfapi/render/cpdf_renderstatus.h"
@@ -23,7 +24,8 @@ CPDF_ProgressiveRenderer::CPDF_ProgressiveRenderer(
       m_pDevice(pDevice),
       m_pOptions(pOptions),
       m_LayerIndex(0),
-      m_pCurrentLayer(nullptr) {}
+      m_pCurrentLayer(nullptr),
+      m_NextIndexedObject(0) {}
 
 CPDF_ProgressiveRenderer::~CPDF_ProgressiveRenderer() {
   if (m_pRenderStatus)
@@ -58,6 +60,33 @@ void CPDF_ProgressiveRenderer::Continue(IFX_Pause* pPause) {
       CFX_Matrix device2object;
       device2object.SetReverse(m_pCurrentLayer->m_Matrix);
       device2object.TransformRect(m_ClipRect);
+      if (m_pCurrentLayer->m_pIndex) {
+        m_IndexedObjects = m_pCurrentLayer->m_pIndex->Query(m_ClipRect);
+        m_NextIndexedObject = 0;
+      }
+    }
+    if (m_pCurrentLayer->m_pIndex) {
+      int nObjsToGo = kStepLimit;
+      while (m_NextIndexedObject < m_IndexedObjects.size()) {
+        if (RenderObject(m_IndexedObjects[m_NextIndexedObject], pPause,
+                         &nObjsToGo)) {
+          return;
+        }
+        ++m_NextIndexedObject;
+        if (nObjsToGo == 0) {
+          if (pPause && pPause->NeedToPauseNow())
+            return;
+          nObjsToGo = kStepLimit;
+        }
+      }
+      m_IndexedObjects.clear();
+      m_pRenderStatus.reset();
+      m_pDevice->RestoreState(false);
+      m_pCurrentLayer = nullptr;
+      m_LayerIndex++;
+      if (pPause && pPause->NeedToPauseNow())
+        return;
+      continue;
     }
     CPDF_PageObjectList::iterator iter;
     CPDF_PageObjectList::iterator iterEnd =
@@ -75,19 +104,8 @@ void CPDF_ProgressiveRenderer::Continue(IFX_Pause* pPause) {
           pCurObj->m_Right >= m_ClipRect.left &&
           pCurObj->m_Bottom <= m_ClipRect.top &&
           pCurObj->m_Top >= m_ClipRect.bottom) {
-        if (m_pRenderStatus->ContinueSingleObject(
-                pCurObj, &m_pCurrentLayer->m_Matrix, pPause)) {
+        if (RenderObject(pCurObj, pPause, &nObjsToGo))
           return;
-        }
-        if (pCurObj->IsImage() &&
-            m_pRenderStatus->m_Options.m_Flags & RENDER_LIMITEDIMAGECACHE) {
-          m_pContext->GetPageCache()->CacheOptimization(
-              m_pRenderStatus->m_Options.m_dwLimitCacheSize);
-        }
-        if (pCurObj->IsForm() || pCurObj->IsShading())
-          nObjsToGo = 0;
-        else
-          --nObjsToGo;
       }
       m_LastObjectRendered = iter;
       if (nObjsToGo == 0) {
@@ -112,3 +130,22 @@ void CPDF_ProgressiveRenderer::Continue(IFX_Pause* pPause) {
     }
   }
 }
+
+bool CPDF_ProgressiveRenderer::RenderObject(CPDF_PageObject* pObj,
+                                            IFX_Pause* pPause,
+                                            int* pObjsToGo) {
+  if (m_pRenderStatus->ContinueSingleObject(pObj, &m_pCurrentLayer->m_Matrix,
+                                            pPause)) {
+    return true;
+  }
+  if (pObj->IsImage() &&
+      m_pRenderStatus->m_Options.m_Flags & RENDER_LIMITEDIMAGECACHE) {
+    m_pContext->GetPageCache()->CacheOptimization(
+        m_pRenderStatus->m_Options.m_dwLimitCacheSize);
+  }
+  if (pObj->IsForm() || pObj->IsShading())
+    *pObjsToGo = 0;
+  else
+    --*pObjsToGo;
+  return false;
+}
@@ -8,12 +8,14 @@
 #define CORE_FPDFAPI_RENDER_CPDF_PROGRESSIVERENDERER_H_
 
 #include <memory>
+#include <vector>
 
 #include "core/fpdfapi/page/cpdf_pageobjectlist.h"
 #include "core/fpdfapi/render/cpdf_rendercontext.h"
 #include "core/fxcrt/fx_coordinates.h"
 #include "core/fxcrt/fx_system.h"
 
+class CPDF_PageObject;
 class CPDF_RenderOptions;
 class CPDF_RenderStatus;
 class CFX_RenderDevice;
@@ -46,6 +48,10 @@ class CPDF_ProgressiveRenderer {
   // Maximum page objects to render before checking for pause.
   static const int kStepLimit = 100;
 
+  // Renders |pObj|, counting it against |pObjsToGo|. Returns true if
+  // rendering paused partway through the object.
+  bool RenderObject(CPDF_PageObject* pObj, IFX_Pause* pPause, int* pObjsToGo);
+
   Status m_Status;
   CPDF_RenderContext* const m_pContext;
   CFX_RenderDevice* const m_pDevice;
@@ -55,6 +61,10 @@ class CPDF_ProgressiveRenderer {
   uint32_t m_LayerIndex;
   CPDF_RenderContext::Layer* m_pCurrentLayer;
   CPDF_PageObjectList::iterator m_LastObjectRendered;
+
+  // The current layer's visible objects, when it has an index.
+  std::vector<CPDF_PageObject*> m_IndexedObjects;
+  size_t m_NextIndexedObject;
 };
 
 #endif  // CORE_FPDFAPI_RENDER_CPDF_PROGRESSIVERENDERER_H_
@@ -20,9 +20,13 @@
 #include "core/fxge/fx_dib.h"
 
 CPDF_RenderContext::CPDF_RenderContext(CPDF_Page* pPage)
+    : CPDF_RenderContext(pPage, pPage->GetRenderCache()) {}
+
+CPDF_RenderContext::CPDF_RenderContext(CPDF_Page* pPage,
+                                       CPDF_PageRenderCache* pPageCache)
     : m_pDocument(pPage->m_pDocument),
       m_pPageResources(pPage->m_pPageResources),
-      m_pPageCache(pPage->GetRenderCache()) {}
+      m_pPageCache(pPageCache) {}
 
 CPDF_RenderContext::CPDF_RenderContext(CPDF_Document* pDoc,
                                        CPDF_PageRenderCache* pPageCache)
@@ -44,8 +48,16 @@ void CPDF_RenderContext::GetBackground(CFX_DIBitmap* pBuffer,
 
 void CPDF_RenderContext::AppendLayer(CPDF_PageObjectHolder* pObjectHolder,
                                      const CFX_Matrix* pObject2Device) {
+  AppendIndexedLayer(pObjectHolder, nullptr, pObject2Device);
+}
+
+void CPDF_RenderContext::AppendIndexedLayer(
+    CPDF_PageObjectHolder* pObjectHolder,
+    const CPDF_PageObjectIndex* pIndex,
+    const CFX_Matrix* pObject2Device) {
   m_Layers.emplace_back();
   m_Layers.back().m_pObjectHolder = pObjectHolder;
+  m_Layers.back().m_pIndex = pIndex;
   if (pObject2Device)
     m_Layers.back().m_Matrix = *pObject2Device;
   else
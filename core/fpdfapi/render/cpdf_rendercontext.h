@@ -17,6 +17,7 @@ class CPDF_Document;
 class CPDF_Page;
 class CPDF_PageObject;
 class CPDF_PageObjectHolder;
+class CPDF_PageObjectIndex;
 class CPDF_PageRenderCache;
 class CPDF_RenderOptions;
 class CFX_DIBitmap;
@@ -28,16 +29,27 @@ class CPDF_RenderContext {
   class Layer {
    public:
     CPDF_PageObjectHolder* m_pObjectHolder;
+    const CPDF_PageObjectIndex* m_pIndex;
     CFX_Matrix m_Matrix;
   };
 
   explicit CPDF_RenderContext(CPDF_Page* pPage);
+  // Renders |pPage| with |pPageCache| in place of the page's own cache.
+  CPDF_RenderContext(CPDF_Page* pPage, CPDF_PageRenderCache* pPageCache);
   CPDF_RenderContext(CPDF_Document* pDoc, CPDF_PageRenderCache* pPageCache);
   ~CPDF_RenderContext();
 
   void AppendLayer(CPDF_PageObjectHolder* pObjectHolder,
                    const CFX_Matrix* pObject2Device);
 
+  // Like AppendLayer(), but CPDF_ProgressiveRenderer looks up the objects
+  // that intersect the clip box in |pIndex|, which must have been built
+  // from |pObjectHolder|'s fully parsed object list, instead of testing
+  // them all.
+  void AppendIndexedLayer(CPDF_PageObjectHolder* pObjectHolder,
+                          const CPDF_PageObjectIndex* pIndex,
+                          const CFX_Matrix* pObject2Device);
+
   void Render(CFX_RenderDevice* pDevice,
               const CPDF_RenderOptions* pOptions,
               const CFX_Matrix* pFinalMatrix);
@@ -27,6 +27,7 @@ class CPDF_Object;
 class CPDF_PageObject;
 class CPDF_PageObjectHolder;
 class CPDF_PathObject;
+class CPDF_Pattern;
 class CPDF_ShadingObject;
 class CPDF_ShadingPattern;
 class CPDF_TilingPattern;
@@ -93,6 +94,7 @@ class CPDF_RenderStatus {
                            const CFX_Matrix* pObj2Device,
                            const CPDF_Color* pColor,
                            bool bStroke);
+  bool LoadPattern(CPDF_Pattern* pPattern);
   void DrawTilingPattern(CPDF_TilingPattern* pPattern,
                          CPDF_PageObject* pPageObj,
                          const CFX_Matrix* pObj2Device,
@@ -154,7 +156,7 @@ class CPDF_RenderStatus {
   void GetScaledMatrix(CFX_Matrix& matrix) const;
 
   static const int kRenderMaxRecursionDepth = 64;
-  static int s_CurrentRecursionDepth;
+  static thread_local int s_CurrentRecursionDepth;
 
   CPDF_RenderContext* m_pContext;
   bool m_bStopped;
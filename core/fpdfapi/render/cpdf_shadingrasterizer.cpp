@@ -0,0 +1,571 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/render/cpdf_shadingrasterizer.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/fpdfapi/page/cpdf_colorspace.h"
+#include "core/fpdfapi/page/pageint.h"
+#include "core/fpdfapi/parser/cpdf_array.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fxcrt/fx_coordinates.h"
+#include "core/fxge/fx_dib.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Number of entries in the color table of an axial or radial shading.
+const int kShadingSteps = 256;
+
+struct AxialParams {
+  FX_FLOAT start_x;
+  FX_FLOAT start_y;
+  FX_FLOAT x_span;
+  FX_FLOAT y_span;
+  FX_FLOAT axis_len_square;
+  bool bStartExtend;
+  bool bEndExtend;
+};
+
+struct RadialParams {
+  FX_FLOAT start_x;
+  FX_FLOAT start_y;
+  FX_FLOAT start_r;
+  FX_FLOAT x_span;
+  FX_FLOAT y_span;
+  FX_FLOAT r_span;
+  FX_FLOAT a;
+  bool bDecreasing;
+  bool bStartExtend;
+  bool bEndExtend;
+};
+
+uint32_t CountOutputs(
+    const std::vector<std::unique_ptr<CPDF_Function>>& funcs) {
+  uint32_t total = 0;
+  for (const auto& func : funcs) {
+    if (func)
+      total += func->CountOutputs();
+  }
+  return total;
+}
+
+// Evaluates the shading functions and the color space for batches of points.
+// One component buffer lives across batches, so components that no function
+// writes behave as they did when every pixel reused a single buffer.
+class ShadingColors {
+ public:
+  ShadingColors(const std::vector<std::unique_ptr<CPDF_Function>>& funcs,
+                CPDF_ColorSpace* pCS)
+      : m_Funcs(funcs),
+        m_pCS(pCS),
+        m_Components(std::max(CountOutputs(funcs), pCS->CountComponents())),
+        m_Outputs(funcs.size()) {}
+
+  // Computes the colors of |count| points, each given by |ninputs| function
+  // inputs.
+  void GetRGB(const FX_FLOAT* inputs,
+              uint32_t ninputs,
+              size_t count,
+              FX_FLOAT* rs,
+              FX_FLOAT* gs,
+              FX_FLOAT* bs) {
+    if (!count)
+      return;
+
+    // The functions share one input buffer, as each clamps the inputs to its
+    // domain in place for those after it.
+    m_Inputs.assign(inputs, inputs + count * ninputs);
+    m_Called.clear();
+    uint32_t offset = 0;
+    for (size_t i = 0; i < m_Funcs.size(); ++i) {
+      const CPDF_Function* pFunc = m_Funcs[i].get();
+      if (!pFunc)
+        continue;
+
+      uint32_t nOutputs = pFunc->CountOutputs();
+      std::vector<FX_FLOAT>& outputs = m_Outputs[i];
+      outputs.resize(std::max<size_t>(count * nOutputs, 1));
+      std::copy(m_Components.begin() + offset,
+                m_Components.begin() + offset + nOutputs, outputs.begin());
+      if (pFunc->CallBatch(m_Inputs.data(), ninputs, count, outputs.data())) {
+        m_Called.push_back(std::make_pair(i, offset));
+        offset += nOutputs;
+      }
+    }
+    for (size_t k = 0; k < count; ++k) {
+      for (const auto& called : m_Called) {
+        uint32_t nOutputs = m_Funcs[called.first]->CountOutputs();
+        const FX_FLOAT* pSrc = m_Outputs[called.first].data() + k * nOutputs;
+        std::copy(pSrc, pSrc + nOutputs, m_Components.begin() + called.second);
+      }
+      FX_FLOAT R = 0.0f, G = 0.0f, B = 0.0f;
+      m_pCS->GetRGB(m_Components.data(), R, G, B);
+      rs[k] = R;
+      gs[k] = G;
+      bs[k] = B;
+    }
+  }
+
+ private:
+  const std::vector<std::unique_ptr<CPDF_Function>>& m_Funcs;
+  CPDF_ColorSpace* const m_pCS;
+  std::vector<FX_FLOAT> m_Inputs;
+  std::vector<FX_FLOAT> m_Components;
+  std::vector<std::vector<FX_FLOAT>> m_Outputs;
+  std::vector<std::pair<size_t, uint32_t>> m_Called;
+};
+
+// Samples a 1-input shading at kShadingSteps points across [t_min, t_max).
+void BuildColorTable(const std::vector<std::unique_ptr<CPDF_Function>>& funcs,
+                     CPDF_ColorSpace* pCS,
+                     FX_FLOAT t_min,
+                     FX_FLOAT t_max,
+                     int alpha,
+                     uint32_t* table) {
+  FX_FLOAT inputs[kShadingSteps];
+  for (int i = 0; i < kShadingSteps; i++)
+    inputs[i] = (t_max - t_min) * i / kShadingSteps + t_min;
+
+  FX_FLOAT rs[kShadingSteps];
+  FX_FLOAT gs[kShadingSteps];
+  FX_FLOAT bs[kShadingSteps];
+  ShadingColors colors(funcs, pCS);
+  colors.GetRGB(inputs, 1, kShadingSteps, rs, gs, bs);
+  for (int i = 0; i < kShadingSteps; i++) {
+    table[i] = FXARGB_TODIB(FXARGB_MAKE(alpha, FXSYS_round(rs[i] * 255),
+                                        FXSYS_round(gs[i] * 255),
+                                        FXSYS_round(bs[i] * 255)));
+  }
+}
+
+int32_t ClampIndex(int32_t index, bool bStartExtend, bool bEndExtend) {
+  if (index < 0)
+    return bStartExtend ? 0 : -1;
+  if (index >= kShadingSteps)
+    return bEndExtend ? kShadingSteps - 1 : -1;
+  return index;
+}
+
+// Returns the color table index of the point (x, y), or -1 if the shading
+// does not cover it.
+int32_t AxialIndex(const AxialParams& p, FX_FLOAT x, FX_FLOAT y) {
+  FX_FLOAT scale =
+      (((x - p.start_x) * p.x_span) + ((y - p.start_y) * p.y_span)) /
+      p.axis_len_square;
+  return ClampIndex((int32_t)(scale * (kShadingSteps - 1)), p.bStartExtend,
+                    p.bEndExtend);
+}
+
+int32_t RadialIndex(const RadialParams& p, FX_FLOAT x, FX_FLOAT y) {
+  FX_FLOAT b = -2 * (((x - p.start_x) * p.x_span) +
+                     ((y - p.start_y) * p.y_span) + (p.start_r * p.r_span));
+  FX_FLOAT c = ((x - p.start_x) * (x - p.start_x)) +
+               ((y - p.start_y) * (y - p.start_y)) - (p.start_r * p.start_r);
+  FX_FLOAT s;
+  if (p.a == 0) {
+    s = -c / b;
+  } else {
+    FX_FLOAT b2_4ac = (b * b) - 4 * (p.a * c);
+    if (b2_4ac < 0)
+      return -1;
+
+    FX_FLOAT root = FXSYS_sqrt(b2_4ac);
+    FX_FLOAT s1, s2;
+    if (p.a > 0) {
+      s1 = (-b - root) / (2 * p.a);
+      s2 = (-b + root) / (2 * p.a);
+    } else {
+      s2 = (-b - root) / (2 * p.a);
+      s1 = (-b + root) / (2 * p.a);
+    }
+    if (p.bDecreasing)
+      s = (s1 >= 0 || p.bStartExtend) ? s1 : s2;
+    else
+      s = (s2 <= 1.0f || p.bEndExtend) ? s2 : s1;
+    if ((p.start_r + s * p.r_span) < 0)
+      return -1;
+  }
+  return ClampIndex((int32_t)(s * (kShadingSteps - 1)), p.bStartExtend,
+                    p.bEndExtend);
+}
+
+#if defined(__SSE2__)
+__m128i SelectInt(__m128i mask, __m128i a, __m128i b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+__m128 SelectFloat(__m128 mask, __m128 a, __m128 b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+__m128 Negate(__m128 v) {
+  return _mm_xor_ps(v, _mm_set1_ps(-0.0f));
+}
+
+// Four lane version of ClampIndex(). Conversions that overflow yield
+// INT32_MIN in both versions, so they clamp alike.
+__m128i ClampIndices(__m128i index, bool bStartExtend, bool bEndExtend) {
+  __m128i below = _mm_cmplt_epi32(index, _mm_setzero_si128());
+  __m128i above = _mm_cmpgt_epi32(index, _mm_set1_epi32(kShadingSteps - 1));
+  index = SelectInt(below, _mm_set1_epi32(bStartExtend ? 0 : -1), index);
+  return SelectInt(above,
+                   _mm_set1_epi32(bEndExtend ? kShadingSteps - 1 : -1), index);
+}
+#endif
+
+// Maps the pixels of |row| through |matrix|, with the same arithmetic as
+// CFX_Matrix::TransformPoint().
+void TransformRow(const CFX_Matrix& matrix,
+                  int row,
+                  int width,
+                  FX_FLOAT* xs,
+                  FX_FLOAT* ys) {
+  FX_FLOAT cy = matrix.c * (FX_FLOAT)row;
+  FX_FLOAT dy = matrix.d * (FX_FLOAT)row;
+  int column = 0;
+#if defined(__SSE2__)
+  __m128 a = _mm_set1_ps(matrix.a);
+  __m128 b = _mm_set1_ps(matrix.b);
+  __m128 e = _mm_set1_ps(matrix.e);
+  __m128 f = _mm_set1_ps(matrix.f);
+  __m128 vcy = _mm_set1_ps(cy);
+  __m128 vdy = _mm_set1_ps(dy);
+  __m128 x = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+  for (; column + 4 <= width; column += 4) {
+    _mm_storeu_ps(xs + column,
+                  _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, x), vcy), e));
+    _mm_storeu_ps(ys + column,
+                  _mm_add_ps(_mm_add_ps(_mm_mul_ps(b, x), vdy), f));
+    x = _mm_add_ps(x, _mm_set1_ps(4.0f));
+  }
+#endif
+  for (; column < width; column++) {
+    FX_FLOAT x = (FX_FLOAT)column;
+    xs[column] = matrix.a * x + cy + matrix.e;
+    ys[column] = matrix.b * x + dy + matrix.f;
+  }
+}
+
+void GetAxialIndices(const AxialParams& p,
+                     const FX_FLOAT* xs,
+                     const FX_FLOAT* ys,
+                     int width,
+                     int32_t* indices) {
+  int column = 0;
+#if defined(__SSE2__)
+  __m128 start_x = _mm_set1_ps(p.start_x);
+  __m128 start_y = _mm_set1_ps(p.start_y);
+  __m128 x_span = _mm_set1_ps(p.x_span);
+  __m128 y_span = _mm_set1_ps(p.y_span);
+  __m128 axis_len_square = _mm_set1_ps(p.axis_len_square);
+  __m128 steps = _mm_set1_ps(kShadingSteps - 1);
+  for (; column + 4 <= width; column += 4) {
+    __m128 x = _mm_loadu_ps(xs + column);
+    __m128 y = _mm_loadu_ps(ys + column);
+    __m128 scale =
+        _mm_div_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(x, start_x), x_span),
+                              _mm_mul_ps(_mm_sub_ps(y, start_y), y_span)),
+                   axis_len_square);
+    __m128i index = _mm_cvttps_epi32(_mm_mul_ps(scale, steps));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(indices + column),
+                     ClampIndices(index, p.bStartExtend, p.bEndExtend));
+  }
+#endif
+  for (; column < width; column++)
+    indices[column] = AxialIndex(p, xs[column], ys[column]);
+}
+
+void GetRadialIndices(const RadialParams& p,
+                      const FX_FLOAT* xs,
+                      const FX_FLOAT* ys,
+                      int width,
+                      int32_t* indices) {
+  int column = 0;
+#if defined(__SSE2__)
+  __m128 zero = _mm_setzero_ps();
+  __m128 start_x = _mm_set1_ps(p.start_x);
+  __m128 start_y = _mm_set1_ps(p.start_y);
+  __m128 start_r = _mm_set1_ps(p.start_r);
+  __m128 x_span = _mm_set1_ps(p.x_span);
+  __m128 y_span = _mm_set1_ps(p.y_span);
+  __m128 r_span = _mm_set1_ps(p.r_span);
+  __m128 start_r_term = _mm_set1_ps(p.start_r * p.r_span);
+  __m128 start_r_square = _mm_set1_ps(p.start_r * p.start_r);
+  __m128 a = _mm_set1_ps(p.a);
+  __m128 two_a = _mm_set1_ps(2 * p.a);
+  __m128 steps = _mm_set1_ps(kShadingSteps - 1);
+  for (; column + 4 <= width; column += 4) {
+    __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + column), start_x);
+    __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + column), start_y);
+    __m128 b = _mm_mul_ps(
+        _mm_set1_ps(-2.0f),
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, x_span), _mm_mul_ps(dy, y_span)),
+                   start_r_term));
+    __m128 c = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                          start_r_square);
+    __m128 s;
+    __m128 valid;
+    if (p.a == 0) {
+      s = _mm_div_ps(Negate(c), b);
+      valid = _mm_cmpeq_ps(zero, zero);
+    } else {
+      __m128 four_ac = _mm_mul_ps(_mm_set1_ps(4.0f), _mm_mul_ps(a, c));
+      __m128 b2_4ac = _mm_sub_ps(_mm_mul_ps(b, b), four_ac);
+      valid = _mm_cmpnlt_ps(b2_4ac, zero);
+      __m128 root = _mm_sqrt_ps(b2_4ac);
+      __m128 neg_b = Negate(b);
+      __m128 lower = _mm_div_ps(_mm_sub_ps(neg_b, root), two_a);
+      __m128 upper = _mm_div_ps(_mm_add_ps(neg_b, root), two_a);
+      __m128 s1 = p.a > 0 ? lower : upper;
+      __m128 s2 = p.a > 0 ? upper : lower;
+      if (p.bDecreasing) {
+        s = p.bStartExtend ? s1
+                           : SelectFloat(_mm_cmpge_ps(s1, zero), s1, s2);
+      } else {
+        s = p.bEndExtend
+                ? s2
+                : SelectFloat(_mm_cmple_ps(s2, _mm_set1_ps(1.0f)), s2, s1);
+      }
+      __m128 radius = _mm_add_ps(start_r, _mm_mul_ps(s, r_span));
+      valid = _mm_and_ps(valid, _mm_cmpnlt_ps(radius, zero));
+    }
+    __m128i index = ClampIndices(_mm_cvttps_epi32(_mm_mul_ps(s, steps)),
+                                 p.bStartExtend, p.bEndExtend);
+    index = SelectInt(_mm_castps_si128(valid), index, _mm_set1_epi32(-1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(indices + column), index);
+  }
+#endif
+  for (; column < width; column++)
+    indices[column] = RadialIndex(p, xs[column], ys[column]);
+}
+
+void FillFromTable(const uint32_t* table,
+                   const int32_t* indices,
+                   int width,
+                   uint32_t* dib_buf) {
+  for (int column = 0; column < width; column++) {
+    if (indices[column] >= 0)
+      dib_buf[column] = table[indices[column]];
+  }
+}
+
+// Packs colors into ARGB pixels, truncating each channel.
+void PackColors(int alpha,
+                const FX_FLOAT* rs,
+                const FX_FLOAT* gs,
+                const FX_FLOAT* bs,
+                size_t count,
+                uint32_t* pixels) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  __m128 scale = _mm_set1_ps(255.0f);
+  __m128i alpha_bits = _mm_set1_epi32((uint32_t)alpha << 24);
+  for (; i + 4 <= count; i += 4) {
+    __m128i r = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(rs + i), scale));
+    __m128i g = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(gs + i), scale));
+    __m128i b = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(bs + i), scale));
+    __m128i argb = _mm_or_si128(
+        _mm_or_si128(alpha_bits, _mm_slli_epi32(r, 16)),
+        _mm_or_si128(_mm_slli_epi32(g, 8), b));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i), argb);
+  }
+#endif
+  for (; i < count; i++) {
+    pixels[i] = FXARGB_TODIB(FXARGB_MAKE(alpha, (int32_t)(rs[i] * 255),
+                                         (int32_t)(gs[i] * 255),
+                                         (int32_t)(bs[i] * 255)));
+  }
+}
+
+}  // namespace
+
+// static
+void CPDF_ShadingRasterizer::DrawAxial(
+    CFX_DIBitmap* pBitmap,
+    const CFX_Matrix& mtObject2Bitmap,
+    CPDF_Dictionary* pDict,
+    const std::vector<std::unique_ptr<CPDF_Function>>& funcs,
+    CPDF_ColorSpace* pCS,
+    int alpha) {
+  ASSERT(pBitmap->GetFormat() == FXDIB_Argb);
+  CPDF_Array* pCoords = pDict->GetArrayFor("Coords");
+  if (!pCoords)
+    return;
+
+  AxialParams params;
+  params.start_x = pCoords->GetNumberAt(0);
+  params.start_y = pCoords->GetNumberAt(1);
+  FX_FLOAT end_x = pCoords->GetNumberAt(2);
+  FX_FLOAT end_y = pCoords->GetNumberAt(3);
+  FX_FLOAT t_min = 0;
+  FX_FLOAT t_max = 1.0f;
+  CPDF_Array* pArray = pDict->GetArrayFor("Domain");
+  if (pArray) {
+    t_min = pArray->GetNumberAt(0);
+    t_max = pArray->GetNumberAt(1);
+  }
+  params.bStartExtend = false;
+  params.bEndExtend = false;
+  pArray = pDict->GetArrayFor("Extend");
+  if (pArray) {
+    params.bStartExtend = !!pArray->GetIntegerAt(0);
+    params.bEndExtend = !!pArray->GetIntegerAt(1);
+  }
+  params.x_span = end_x - params.start_x;
+  params.y_span = end_y - params.start_y;
+  params.axis_len_square =
+      (params.x_span * params.x_span) + (params.y_span * params.y_span);
+
+  CFX_Matrix matrix;
+  matrix.SetReverse(mtObject2Bitmap);
+  uint32_t rgb_array[kShadingSteps];
+  BuildColorTable(funcs, pCS, t_min, t_max, alpha, rgb_array);
+
+  int width = pBitmap->GetWidth();
+  int height = pBitmap->GetHeight();
+  int pitch = pBitmap->GetPitch();
+  std::vector<FX_FLOAT> xs(width);
+  std::vector<FX_FLOAT> ys(width);
+  std::vector<int32_t> indices(width);
+  for (int row = 0; row < height; row++) {
+    uint32_t* dib_buf = (uint32_t*)(pBitmap->GetBuffer() + row * pitch);
+    TransformRow(matrix, row, width, xs.data(), ys.data());
+    GetAxialIndices(params, xs.data(), ys.data(), width, indices.data());
+    FillFromTable(rgb_array, indices.data(), width, dib_buf);
+  }
+}
+
+// static
+void CPDF_ShadingRasterizer::DrawRadial(
+    CFX_DIBitmap* pBitmap,
+    const CFX_Matrix& mtObject2Bitmap,
+    CPDF_Dictionary* pDict,
+    const std::vector<std::unique_ptr<CPDF_Function>>& funcs,
+    CPDF_ColorSpace* pCS,
+    int alpha) {
+  ASSERT(pBitmap->GetFormat() == FXDIB_Argb);
+  CPDF_Array* pCoords = pDict->GetArrayFor("Coords");
+  if (!pCoords)
+    return;
+
+  RadialParams params;
+  FX_FLOAT start_x = pCoords->GetNumberAt(0);
+  FX_FLOAT start_y = pCoords->GetNumberAt(1);
+  FX_FLOAT start_r = pCoords->GetNumberAt(2);
+  FX_FLOAT end_x = pCoords->GetNumberAt(3);
+  FX_FLOAT end_y = pCoords->GetNumberAt(4);
+  FX_FLOAT end_r = pCoords->GetNumberAt(5);
+  FX_FLOAT t_min = 0;
+  FX_FLOAT t_max = 1.0f;
+  CPDF_Array* pArray = pDict->GetArrayFor("Domain");
+  if (pArray) {
+    t_min = pArray->GetNumberAt(0);
+    t_max = pArray->GetNumberAt(1);
+  }
+  params.bStartExtend = false;
+  params.bEndExtend = false;
+  pArray = pDict->GetArrayFor("Extend");
+  if (pArray) {
+    params.bStartExtend = !!pArray->GetIntegerAt(0);
+    params.bEndExtend = !!pArray->GetIntegerAt(1);
+  }
+  params.start_x = start_x;
+  params.start_y = start_y;
+  params.start_r = start_r;
+  params.x_span = end_x - start_x;
+  params.y_span = end_y - start_y;
+  params.r_span = end_r - start_r;
+  params.a = ((start_x - end_x) * (start_x - end_x)) +
+             ((start_y - end_y) * (start_y - end_y)) -
+             ((start_r - end_r) * (start_r - end_r));
+  params.bDecreasing = false;
+  if (start_r > end_r) {
+    int length = (int)FXSYS_sqrt((((start_x - end_x) * (start_x - end_x)) +
+                                  ((start_y - end_y) * (start_y - end_y))));
+    if (length < start_r - end_r)
+      params.bDecreasing = true;
+  }
+
+  CFX_Matrix matrix;
+  matrix.SetReverse(mtObject2Bitmap);
+  uint32_t rgb_array[kShadingSteps];
+  BuildColorTable(funcs, pCS, t_min, t_max, alpha, rgb_array);
+
+  int width = pBitmap->GetWidth();
+  int height = pBitmap->GetHeight();
+  int pitch = pBitmap->GetPitch();
+  std::vector<FX_FLOAT> xs(width);
+  std::vector<FX_FLOAT> ys(width);
+  std::vector<int32_t> indices(width);
+  for (int row = 0; row < height; row++) {
+    uint32_t* dib_buf = (uint32_t*)(pBitmap->GetBuffer() + row * pitch);
+    TransformRow(matrix, row, width, xs.data(), ys.data());
+    GetRadialIndices(params, xs.data(), ys.data(), width, indices.data());
+    FillFromTable(rgb_array, indices.data(), width, dib_buf);
+  }
+}
+
+// static
+void CPDF_ShadingRasterizer::DrawFunction(
+    CFX_DIBitmap* pBitmap,
+    const CFX_Matrix& mtObject2Bitmap,
+    CPDF_Dictionary* pDict,
+    const std::vector<std::unique_ptr<CPDF_Function>>& funcs,
+    CPDF_ColorSpace* pCS,
+    int alpha) {
+  ASSERT(pBitmap->GetFormat() == FXDIB_Argb);
+  CPDF_Array* pDomain = pDict->GetArrayFor("Domain");
+  FX_FLOAT xmin = 0, ymin = 0, xmax = 1.0f, ymax = 1.0f;
+  if (pDomain) {
+    xmin = pDomain->GetNumberAt(0);
+    xmax = pDomain->GetNumberAt(1);
+    ymin = pDomain->GetNumberAt(2);
+    ymax = pDomain->GetNumberAt(3);
+  }
+  CFX_Matrix mtDomain2Target = pDict->GetMatrixFor("Matrix");
+  CFX_Matrix matrix, reverse_matrix;
+  matrix.SetReverse(mtObject2Bitmap);
+  reverse_matrix.SetReverse(mtDomain2Target);
+  matrix.Concat(reverse_matrix);
+
+  int width = pBitmap->GetWidth();
+  int height = pBitmap->GetHeight();
+  int pitch = pBitmap->GetPitch();
+  ShadingColors colors(funcs, pCS);
+  std::vector<FX_FLOAT> xs(width);
+  std::vector<FX_FLOAT> ys(width);
+  std::vector<FX_FLOAT> inputs(width * 2);
+  std::vector<int> columns(width);
+  std::vector<FX_FLOAT> rs(width);
+  std::vector<FX_FLOAT> gs(width);
+  std::vector<FX_FLOAT> bs(width);
+  std::vector<uint32_t> pixels(width);
+  for (int row = 0; row < height; row++) {
+    uint32_t* dib_buf = (uint32_t*)(pBitmap->GetBuffer() + row * pitch);
+    TransformRow(matrix, row, width, xs.data(), ys.data());
+
+    // Gather the pixels inside the domain into one span.
+    size_t count = 0;
+    for (int column = 0; column < width; column++) {
+      FX_FLOAT x = xs[column];
+      FX_FLOAT y = ys[column];
+      if (x < xmin || x > xmax || y < ymin || y > ymax)
+        continue;
+
+      inputs[count * 2] = x;
+      inputs[count * 2 + 1] = y;
+      columns[count++] = column;
+    }
+    colors.GetRGB(inputs.data(), 2, count, rs.data(), gs.data(), bs.data());
+    PackColors(alpha, rs.data(), gs.data(), bs.data(), count, pixels.data());
+    for (size_t i = 0; i < count; i++)
+      dib_buf[columns[i]] = pixels[i];
+  }
+}
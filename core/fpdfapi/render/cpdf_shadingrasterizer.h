@@ -0,0 +1,49 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFAPI_RENDER_CPDF_SHADINGRASTERIZER_H_
+#define CORE_FPDFAPI_RENDER_CPDF_SHADINGRASTERIZER_H_
+
+#include <memory>
+#include <vector>
+
+class CFX_DIBitmap;
+class CFX_Matrix;
+class CPDF_ColorSpace;
+class CPDF_Dictionary;
+class CPDF_Function;
+
+// Fills an ARGB bitmap with a function-based, axial or radial shading.
+//
+// Pixels are produced a row at a time rather than one by one: the shading
+// space coordinates of the whole row are computed together, using SSE2 where
+// the target has it, the shading functions are evaluated for the row in a
+// single batch, and the resulting colors are packed in bulk. Axial and radial
+// shadings look their colors up in a table sampled once from the functions.
+// The output is bit for bit what evaluating each pixel on its own gives.
+class CPDF_ShadingRasterizer {
+ public:
+  static void DrawAxial(CFX_DIBitmap* pBitmap,
+                        const CFX_Matrix& mtObject2Bitmap,
+                        CPDF_Dictionary* pDict,
+                        const std::vector<std::unique_ptr<CPDF_Function>>& funcs,
+                        CPDF_ColorSpace* pCS,
+                        int alpha);
+  static void DrawRadial(
+      CFX_DIBitmap* pBitmap,
+      const CFX_Matrix& mtObject2Bitmap,
+      CPDF_Dictionary* pDict,
+      const std::vector<std::unique_ptr<CPDF_Function>>& funcs,
+      CPDF_ColorSpace* pCS,
+      int alpha);
+  static void DrawFunction(
+      CFX_DIBitmap* pBitmap,
+      const CFX_Matrix& mtObject2Bitmap,
+      CPDF_Dictionary* pDict,
+      const std::vector<std::unique_ptr<CPDF_Function>>& funcs,
+      CPDF_ColorSpace* pCS,
+      int alpha);
+};
+
+#endif  // CORE_FPDFAPI_RENDER_CPDF_SHADINGRASTERIZER_H_
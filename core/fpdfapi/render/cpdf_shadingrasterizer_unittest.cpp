@@ -0,0 +1,539 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/render/cpdf_shadingrasterizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "core/fpdfapi/cpdf_modulemgr.h"
+#include "core/fpdfapi/page/cpdf_colorspace.h"
+#include "core/fpdfapi/page/pageint.h"
+#include "core/fpdfapi/parser/cpdf_array.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_number.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fxge/fx_dib.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+using FunctionList = std::vector<std::unique_ptr<CPDF_Function>>;
+
+const int kSteps = 256;
+
+// The per-pixel rasterizers that CPDF_ShadingRasterizer replaced. Its output
+// must match theirs exactly.
+
+uint32_t RefCountOutputs(const FunctionList& funcs) {
+  uint32_t total = 0;
+  for (const auto& func : funcs) {
+    if (func)
+      total += func->CountOutputs();
+  }
+  return total;
+}
+
+void RefBuildColorTable(const FunctionList& funcs,
+                        CPDF_ColorSpace* pCS,
+                        FX_FLOAT t_min,
+                        FX_FLOAT t_max,
+                        int alpha,
+                        uint32_t* rgb_array) {
+  uint32_t total_results = std::max(RefCountOutputs(funcs),
+                                    pCS->CountComponents());
+  std::vector<FX_FLOAT> results(total_results);
+  for (int i = 0; i < kSteps; i++) {
+    FX_FLOAT input = (t_max - t_min) * i / kSteps + t_min;
+    int offset = 0;
+    for (const auto& func : funcs) {
+      if (func) {
+        int nresults = 0;
+        if (func->Call(&input, 1, results.data() + offset, nresults))
+          offset += nresults;
+      }
+    }
+    FX_FLOAT R = 0.0f, G = 0.0f, B = 0.0f;
+    pCS->GetRGB(results.data(), R, G, B);
+    rgb_array[i] =
+        FXARGB_TODIB(FXARGB_MAKE(alpha, FXSYS_round(R * 255),
+                                 FXSYS_round(G * 255), FXSYS_round(B * 255)));
+  }
+}
+
+void RefDrawAxial(CFX_DIBitmap* pBitmap,
+                  const CFX_Matrix& mtObject2Bitmap,
+                  CPDF_Dictionary* pDict,
+                  const FunctionList& funcs,
+                  CPDF_ColorSpace* pCS,
+                  int alpha) {
+  CPDF_Array* pCoords = pDict->GetArrayFor("Coords");
+  FX_FLOAT start_x = pCoords->GetNumberAt(0);
+  FX_FLOAT start_y = pCoords->GetNumberAt(1);
+  FX_FLOAT end_x = pCoords->GetNumberAt(2);
+  FX_FLOAT end_y = pCoords->GetNumberAt(3);
+  FX_FLOAT t_min = 0;
+  FX_FLOAT t_max = 1.0f;
+  CPDF_Array* pArray = pDict->GetArrayFor("Domain");
+  if (pArray) {
+    t_min = pArray->GetNumberAt(0);
+    t_max = pArray->GetNumberAt(1);
+  }
+  bool bStartExtend = false;
+  bool bEndExtend = false;
+  pArray = pDict->GetArrayFor("Extend");
+  if (pArray) {
+    bStartExtend = !!pArray->GetIntegerAt(0);
+    bEndExtend = !!pArray->GetIntegerAt(1);
+  }
+  FX_FLOAT x_span = end_x - start_x;
+  FX_FLOAT y_span = end_y - start_y;
+  FX_FLOAT axis_len_square = (x_span * x_span) + (y_span * y_span);
+  CFX_Matrix matrix;
+  matrix.SetReverse(mtObject2Bitmap);
+  uint32_t rgb_array[kSteps];
+  RefBuildColorTable(funcs, pCS, t_min, t_max, alpha, rgb_array);
+  for (int row = 0; row < pBitmap->GetHeight(); row++) {
+    uint32_t* dib_buf =
+        (uint32_t*)(pBitmap->GetBuffer() + row * pBitmap->GetPitch());
+    for (int column = 0; column < pBitmap->GetWidth(); column++) {
+      FX_FLOAT x = (FX_FLOAT)column, y = (FX_FLOAT)row;
+      matrix.Transform(x, y);
+      FX_FLOAT scale = (((x - start_x) * x_span) + ((y - start_y) * y_span)) /
+                       axis_len_square;
+      int index = (int32_t)(scale * (kSteps - 1));
+      if (index < 0) {
+        if (!bStartExtend)
+          continue;
+        index = 0;
+      } else if (index >= kSteps) {
+        if (!bEndExtend)
+          continue;
+        index = kSteps - 1;
+      }
+      dib_buf[column] = rgb_array[index];
+    }
+  }
+}
+
+void RefDrawRadial(CFX_DIBitmap* pBitmap,
+                   const CFX_Matrix& mtObject2Bitmap,
+                   CPDF_Dictionary* pDict,
+                   const FunctionList& funcs,
+                   CPDF_ColorSpace* pCS,
+                   int alpha) {
+  CPDF_Array* pCoords = pDict->GetArrayFor("Coords");
+  FX_FLOAT start_x = pCoords->GetNumberAt(0);
+  FX_FLOAT start_y = pCoords->GetNumberAt(1);
+  FX_FLOAT start_r = pCoords->GetNumberAt(2);
+  FX_FLOAT end_x = pCoords->GetNumberAt(3);
+  FX_FLOAT end_y = pCoords->GetNumberAt(4);
+  FX_FLOAT end_r = pCoords->GetNumberAt(5);
+  CFX_Matrix matrix;
+  matrix.SetReverse(mtObject2Bitmap);
+  FX_FLOAT t_min = 0;
+  FX_FLOAT t_max = 1.0f;
+  CPDF_Array* pArray = pDict->GetArrayFor("Domain");
+  if (pArray) {
+    t_min = pArray->GetNumberAt(0);
+    t_max = pArray->GetNumberAt(1);
+  }
+  bool bStartExtend = false;
+  bool bEndExtend = false;
+  pArray = pDict->GetArrayFor("Extend");
+  if (pArray) {
+    bStartExtend = !!pArray->GetIntegerAt(0);
+    bEndExtend = !!pArray->GetIntegerAt(1);
+  }
+  uint32_t rgb_array[kSteps];
+  RefBuildColorTable(funcs, pCS, t_min, t_max, alpha, rgb_array);
+  FX_FLOAT a = ((start_x - end_x) * (start_x - end_x)) +
+               ((start_y - end_y) * (start_y - end_y)) -
+               ((start_r - end_r) * (start_r - end_r));
+  bool bDecreasing = false;
+  if (start_r > end_r) {
+    int length = (int)FXSYS_sqrt((((start_x - end_x) * (start_x - end_x)) +
+                                  ((start_y - end_y) * (start_y - end_y))));
+    if (length < start_r - end_r)
+      bDecreasing = true;
+  }
+  for (int row = 0; row < pBitmap->GetHeight(); row++) {
+    uint32_t* dib_buf =
+        (uint32_t*)(pBitmap->GetBuffer() + row * pBitmap->GetPitch());
+    for (int column = 0; column < pBitmap->GetWidth(); column++) {
+      FX_FLOAT x = (FX_FLOAT)column, y = (FX_FLOAT)row;
+      matrix.Transform(x, y);
+      FX_FLOAT b = -2 * (((x - start_x) * (end_x - start_x)) +
+                         ((y - start_y) * (end_y - start_y)) +
+                         (start_r * (end_r - start_r)));
+      FX_FLOAT c = ((x - start_x) * (x - start_x)) +
+                   ((y - start_y) * (y - start_y)) - (start_r * start_r);
+      FX_FLOAT s;
+      if (a == 0) {
+        s = -c / b;
+      } else {
+        FX_FLOAT b2_4ac = (b * b) - 4 * (a * c);
+        if (b2_4ac < 0)
+          continue;
+        FX_FLOAT root = FXSYS_sqrt(b2_4ac);
+        FX_FLOAT s1, s2;
+        if (a > 0) {
+          s1 = (-b - root) / (2 * a);
+          s2 = (-b + root) / (2 * a);
+        } else {
+          s2 = (-b - root) / (2 * a);
+          s1 = (-b + root) / (2 * a);
+        }
+        if (bDecreasing)
+          s = (s1 >= 0 || bStartExtend) ? s1 : s2;
+        else
+          s = (s2 <= 1.0f || bEndExtend) ? s2 : s1;
+        if ((start_r + s * (end_r - start_r)) < 0)
+          continue;
+      }
+      int index = (int32_t)(s * (kSteps - 1));
+      if (index < 0) {
+        if (!bStartExtend)
+          continue;
+        index = 0;
+      }
+      if (index >= kSteps) {
+        if (!bEndExtend)
+          continue;
+        index = kSteps - 1;
+      }
+      dib_buf[column] = rgb_array[index];
+    }
+  }
+}
+
+void RefDrawFunction(CFX_DIBitmap* pBitmap,
+                     const CFX_Matrix& mtObject2Bitmap,
+                     CPDF_Dictionary* pDict,
+                     const FunctionList& funcs,
+                     CPDF_ColorSpace* pCS,
+                     int alpha) {
+  CPDF_Array* pDomain = pDict->GetArrayFor("Domain");
+  FX_FLOAT xmin = 0, ymin = 0, xmax = 1.0f, ymax = 1.0f;
+  if (pDomain) {
+    xmin = pDomain->GetNumberAt(0);
+    xmax = pDomain->GetNumberAt(1);
+    ymin = pDomain->GetNumberAt(2);
+    ymax = pDomain->GetNumberAt(3);
+  }
+  CFX_Matrix mtDomain2Target = pDict->GetMatrixFor("Matrix");
+  CFX_Matrix matrix, reverse_matrix;
+  matrix.SetReverse(mtObject2Bitmap);
+  reverse_matrix.SetReverse(mtDomain2Target);
+  matrix.Concat(reverse_matrix);
+  uint32_t total_results = std::max(RefCountOutputs(funcs),
+                                    pCS->CountComponents());
+  std::vector<FX_FLOAT> results(total_results);
+  for (int row = 0; row < pBitmap->GetHeight(); row++) {
+    uint32_t* dib_buf =
+        (uint32_t*)(pBitmap->GetBuffer() + row * pBitmap->GetPitch());
+    for (int column = 0; column < pBitmap->GetWidth(); column++) {
+      FX_FLOAT x = (FX_FLOAT)column, y = (FX_FLOAT)row;
+      matrix.Transform(x, y);
+      if (x < xmin || x > xmax || y < ymin || y > ymax)
+        continue;
+      FX_FLOAT input[2] = {x, y};
+      int offset = 0;
+      for (const auto& func : funcs) {
+        if (func) {
+          int nresults;
+          if (func->Call(input, 2, results.data() + offset, nresults))
+            offset += nresults;
+        }
+      }
+      FX_FLOAT R = 0.0f, G = 0.0f, B = 0.0f;
+      pCS->GetRGB(results.data(), R, G, B);
+      dib_buf[column] = FXARGB_TODIB(FXARGB_MAKE(
+          alpha, (int32_t)(R * 255), (int32_t)(G * 255), (int32_t)(B * 255)));
+    }
+  }
+}
+
+using DrawProc = void (*)(CFX_DIBitmap*,
+                          const CFX_Matrix&,
+                          CPDF_Dictionary*,
+                          const FunctionList&,
+                          CPDF_ColorSpace*,
+                          int);
+
+void SetNumbers(CPDF_Dictionary* pDict,
+                const char* key,
+                std::initializer_list<FX_FLOAT> values) {
+  CPDF_Array* pArray = pDict->SetNewFor<CPDF_Array>(key);
+  for (FX_FLOAT value : values)
+    pArray->AddNew<CPDF_Number>(value);
+}
+
+std::unique_ptr<CPDF_Dictionary> MakeExpFunction(
+    std::initializer_list<FX_FLOAT> domain,
+    std::initializer_list<FX_FLOAT> c0,
+    std::initializer_list<FX_FLOAT> c1,
+    FX_FLOAT exponent) {
+  auto pDict = pdfium::MakeUnique<CPDF_Dictionary>();
+  pDict->SetNewFor<CPDF_Number>("FunctionType", 2);
+  SetNumbers(pDict.get(), "Domain", domain);
+  SetNumbers(pDict.get(), "C0", c0);
+  SetNumbers(pDict.get(), "C1", c1);
+  pDict->SetNewFor<CPDF_Number>("N", exponent);
+  return pDict;
+}
+
+std::unique_ptr<CPDF_Function> LoadFunction(CPDF_Object* pObj) {
+  std::unique_ptr<CPDF_Function> pFunc = CPDF_Function::Load(pObj);
+  EXPECT_TRUE(pFunc);
+  return pFunc;
+}
+
+// A 2-input sampled function with RGB outputs on a 4x3 grid.
+std::unique_ptr<CPDF_Stream> MakeSampledFunction() {
+  const int kOutputs = 3 * 4 * 3;
+  std::unique_ptr<uint8_t, FxFreeDeleter> pData(FX_Alloc(uint8_t, kOutputs));
+  for (int i = 0; i < kOutputs; i++)
+    pData.get()[i] = static_cast<uint8_t>(i * 37 + 11);
+  auto pDict = pdfium::MakeUnique<CPDF_Dictionary>();
+  pDict->SetNewFor<CPDF_Number>("FunctionType", 0);
+  SetNumbers(pDict.get(), "Domain", {0, 1, 0, 1});
+  SetNumbers(pDict.get(), "Range", {0, 1, 0, 1, 0, 1});
+  SetNumbers(pDict.get(), "Size", {4, 3});
+  pDict->SetNewFor<CPDF_Number>("BitsPerSample", 8);
+  return pdfium::MakeUnique<CPDF_Stream>(std::move(pData), kOutputs,
+                                         std::move(pDict));
+}
+
+class ShadingRasterizerTest : public testing::Test {
+ public:
+  void SetUp() override { CPDF_ModuleMgr::Get()->InitPageModule(); }
+  void TearDown() override { CPDF_ModuleMgr::Destroy(); }
+
+  // Draws the shading both ways over a grey background and checks that the
+  // results match. Widths that are not a multiple of four exercise the
+  // scalar tails of the vector loops.
+  void Compare(DrawProc pRefProc,
+               DrawProc pProc,
+               CPDF_Dictionary* pShading,
+               const FunctionList& funcs,
+               const CFX_Matrix& matrix) {
+    CPDF_ColorSpace* pCS = CPDF_ColorSpace::GetStockCS(PDFCS_DEVICERGB);
+    CFX_DIBitmap expected;
+    CFX_DIBitmap actual;
+    ASSERT_TRUE(expected.Create(67, 45, FXDIB_Argb));
+    ASSERT_TRUE(actual.Create(67, 45, FXDIB_Argb));
+    expected.Clear(0xff808080);
+    actual.Clear(0xff808080);
+    pRefProc(&expected, matrix, pShading, funcs, pCS, 200);
+    pProc(&actual, matrix, pShading, funcs, pCS, 200);
+    for (int row = 0; row < expected.GetHeight(); row++) {
+      const uint32_t* pExpected =
+          reinterpret_cast<const uint32_t*>(expected.GetScanline(row));
+      const uint32_t* pActual =
+          reinterpret_cast<const uint32_t*>(actual.GetScanline(row));
+      for (int column = 0; column < expected.GetWidth(); column++) {
+        ASSERT_EQ(pExpected[column], pActual[column]) << "at " << column
+                                                      << ", " << row;
+      }
+    }
+  }
+
+  std::vector<CFX_Matrix> Matrices() const {
+    return {CFX_Matrix(60, 0, 0, 40, 3, 2), CFX_Matrix(-50, 10, 20, 35, 60, 4),
+            CFX_Matrix(0.5f, 0.25f, -0.25f, 0.5f, 30, 20),
+            CFX_Matrix(1000, 0, 0, -1000, -400, 600)};
+  }
+};
+
+}  // namespace
+
+TEST_F(ShadingRasterizerTest, Axial) {
+  auto pFunc = MakeExpFunction({0, 1}, {1, 0, 0.25f}, {0, 0.5f, 1}, 1);
+  auto pCurve = MakeExpFunction({0, 1}, {0.1f}, {0.9f}, 2.2f);
+  FunctionList linear;
+  linear.push_back(LoadFunction(pFunc.get()));
+  // Three single-output functions, one per component.
+  FunctionList separate;
+  for (int i = 0; i < 3; i++)
+    separate.push_back(LoadFunction(pCurve.get()));
+
+  for (const CFX_Matrix& matrix : Matrices()) {
+    for (int extend = 0; extend < 4; extend++) {
+      for (const FunctionList* pFuncs : {&linear, &separate}) {
+        CPDF_Dictionary shading;
+        SetNumbers(&shading, "Coords", {0.1f, 0.2f, 0.8f, 0.6f});
+        SetNumbers(&shading, "Domain", {0.2f, 0.9f});
+        SetNumbers(&shading, "Extend",
+                   {FX_FLOAT(extend & 1), FX_FLOAT(extend >> 1)});
+        Compare(RefDrawAxial, CPDF_ShadingRasterizer::DrawAxial, &shading,
+                *pFuncs, matrix);
+      }
+    }
+  }
+}
+
+TEST_F(ShadingRasterizerTest, AxialFunctionsWithDifferentDomains) {
+  // Each function clamps the input to its domain in place, so the ones after
+  // it see the clamped input.
+  auto pRed = MakeExpFunction({0.3f, 0.6f}, {0}, {1}, 1);
+  auto pGreen = MakeExpFunction({0, 1}, {1}, {0}, 1);
+  auto pBlue = MakeExpFunction({0.5f, 2}, {0}, {1}, 2);
+  FunctionList funcs;
+  funcs.push_back(LoadFunction(pRed.get()));
+  funcs.push_back(LoadFunction(pGreen.get()));
+  funcs.push_back(LoadFunction(pBlue.get()));
+
+  for (const CFX_Matrix& matrix : Matrices()) {
+    CPDF_Dictionary shading;
+    SetNumbers(&shading, "Coords", {0.1f, 0.2f, 0.8f, 0.6f});
+    SetNumbers(&shading, "Extend", {1, 1});
+    Compare(RefDrawAxial, CPDF_ShadingRasterizer::DrawAxial, &shading, funcs,
+            matrix);
+  }
+}
+
+TEST_F(ShadingRasterizerTest, AxialDegenerate) {
+  auto pFunc = MakeExpFunction({0, 1}, {1, 0, 0}, {0, 0, 1}, 1);
+  FunctionList funcs;
+  funcs.push_back(LoadFunction(pFunc.get()));
+
+  // A zero length axis divides by zero everywhere.
+  CPDF_Dictionary shading;
+  SetNumbers(&shading, "Coords", {0.5f, 0.5f, 0.5f, 0.5f});
+  SetNumbers(&shading, "Extend", {1, 1});
+  Compare(RefDrawAxial, CPDF_ShadingRasterizer::DrawAxial, &shading, funcs,
+          Matrices()[0]);
+}
+
+TEST_F(ShadingRasterizerTest, Radial) {
+  auto pFunc = MakeExpFunction({0, 1}, {0, 0, 0}, {1, 0.75f, 0.5f}, 1.5f);
+  FunctionList funcs;
+  funcs.push_back(LoadFunction(pFunc.get()));
+
+  const std::vector<std::vector<FX_FLOAT>> kCoords = {
+      {0.5f, 0.5f, 0, 0.5f, 0.5f, 0.5f},    // Concentric.
+      {0.3f, 0.4f, 0.1f, 0.7f, 0.5f, 0.4f},  // Offset centers.
+      {0.5f, 0.5f, 0.6f, 0.55f, 0.5f, 0},    // Shrinking, |bDecreasing|.
+      {0, 0.5f, 0, 0.5f, 0.5f, 0.5f},        // Tangent, so a == 0.
+      {0.2f, 0.2f, 0.5f, 0.8f, 0.7f, 0.1f},  // Cone, a > 0.
+  };
+  for (const CFX_Matrix& matrix : Matrices()) {
+    for (const auto& coords : kCoords) {
+      for (int extend = 0; extend < 4; extend++) {
+        CPDF_Dictionary shading;
+        CPDF_Array* pCoords = shading.SetNewFor<CPDF_Array>("Coords");
+        for (FX_FLOAT value : coords)
+          pCoords->AddNew<CPDF_Number>(value);
+        SetNumbers(&shading, "Extend",
+                   {FX_FLOAT(extend & 1), FX_FLOAT(extend >> 1)});
+        Compare(RefDrawRadial, CPDF_ShadingRasterizer::DrawRadial, &shading,
+                funcs, matrix);
+      }
+    }
+  }
+}
+
+TEST_F(ShadingRasterizerTest, Function) {
+  // A 2-input exponential function has twice as many outputs as colors.
+  auto pExp = MakeExpFunction({0, 1, 0, 1}, {1, 0.2f, 0}, {0, 0.6f, 1}, 1);
+  std::unique_ptr<CPDF_Stream> pSampled = MakeSampledFunction();
+  FunctionList exponential;
+  exponential.push_back(LoadFunction(pExp.get()));
+  FunctionList sampled;
+  sampled.push_back(LoadFunction(pSampled.get()));
+
+  for (const CFX_Matrix& matrix : Matrices()) {
+    for (const FunctionList* pFuncs : {&exponential, &sampled}) {
+      CPDF_Dictionary shading;
+      SetNumbers(&shading, "Domain", {0.1f, 0.9f, 0, 0.8f});
+      SetNumbers(&shading, "Matrix", {1.2f, 0.1f, -0.1f, 0.9f, -0.05f, 0});
+      Compare(RefDrawFunction, CPDF_ShadingRasterizer::DrawFunction,
+              &shading, *pFuncs, matrix);
+    }
+  }
+}
+
+TEST_F(ShadingRasterizerTest, CallBatch) {
+  auto pDict = MakeExpFunction({0, 1}, {0, 1}, {1, 0}, 3);
+  std::unique_ptr<CPDF_Function> pFunc = LoadFunction(pDict.get());
+  ASSERT_EQ(2u, pFunc->CountOutputs());
+
+  const FX_FLOAT kInputs[] = {-1, 0, 0.25f, 0.5f, 1, 2};
+  FX_FLOAT inputs[6];
+  std::copy(kInputs, kInputs + 6, inputs);
+  FX_FLOAT results[12];
+  EXPECT_FALSE(pFunc->CallBatch(inputs, 2, 3, results));
+  ASSERT_TRUE(pFunc->CallBatch(inputs, 1, 6, results));
+  for (size_t i = 0; i < 6; i++) {
+    FX_FLOAT input = kInputs[i];
+    FX_FLOAT expected[2];
+    int nresults = 0;
+    ASSERT_TRUE(pFunc->Call(&input, 1, expected, nresults));
+    EXPECT_EQ(expected[0], results[i * 2]);
+    EXPECT_EQ(expected[1], results[i * 2 + 1]);
+    // The inputs are clamped in place, as by Call().
+    EXPECT_EQ(input, inputs[i]);
+  }
+}
+
+// Times the per-pixel rasterizers against CPDF_ShadingRasterizer on a large
+// bitmap. Run with --gtest_also_run_disabled_tests.
+TEST_F(ShadingRasterizerTest, DISABLED_Benchmark) {
+  auto pAxialFunc = MakeExpFunction({0, 1}, {1, 0, 0.25f}, {0, 0.5f, 1}, 1);
+  auto pFuncFunc =
+      MakeExpFunction({0, 1, 0, 1}, {1, 0.2f, 0}, {0, 0.6f, 1}, 1);
+  FunctionList axial_funcs;
+  axial_funcs.push_back(LoadFunction(pAxialFunc.get()));
+  FunctionList func_funcs;
+  func_funcs.push_back(LoadFunction(pFuncFunc.get()));
+
+  CPDF_Dictionary axial;
+  SetNumbers(&axial, "Coords", {0.1f, 0.2f, 0.8f, 0.6f});
+  SetNumbers(&axial, "Extend", {1, 1});
+  CPDF_Dictionary radial;
+  SetNumbers(&radial, "Coords", {0.3f, 0.4f, 0.1f, 0.7f, 0.5f, 0.4f});
+  SetNumbers(&radial, "Extend", {1, 1});
+  CPDF_Dictionary function;
+  SetNumbers(&function, "Domain", {0, 1, 0, 1});
+
+  struct Case {
+    const char* name;
+    CPDF_Dictionary* pShading;
+    const FunctionList* pFuncs;
+    DrawProc pRefProc;
+    DrawProc pProc;
+  };
+  const Case kCases[] = {
+      {"axial", &axial, &axial_funcs, RefDrawAxial,
+       CPDF_ShadingRasterizer::DrawAxial},
+      {"radial", &radial, &axial_funcs, RefDrawRadial,
+       CPDF_ShadingRasterizer::DrawRadial},
+      {"function", &function, &func_funcs, RefDrawFunction,
+       CPDF_ShadingRasterizer::DrawFunction},
+  };
+  CPDF_ColorSpace* pCS = CPDF_ColorSpace::GetStockCS(PDFCS_DEVICERGB);
+  CFX_Matrix matrix(1024, 0, 0, 1024, 0, 0);
+  CFX_DIBitmap bitmap;
+  ASSERT_TRUE(bitmap.Create(1024, 1024, FXDIB_Argb));
+  for (const Case& c : kCases) {
+    double seconds[2];
+    for (int i = 0; i < 2; i++) {
+      DrawProc pProc = i ? c.pProc : c.pRefProc;
+      auto start = std::chrono::steady_clock::now();
+      for (int j = 0; j < 10; j++)
+        pProc(&bitmap, matrix, c.pShading, *c.pFuncs, pCS, 255);
+      seconds[i] = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    }
+    printf("%-8s per-pixel %7.2f ms  spans %7.2f ms  (%.1fx)\n", c.name,
+           seconds[0] * 100, seconds[1] * 100, seconds[0] / seconds[1]);
+  }
+}
@@ -0,0 +1,353 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdftext/cpdf_textindex.h"
+
+#include <limits.h>
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "core/fpdftext/cpdf_textpage.h"
+#include "core/fxcrt/fx_ext.h"
+#include "third_party/base/stl_util.h"
+
+namespace {
+
+const char kMagic[4] = {'P', 'T', 'I', 'X'};
+const uint32_t kVersion = 1;
+
+// Chars that make up a word of their own.
+bool IsSingleCharWord(FX_WCHAR ch) {
+  return (ch >= 0x3040 && ch <= 0x30FF) ||  // Hiragana and Katakana.
+         (ch >= 0x3400 && ch <= 0x4DBF) ||  // CJK Extension A.
+         (ch >= 0x4E00 && ch <= 0x9FFF) ||  // CJK Unified Ideographs.
+         (ch >= 0xF900 && ch <= 0xFAFF);    // CJK Compatibility Ideographs.
+}
+
+bool IsWordChar(FX_WCHAR ch) {
+  if (ch < 0x80)
+    return FXSYS_iswalnum(ch);
+  // Latin-1 punctuation and symbols, general punctuation, CJK symbols and
+  // punctuation, and halfwidth and fullwidth punctuation.
+  if (ch <= 0xBF || ch == 0xD7 || ch == 0xF7)
+    return false;
+  if ((ch >= 0x2000 && ch <= 0x206F) || (ch >= 0x3000 && ch <= 0x303F))
+    return false;
+  if (ch >= 0xFF00 && ch <= 0xFF0F)
+    return false;
+  if ((ch >= 0xFF1A && ch <= 0xFF20) || (ch >= 0xFF3B && ch <= 0xFF40) ||
+      (ch >= 0xFF5B && ch <= 0xFF65)) {
+    return false;
+  }
+  return ch != 0xFFFE && ch != 0xFFFF;
+}
+
+// Calls |func| with the lowercased text, char index and length of each word
+// of |text|, in order.
+template <typename Func>
+void ForEachWord(const CFX_WideStringC& text, Func func) {
+  FX_STRSIZE length = text.GetLength();
+  FX_STRSIZE i = 0;
+  while (i < length) {
+    FX_WCHAR ch = text.GetAt(i);
+    if (!IsWordChar(ch)) {
+      ++i;
+      continue;
+    }
+    FX_STRSIZE start = i++;
+    if (!IsSingleCharWord(ch)) {
+      while (i < length && IsWordChar(text.GetAt(i)) &&
+             !IsSingleCharWord(text.GetAt(i))) {
+        ++i;
+      }
+    }
+    CFX_WideString word(text.Mid(start, i - start));
+    word.MakeLower();
+    func(word, start, i - start);
+  }
+}
+
+void AppendUInt(uint32_t value, std::vector<uint8_t>* pData) {
+  while (value >= 0x80) {
+    pData->push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  pData->push_back(static_cast<uint8_t>(value));
+}
+
+void AppendBytes(const CFX_ByteString& bytes, std::vector<uint8_t>* pData) {
+  AppendUInt(bytes.GetLength(), pData);
+  pData->insert(pData->end(), bytes.raw_str(),
+                bytes.raw_str() + bytes.GetLength());
+}
+
+class IndexReader {
+ public:
+  IndexReader(const uint8_t* pData, uint32_t size)
+      : m_pData(pData), m_Size(size), m_Offset(0) {}
+
+  bool AtEnd() const { return m_Offset == m_Size; }
+
+  bool ReadUInt(uint32_t* pValue) {
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      if (m_Offset >= m_Size)
+        return false;
+      uint8_t byte = m_pData[m_Offset++];
+      value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) {
+        *pValue = value;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ReadBytes(CFX_ByteString* pBytes) {
+    uint32_t length;
+    if (!ReadUInt(&length) || length > m_Size - m_Offset)
+      return false;
+    *pBytes = CFX_ByteString(m_pData + m_Offset, length);
+    m_Offset += length;
+    return true;
+  }
+
+  bool ReadMagic() {
+    if (m_Size - m_Offset < sizeof(kMagic) ||
+        memcmp(m_pData + m_Offset, kMagic, sizeof(kMagic)) != 0) {
+      return false;
+    }
+    m_Offset += sizeof(kMagic);
+    return true;
+  }
+
+ private:
+  const uint8_t* const m_pData;
+  const uint32_t m_Size;
+  uint32_t m_Offset;
+};
+
+}  // namespace
+
+bool CPDF_TextIndex::Hit::operator==(const Hit& that) const {
+  return page_index == that.page_index && char_index == that.char_index &&
+         char_count == that.char_count;
+}
+
+CPDF_TextIndex::CPDF_TextIndex(int page_count, const CFX_ByteString& doc_id)
+    : m_PageCount(page_count), m_DocId(doc_id) {}
+
+CPDF_TextIndex::~CPDF_TextIndex() {}
+
+int CPDF_TextIndex::CountIndexedPages() const {
+  CFX_AutoLock lock(&m_Lock);
+  return pdfium::CollectionSize<int>(m_IndexedPages);
+}
+
+bool CPDF_TextIndex::IsPageIndexed(int page_index) const {
+  CFX_AutoLock lock(&m_Lock);
+  return pdfium::ContainsKey(m_IndexedPages, page_index);
+}
+
+void CPDF_TextIndex::AddPage(int page_index, const CPDF_TextPage* pTextPage) {
+  if (!pTextPage->IsParsed() || IsPageIndexed(page_index))
+    return;
+
+  // Built from the chars one by one, so that positions in it are char
+  // indices; GetPageText() can leave chars out.
+  int count = pTextPage->CountChars();
+  CFX_WideString text;
+  FX_WCHAR* pBuf = text.GetBuffer(count);
+  for (int i = 0; i < count; ++i) {
+    FPDF_CHAR_INFO info;
+    pTextPage->GetCharInfo(i, &info);
+    pBuf[i] = info.m_Unicode ? info.m_Unicode : L' ';
+  }
+  text.ReleaseBuffer(count);
+  AddPageText(page_index, text.AsStringC());
+}
+
+void CPDF_TextIndex::AddPageText(int page_index, const CFX_WideStringC& text) {
+  if (page_index < 0 || page_index >= m_PageCount)
+    return;
+
+  CFX_AutoLock lock(&m_Lock);
+  if (!m_IndexedPages.insert(page_index).second)
+    return;
+
+  AddPageTextLocked(page_index, text);
+}
+
+void CPDF_TextIndex::AddPageTextLocked(int page_index,
+                                       const CFX_WideStringC& text) {
+  uint32_t ordinal = 0;
+  ForEachWord(text, [this, page_index, &ordinal](const CFX_WideString& word,
+                                                 FX_STRSIZE start,
+                                                 FX_STRSIZE length) {
+    PostingList& postings = m_Terms[word];
+    Posting posting = {static_cast<uint32_t>(page_index), ordinal++,
+                       static_cast<uint32_t>(start),
+                       static_cast<uint32_t>(length)};
+    // Pages can come in any order; keep each list sorted by page.
+    auto it = std::upper_bound(
+        postings.begin(), postings.end(), posting.page_index,
+        [](uint32_t page, const Posting& that) {
+          return page < that.page_index;
+        });
+    postings.insert(it, posting);
+  });
+}
+
+std::vector<CPDF_TextIndex::Hit> CPDF_TextIndex::Find(
+    const CFX_WideStringC& query) const {
+  std::vector<CFX_WideString> words;
+  ForEachWord(query, [&words](const CFX_WideString& word, FX_STRSIZE start,
+                              FX_STRSIZE length) { words.push_back(word); });
+  std::vector<Hit> hits;
+  if (words.empty())
+    return hits;
+
+  CFX_AutoLock lock(&m_Lock);
+  std::vector<const PostingList*> lists;
+  for (const CFX_WideString& word : words) {
+    auto it = m_Terms.find(word);
+    if (it == m_Terms.end())
+      return hits;
+    lists.push_back(&it->second);
+  }
+
+  auto less = [](const Posting& posting,
+                 const std::pair<uint32_t, uint32_t>& key) {
+    return posting.page_index < key.first ||
+           (posting.page_index == key.first && posting.ordinal < key.second);
+  };
+  for (const Posting& first : *lists[0]) {
+    const Posting* pLast = &first;
+    for (size_t i = 1; i < lists.size() && pLast; ++i) {
+      std::pair<uint32_t, uint32_t> key(first.page_index, first.ordinal + i);
+      auto it =
+          std::lower_bound(lists[i]->begin(), lists[i]->end(), key, less);
+      pLast = it != lists[i]->end() && it->page_index == key.first &&
+                      it->ordinal == key.second
+                  ? &*it
+                  : nullptr;
+    }
+    if (!pLast)
+      continue;
+
+    Hit hit = {static_cast<int>(first.page_index),
+               static_cast<int>(first.char_index),
+               static_cast<int>(pLast->char_index + pLast->char_count -
+                                first.char_index)};
+    hits.push_back(hit);
+  }
+  return hits;
+}
+
+std::vector<uint8_t> CPDF_TextIndex::Serialize() const {
+  CFX_AutoLock lock(&m_Lock);
+  std::vector<uint8_t> data(kMagic, kMagic + sizeof(kMagic));
+  AppendUInt(kVersion, &data);
+  AppendUInt(m_PageCount, &data);
+  AppendBytes(m_DocId, &data);
+
+  // Page numbers, and positions within a page, are stored as deltas.
+  AppendUInt(m_IndexedPages.size(), &data);
+  int prev_page = 0;
+  for (int page_index : m_IndexedPages) {
+    AppendUInt(page_index - prev_page, &data);
+    prev_page = page_index;
+  }
+
+  AppendUInt(m_Terms.size(), &data);
+  for (const auto& term : m_Terms) {
+    AppendBytes(term.first.UTF8Encode(), &data);
+    const PostingList& postings = term.second;
+    AppendUInt(postings.size(), &data);
+    uint32_t page = 0;
+    uint32_t char_index = 0;
+    for (const Posting& posting : postings) {
+      if (posting.page_index != page)
+        char_index = 0;
+      AppendUInt(posting.page_index - page, &data);
+      AppendUInt(posting.ordinal, &data);
+      AppendUInt(posting.char_index - char_index, &data);
+      AppendUInt(posting.char_count, &data);
+      page = posting.page_index;
+      char_index = posting.char_index;
+    }
+  }
+  return data;
+}
+
+bool CPDF_TextIndex::Deserialize(const uint8_t* pData, uint32_t size) {
+  IndexReader reader(pData, size);
+  uint32_t version;
+  uint32_t page_count;
+  CFX_ByteString doc_id;
+  if (!reader.ReadMagic() || !reader.ReadUInt(&version) ||
+      version != kVersion || !reader.ReadUInt(&page_count) ||
+      page_count != static_cast<uint32_t>(m_PageCount) ||
+      !reader.ReadBytes(&doc_id) || doc_id != m_DocId) {
+    return false;
+  }
+
+  std::set<int> pages;
+  uint32_t page_total;
+  if (!reader.ReadUInt(&page_total) || page_total > page_count)
+    return false;
+  uint32_t page = 0;
+  for (uint32_t i = 0; i < page_total; ++i) {
+    uint32_t delta;
+    if (!reader.ReadUInt(&delta) || delta > page_count - page)
+      return false;
+    page += delta;
+    if (page >= page_count || !pages.insert(page).second)
+      return false;
+  }
+
+  std::map<CFX_WideString, PostingList> terms;
+  uint32_t term_count;
+  if (!reader.ReadUInt(&term_count))
+    return false;
+  for (uint32_t i = 0; i < term_count; ++i) {
+    CFX_ByteString term;
+    uint32_t posting_count;
+    if (!reader.ReadBytes(&term) || !reader.ReadUInt(&posting_count))
+      return false;
+
+    PostingList postings;
+    Posting posting = {0, 0, 0, 0};
+    for (uint32_t j = 0; j < posting_count; ++j) {
+      uint32_t page_delta;
+      uint32_t char_delta;
+      if (!reader.ReadUInt(&page_delta) ||
+          page_delta > page_count - posting.page_index ||
+          !reader.ReadUInt(&posting.ordinal) ||
+          !reader.ReadUInt(&char_delta) ||
+          !reader.ReadUInt(&posting.char_count)) {
+        return false;
+      }
+      if (page_delta)
+        posting.char_index = 0;
+      posting.page_index += page_delta;
+      posting.char_index += char_delta;
+      if (!pdfium::ContainsKey(pages, static_cast<int>(posting.page_index)) ||
+          posting.char_index > INT_MAX || posting.char_count > INT_MAX) {
+        return false;
+      }
+      postings.push_back(posting);
+    }
+    terms[CFX_WideString::FromUTF8(term.AsStringC())] = std::move(postings);
+  }
+  if (!reader.AtEnd())
+    return false;
+
+  CFX_AutoLock lock(&m_Lock);
+  m_IndexedPages = std::move(pages);
+  m_Terms = std::move(terms);
+  return true;
+}
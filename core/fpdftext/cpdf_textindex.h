@@ -0,0 +1,84 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFTEXT_CPDF_TEXTINDEX_H_
+#define CORE_FPDFTEXT_CPDF_TEXTINDEX_H_
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "core/fxcrt/cfx_mutex.h"
+#include "core/fxcrt/fx_string.h"
+#include "core/fxcrt/fx_system.h"
+
+class CPDF_TextPage;
+
+// Document-wide index of the words on the pages of a document, so that
+// searching the whole document does not mean loading every page again for
+// every query. Pages are added as their text gets extracted. The index can
+// be written out and read back, to keep it next to the file it is for.
+//
+// Words are runs of letters and digits, compared without regard to case.
+// Each ideograph and kana counts as a word of its own, as these scripts do
+// not separate words with spaces. Words are located by the char index of
+// their first char and their number of chars, as in CPDF_TextPage.
+class CPDF_TextIndex {
+ public:
+  struct Hit {
+    bool operator==(const Hit& that) const;
+
+    int page_index;
+    int char_index;
+    int char_count;
+  };
+
+  // |doc_id| identifies the document, e.g. by the first element of its /ID,
+  // so that an index written for a different document is not read back.
+  CPDF_TextIndex(int page_count, const CFX_ByteString& doc_id);
+  ~CPDF_TextIndex();
+
+  int GetPageCount() const { return m_PageCount; }
+  int CountIndexedPages() const;
+  bool IsPageIndexed(int page_index) const;
+
+  // Adds the words of |pTextPage|, which must be parsed, as those of page
+  // |page_index|. Does nothing if the page is indexed already.
+  void AddPage(int page_index, const CPDF_TextPage* pTextPage);
+
+  // Same as AddPage(), for text whose char indices are its own indices.
+  void AddPageText(int page_index, const CFX_WideStringC& text);
+
+  // Finds where the words of |query| occur one right after the other, in
+  // page and then char order. Separators between the words do not matter.
+  std::vector<Hit> Find(const CFX_WideStringC& query) const;
+
+  std::vector<uint8_t> Serialize() const;
+
+  // Replaces the contents with what |pData| holds, as written by
+  // Serialize() for the same document. Returns false, keeping the index as
+  // it is, if the data is malformed or for another document.
+  bool Deserialize(const uint8_t* pData, uint32_t size);
+
+ private:
+  // Where a word occurs: its position among the words of the page, and its
+  // chars.
+  struct Posting {
+    uint32_t page_index;
+    uint32_t ordinal;
+    uint32_t char_index;
+    uint32_t char_count;
+  };
+  using PostingList = std::vector<Posting>;
+
+  void AddPageTextLocked(int page_index, const CFX_WideStringC& text);
+
+  const int m_PageCount;
+  const CFX_ByteString m_DocId;
+  mutable CFX_Mutex m_Lock;
+  std::set<int> m_IndexedPages;
+  std::map<CFX_WideString, PostingList> m_Terms;
+};
+
+#endif  // CORE_FPDFTEXT_CPDF_TEXTINDEX_H_
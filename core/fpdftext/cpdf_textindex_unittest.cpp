@@ -0,0 +1,131 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdftext/cpdf_textindex.h"
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+std::vector<CPDF_TextIndex::Hit> Hits(
+    std::initializer_list<CPDF_TextIndex::Hit> hits) {
+  return std::vector<CPDF_TextIndex::Hit>(hits);
+}
+
+}  // namespace
+
+TEST(cpdf_textindex, FindWords) {
+  CPDF_TextIndex index(3, "id");
+  EXPECT_EQ(0, index.CountIndexedPages());
+
+  index.AddPageText(2, L"The quick brown fox.");
+  index.AddPageText(0, L"A fox, the fox-hound\r\nand THE Fox");
+  EXPECT_EQ(2, index.CountIndexedPages());
+  EXPECT_TRUE(index.IsPageIndexed(0));
+  EXPECT_FALSE(index.IsPageIndexed(1));
+
+  EXPECT_EQ(Hits({{0, 2, 3}, {0, 11, 3}, {0, 30, 3}, {2, 16, 3}}),
+            index.Find(L"FOX"));
+  EXPECT_EQ(Hits({{2, 4, 5}}), index.Find(L"quick"));
+  EXPECT_TRUE(index.Find(L"qui").empty());
+  EXPECT_TRUE(index.Find(L"wolf").empty());
+  EXPECT_TRUE(index.Find(L"").empty());
+  EXPECT_TRUE(index.Find(L" ,.").empty());
+
+  // Pages are only indexed once; out of range pages not at all.
+  index.AddPageText(2, L"wolf");
+  index.AddPageText(3, L"wolf");
+  index.AddPageText(-1, L"wolf");
+  EXPECT_TRUE(index.Find(L"wolf").empty());
+  EXPECT_EQ(2, index.CountIndexedPages());
+}
+
+TEST(cpdf_textindex, PagesInAnyOrder) {
+  CPDF_TextIndex index(4, "id");
+  index.AddPageText(3, L"fox fox");
+  index.AddPageText(1, L"fox");
+  index.AddPageText(2, L"a fox");
+  index.AddPageText(0, L"fox hound fox");
+
+  EXPECT_EQ(Hits({{0, 0, 3},
+                  {0, 10, 3},
+                  {1, 0, 3},
+                  {2, 2, 3},
+                  {3, 0, 3},
+                  {3, 4, 3}}),
+            index.Find(L"fox"));
+  EXPECT_EQ(Hits({{3, 0, 7}}), index.Find(L"fox fox"));
+}
+
+TEST(cpdf_textindex, FindPhrases) {
+  CPDF_TextIndex index(2, "id");
+  index.AddPageText(0, L"the fox-hound and the fox");
+  index.AddPageText(1, L"fox\nhound");
+
+  EXPECT_EQ(Hits({{0, 4, 9}, {1, 0, 9}}), index.Find(L"fox hound"));
+  EXPECT_EQ(Hits({{0, 0, 13}}), index.Find(L"The Fox-Hound"));
+  EXPECT_EQ(Hits({{0, 0, 7}, {0, 18, 7}}), index.Find(L"the fox."));
+  EXPECT_TRUE(index.Find(L"hound fox").empty());
+  EXPECT_TRUE(index.Find(L"the hound").empty());
+}
+
+TEST(cpdf_textindex, FindIdeographs) {
+  CPDF_TextIndex index(1, "id");
+  // "Tokyo tower" and "Kyoto" in Japanese, with Latin text in between.
+  index.AddPageText(0, L"\x6771\x4eac\x30bf\x30ef\x30fc abc\x3001\x4eac\x90fd");
+
+  EXPECT_EQ(Hits({{0, 1, 1}, {0, 10, 1}}), index.Find(L"\x4eac"));
+  EXPECT_EQ(Hits({{0, 0, 2}}), index.Find(L"\x6771\x4eac"));
+  EXPECT_EQ(Hits({{0, 10, 2}}), index.Find(L"\x4eac\x90fd"));
+  EXPECT_EQ(Hits({{0, 6, 3}}), index.Find(L"ABC"));
+  EXPECT_TRUE(index.Find(L"\x90fd\x6771").empty());
+}
+
+TEST(cpdf_textindex, SerializeRoundTrip) {
+  CPDF_TextIndex index(40, "doc");
+  index.AddPageText(35, L"alpha beta \x00e9t\x00e9 gamma");
+  index.AddPageText(3, L"Beta gamma, beta.");
+  index.AddPageText(4, L"");
+  std::vector<uint8_t> data = index.Serialize();
+
+  CPDF_TextIndex loaded(40, "doc");
+  loaded.AddPageText(7, L"delta");
+  ASSERT_TRUE(loaded.Deserialize(data.data(), data.size()));
+  EXPECT_EQ(3, loaded.CountIndexedPages());
+  EXPECT_TRUE(loaded.IsPageIndexed(4));
+  EXPECT_FALSE(loaded.IsPageIndexed(7));
+  for (const wchar_t* query :
+       {L"beta", L"gamma", L"beta gamma", L"\x00e9T\x00e9", L"delta"}) {
+    EXPECT_EQ(index.Find(query), loaded.Find(query)) << query;
+  }
+  EXPECT_EQ(data, loaded.Serialize());
+}
+
+TEST(cpdf_textindex, DeserializeRejectsBadData) {
+  CPDF_TextIndex index(5, "doc");
+  index.AddPageText(1, L"one two three");
+  std::vector<uint8_t> data = index.Serialize();
+
+  CPDF_TextIndex other_id(5, "other");
+  EXPECT_FALSE(other_id.Deserialize(data.data(), data.size()));
+  CPDF_TextIndex other_count(6, "doc");
+  EXPECT_FALSE(other_count.Deserialize(data.data(), data.size()));
+
+  CPDF_TextIndex loaded(5, "doc");
+  loaded.AddPageText(2, L"four");
+  for (size_t size = 0; size < data.size(); ++size)
+    EXPECT_FALSE(loaded.Deserialize(data.data(), size)) << size;
+  std::vector<uint8_t> longer = data;
+  longer.push_back(0);
+  EXPECT_FALSE(loaded.Deserialize(longer.data(), longer.size()));
+  std::vector<uint8_t> corrupt = data;
+  corrupt[0] = 'X';
+  EXPECT_FALSE(loaded.Deserialize(corrupt.data(), corrupt.size()));
+
+  // Failed loads leave the index alone.
+  EXPECT_EQ(1, loaded.CountIndexedPages());
+  EXPECT_EQ(1u, loaded.Find(L"four").size());
+}
@@ -36,14 +36,18 @@ class CCodec_FlateModule {
                             uint32_t estimated_size,
                             uint8_t*& dest_buf,
                             uint32_t& dest_size);
+  // |level| is a zlib compression level, from 0 (stored) to 9 (smallest),
+  // or -1 for zlib's default.
   bool Encode(const uint8_t* src_buf,
               uint32_t src_size,
               uint8_t** dest_buf,
-              uint32_t* dest_size);
+              uint32_t* dest_size,
+              int level = -1);
   bool PngEncode(const uint8_t* src_buf,
                  uint32_t src_size,
                  uint8_t** dest_buf,
-                 uint32_t* dest_size);
+                 uint32_t* dest_size,
+                 int level = -1);
 };
 
 #endif  // CORE_FXCODEC_CODEC_CCODEC_FLATEMODULE_H_
@@ -35,9 +35,16 @@ class CCodec_Jbig2Context {
 
 class CCodec_Jbig2Module {
  public:
-  CCodec_Jbig2Module() {}
+  CCodec_Jbig2Module();
   ~CCodec_Jbig2Module();
 
+  // Sets the budget of the symbol dictionary cache of the documents that
+  // start decoding JBIG2 images from now on.
+  void SetSymbolDictCacheBytes(uint32_t nBytes) {
+    m_nSymbolDictCacheBytes = nBytes;
+  }
+  uint32_t GetSymbolDictCacheBytes() const { return m_nSymbolDictCacheBytes; }
+
   FXCODEC_STATUS StartDecode(
       CCodec_Jbig2Context* pJbig2Context,
       std::unique_ptr<JBig2_DocumentContext>* pContextHolder,
@@ -50,6 +57,9 @@ class CCodec_Jbig2Module {
       IFX_Pause* pPause);
   FXCODEC_STATUS ContinueDecode(CCodec_Jbig2Context* pJbig2Context,
                                 IFX_Pause* pPause);
+
+ private:
+  uint32_t m_nSymbolDictCacheBytes;
 };
 
 #endif  // CORE_FXCODEC_CODEC_CCODEC_JBIG2MODULE_H_
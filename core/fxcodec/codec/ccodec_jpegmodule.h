@@ -23,12 +23,15 @@ class CCodec_JpegModule {
  public:
   CCodec_JpegModule() {}
 
+  // |scale_denom| is 1, 2, 4 or 8, to decode the image scaled down by that
+  // much, as libjpeg does within the inverse DCT.
   std::unique_ptr<CCodec_ScanlineDecoder> CreateDecoder(const uint8_t* src_buf,
                                                         uint32_t src_size,
                                                         int width,
                                                         int height,
                                                         int nComps,
-                                                        bool ColorTransform);
+                                                        bool ColorTransform,
+                                                        int scale_denom);
   bool LoadInfo(const uint8_t* src_buf,
                 uint32_t src_size,
                 int* width,
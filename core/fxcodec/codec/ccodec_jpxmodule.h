@@ -19,13 +19,19 @@ class CCodec_JpxModule {
   CCodec_JpxModule();
   ~CCodec_JpxModule();
 
+  // Decodes the image at a lower resolution, halving its size |reduction|
+  // times, if its codestream has as many resolution levels to leave out.
   CJPX_Decoder* CreateDecoder(const uint8_t* src_buf,
                               uint32_t src_size,
-                              CPDF_ColorSpace* cs);
+                              CPDF_ColorSpace* cs,
+                              uint32_t reduction);
+  // The size of the image as decoded.
   void GetImageInfo(CJPX_Decoder* pDecoder,
                     uint32_t* width,
                     uint32_t* height,
                     uint32_t* components);
+  // How many times the image has been halved in size.
+  uint32_t GetReduction(CJPX_Decoder* pDecoder);
   bool Decode(CJPX_Decoder* pDecoder,
               uint8_t* dest_data,
               int pitch,
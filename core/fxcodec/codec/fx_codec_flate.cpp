@@ -9,10 +9,11 @@
 #include <algorithm>
 #include <memory>
 #include <utility>
-#include <vector>
 
+#include "core/fxcodec/codec/fx_codec_predictor.h"
 #include "core/fxcodec/fx_codec.h"
 #include "core/fxcrt/fx_ext.h"
+#include "core/fxcrt/fx_safe_types.h"
 #include "third_party/base/ptr_util.h"
 #include "third_party/zlib_v128/zlib.h"
 
@@ -35,8 +36,9 @@ static int FPDFAPI_FlateGetTotalIn(void* context) {
 static bool FPDFAPI_FlateCompress(unsigned char* dest_buf,
                                   unsigned long* dest_size,
                                   const unsigned char* src_buf,
-                                  unsigned long src_size) {
-  return compress(dest_buf, dest_size, src_buf, src_size) == Z_OK;
+                                  unsigned long src_size,
+                                  int level) {
+  return compress2(dest_buf, dest_size, src_buf, src_size, level) == Z_OK;
 }
 
 void* FPDFAPI_FlateInit(void* (*alloc_func)(void*, unsigned int, unsigned int),
@@ -240,18 +242,6 @@ int CLZWDecoder::Decode(uint8_t* dest_buf,
   return 0;
 }
 
-uint8_t PathPredictor(int a, int b, int c) {
-  int p = a + b - c;
-  int pa = FXSYS_abs(p - a);
-  int pb = FXSYS_abs(p - b);
-  int pc = FXSYS_abs(p - c);
-  if (pa <= pb && pa <= pc)
-    return (uint8_t)a;
-  if (pb <= pc)
-    return (uint8_t)b;
-  return (uint8_t)c;
-}
-
 void PNG_PredictorEncode(uint8_t** data_buf, uint32_t* data_size) {
   const int row_size = 7;
   const int row_count = (*data_size + row_size - 1) / row_size;
@@ -286,63 +276,8 @@ void PNG_PredictLine(uint8_t* pDestData,
                      int nPixels) {
   int row_size = (nPixels * bpc * nColors + 7) / 8;
   int BytesPerPixel = (bpc * nColors + 7) / 8;
-  uint8_t tag = pSrcData[0];
-  if (tag == 0) {
-    FXSYS_memmove(pDestData, pSrcData + 1, row_size);
-    return;
-  }
-  for (int byte = 0; byte < row_size; byte++) {
-    uint8_t raw_byte = pSrcData[byte + 1];
-    switch (tag) {
-      case 1: {
-        uint8_t left = 0;
-        if (byte >= BytesPerPixel) {
-          left = pDestData[byte - BytesPerPixel];
-        }
-        pDestData[byte] = raw_byte + left;
-        break;
-      }
-      case 2: {
-        uint8_t up = 0;
-        if (pLastLine) {
-          up = pLastLine[byte];
-        }
-        pDestData[byte] = raw_byte + up;
-        break;
-      }
-      case 3: {
-        uint8_t left = 0;
-        if (byte >= BytesPerPixel) {
-          left = pDestData[byte - BytesPerPixel];
-        }
-        uint8_t up = 0;
-        if (pLastLine) {
-          up = pLastLine[byte];
-        }
-        pDestData[byte] = raw_byte + (up + left) / 2;
-        break;
-      }
-      case 4: {
-        uint8_t left = 0;
-        if (byte >= BytesPerPixel) {
-          left = pDestData[byte - BytesPerPixel];
-        }
-        uint8_t up = 0;
-        if (pLastLine) {
-          up = pLastLine[byte];
-        }
-        uint8_t upper_left = 0;
-        if (byte >= BytesPerPixel && pLastLine) {
-          upper_left = pLastLine[byte - BytesPerPixel];
-        }
-        pDestData[byte] = raw_byte + PathPredictor(left, up, upper_left);
-        break;
-      }
-      default:
-        pDestData[byte] = raw_byte;
-        break;
-    }
-  }
+  PNG_UnfilterRow(pSrcData[0], pDestData, pSrcData + 1, pLastLine, row_size,
+                  BytesPerPixel);
 }
 
 bool PNG_Predictor(uint8_t*& data_buf,
@@ -359,76 +294,15 @@ bool PNG_Predictor(uint8_t*& data_buf,
     return false;
   const int last_row_size = data_size % (row_size + 1);
   uint8_t* dest_buf = FX_Alloc2D(uint8_t, row_size, row_count);
-  int byte_cnt = 0;
   uint8_t* pSrcData = data_buf;
   uint8_t* pDestData = dest_buf;
   for (int row = 0; row < row_count; row++) {
-    uint8_t tag = pSrcData[0];
-    byte_cnt++;
-    if (tag == 0) {
-      int move_size = row_size;
-      if ((row + 1) * (move_size + 1) > (int)data_size) {
-        move_size = last_row_size - 1;
-      }
-      FXSYS_memmove(pDestData, pSrcData + 1, move_size);
-      pSrcData += move_size + 1;
-      pDestData += move_size;
-      byte_cnt += move_size;
-      continue;
-    }
-    for (int byte = 0; byte < row_size && byte_cnt < (int)data_size; byte++) {
-      uint8_t raw_byte = pSrcData[byte + 1];
-      switch (tag) {
-        case 1: {
-          uint8_t left = 0;
-          if (byte >= BytesPerPixel) {
-            left = pDestData[byte - BytesPerPixel];
-          }
-          pDestData[byte] = raw_byte + left;
-          break;
-        }
-        case 2: {
-          uint8_t up = 0;
-          if (row) {
-            up = pDestData[byte - row_size];
-          }
-          pDestData[byte] = raw_byte + up;
-          break;
-        }
-        case 3: {
-          uint8_t left = 0;
-          if (byte >= BytesPerPixel) {
-            left = pDestData[byte - BytesPerPixel];
-          }
-          uint8_t up = 0;
-          if (row) {
-            up = pDestData[byte - row_size];
-          }
-          pDestData[byte] = raw_byte + (up + left) / 2;
-          break;
-        }
-        case 4: {
-          uint8_t left = 0;
-          if (byte >= BytesPerPixel) {
-            left = pDestData[byte - BytesPerPixel];
-          }
-          uint8_t up = 0;
-          if (row) {
-            up = pDestData[byte - row_size];
-          }
-          uint8_t upper_left = 0;
-          if (byte >= BytesPerPixel && row) {
-            upper_left = pDestData[byte - row_size - BytesPerPixel];
-          }
-          pDestData[byte] = raw_byte + PathPredictor(left, up, upper_left);
-          break;
-        }
-        default:
-          pDestData[byte] = raw_byte;
-          break;
-      }
-      byte_cnt++;
-    }
+    // The last row may be cut short.
+    int size = row_size;
+    if ((row + 1) * (row_size + 1) > (int)data_size)
+      size = last_row_size - 1;
+    PNG_UnfilterRow(pSrcData[0], pDestData, pSrcData + 1,
+                    row ? pDestData - row_size : nullptr, size, BytesPerPixel);
     pSrcData += row_size + 1;
     pDestData += row_size;
   }
@@ -472,10 +346,9 @@ void TIFF_PredictLine(uint8_t* dest_buf,
       dest_buf[i] = pixel >> 8;
       dest_buf[i + 1] = (uint8_t)pixel;
     }
-  } else {
-    for (uint32_t i = BytesPerPixel; i < row_size; i++) {
-      dest_buf[i] += dest_buf[i - BytesPerPixel];
-    }
+  } else if (BytesPerPixel > 0) {
+    // This is the PNG Sub filter, applied in place.
+    PNG_UnfilterRow(1, dest_buf, dest_buf, nullptr, row_size, BytesPerPixel);
   }
 }
 
@@ -499,22 +372,41 @@ bool TIFF_Predictor(uint8_t*& data_buf,
   return true;
 }
 
+// Deflate cannot expand data by more than this, so a larger size hint for
+// the output of a stream is bogus.
+const uint32_t kMaxFlateRatio = 1032;
+
+// How much to allocate for the output at first. A plausible hint is taken at
+// its word up to a cap, as it comes from the file; past that, and without a
+// hint, the buffer grows as the output comes in.
+uint32_t GuessUncompressedSize(uint32_t src_size, uint32_t orig_size) {
+  static const uint32_t kMaxInitialAllocSize = 10000000;
+  FX_SAFE_UINT32 max_size = src_size;
+  max_size *= kMaxFlateRatio;
+  if (orig_size && (!max_size.IsValid() || orig_size <= max_size.ValueOrDie()))
+    return std::min(orig_size, kMaxInitialAllocSize);
+
+  FX_SAFE_UINT32 guess_size = src_size;
+  guess_size *= 2;
+  if (!guess_size.IsValid())
+    return kMaxInitialAllocSize;
+  return std::min(std::max(guess_size.ValueOrDie(), 1u), kMaxInitialAllocSize);
+}
+
+// Inflates straight into a single buffer. With a correct size hint within the
+// cap, the output fits the first allocation; otherwise the buffer grows by
+// half its size each time it fills, so even large streams are reallocated a
+// handful of times rather than decoded into chunks and copied together.
 void FlateUncompress(const uint8_t* src_buf,
                      uint32_t src_size,
                      uint32_t orig_size,
                      uint8_t*& dest_buf,
                      uint32_t& dest_size,
                      uint32_t& offset) {
-  uint32_t guess_size = orig_size ? orig_size : src_size * 2;
-  const uint32_t kStepSize = 10240;
-  uint32_t alloc_step = orig_size ? kStepSize : std::min(src_size, kStepSize);
-  static const uint32_t kMaxInitialAllocSize = 10000000;
-  if (guess_size > kMaxInitialAllocSize) {
-    guess_size = kMaxInitialAllocSize;
-    alloc_step = kMaxInitialAllocSize;
-  }
-  uint32_t buf_size = guess_size;
-  uint32_t last_buf_size = buf_size;
+  // FPDFAPI_FlateOutput() zeroes whatever it is given but does not fill, so
+  // an oversized hint must not be handed to it all at once.
+  static const uint32_t kMaxOutputStep = 1024 * 1024;
+  static const uint32_t kMinGrowSize = 10240;
 
   dest_buf = nullptr;
   dest_size = 0;
@@ -522,92 +414,35 @@ void FlateUncompress(const uint8_t* src_buf,
   if (!context)
     return;
 
-  std::unique_ptr<uint8_t, FxFreeDeleter> guess_buf(
-      FX_Alloc(uint8_t, guess_size + 1));
-  guess_buf.get()[guess_size] = '\0';
-
+  uint32_t buf_size = GuessUncompressedSize(src_size, orig_size);
+  std::unique_ptr<uint8_t, FxFreeDeleter> buf(FX_Alloc(uint8_t, buf_size + 1));
   FPDFAPI_FlateInput(context, src_buf, src_size);
-
-  if (src_size < kStepSize) {
-    // This is the old implementation.
-    uint8_t* cur_buf = guess_buf.get();
-    while (1) {
-      int32_t ret = FPDFAPI_FlateOutput(context, cur_buf, buf_size);
-      if (ret != Z_OK)
-        break;
-      int32_t avail_buf_size = FPDFAPI_FlateGetAvailOut(context);
-      if (avail_buf_size != 0)
-        break;
-
-      uint32_t old_size = guess_size;
-      guess_size += alloc_step;
-      if (guess_size < old_size || guess_size + 1 < guess_size) {
+  uint32_t out_size = 0;
+  while (1) {
+    if (out_size == buf_size) {
+      FX_SAFE_UINT32 new_size = buf_size;
+      new_size += std::max(buf_size / 2, kMinGrowSize);
+      new_size += 1;
+      if (!new_size.IsValid()) {
         FPDFAPI_FlateEnd(context);
         return;
       }
-
-      {
-        uint8_t* new_buf =
-            FX_Realloc(uint8_t, guess_buf.release(), guess_size + 1);
-        guess_buf.reset(new_buf);
-      }
-      guess_buf.get()[guess_size] = '\0';
-      cur_buf = guess_buf.get() + old_size;
-      buf_size = guess_size - old_size;
-    }
-    dest_size = FPDFAPI_FlateGetTotalOut(context);
-    offset = FPDFAPI_FlateGetTotalIn(context);
-    if (guess_size / 2 > dest_size) {
-      {
-        uint8_t* new_buf =
-            FX_Realloc(uint8_t, guess_buf.release(), dest_size + 1);
-        guess_buf.reset(new_buf);
-      }
-      guess_size = dest_size;
-      guess_buf.get()[guess_size] = '\0';
-    }
-    dest_buf = guess_buf.release();
-  } else {
-    std::vector<uint8_t*> result_tmp_bufs;
-    uint8_t* cur_buf = guess_buf.release();
-    while (1) {
-      int32_t ret = FPDFAPI_FlateOutput(context, cur_buf, buf_size);
-      int32_t avail_buf_size = FPDFAPI_FlateGetAvailOut(context);
-      if (ret != Z_OK) {
-        last_buf_size = buf_size - avail_buf_size;
-        result_tmp_bufs.push_back(cur_buf);
-        break;
-      }
-      if (avail_buf_size != 0) {
-        last_buf_size = buf_size - avail_buf_size;
-        result_tmp_bufs.push_back(cur_buf);
-        break;
-      }
-      result_tmp_bufs.push_back(cur_buf);
-      cur_buf = FX_Alloc(uint8_t, buf_size + 1);
-      cur_buf[buf_size] = '\0';
-    }
-    dest_size = FPDFAPI_FlateGetTotalOut(context);
-    offset = FPDFAPI_FlateGetTotalIn(context);
-    if (result_tmp_bufs.size() == 1) {
-      dest_buf = result_tmp_bufs[0];
-    } else {
-      uint8_t* result_buf = FX_Alloc(uint8_t, dest_size);
-      uint32_t result_pos = 0;
-      for (size_t i = 0; i < result_tmp_bufs.size(); i++) {
-        uint8_t* tmp_buf = result_tmp_bufs[i];
-        uint32_t tmp_buf_size = buf_size;
-        if (i == result_tmp_bufs.size() - 1) {
-          tmp_buf_size = last_buf_size;
-        }
-        FXSYS_memcpy(result_buf + result_pos, tmp_buf, tmp_buf_size);
-        result_pos += tmp_buf_size;
-        FX_Free(result_tmp_bufs[i]);
-      }
-      dest_buf = result_buf;
+      buf.reset(FX_Realloc(uint8_t, buf.release(), new_size.ValueOrDie()));
+      buf_size = new_size.ValueOrDie() - 1;
     }
+    uint32_t step = std::min(buf_size - out_size, kMaxOutputStep);
+    int32_t ret = FPDFAPI_FlateOutput(context, buf.get() + out_size, step);
+    out_size = FPDFAPI_FlateGetTotalOut(context);
+    if (ret != Z_OK || FPDFAPI_FlateGetAvailOut(context) != 0)
+      break;
   }
+  offset = FPDFAPI_FlateGetTotalIn(context);
   FPDFAPI_FlateEnd(context);
+  if (out_size < buf_size)
+    buf.reset(FX_Realloc(uint8_t, buf.release(), out_size + 1));
+  buf.get()[out_size] = '\0';
+  dest_size = out_size;
+  dest_buf = buf.release();
 }
 
 }  // namespace
@@ -848,11 +683,12 @@ uint32_t CCodec_FlateModule::FlateOrLZWDecode(bool bLZW,
 bool CCodec_FlateModule::Encode(const uint8_t* src_buf,
                                 uint32_t src_size,
                                 uint8_t** dest_buf,
-                                uint32_t* dest_size) {
+                                uint32_t* dest_size,
+                                int level) {
   *dest_size = src_size + src_size / 1000 + 12;
   *dest_buf = FX_Alloc(uint8_t, *dest_size);
   unsigned long temp_size = *dest_size;
-  if (!FPDFAPI_FlateCompress(*dest_buf, &temp_size, src_buf, src_size))
+  if (!FPDFAPI_FlateCompress(*dest_buf, &temp_size, src_buf, src_size, level))
     return false;
 
   *dest_size = (uint32_t)temp_size;
@@ -862,11 +698,12 @@ bool CCodec_FlateModule::Encode(const uint8_t* src_buf,
 bool CCodec_FlateModule::PngEncode(const uint8_t* src_buf,
                                    uint32_t src_size,
                                    uint8_t** dest_buf,
-                                   uint32_t* dest_size) {
+                                   uint32_t* dest_size,
+                                   int level) {
   uint8_t* pSrcBuf = FX_Alloc(uint8_t, src_size);
   FXSYS_memcpy(pSrcBuf, src_buf, src_size);
   PNG_PredictorEncode(&pSrcBuf, &src_size);
-  bool ret = Encode(pSrcBuf, src_size, dest_buf, dest_size);
+  bool ret = Encode(pSrcBuf, src_size, dest_buf, dest_size, level);
   FX_Free(pSrcBuf);
   return ret;
 }
@@ -6,6 +6,7 @@
 
 #include "core/fxcodec/codec/codec_int.h"
 #include "core/fxcodec/fx_codec.h"
+#include "core/fxcrt/cfx_mutex.h"
 #include "third_party/lcms2-2.6/include/lcms2.h"
 
 struct CLcmsCmm {
@@ -107,20 +108,24 @@ void* IccLib_CreateTransform(const unsigned char* pSrcProfileData,
     return nullptr;
   }
 
+  // The one-pixel cache inside a transform is not safe to share between
+  // threads, and ICC profiles are shared by all pages of a document.
+  const cmsUInt32Number dwFlags =
+      CFX_Mutex::IsThreadSafeMode() ? cmsFLAGS_NOCACHE : 0;
   cmsHTRANSFORM hTransform = nullptr;
   switch (dstCS) {
     case cmsSigGrayData:
       hTransform = cmsCreateTransform(srcProfile, srcFormat, dstProfile,
-                                      TYPE_GRAY_8, intent, 0);
+                                      TYPE_GRAY_8, intent, dwFlags);
       break;
     case cmsSigRgbData:
       hTransform = cmsCreateTransform(srcProfile, srcFormat, dstProfile,
-                                      TYPE_BGR_8, intent, 0);
+                                      TYPE_BGR_8, intent, dwFlags);
       break;
     case cmsSigCmykData:
       hTransform = cmsCreateTransform(
           srcProfile, srcFormat, dstProfile,
-          T_DOSWAP(dwDstFormat) ? TYPE_KYMC_8 : TYPE_CMYK_8, intent, 0);
+          T_DOSWAP(dwDstFormat) ? TYPE_KYMC_8 : TYPE_CMYK_8, intent, dwFlags);
       break;
     default:
       break;
@@ -6,7 +6,6 @@
 
 #include "core/fxcodec/codec/ccodec_jbig2module.h"
 
-#include <list>
 #include <memory>
 
 #include "core/fpdfapi/parser/cpdf_stream_acc.h"
@@ -16,14 +15,18 @@
 #include "core/fxcrt/fx_memory.h"
 #include "third_party/base/ptr_util.h"
 
-JBig2_DocumentContext::JBig2_DocumentContext() {}
+JBig2_DocumentContext::JBig2_DocumentContext(uint32_t nSymbolDictCacheBytes)
+    : m_SymbolDictCache(nSymbolDictCacheBytes) {}
 
 JBig2_DocumentContext::~JBig2_DocumentContext() {}
 
 JBig2_DocumentContext* GetJBig2DocumentContext(
-    std::unique_ptr<JBig2_DocumentContext>* pContextHolder) {
-  if (!pContextHolder->get())
-    *pContextHolder = pdfium::MakeUnique<JBig2_DocumentContext>();
+    std::unique_ptr<JBig2_DocumentContext>* pContextHolder,
+    uint32_t nSymbolDictCacheBytes) {
+  if (!pContextHolder->get()) {
+    *pContextHolder =
+        pdfium::MakeUnique<JBig2_DocumentContext>(nSymbolDictCacheBytes);
+  }
   return pContextHolder->get();
 }
 
@@ -38,6 +41,9 @@ CCodec_Jbig2Context::CCodec_Jbig2Context()
 
 CCodec_Jbig2Context::~CCodec_Jbig2Context() {}
 
+CCodec_Jbig2Module::CCodec_Jbig2Module()
+    : m_nSymbolDictCacheBytes(CJBig2_SymbolDictCache::kDefaultMaxBytes) {}
+
 CCodec_Jbig2Module::~CCodec_Jbig2Module() {}
 
 FXCODEC_STATUS CCodec_Jbig2Module::StartDecode(
@@ -54,7 +60,7 @@ FXCODEC_STATUS CCodec_Jbig2Module::StartDecode(
     return FXCODEC_STATUS_ERR_PARAMS;
 
   JBig2_DocumentContext* pJBig2DocumentContext =
-      GetJBig2DocumentContext(pContextHolder);
+      GetJBig2DocumentContext(pContextHolder, m_nSymbolDictCacheBytes);
   pJbig2Context->m_width = width;
   pJbig2Context->m_height = height;
   pJbig2Context->m_pSrcStream = src_stream;
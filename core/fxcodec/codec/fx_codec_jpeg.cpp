@@ -156,7 +156,8 @@ class CCodec_JpegDecoder : public CCodec_ScanlineDecoder {
               int width,
               int height,
               int nComps,
-              bool ColorTransform);
+              bool ColorTransform,
+              int scale_denom);
 
   // CCodec_ScanlineDecoder
   bool v_Rewind() override;
@@ -178,7 +179,7 @@ class CCodec_JpegDecoder : public CCodec_ScanlineDecoder {
   bool m_bJpegTransform;
 
  protected:
-  uint32_t m_nDefaultScaleDenom;
+  uint32_t m_nScaleDenom;
 };
 
 CCodec_JpegDecoder::CCodec_JpegDecoder() {
@@ -188,7 +189,7 @@ CCodec_JpegDecoder::CCodec_JpegDecoder() {
   FXSYS_memset(&cinfo, 0, sizeof(cinfo));
   FXSYS_memset(&jerr, 0, sizeof(jerr));
   FXSYS_memset(&src, 0, sizeof(src));
-  m_nDefaultScaleDenom = 1;
+  m_nScaleDenom = 1;
 }
 
 CCodec_JpegDecoder::~CCodec_JpegDecoder() {
@@ -227,9 +228,10 @@ bool CCodec_JpegDecoder::InitDecode() {
 
   m_OrigWidth = cinfo.image_width;
   m_OrigHeight = cinfo.image_height;
-  m_OutputWidth = m_OrigWidth;
-  m_OutputHeight = m_OrigHeight;
-  m_nDefaultScaleDenom = cinfo.scale_denom;
+  cinfo.scale_denom = m_nScaleDenom;
+  jpeg_calc_output_dimensions(&cinfo);
+  m_OutputWidth = cinfo.output_width;
+  m_OutputHeight = cinfo.output_height;
   return true;
 }
 
@@ -238,7 +240,8 @@ bool CCodec_JpegDecoder::Create(const uint8_t* src_buf,
                                 int width,
                                 int height,
                                 int nComps,
-                                bool ColorTransform) {
+                                bool ColorTransform,
+                                int scale_denom) {
   JpegScanSOI(&src_buf, &src_size);
   m_SrcBuf = src_buf;
   m_SrcSize = src_size;
@@ -260,6 +263,7 @@ bool CCodec_JpegDecoder::Create(const uint8_t* src_buf,
   }
   m_OutputWidth = m_OrigWidth = width;
   m_OutputHeight = m_OrigHeight = height;
+  m_nScaleDenom = scale_denom;
   if (!InitDecode())
     return false;
 
@@ -289,14 +293,13 @@ bool CCodec_JpegDecoder::v_Rewind() {
   if (setjmp(m_JmpBuf) == -1) {
     return false;
   }
-  cinfo.scale_denom = m_nDefaultScaleDenom;
-  m_OutputWidth = m_OrigWidth;
-  m_OutputHeight = m_OrigHeight;
+  cinfo.scale_denom = m_nScaleDenom;
   if (!jpeg_start_decompress(&cinfo)) {
     jpeg_destroy_decompress(&cinfo);
     return false;
   }
-  if ((int)cinfo.output_width > m_OrigWidth) {
+  if ((int)cinfo.output_width != m_OutputWidth ||
+      (int)cinfo.output_height != m_OutputHeight) {
     ASSERT(false);
     return false;
   }
@@ -322,13 +325,14 @@ std::unique_ptr<CCodec_ScanlineDecoder> CCodec_JpegModule::CreateDecoder(
     int width,
     int height,
     int nComps,
-    bool ColorTransform) {
+    bool ColorTransform,
+    int scale_denom) {
   if (!src_buf || src_size == 0)
     return nullptr;
 
   auto pDecoder = pdfium::MakeUnique<CCodec_JpegDecoder>();
   if (!pDecoder->Create(src_buf, src_size, width, height, nComps,
-                        ColorTransform)) {
+                        ColorTransform, scale_denom)) {
     return nullptr;
   }
   return std::move(pDecoder);
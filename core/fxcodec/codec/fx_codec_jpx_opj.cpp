@@ -26,6 +26,13 @@ static void fx_info_callback(const char* msg, void* client_data) {
   (void)client_data;
 }
 
+// The number of pixels |size| pixels round up to when halved |reduction|
+// times, as OpenJPEG sizes images decoded at a lower resolution.
+static uint32_t ReduceSize(uint32_t size, uint32_t reduction) {
+  return static_cast<uint32_t>(
+      ((static_cast<uint64_t>(size) + (1u << reduction) - 1) >> reduction));
+}
+
 OPJ_SIZE_T opj_read_from_memory(void* p_buffer,
                                 OPJ_SIZE_T nb_bytes,
                                 void* p_user_data) {
@@ -692,8 +699,11 @@ class CJPX_Decoder {
  public:
   explicit CJPX_Decoder(CPDF_ColorSpace* cs);
   ~CJPX_Decoder();
-  bool Init(const unsigned char* src_data, uint32_t src_size);
+  bool Init(const unsigned char* src_data,
+            uint32_t src_size,
+            uint32_t reduction);
   void GetInfo(uint32_t* width, uint32_t* height, uint32_t* components);
+  uint32_t GetReduction() const { return m_nReduction; }
   bool Decode(uint8_t* dest_buf,
               int pitch,
               const std::vector<uint8_t>& offsets);
@@ -705,10 +715,15 @@ class CJPX_Decoder {
   opj_codec_t* l_codec;
   opj_stream_t* l_stream;
   const CPDF_ColorSpace* const m_ColorSpace;
+  uint32_t m_nReduction;
 };
 
 CJPX_Decoder::CJPX_Decoder(CPDF_ColorSpace* cs)
-    : image(nullptr), l_codec(nullptr), l_stream(nullptr), m_ColorSpace(cs) {}
+    : image(nullptr),
+      l_codec(nullptr),
+      l_stream(nullptr),
+      m_ColorSpace(cs),
+      m_nReduction(0) {}
 
 CJPX_Decoder::~CJPX_Decoder() {
   if (l_codec) {
@@ -722,7 +737,9 @@ CJPX_Decoder::~CJPX_Decoder() {
   }
 }
 
-bool CJPX_Decoder::Init(const unsigned char* src_data, uint32_t src_size) {
+bool CJPX_Decoder::Init(const unsigned char* src_data,
+                        uint32_t src_size,
+                        uint32_t reduction) {
   static const unsigned char szJP2Header[] = {
       0x00, 0x00, 0x00, 0x0c, 0x6a, 0x50, 0x20, 0x20, 0x0d, 0x0a, 0x87, 0x0a};
   if (!src_data || src_size < sizeof(szJP2Header))
@@ -764,6 +781,29 @@ bool CJPX_Decoder::Init(const unsigned char* src_data, uint32_t src_size) {
   }
   image->pdfium_use_colorspace = !!m_ColorSpace;
 
+  // Leaving out the highest resolution levels halves the image each time.
+  // The codestream may have fewer levels than asked for.
+  m_nReduction = reduction;
+  while (m_nReduction > 0 &&
+         !opj_set_decoded_resolution_factor(l_codec, m_nReduction)) {
+    --m_nReduction;
+  }
+  if (reduction > 0 && m_nReduction == 0)
+    opj_set_decoded_resolution_factor(l_codec, 0);
+  if (m_nReduction > 0) {
+    const uint32_t kMaxArea = std::numeric_limits<int32_t>::max();
+    if (image->x1 > kMaxArea || image->y1 > kMaxArea)
+      return false;
+    // OpenJPEG only sizes the image for the reduction when given an area to
+    // decode, so give it the whole image.
+    for (uint32_t i = 0; i < image->numcomps; ++i)
+      image->comps[i].factor = m_nReduction;
+    parameters.DA_x0 = image->x0;
+    parameters.DA_y0 = image->y0;
+    parameters.DA_x1 = image->x1;
+    parameters.DA_y1 = image->y1;
+  }
+
   if (!parameters.nb_tile_to_decode) {
     if (!opj_set_decode_area(l_codec, image, parameters.DA_x0, parameters.DA_y0,
                              parameters.DA_x1, parameters.DA_y1)) {
@@ -808,21 +848,23 @@ bool CJPX_Decoder::Init(const unsigned char* src_data, uint32_t src_size) {
 void CJPX_Decoder::GetInfo(uint32_t* width,
                            uint32_t* height,
                            uint32_t* components) {
-  *width = (uint32_t)image->x1;
-  *height = (uint32_t)image->y1;
+  *width = ReduceSize(image->x1, m_nReduction);
+  *height = ReduceSize(image->y1, m_nReduction);
   *components = (uint32_t)image->numcomps;
 }
 
 bool CJPX_Decoder::Decode(uint8_t* dest_buf,
                           int pitch,
                           const std::vector<uint8_t>& offsets) {
-  if (image->comps[0].w != image->x1 || image->comps[0].h != image->y1)
+  if (image->comps[0].w != ReduceSize(image->x1, m_nReduction) ||
+      image->comps[0].h != ReduceSize(image->y1, m_nReduction)) {
     return false;
+  }
 
   if (pitch<(int)(image->comps[0].w * 8 * image->numcomps + 31)>> 5 << 2)
     return false;
 
-  FXSYS_memset(dest_buf, 0xff, image->y1 * pitch);
+  FXSYS_memset(dest_buf, 0xff, image->comps[0].h * pitch);
   std::vector<uint8_t*> channel_bufs(image->numcomps);
   std::vector<int> adjust_comps(image->numcomps);
   for (uint32_t i = 0; i < image->numcomps; i++) {
@@ -895,9 +937,11 @@ CCodec_JpxModule::~CCodec_JpxModule() {}
 
 CJPX_Decoder* CCodec_JpxModule::CreateDecoder(const uint8_t* src_buf,
                                               uint32_t src_size,
-                                              CPDF_ColorSpace* cs) {
+                                              CPDF_ColorSpace* cs,
+                                              uint32_t reduction) {
   std::unique_ptr<CJPX_Decoder> decoder(new CJPX_Decoder(cs));
-  return decoder->Init(src_buf, src_size) ? decoder.release() : nullptr;
+  return decoder->Init(src_buf, src_size, reduction) ? decoder.release()
+                                                     : nullptr;
 }
 
 void CCodec_JpxModule::GetImageInfo(CJPX_Decoder* pDecoder,
@@ -907,6 +951,10 @@ void CCodec_JpxModule::GetImageInfo(CJPX_Decoder* pDecoder,
   pDecoder->GetInfo(width, height, components);
 }
 
+uint32_t CCodec_JpxModule::GetReduction(CJPX_Decoder* pDecoder) {
+  return pDecoder->GetReduction();
+}
+
 bool CCodec_JpxModule::Decode(CJPX_Decoder* pDecoder,
                               uint8_t* dest_data,
                               int pitch,
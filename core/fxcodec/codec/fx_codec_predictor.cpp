@@ -0,0 +1,276 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcodec/codec/fx_codec_predictor.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "core/fxcrt/fx_cpu.h"
+#include "core/fxcrt/fx_system.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FXCODEC_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+enum PNGFilter {
+  kFilterNone = 0,
+  kFilterSub = 1,
+  kFilterUp = 2,
+  kFilterAverage = 3,
+  kFilterPaeth = 4,
+};
+
+uint8_t PaethPredictor(int a, int b, int c) {
+  int p = a + b - c;
+  int pa = FXSYS_abs(p - a);
+  int pb = FXSYS_abs(p - b);
+  int pc = FXSYS_abs(p - c);
+  if (pa <= pb && pa <= pc)
+    return (uint8_t)a;
+  if (pb <= pc)
+    return (uint8_t)b;
+  return (uint8_t)c;
+}
+
+// Reconstructs bytes [start, size) of a row whose first |start| bytes are
+// done already. Each filter has its own loop, with the bytes of the first
+// pixel, which have nothing to their left, peeled off.
+void UnfilterBytes(uint8_t tag,
+                   uint8_t* pDest,
+                   const uint8_t* pSrc,
+                   const uint8_t* pPrev,
+                   int start,
+                   int size,
+                   int bpp) {
+  int i = start;
+  int first_end = std::min(bpp, size);
+  switch (tag) {
+    case kFilterSub:
+      for (; i < first_end; ++i)
+        pDest[i] = pSrc[i];
+      for (; i < size; ++i)
+        pDest[i] = pSrc[i] + pDest[i - bpp];
+      break;
+    case kFilterUp:
+      for (; i < size; ++i)
+        pDest[i] = pSrc[i] + pPrev[i];
+      break;
+    case kFilterAverage:
+      for (; i < first_end; ++i)
+        pDest[i] = pSrc[i] + pPrev[i] / 2;
+      for (; i < size; ++i)
+        pDest[i] = pSrc[i] + (pDest[i - bpp] + pPrev[i]) / 2;
+      break;
+    case kFilterPaeth:
+      for (; i < first_end; ++i)
+        pDest[i] = pSrc[i] + PaethPredictor(0, pPrev[i], 0);
+      for (; i < size; ++i) {
+        pDest[i] = pSrc[i] +
+                   PaethPredictor(pDest[i - bpp], pPrev[i], pPrev[i - bpp]);
+      }
+      break;
+  }
+}
+
+#ifdef FXCODEC_HAVE_SSE2
+
+// Pixels are handled whole, one per vector, with their bytes in the low
+// lanes. They are read and written without touching the bytes past them.
+template <int kBpp>
+__m128i LoadPixel(const uint8_t* p);
+
+template <int kBpp>
+void StorePixel(uint8_t* p, __m128i v);
+
+template <>
+__m128i LoadPixel<4>(const uint8_t* p) {
+  int32_t pixel;
+  memcpy(&pixel, p, sizeof(pixel));
+  return _mm_cvtsi32_si128(pixel);
+}
+
+template <>
+void StorePixel<4>(uint8_t* p, __m128i v) {
+  int32_t pixel = _mm_cvtsi128_si32(v);
+  memcpy(p, &pixel, sizeof(pixel));
+}
+
+// Assembled in a register: going through memcpy() into a 4 byte variable
+// stalls on store forwarding.
+template <>
+__m128i LoadPixel<3>(const uint8_t* p) {
+  return _mm_cvtsi32_si128(p[0] | (p[1] << 8) | (p[2] << 16));
+}
+
+template <>
+void StorePixel<3>(uint8_t* p, __m128i v) {
+  uint32_t pixel = _mm_cvtsi128_si32(v);
+  p[0] = static_cast<uint8_t>(pixel);
+  p[1] = static_cast<uint8_t>(pixel >> 8);
+  p[2] = static_cast<uint8_t>(pixel >> 16);
+}
+
+__m128i Abs16(__m128i v) {
+  return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v));
+}
+
+__m128i Select(__m128i mask, __m128i a, __m128i b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+int UnfilterUpSSE2(uint8_t* pDest,
+                   const uint8_t* pSrc,
+                   const uint8_t* pPrev,
+                   int size) {
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPrev + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + i),
+                     _mm_add_epi8(x, b));
+  }
+  return i;
+}
+
+// The kernels below return how many bytes they reconstructed, a multiple of
+// |kBpp|; the scalar code does the rest.
+template <int kBpp>
+int UnfilterSubSSE2(uint8_t* pDest, const uint8_t* pSrc, int size) {
+  __m128i a = _mm_setzero_si128();
+  int i = 0;
+  for (; i + kBpp <= size; i += kBpp) {
+    a = _mm_add_epi8(a, LoadPixel<kBpp>(pSrc + i));
+    StorePixel<kBpp>(pDest + i, a);
+  }
+  return i;
+}
+
+template <int kBpp>
+int UnfilterAverageSSE2(uint8_t* pDest,
+                        const uint8_t* pSrc,
+                        const uint8_t* pPrev,
+                        int size) {
+  // _mm_avg_epu8() rounds up where the filter rounds down.
+  const __m128i kOne = _mm_set1_epi8(1);
+  __m128i a = _mm_setzero_si128();
+  int i = 0;
+  for (; i + kBpp <= size; i += kBpp) {
+    __m128i b = LoadPixel<kBpp>(pPrev + i);
+    __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+                               _mm_and_si128(_mm_xor_si128(a, b), kOne));
+    a = _mm_add_epi8(LoadPixel<kBpp>(pSrc + i), avg);
+    StorePixel<kBpp>(pDest + i, a);
+  }
+  return i;
+}
+
+template <int kBpp>
+int UnfilterPaethSSE2(uint8_t* pDest,
+                      const uint8_t* pSrc,
+                      const uint8_t* pPrev,
+                      int size) {
+  // Works on 16 bit lanes. With p = a + b - c as in PaethPredictor(), the
+  // distances |p - a|, |p - b| and |p - c| are |b - c|, |a - c| and
+  // |a + b - 2c|.
+  const __m128i kZero = _mm_setzero_si128();
+  const __m128i kLowByte = _mm_set1_epi16(0xff);
+  __m128i a = kZero;
+  __m128i c = kZero;
+  int i = 0;
+  for (; i + kBpp <= size; i += kBpp) {
+    __m128i b = _mm_unpacklo_epi8(LoadPixel<kBpp>(pPrev + i), kZero);
+    __m128i x = _mm_unpacklo_epi8(LoadPixel<kBpp>(pSrc + i), kZero);
+    __m128i pa = _mm_sub_epi16(b, c);
+    __m128i pb = _mm_sub_epi16(a, c);
+    __m128i pc = Abs16(_mm_add_epi16(pa, pb));
+    pa = Abs16(pa);
+    pb = Abs16(pb);
+    __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+    __m128i pred = Select(_mm_cmpeq_epi16(pb, smallest), b, c);
+    pred = Select(_mm_cmpeq_epi16(pa, smallest), a, pred);
+    a = _mm_and_si128(_mm_add_epi16(x, pred), kLowByte);
+    StorePixel<kBpp>(pDest + i, _mm_packus_epi16(a, a));
+    c = b;
+  }
+  return i;
+}
+
+template <int kBpp>
+int UnfilterPixelsSSE2(uint8_t tag,
+                       uint8_t* pDest,
+                       const uint8_t* pSrc,
+                       const uint8_t* pPrev,
+                       int size) {
+  switch (tag) {
+    case kFilterSub:
+      return UnfilterSubSSE2<kBpp>(pDest, pSrc, size);
+    case kFilterAverage:
+      return UnfilterAverageSSE2<kBpp>(pDest, pSrc, pPrev, size);
+    case kFilterPaeth:
+      return UnfilterPaethSSE2<kBpp>(pDest, pSrc, pPrev, size);
+  }
+  return 0;
+}
+
+int UnfilterSSE2(uint8_t tag,
+                 uint8_t* pDest,
+                 const uint8_t* pSrc,
+                 const uint8_t* pPrev,
+                 int size,
+                 int bpp) {
+  if (tag == kFilterUp)
+    return UnfilterUpSSE2(pDest, pSrc, pPrev, size);
+  if (bpp == 3)
+    return UnfilterPixelsSSE2<3>(tag, pDest, pSrc, pPrev, size);
+  if (bpp == 4)
+    return UnfilterPixelsSSE2<4>(tag, pDest, pSrc, pPrev, size);
+  return 0;
+}
+
+#endif  // FXCODEC_HAVE_SSE2
+
+}  // namespace
+
+void PNG_UnfilterRow(uint8_t tag,
+                     uint8_t* pDest,
+                     const uint8_t* pSrc,
+                     const uint8_t* pPrev,
+                     int size,
+                     int bytes_per_pixel) {
+  if (size <= 0)
+    return;
+
+  if (tag < kFilterSub || tag > kFilterPaeth) {
+    memmove(pDest, pSrc, size);
+    return;
+  }
+  if (!pPrev) {
+    // The row above counts as zeros, which makes Up a copy and Paeth the
+    // same as Sub.
+    if (tag == kFilterUp) {
+      memmove(pDest, pSrc, size);
+      return;
+    }
+    if (tag == kFilterAverage) {
+      for (int i = 0; i < size; ++i) {
+        uint8_t left = i >= bytes_per_pixel ? pDest[i - bytes_per_pixel] : 0;
+        pDest[i] = pSrc[i] + left / 2;
+      }
+      return;
+    }
+    tag = kFilterSub;
+  }
+  int done = 0;
+#ifdef FXCODEC_HAVE_SSE2
+  if (FXCPU_GetFeatures() & FXCPU_SSE2)
+    done = UnfilterSSE2(tag, pDest, pSrc, pPrev, size, bytes_per_pixel);
+#endif
+  UnfilterBytes(tag, pDest, pSrc, pPrev, done, size, bytes_per_pixel);
+}
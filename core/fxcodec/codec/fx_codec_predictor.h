@@ -0,0 +1,26 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXCODEC_CODEC_FX_CODEC_PREDICTOR_H_
+#define CORE_FXCODEC_CODEC_FX_CODEC_PREDICTOR_H_
+
+#include <stdint.h>
+
+// Undoes the PNG filter |tag| on one row: reconstructs |size| bytes into
+// |pDest| from the filtered bytes |pSrc|, given |pPrev|, the reconstructed
+// row above, or nullptr for the first row. The "left" byte of a filter is
+// |bytes_per_pixel| before the current one. Unknown tags copy the row as is.
+// |pDest| may be |pSrc|, but must not overlap |pPrev|.
+//
+// The Up filter, and the other filters on 3 and 4 byte pixels, which is what
+// RGB and CMYK images use, take an SSE2 path when FXCPU_GetFeatures()
+// reports it. Both paths give the same bytes.
+void PNG_UnfilterRow(uint8_t tag,
+                     uint8_t* pDest,
+                     const uint8_t* pSrc,
+                     const uint8_t* pPrev,
+                     int size,
+                     int bytes_per_pixel);
+
+#endif  // CORE_FXCODEC_CODEC_FX_CODEC_PREDICTOR_H_
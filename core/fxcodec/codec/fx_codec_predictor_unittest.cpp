@@ -0,0 +1,211 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcodec/codec/fx_codec_predictor.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "core/fxcodec/codec/ccodec_flatemodule.h"
+#include "core/fxcrt/fx_cpu.h"
+#include "core/fxcrt/fx_memory.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// The byte at a time code that PNG_UnfilterRow() replaced.
+void ReferenceUnfilterRow(uint8_t tag,
+                          uint8_t* pDest,
+                          const uint8_t* pSrc,
+                          const uint8_t* pPrev,
+                          int size,
+                          int bpp) {
+  for (int i = 0; i < size; ++i) {
+    int left = i >= bpp ? pDest[i - bpp] : 0;
+    int up = pPrev ? pPrev[i] : 0;
+    int upper_left = i >= bpp && pPrev ? pPrev[i - bpp] : 0;
+    switch (tag) {
+      case 1:
+        pDest[i] = pSrc[i] + left;
+        break;
+      case 2:
+        pDest[i] = pSrc[i] + up;
+        break;
+      case 3:
+        pDest[i] = pSrc[i] + (up + left) / 2;
+        break;
+      case 4: {
+        int p = left + up - upper_left;
+        int pa = abs(p - left);
+        int pb = abs(p - up);
+        int pc = abs(p - upper_left);
+        int pred = pa <= pb && pa <= pc ? left : pb <= pc ? up : upper_left;
+        pDest[i] = pSrc[i] + pred;
+        break;
+      }
+      default:
+        pDest[i] = pSrc[i];
+        break;
+    }
+  }
+}
+
+class ByteSource {
+ public:
+  ByteSource() : m_State(12345) {}
+
+  std::vector<uint8_t> Row(size_t size) {
+    std::vector<uint8_t> row(size);
+    for (uint8_t& byte : row) {
+      m_State = m_State * 1103515245 + 12345;
+      byte = static_cast<uint8_t>(m_State >> 16);
+    }
+    return row;
+  }
+
+ private:
+  uint32_t m_State;
+};
+
+class FeatureMask {
+ public:
+  explicit FeatureMask(uint32_t mask) { FXCPU_SetFeatureMaskForTesting(mask); }
+  ~FeatureMask() { FXCPU_SetFeatureMaskForTesting(~0u); }
+};
+
+}  // namespace
+
+TEST(fx_codec_predictor, MatchesReference) {
+  ByteSource source;
+  for (uint32_t mask : {0u, ~0u}) {
+    FeatureMask feature_mask(mask);
+    for (uint8_t tag = 0; tag <= 5; ++tag) {
+      for (int bpp = 1; bpp <= 8; ++bpp) {
+        for (int size = 0; size <= 70; ++size) {
+          std::vector<uint8_t> src = source.Row(size);
+          std::vector<uint8_t> prev = source.Row(size);
+          for (bool has_prev : {false, true}) {
+            const uint8_t* pPrev = has_prev ? prev.data() : nullptr;
+            std::vector<uint8_t> expected(size + 1, 0xcd);
+            std::vector<uint8_t> actual(size + 1, 0xcd);
+            ReferenceUnfilterRow(tag, expected.data(), src.data(), pPrev, size,
+                                 bpp);
+            PNG_UnfilterRow(tag, actual.data(), src.data(), pPrev, size, bpp);
+            EXPECT_EQ(expected, actual)
+                << "mask " << mask << " tag " << static_cast<int>(tag)
+                << " bpp " << bpp << " size " << size << " prev "
+                << has_prev;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(fx_codec_predictor, InPlaceSub) {
+  ByteSource source;
+  for (int bpp : {1, 3, 4}) {
+    std::vector<uint8_t> src = source.Row(101);
+    std::vector<uint8_t> expected(src.size());
+    ReferenceUnfilterRow(1, expected.data(), src.data(), nullptr, src.size(),
+                         bpp);
+    PNG_UnfilterRow(1, src.data(), src.data(), nullptr, src.size(), bpp);
+    EXPECT_EQ(expected, src) << "bpp " << bpp;
+  }
+}
+
+TEST(fx_codec_predictor, FlateDecodeWithPredictors) {
+  // A 17 pixel wide RGB image whose rows use each PNG filter in turn, with
+  // the last row cut short.
+  const int kColumns = 17;
+  const int kRowSize = kColumns * 3;
+  ByteSource source;
+  std::vector<uint8_t> predicted;
+  for (int row = 0; row < 12; ++row) {
+    predicted.push_back(row % 5);
+    std::vector<uint8_t> bytes = source.Row(kRowSize);
+    predicted.insert(predicted.end(), bytes.begin(), bytes.end());
+  }
+  predicted.resize(predicted.size() - 10);
+
+  CCodec_FlateModule module;
+  uint8_t* encoded = nullptr;
+  uint32_t encoded_size = 0;
+  ASSERT_TRUE(module.Encode(predicted.data(), predicted.size(), &encoded,
+                            &encoded_size));
+
+  std::vector<uint8_t> results[2];
+  for (int i = 0; i < 2; ++i) {
+    FeatureMask feature_mask(i ? ~0u : 0u);
+    uint8_t* decoded = nullptr;
+    uint32_t decoded_size = 0;
+    EXPECT_EQ(encoded_size,
+              module.FlateOrLZWDecode(false, encoded, encoded_size, false, 15,
+                                      3, 8, kColumns, 0, decoded,
+                                      decoded_size));
+    ASSERT_TRUE(decoded);
+    results[i].assign(decoded, decoded + decoded_size);
+    FX_Free(decoded);
+  }
+  FX_Free(encoded);
+
+  std::vector<uint8_t> expected(12 * kRowSize);
+  for (int row = 0; row < 12; ++row) {
+    const uint8_t* pSrc = predicted.data() + row * (kRowSize + 1);
+    int size = std::min<int>(kRowSize, predicted.data() + predicted.size() -
+                                           pSrc - 1);
+    uint8_t* pDest = expected.data() + row * kRowSize;
+    ReferenceUnfilterRow(pSrc[0], pDest, pSrc + 1,
+                         row ? pDest - kRowSize : nullptr, size, 3);
+  }
+  expected.resize(expected.size() - 10);
+  EXPECT_EQ(expected, results[0]);
+  EXPECT_EQ(expected, results[1]);
+}
+
+// Times undoing each filter on 3300 rows of 2500 RGB and CMYK pixels, about
+// a letter page at 300 dpi, best of five: with the byte at a time reference,
+// and with PNG_UnfilterRow() on the scalar and the SSE2 paths. Run with
+// --gtest_also_run_disabled_tests.
+TEST(fx_codec_predictor, DISABLED_Benchmark) {
+  const int kRows = 3300;
+  const int kPixels = 2500;
+  const char* const kFilters[] = {"Sub", "Up", "Avg", "Paeth"};
+  ByteSource source;
+  for (int bpp : {3, 4}) {
+    const int size = kPixels * bpp;
+    std::vector<uint8_t> src = source.Row(size * kRows);
+    std::vector<uint8_t> dest(src.size());
+    for (uint8_t tag = 1; tag <= 4; ++tag) {
+      double best[3] = {0, 0, 0};
+      for (int method = 0; method < 3; ++method) {
+        FeatureMask feature_mask(method == 2 ? ~0u : 0u);
+        for (int i = 0; i < 5; ++i) {
+          auto start = std::chrono::steady_clock::now();
+          for (int row = 0; row < kRows; ++row) {
+            uint8_t* pDest = dest.data() + row * size;
+            const uint8_t* pSrc = src.data() + row * size;
+            const uint8_t* pPrev = row ? pDest - size : nullptr;
+            if (method == 0)
+              ReferenceUnfilterRow(tag, pDest, pSrc, pPrev, size, bpp);
+            else
+              PNG_UnfilterRow(tag, pDest, pSrc, pPrev, size, bpp);
+          }
+          double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+          if (i == 0 || seconds < best[method])
+            best[method] = seconds;
+        }
+      }
+      printf("%-4s %-5s reference %6.1f ms  scalar %6.1f ms  sse2 %6.1f ms\n",
+             bpp == 3 ? "RGB" : "CMYK", kFilters[tag - 1], best[0] * 1000,
+             best[1] * 1000, best[2] * 1000);
+    }
+  }
+}
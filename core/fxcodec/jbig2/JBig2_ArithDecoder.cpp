@@ -6,19 +6,45 @@
 
 #include "core/fxcodec/jbig2/JBig2_ArithDecoder.h"
 
+#include <algorithm>
+
 #include "core/fxcodec/jbig2/JBig2_BitStream.h"
 #include "core/fxcrt/fx_basic.h"
 
 namespace {
 
-struct JBig2ArithQe {
-  unsigned int Qe;
-  unsigned int NMPS;
-  unsigned int NLPS;
-  unsigned int nSwitch;
-};
+const unsigned int kDefaultAValue = 0x8000;
+
+// Returns how many times |a|, which is less than kDefaultAValue and not 0,
+// has to be doubled to reach it.
+unsigned int CountRenormShifts(unsigned int a) {
+#if defined(__clang__) || defined(__GNUC__)
+  return __builtin_clz(a) - 16;
+#else
+  unsigned int n = 0;
+  for (; !(a & kDefaultAValue); a <<= 1)
+    ++n;
+  return n;
+#endif
+}
+
+int DecodeNMPS(JBig2ArithCtx* pCX, const JBig2ArithQe& qe) {
+  pCX->I = qe.NMPS;
+  return pCX->MPS;
+}
+
+int DecodeNLPS(JBig2ArithCtx* pCX, const JBig2ArithQe& qe) {
+  // TODO(thestig): |D|, |MPS| and friends probably should be booleans.
+  int D = 1 - pCX->MPS;
+  if (qe.nSwitch == 1)
+    pCX->MPS = 1 - pCX->MPS;
+  pCX->I = qe.NLPS;
+  return D;
+}
+
+}  // namespace
 
-const JBig2ArithQe kQeTable[] = {
+const JBig2ArithQe CJBig2_ArithDecoder::kQeTable[] = {
     // Stupid hack to keep clang-format from reformatting this badly.
     {0x5601, 1, 1, 1},   {0x3401, 2, 6, 0},   {0x1801, 3, 9, 0},
     {0x0AC1, 4, 12, 0},  {0x0521, 5, 29, 0},  {0x0221, 38, 33, 0},
@@ -37,24 +63,6 @@ const JBig2ArithQe kQeTable[] = {
     {0x0015, 43, 40, 0}, {0x0009, 44, 41, 0}, {0x0005, 45, 42, 0},
     {0x0001, 45, 43, 0}, {0x5601, 46, 46, 0}};
 
-const unsigned int kDefaultAValue = 0x8000;
-
-int DecodeNMPS(JBig2ArithCtx* pCX, const JBig2ArithQe& qe) {
-  pCX->I = qe.NMPS;
-  return pCX->MPS;
-}
-
-int DecodeNLPS(JBig2ArithCtx* pCX, const JBig2ArithQe& qe) {
-  // TODO(thestig): |D|, |MPS| and friends probably should be booleans.
-  int D = 1 - pCX->MPS;
-  if (qe.nSwitch == 1)
-    pCX->MPS = 1 - pCX->MPS;
-  pCX->I = qe.NLPS;
-  return D;
-}
-
-}  // namespace
-
 CJBig2_ArithDecoder::CJBig2_ArithDecoder(CJBig2_BitStream* pStream)
     : m_pStream(pStream) {
   m_B = m_pStream->getCurByte_arith();
@@ -67,7 +75,7 @@ CJBig2_ArithDecoder::CJBig2_ArithDecoder(CJBig2_BitStream* pStream)
 
 CJBig2_ArithDecoder::~CJBig2_ArithDecoder() {}
 
-int CJBig2_ArithDecoder::DECODE(JBig2ArithCtx* pCX) {
+int CJBig2_ArithDecoder::DecodeSlow(JBig2ArithCtx* pCX) {
   if (!pCX || pCX->I >= FX_ArraySize(kQeTable))
     return 0;
 
@@ -110,11 +118,13 @@ void CJBig2_ArithDecoder::BYTEIN() {
 }
 
 void CJBig2_ArithDecoder::ReadValueA() {
+  // Shifts as many bits at once as |m_C| has left before the next byte.
   do {
     if (m_CT == 0)
       BYTEIN();
-    m_A <<= 1;
-    m_C <<= 1;
-    --m_CT;
+    unsigned int shift = std::min(m_CT, CountRenormShifts(m_A));
+    m_A <<= shift;
+    m_C <<= shift;
+    m_CT -= shift;
   } while ((m_A & kDefaultAValue) == 0);
 }
@@ -7,6 +7,8 @@
 #ifndef CORE_FXCODEC_JBIG2_JBIG2_ARITHDECODER_H_
 #define CORE_FXCODEC_JBIG2_JBIG2_ARITHDECODER_H_
 
+#include "core/fxcrt/fx_memory.h"
+
 class CJBig2_BitStream;
 
 struct JBig2ArithCtx {
@@ -16,15 +18,36 @@ struct JBig2ArithCtx {
   unsigned int I;
 };
 
+struct JBig2ArithQe {
+  unsigned int Qe;
+  unsigned int NMPS;
+  unsigned int NLPS;
+  unsigned int nSwitch;
+};
+
 class CJBig2_ArithDecoder {
  public:
   explicit CJBig2_ArithDecoder(CJBig2_BitStream* pStream);
 
   ~CJBig2_ArithDecoder();
 
-  int DECODE(JBig2ArithCtx* pCX);
+  // Most decisions are the more probable symbol without renormalization,
+  // which is handled inline; everything else goes to DecodeSlow().
+  int DECODE(JBig2ArithCtx* pCX) {
+    if (pCX && pCX->I < FX_ArraySize(kQeTable)) {
+      unsigned int A = m_A - kQeTable[pCX->I].Qe;
+      if ((A & 0x8000) && (m_C >> 16) < A) {
+        m_A = A;
+        return pCX->MPS;
+      }
+    }
+    return DecodeSlow(pCX);
+  }
 
  private:
+  static const JBig2ArithQe kQeTable[47];
+
+  int DecodeSlow(JBig2ArithCtx* pCX);
   void BYTEIN();
   void ReadValueA();
 
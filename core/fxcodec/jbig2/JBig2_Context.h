@@ -7,7 +7,6 @@
 #ifndef CORE_FXCODEC_JBIG2_JBIG2_CONTEXT_H_
 #define CORE_FXCODEC_JBIG2_JBIG2_CONTEXT_H_
 
-#include <list>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -19,14 +18,10 @@
 
 class CJBig2_ArithDecoder;
 class CJBig2_GRDProc;
+class CJBig2_SymbolDictCache;
 class CPDF_StreamAcc;
 class IFX_Pause;
 
-// Cache is keyed by the ObjNum of a stream and an index within the stream.
-using CJBig2_CacheKey = std::pair<uint32_t, uint32_t>;
-using CJBig2_CachePair =
-    std::pair<CJBig2_CacheKey, std::unique_ptr<CJBig2_SymbolDict>>;
-
 #define JBIG2_SUCCESS 0
 #define JBIG2_FAILED -1
 #define JBIG2_ERROR_TOO_SHORT -2
@@ -42,7 +37,7 @@ class CJBig2_Context {
  public:
   CJBig2_Context(CPDF_StreamAcc* pGlobalStream,
                  CPDF_StreamAcc* pSrcStream,
-                 std::list<CJBig2_CachePair>* pSymbolDictCache,
+                 CJBig2_SymbolDictCache* pSymbolDictCache,
                  IFX_Pause* pPause,
                  bool bIsGlobal);
   ~CJBig2_Context();
@@ -103,7 +98,7 @@ class CJBig2_Context {
   std::unique_ptr<CJBig2_Segment> m_pSegment;
   uint32_t m_dwOffset;
   JBig2RegionInfo m_ri;
-  std::list<CJBig2_CachePair>* const m_pSymbolDictCache;
+  CJBig2_SymbolDictCache* const m_pSymbolDictCache;
   bool m_bIsGlobal;
 };
 
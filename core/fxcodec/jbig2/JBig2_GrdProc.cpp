@@ -6,6 +6,7 @@
 
 #include "core/fxcodec/jbig2/JBig2_GrdProc.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "core/fxcodec/fx_codec.h"
@@ -13,6 +14,39 @@
 #include "core/fxcodec/jbig2/JBig2_BitStream.h"
 #include "core/fxcodec/jbig2/JBig2_Image.h"
 
+namespace {
+
+// Where the pixels of a generic region template go in its context, apart
+// from the AT pixels. The pixels on each of the two lines above are a run
+// ending |nRightN| pixels right of the one being decoded, and put at
+// |nShiftN|. The pixels left of it on its own line are the lowest bits.
+struct GenericTemplate {
+  uint32_t nCurBits;
+  uint32_t nRight1;
+  uint32_t nBits1;
+  uint32_t nShift1;
+  uint32_t nRight2;
+  uint32_t nBits2;
+  uint32_t nShift2;
+  uint32_t nATPixels;
+  uint32_t ATShift[4];
+};
+
+const GenericTemplate kGenericTemplates[] = {
+    {4, 2, 5, 5, 1, 3, 12, 4, {4, 10, 11, 15}},
+    {3, 2, 5, 4, 2, 4, 9, 1, {3}},
+    {2, 1, 4, 3, 1, 3, 7, 1, {2}},
+    {4, 1, 5, 5, 0, 0, 0, 1, {4}},
+};
+
+const uint32_t kTPGDContext[] = {0x9b25, 0x0795, 0x00e5, 0x0195};
+
+const GenericTemplate& GetGenericTemplate(uint8_t GBTEMPLATE) {
+  return kGenericTemplates[std::min<uint8_t>(GBTEMPLATE, 3)];
+}
+
+}  // namespace
+
 CJBig2_GRDProc::CJBig2_GRDProc()
     : m_loopIndex(0),
       m_pLine(nullptr),
@@ -39,6 +73,93 @@ bool CJBig2_GRDProc::UseTemplate23Opt3() const {
   return (GBAT[0] == 2) && (GBAT[1] == -1);
 }
 
+bool CJBig2_GRDProc::UseGenericOpt() const {
+  if (USESKIP)
+    return false;
+
+  // Only AT pixels decoded before the current one can be read from the
+  // image as it is being decoded.
+  const GenericTemplate& t = GetGenericTemplate(GBTEMPLATE);
+  for (uint32_t i = 0; i < t.nATPixels; ++i) {
+    if (GBAT[2 * i + 1] > 0 || (GBAT[2 * i + 1] == 0 && GBAT[2 * i] >= 0))
+      return false;
+  }
+  return true;
+}
+
+void CJBig2_GRDProc::decode_Arith_Generic_Line(
+    CJBig2_Image* pImage,
+    uint32_t h,
+    CJBig2_ArithDecoder* pArithDecoder,
+    JBig2ArithCtx* gbContext) {
+  // A copy, so that the compiler knows writing the line does not change it.
+  const GenericTemplate t = GetGenericTemplate(GBTEMPLATE);
+  const uint32_t nStride = pImage->stride();
+  uint8_t* pLine = pImage->m_pData + h * nStride;
+  const uint8_t* pLine1 = h > 0 ? pLine - nStride : nullptr;
+  const uint8_t* pLine2 = h > 1 && t.nBits2 ? pLine - 2 * nStride : nullptr;
+
+  // The lines above are read a byte ahead into |line1| and |line2|, so
+  // that the pixel being decoded is at bit 8 + k. The AT pixels are read
+  // the same way from the two bytes they move through while a byte is
+  // decoded, except for those shortly before on the current line, which
+  // are taken from the pixels decoded last in |line3|.
+  const uint8_t* pATLine[4];
+  int32_t ATByte[4];
+  uint32_t ATBit[4];
+  bool bATFromLine3[4];
+  uint32_t ATWord[4] = {};
+  for (uint32_t i = 0; i < t.nATPixels; ++i) {
+    int32_t dx = GBAT[2 * i];
+    int32_t y = static_cast<int32_t>(h) + GBAT[2 * i + 1];
+    bATFromLine3[i] = y == static_cast<int32_t>(h) && dx >= -32;
+    pATLine[i] = y >= 0 ? pImage->m_pData + y * nStride : nullptr;
+    ATByte[i] = dx >> 3;
+    ATBit[i] = bATFromLine3[i] ? -dx - 1 : 8 - (dx & 7);
+  }
+
+  const uint32_t nCurMask = (1 << t.nCurBits) - 1;
+  const uint32_t nMask1 = (1 << t.nBits1) - 1;
+  const uint32_t nMask2 = (1 << t.nBits2) - 1;
+  const uint32_t nLineBytes = (GBW + 7) >> 3;
+  uint32_t line1 = pLine1 ? pLine1[0] : 0;
+  uint32_t line2 = pLine2 ? pLine2[0] : 0;
+  uint32_t line3 = 0;
+  uint32_t w = 0;
+  for (uint32_t cc = 0; cc < nLineBytes; ++cc) {
+    line1 <<= 8;
+    line2 <<= 8;
+    if (cc + 1 < nLineBytes) {
+      if (pLine1)
+        line1 |= pLine1[cc + 1];
+      if (pLine2)
+        line2 |= pLine2[cc + 1];
+    }
+    for (uint32_t i = 0; i < t.nATPixels; ++i) {
+      if (bATFromLine3[i] || !pATLine[i])
+        continue;
+      uint32_t nByte = cc + ATByte[i];
+      ATWord[i] = (nByte < nLineBytes ? pATLine[i][nByte] << 8 : 0) |
+                  (nByte + 1 < nLineBytes ? pATLine[i][nByte + 1] : 0);
+    }
+    int32_t kEnd = 8 - static_cast<int32_t>(std::min<uint32_t>(GBW - w, 8));
+    for (int32_t k = 7; k >= kEnd; --k, ++w) {
+      uint32_t CONTEXT =
+          (line3 & nCurMask) |
+          (((line1 >> (k + 8 - t.nRight1)) & nMask1) << t.nShift1) |
+          (((line2 >> (k + 8 - t.nRight2)) & nMask2) << t.nShift2);
+      for (uint32_t i = 0; i < t.nATPixels; ++i) {
+        uint32_t bits = bATFromLine3[i] ? line3 : ATWord[i] >> k;
+        CONTEXT |= ((bits >> ATBit[i]) & 1) << t.ATShift[i];
+      }
+      int bVal = pArithDecoder->DECODE(&gbContext[CONTEXT]);
+      if (bVal)
+        pLine[cc] |= 1 << k;
+      line3 = (line3 << 1) | bVal;
+    }
+  }
+}
+
 CJBig2_Image* CJBig2_GRDProc::decode_Arith(CJBig2_ArithDecoder* pArithDecoder,
                                            JBig2ArithCtx* gbContext) {
   if (GBW == 0 || GBH == 0)
@@ -47,21 +168,51 @@ CJBig2_Image* CJBig2_GRDProc::decode_Arith(CJBig2_ArithDecoder* pArithDecoder,
   if (GBTEMPLATE == 0) {
     if (UseTemplate0Opt3())
       return decode_Arith_Template0_opt3(pArithDecoder, gbContext);
+    if (UseGenericOpt())
+      return decode_Arith_Generic_opt(pArithDecoder, gbContext);
     return decode_Arith_Template0_unopt(pArithDecoder, gbContext);
   } else if (GBTEMPLATE == 1) {
     if (UseTemplate1Opt3())
       return decode_Arith_Template1_opt3(pArithDecoder, gbContext);
+    if (UseGenericOpt())
+      return decode_Arith_Generic_opt(pArithDecoder, gbContext);
     return decode_Arith_Template1_unopt(pArithDecoder, gbContext);
   } else if (GBTEMPLATE == 2) {
     if (UseTemplate23Opt3())
       return decode_Arith_Template2_opt3(pArithDecoder, gbContext);
+    if (UseGenericOpt())
+      return decode_Arith_Generic_opt(pArithDecoder, gbContext);
     return decode_Arith_Template2_unopt(pArithDecoder, gbContext);
   } else {
     if (UseTemplate23Opt3())
       return decode_Arith_Template3_opt3(pArithDecoder, gbContext);
+    if (UseGenericOpt())
+      return decode_Arith_Generic_opt(pArithDecoder, gbContext);
     return decode_Arith_Template3_unopt(pArithDecoder, gbContext);
   }
 }
+
+CJBig2_Image* CJBig2_GRDProc::decode_Arith_Generic_opt(
+    CJBig2_ArithDecoder* pArithDecoder,
+    JBig2ArithCtx* gbContext) {
+  std::unique_ptr<CJBig2_Image> GBREG(new CJBig2_Image(GBW, GBH));
+  if (!GBREG->m_pData)
+    return nullptr;
+
+  GBREG->fill(0);
+  const uint32_t nTPGDContext = kTPGDContext[std::min<uint8_t>(GBTEMPLATE, 3)];
+  int LTP = 0;
+  for (uint32_t h = 0; h < GBH; h++) {
+    if (TPGDON)
+      LTP = LTP ^ pArithDecoder->DECODE(&gbContext[nTPGDContext]);
+    if (LTP)
+      GBREG->copyLine(h, h - 1);
+    else
+      decode_Arith_Generic_Line(GBREG.get(), h, pArithDecoder, gbContext);
+  }
+  return GBREG.release();
+}
+
 CJBig2_Image* CJBig2_GRDProc::decode_Arith_Template0_opt3(
     CJBig2_ArithDecoder* pArithDecoder,
     JBig2ArithCtx* gbContext) {
@@ -572,6 +723,9 @@ FXCODEC_STATUS CJBig2_GRDProc::decode_Arith(IFX_Pause* pPause) {
     if (UseTemplate0Opt3()) {
       m_ProssiveStatus = decode_Arith_Template0_opt3(pImage, m_pArithDecoder,
                                                      m_gbContext, pPause);
+    } else if (UseGenericOpt()) {
+      m_ProssiveStatus = decode_Arith_Generic_opt(pImage, m_pArithDecoder,
+                                                  m_gbContext, pPause);
     } else {
       m_ProssiveStatus = decode_Arith_Template0_unopt(pImage, m_pArithDecoder,
                                                       m_gbContext, pPause);
@@ -580,6 +734,9 @@ FXCODEC_STATUS CJBig2_GRDProc::decode_Arith(IFX_Pause* pPause) {
     if (UseTemplate1Opt3()) {
       m_ProssiveStatus = decode_Arith_Template1_opt3(pImage, m_pArithDecoder,
                                                      m_gbContext, pPause);
+    } else if (UseGenericOpt()) {
+      m_ProssiveStatus = decode_Arith_Generic_opt(pImage, m_pArithDecoder,
+                                                  m_gbContext, pPause);
     } else {
       m_ProssiveStatus = decode_Arith_Template1_unopt(pImage, m_pArithDecoder,
                                                       m_gbContext, pPause);
@@ -588,6 +745,9 @@ FXCODEC_STATUS CJBig2_GRDProc::decode_Arith(IFX_Pause* pPause) {
     if (UseTemplate23Opt3()) {
       m_ProssiveStatus = decode_Arith_Template2_opt3(pImage, m_pArithDecoder,
                                                      m_gbContext, pPause);
+    } else if (UseGenericOpt()) {
+      m_ProssiveStatus = decode_Arith_Generic_opt(pImage, m_pArithDecoder,
+                                                  m_gbContext, pPause);
     } else {
       m_ProssiveStatus = decode_Arith_Template2_unopt(pImage, m_pArithDecoder,
                                                       m_gbContext, pPause);
@@ -596,6 +756,9 @@ FXCODEC_STATUS CJBig2_GRDProc::decode_Arith(IFX_Pause* pPause) {
     if (UseTemplate23Opt3()) {
       m_ProssiveStatus = decode_Arith_Template3_opt3(pImage, m_pArithDecoder,
                                                      m_gbContext, pPause);
+    } else if (UseGenericOpt()) {
+      m_ProssiveStatus = decode_Arith_Generic_opt(pImage, m_pArithDecoder,
+                                                  m_gbContext, pPause);
     } else {
       m_ProssiveStatus = decode_Arith_Template3_unopt(pImage, m_pArithDecoder,
                                                       m_gbContext, pPause);
@@ -645,6 +808,31 @@ FXCODEC_STATUS CJBig2_GRDProc::Continue_decode(IFX_Pause* pPause) {
   return decode_Arith(pPause);
 }
 
+FXCODEC_STATUS CJBig2_GRDProc::decode_Arith_Generic_opt(
+    CJBig2_Image* pImage,
+    CJBig2_ArithDecoder* pArithDecoder,
+    JBig2ArithCtx* gbContext,
+    IFX_Pause* pPause) {
+  const uint32_t nTPGDContext = kTPGDContext[std::min<uint8_t>(GBTEMPLATE, 3)];
+  for (; m_loopIndex < GBH; m_loopIndex++) {
+    if (TPGDON)
+      m_LTP = m_LTP ^ pArithDecoder->DECODE(&gbContext[nTPGDContext]);
+    if (m_LTP) {
+      pImage->copyLine(m_loopIndex, m_loopIndex - 1);
+    } else {
+      decode_Arith_Generic_Line(pImage, m_loopIndex, pArithDecoder,
+                                gbContext);
+    }
+    if (pPause && pPause->NeedToPauseNow()) {
+      m_loopIndex++;
+      m_ProssiveStatus = FXCODEC_STATUS_DECODE_TOBECONTINUE;
+      return FXCODEC_STATUS_DECODE_TOBECONTINUE;
+    }
+  }
+  m_ProssiveStatus = FXCODEC_STATUS_DECODE_FINISH;
+  return FXCODEC_STATUS_DECODE_FINISH;
+}
+
 FXCODEC_STATUS CJBig2_GRDProc::decode_Arith_Template0_opt3(
     CJBig2_Image* pImage,
     CJBig2_ArithDecoder* pArithDecoder,
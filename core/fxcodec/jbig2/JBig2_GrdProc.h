@@ -47,8 +47,20 @@ class CJBig2_GRDProc {
   bool UseTemplate0Opt3() const;
   bool UseTemplate1Opt3() const;
   bool UseTemplate23Opt3() const;
+  bool UseGenericOpt() const;
+
+  // Decodes line |h| of |pImage| for any template, reading the AT pixels
+  // wherever they are. Needs UseGenericOpt() and |pImage| to be zeroed.
+  void decode_Arith_Generic_Line(CJBig2_Image* pImage,
+                                 uint32_t h,
+                                 CJBig2_ArithDecoder* pArithDecoder,
+                                 JBig2ArithCtx* gbContext);
 
   FXCODEC_STATUS decode_Arith(IFX_Pause* pPause);
+  FXCODEC_STATUS decode_Arith_Generic_opt(CJBig2_Image* pImage,
+                                          CJBig2_ArithDecoder* pArithDecoder,
+                                          JBig2ArithCtx* gbContext,
+                                          IFX_Pause* pPause);
   FXCODEC_STATUS decode_Arith_Template0_opt3(CJBig2_Image* pImage,
                                              CJBig2_ArithDecoder* pArithDecoder,
                                              JBig2ArithCtx* gbContext,
@@ -85,6 +97,9 @@ class CJBig2_GRDProc {
       CJBig2_ArithDecoder* pArithDecoder,
       JBig2ArithCtx* gbContext,
       IFX_Pause* pPause);
+  CJBig2_Image* decode_Arith_Generic_opt(CJBig2_ArithDecoder* pArithDecoder,
+                                         JBig2ArithCtx* gbContext);
+
   CJBig2_Image* decode_Arith_Template0_opt3(CJBig2_ArithDecoder* pArithDecoder,
                                             JBig2ArithCtx* gbContext);
 
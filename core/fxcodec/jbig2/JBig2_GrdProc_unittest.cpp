@@ -0,0 +1,362 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcodec/jbig2/JBig2_GrdProc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/parser/cpdf_stream_acc.h"
+#include "core/fxcodec/jbig2/JBig2_ArithDecoder.h"
+#include "core/fxcodec/jbig2/JBig2_BitStream.h"
+#include "core/fxcodec/jbig2/JBig2_Image.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+struct Qe {
+  uint32_t Qe;
+  uint8_t NMPS;
+  uint8_t NLPS;
+  uint8_t nSwitch;
+};
+
+const Qe kQeTable[] = {
+    {0x5601, 1, 1, 1},   {0x3401, 2, 6, 0},   {0x1801, 3, 9, 0},
+    {0x0AC1, 4, 12, 0},  {0x0521, 5, 29, 0},  {0x0221, 38, 33, 0},
+    {0x5601, 7, 6, 1},   {0x5401, 8, 14, 0},  {0x4801, 9, 14, 0},
+    {0x3801, 10, 14, 0}, {0x3001, 11, 17, 0}, {0x2401, 12, 18, 0},
+    {0x1C01, 13, 20, 0}, {0x1601, 29, 21, 0}, {0x5601, 15, 14, 1},
+    {0x5401, 16, 14, 0}, {0x5101, 17, 15, 0}, {0x4801, 18, 16, 0},
+    {0x3801, 19, 17, 0}, {0x3401, 20, 18, 0}, {0x3001, 21, 19, 0},
+    {0x2801, 22, 19, 0}, {0x2401, 23, 20, 0}, {0x2201, 24, 21, 0},
+    {0x1C01, 25, 22, 0}, {0x1801, 26, 23, 0}, {0x1601, 27, 24, 0},
+    {0x1401, 28, 25, 0}, {0x1201, 29, 26, 0}, {0x1101, 30, 27, 0},
+    {0x0AC1, 31, 28, 0}, {0x09C1, 32, 29, 0}, {0x08A1, 33, 30, 0},
+    {0x0521, 34, 31, 0}, {0x0441, 35, 32, 0}, {0x02A1, 36, 33, 0},
+    {0x0221, 37, 34, 0}, {0x0141, 38, 35, 0}, {0x0111, 39, 36, 0},
+    {0x0085, 40, 37, 0}, {0x0049, 41, 38, 0}, {0x0025, 42, 39, 0},
+    {0x0015, 43, 40, 0}, {0x0009, 44, 41, 0}, {0x0005, 45, 42, 0},
+    {0x0001, 45, 43, 0}, {0x5601, 46, 46, 0}};
+
+// The MQ encoder of T.88 annex E.2, to make test data from images.
+class ArithEncoder {
+ public:
+  // Starts with a byte that is not part of the output, as BP starts out
+  // pointing before the buffer.
+  ArithEncoder() : m_A(0x8000), m_C(0), m_CT(12), m_Out(1, 0) {}
+
+  void Encode(JBig2ArithCtx* pCX, int D) {
+    const Qe& qe = kQeTable[pCX->I];
+    m_A -= qe.Qe;
+    if (static_cast<uint32_t>(D) == pCX->MPS) {
+      if (m_A & 0x8000) {
+        m_C += qe.Qe;
+        return;
+      }
+      if (m_A < qe.Qe)
+        m_A = qe.Qe;
+      else
+        m_C += qe.Qe;
+      pCX->I = qe.NMPS;
+    } else {
+      if (m_A < qe.Qe)
+        m_C += qe.Qe;
+      else
+        m_A = qe.Qe;
+      if (qe.nSwitch)
+        pCX->MPS = 1 - pCX->MPS;
+      pCX->I = qe.NLPS;
+    }
+    do {
+      m_A <<= 1;
+      m_C <<= 1;
+      if (--m_CT == 0)
+        ByteOut();
+    } while (!(m_A & 0x8000));
+  }
+
+  std::vector<uint8_t> Finish() {
+    uint32_t temp = m_C + m_A;
+    m_C |= 0xffff;
+    if (m_C >= temp)
+      m_C -= 0x8000;
+    m_C <<= m_CT;
+    ByteOut();
+    m_C <<= m_CT;
+    ByteOut();
+    if (m_Out.back() != 0xff)
+      m_Out.push_back(0xff);
+    m_Out.push_back(0xac);
+    return std::vector<uint8_t>(m_Out.begin() + 1, m_Out.end());
+  }
+
+ private:
+  void ByteOut() {
+    if (m_Out.back() != 0xff) {
+      if (m_C >= 0x8000000) {
+        ++m_Out.back();
+        if (m_Out.back() == 0xff)
+          m_C &= 0x7ffffff;
+      }
+    }
+    if (m_Out.back() == 0xff) {
+      m_Out.push_back(static_cast<uint8_t>(m_C >> 20));
+      m_C &= 0xfffff;
+      m_CT = 7;
+    } else {
+      m_Out.push_back(static_cast<uint8_t>(m_C >> 19));
+      m_C &= 0x7ffff;
+      m_CT = 8;
+    }
+  }
+
+  uint32_t m_A;
+  uint32_t m_C;
+  uint32_t m_CT;
+  std::vector<uint8_t> m_Out;
+};
+
+const int8_t kDefaultAT[4][8] = {{3, -1, -3, -1, 2, -2, -2, -2},
+                                 {3, -1},
+                                 {2, -1},
+                                 {2, -1}};
+const uint32_t kContextBits[] = {16, 13, 10, 10};
+const uint32_t kTPGDContext[] = {0x9b25, 0x0795, 0x00e5, 0x0195};
+
+// |count| pixels of line |y| ending at |x|, with the one at |x| lowest.
+uint32_t Pixels(CJBig2_Image* pImage, int32_t x, int32_t y, int count) {
+  uint32_t result = 0;
+  for (int i = 0; i < count; ++i)
+    result |= pImage->getPixel(x - i, y) << i;
+  return result;
+}
+
+// The context of pixel (x, y) as in figures 3 to 6 of T.88.
+uint32_t GetContext(CJBig2_Image* pImage,
+                    int tmpl,
+                    const int8_t* at,
+                    int32_t x,
+                    int32_t y) {
+  auto AT = [pImage, at, x, y](int i) {
+    return pImage->getPixel(x + at[2 * i], y + at[2 * i + 1]);
+  };
+  switch (tmpl) {
+    case 0:
+      return Pixels(pImage, x - 1, y, 4) | AT(0) << 4 |
+             Pixels(pImage, x + 2, y - 1, 5) << 5 | AT(1) << 10 |
+             AT(2) << 11 | Pixels(pImage, x + 1, y - 2, 3) << 12 | AT(3) << 15;
+    case 1:
+      return Pixels(pImage, x - 1, y, 3) | AT(0) << 3 |
+             Pixels(pImage, x + 2, y - 1, 5) << 4 |
+             Pixels(pImage, x + 2, y - 2, 4) << 9;
+    case 2:
+      return Pixels(pImage, x - 1, y, 2) | AT(0) << 2 |
+             Pixels(pImage, x + 1, y - 1, 4) << 3 |
+             Pixels(pImage, x + 1, y - 2, 3) << 7;
+    default:
+      return Pixels(pImage, x - 1, y, 4) | AT(0) << 4 |
+             Pixels(pImage, x + 1, y - 1, 5) << 5;
+  }
+}
+
+std::vector<uint8_t> EncodeGeneric(CJBig2_Image* pImage,
+                                   int tmpl,
+                                   const int8_t* at,
+                                   bool tpgdon) {
+  std::vector<JBig2ArithCtx> contexts(1 << kContextBits[tmpl]);
+  ArithEncoder encoder;
+  bool ltp = false;
+  for (int32_t y = 0; y < pImage->height(); ++y) {
+    if (tpgdon) {
+      bool same = true;
+      for (int32_t x = 0; x < pImage->width() && same; ++x)
+        same = pImage->getPixel(x, y) == pImage->getPixel(x, y - 1);
+      encoder.Encode(&contexts[kTPGDContext[tmpl]], same != ltp);
+      ltp = same;
+      if (ltp)
+        continue;
+    }
+    for (int32_t x = 0; x < pImage->width(); ++x) {
+      encoder.Encode(&contexts[GetContext(pImage, tmpl, at, x, y)],
+                     pImage->getPixel(x, y));
+    }
+  }
+  return encoder.Finish();
+}
+
+// Lines of glyph-sized blobs with specks in between, roughly like a page of
+// scanned text, with the last line repeated to give TPGDON lines to skip.
+std::unique_ptr<CJBig2_Image> MakePage(int32_t width, int32_t height) {
+  auto pImage = pdfium::MakeUnique<CJBig2_Image>(width, height);
+  pImage->fill(0);
+  uint32_t seed = 12345;
+  auto Random = [&seed](uint32_t n) {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % n;
+  };
+  for (int32_t top = 4; top + 40 < height; top += 40) {
+    for (int32_t left = Random(20); left + 16 < width;
+         left += 14 + Random(10)) {
+      // Strokes three pixels wide along some of the sides and across the
+      // middle of a box, with ragged edges.
+      int32_t glyph_top = top + 14 - Random(12);
+      uint32_t strokes = 1 + Random(31);
+      for (int32_t y = glyph_top; y < top + 26; ++y) {
+        for (int32_t x = left; x < left + 12; ++x) {
+          bool on = ((strokes & 1) && x < left + 3) ||
+                    ((strokes & 2) && x >= left + 9) ||
+                    ((strokes & 4) && y < glyph_top + 3) ||
+                    ((strokes & 8) && y >= top + 23) ||
+                    ((strokes & 16) && y >= (glyph_top + top + 23) / 2 &&
+                     y < (glyph_top + top + 29) / 2);
+          if (on != !Random(16))
+            pImage->setPixel(x, y, 1);
+        }
+      }
+    }
+    for (int i = 0; i < width / 16; ++i)
+      pImage->setPixel(Random(width), top + 30 + Random(10), 1);
+  }
+  for (int32_t y = height - 6; y < height; ++y)
+    pImage->copyLine(y, height - 7);
+  return pImage;
+}
+
+std::unique_ptr<CPDF_Stream> MakeStream(const std::vector<uint8_t>& data) {
+  std::unique_ptr<uint8_t, FxFreeDeleter> pData(FX_Alloc(uint8_t, data.size()));
+  memcpy(pData.get(), data.data(), data.size());
+  return pdfium::MakeUnique<CPDF_Stream>(
+      std::move(pData), data.size(), pdfium::MakeUnique<CPDF_Dictionary>());
+}
+
+class AlwaysPause : public IFX_Pause {
+ public:
+  bool NeedToPauseNow() override { return true; }
+};
+
+std::unique_ptr<CJBig2_Image> DecodeGeneric(const std::vector<uint8_t>& data,
+                                            int tmpl,
+                                            const int8_t* at,
+                                            bool tpgdon,
+                                            int32_t width,
+                                            int32_t height,
+                                            bool progressive) {
+  std::unique_ptr<CPDF_Stream> pStream = MakeStream(data);
+  CPDF_StreamAcc acc;
+  acc.LoadAllData(pStream.get(), false);
+  CJBig2_BitStream bit_stream(&acc);
+  CJBig2_ArithDecoder decoder(&bit_stream);
+  std::vector<JBig2ArithCtx> contexts(1 << kContextBits[tmpl]);
+  CJBig2_GRDProc proc;
+  proc.MMR = false;
+  proc.GBW = width;
+  proc.GBH = height;
+  proc.GBTEMPLATE = tmpl;
+  proc.TPGDON = tpgdon;
+  proc.USESKIP = false;
+  proc.SKIP = nullptr;
+  memcpy(proc.GBAT, at, sizeof(proc.GBAT));
+  if (!progressive)
+    return std::unique_ptr<CJBig2_Image>(
+        proc.decode_Arith(&decoder, contexts.data()));
+
+  CJBig2_Image* pImage = nullptr;
+  AlwaysPause pause;
+  FXCODEC_STATUS status =
+      proc.Start_decode_Arith(&pImage, &decoder, contexts.data(), &pause);
+  while (status == FXCODEC_STATUS_DECODE_TOBECONTINUE)
+    status = proc.Continue_decode(&pause);
+  EXPECT_EQ(FXCODEC_STATUS_DECODE_FINISH, status);
+  return std::unique_ptr<CJBig2_Image>(pImage);
+}
+
+void ExpectSameImage(CJBig2_Image* pExpected, CJBig2_Image* pActual) {
+  ASSERT_TRUE(pActual);
+  ASSERT_EQ(pExpected->width(), pActual->width());
+  ASSERT_EQ(pExpected->height(), pActual->height());
+  for (int32_t y = 0; y < pExpected->height(); ++y) {
+    for (int32_t x = 0; x < pExpected->width(); ++x) {
+      ASSERT_EQ(pExpected->getPixel(x, y), pActual->getPixel(x, y))
+          << "(" << x << ", " << y << ")";
+    }
+  }
+}
+
+void CheckRoundTrip(int tmpl, const int8_t* at) {
+  // Odd widths leave partial bytes at the ends of lines.
+  for (int32_t width : {1, 7, 61, 203}) {
+    std::unique_ptr<CJBig2_Image> pPage = MakePage(width, 97);
+    for (bool tpgdon : {false, true}) {
+      std::vector<uint8_t> data = EncodeGeneric(pPage.get(), tmpl, at, tpgdon);
+      for (bool progressive : {false, true}) {
+        SCOPED_TRACE(testing::Message() << "width " << width << " tpgdon "
+                                        << tpgdon << " progressive "
+                                        << progressive);
+        ExpectSameImage(pPage.get(),
+                        DecodeGeneric(data, tmpl, at, tpgdon, width,
+                                      pPage->height(), progressive)
+                            .get());
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(JBig2_GrdProc, DefaultATPixels) {
+  for (int tmpl = 0; tmpl < 4; ++tmpl) {
+    SCOPED_TRACE(tmpl);
+    CheckRoundTrip(tmpl, kDefaultAT[tmpl]);
+  }
+}
+
+TEST(JBig2_GrdProc, MovedATPixels) {
+  const int8_t kATs[][8] = {{-1, 0, -4, -1, 3, -2, -2, -3},
+                            {-128, -1, 127, -1, -20, -128, 0, -2},
+                            {5, -3, 0, -1, 1, -1, -2, -1},
+                            {-8, 0, -7, 0, -9, 0, -1, 0}};
+  for (int tmpl = 0; tmpl < 4; ++tmpl) {
+    for (const int8_t* at : kATs) {
+      SCOPED_TRACE(testing::Message() << "template " << tmpl << " AT "
+                                      << static_cast<int>(at[0]) << ","
+                                      << static_cast<int>(at[1]));
+      CheckRoundTrip(tmpl, at);
+    }
+  }
+}
+
+// Times decoding a page sized like a 300 dpi scan, best of five, with the AT
+// pixels where the templates have them by default and elsewhere. Run with
+// --gtest_also_run_disabled_tests.
+TEST(JBig2_GrdProc, DISABLED_Benchmark) {
+  std::unique_ptr<CJBig2_Image> pPage = MakePage(2480, 3508);
+  const int8_t kMovedAT[8] = {-1, -2, -3, -2, 2, -1, -2, -1};
+  for (int tmpl = 0; tmpl < 4; ++tmpl) {
+    for (const int8_t* at : {kDefaultAT[tmpl], kMovedAT}) {
+      std::vector<uint8_t> data = EncodeGeneric(pPage.get(), tmpl, at, true);
+      double best = 0;
+      for (int i = 0; i < 5; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        DecodeGeneric(data, tmpl, at, true, pPage->width(), pPage->height(),
+                      false);
+        double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+        if (i == 0 || seconds < best)
+          best = seconds;
+      }
+      printf("template %d %-10s %7.2f ms/page\n", tmpl,
+             at == kMovedAT ? "moved AT" : "default AT", best * 1000);
+    }
+  }
+}
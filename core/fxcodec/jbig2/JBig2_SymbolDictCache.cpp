@@ -0,0 +1,99 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcodec/jbig2/JBig2_SymbolDictCache.h"
+
+#include <iterator>
+#include <utility>
+
+#include "core/fxcodec/jbig2/JBig2_Image.h"
+#include "core/fxcodec/jbig2/JBig2_SymbolDict.h"
+#include "core/fxcrt/fx_safe_types.h"
+
+namespace {
+
+// The memory taken by |dict| and its symbol bitmaps, or 0 if it does not
+// fit in 32 bits.
+uint32_t GetDictSize(const CJBig2_SymbolDict& dict) {
+  FX_SAFE_UINT32 size = sizeof(CJBig2_SymbolDict);
+  for (size_t i = 0; i < dict.NumImages(); ++i) {
+    const CJBig2_Image* pImage = dict.GetImage(i);
+    size += sizeof(CJBig2_Image);
+    if (pImage) {
+      FX_SAFE_UINT32 image_size = pImage->stride();
+      image_size *= pImage->height();
+      if (!image_size.IsValid())
+        return 0;
+      size += image_size.ValueOrDie();
+    }
+  }
+  return size.ValueOrDefault(0);
+}
+
+}  // namespace
+
+size_t CJBig2_SymbolDictCache::KeyHash::operator()(
+    const CJBig2_CacheKey& key) const {
+  return (static_cast<size_t>(key.first) * 31) ^ key.second;
+}
+
+CJBig2_SymbolDictCache::CJBig2_SymbolDictCache(uint32_t nMaxBytes)
+    : m_nMaxBytes(nMaxBytes),
+      m_nBytes(0),
+      m_nHits(0),
+      m_nMisses(0),
+      m_nEvictions(0) {}
+
+CJBig2_SymbolDictCache::~CJBig2_SymbolDictCache() {}
+
+std::unique_ptr<CJBig2_SymbolDict> CJBig2_SymbolDictCache::Find(
+    const CJBig2_CacheKey& key) {
+  auto it = m_Index.find(key);
+  if (it == m_Index.end()) {
+    ++m_nMisses;
+    return nullptr;
+  }
+  ++m_nHits;
+  m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+  return it->second->pDict->DeepCopy();
+}
+
+void CJBig2_SymbolDictCache::Put(const CJBig2_CacheKey& key,
+                                 std::unique_ptr<CJBig2_SymbolDict> pDict) {
+  auto it = m_Index.find(key);
+  if (it != m_Index.end())
+    Erase(it->second);
+
+  uint32_t nBytes = GetDictSize(*pDict);
+  if (nBytes == 0)
+    return;
+
+  // A dictionary larger than the budget is still kept on its own, as the
+  // next image is likely to use it again.
+  while (!m_Entries.empty() &&
+         (nBytes > m_nMaxBytes || m_nBytes > m_nMaxBytes - nBytes)) {
+    Erase(std::prev(m_Entries.end()));
+    ++m_nEvictions;
+  }
+  m_Entries.push_front({key, std::move(pDict), nBytes});
+  m_Index[key] = m_Entries.begin();
+  m_nBytes += nBytes;
+}
+
+CJBig2_SymbolDictCache::Stats CJBig2_SymbolDictCache::GetStats() const {
+  Stats stats;
+  stats.nHits = m_nHits;
+  stats.nMisses = m_nMisses;
+  stats.nEvictions = m_nEvictions;
+  stats.nDicts = m_Index.size();
+  stats.nBytes = m_nBytes;
+  stats.nMaxBytes = m_nMaxBytes;
+  return stats;
+}
+
+void CJBig2_SymbolDictCache::Erase(EntryList::iterator it) {
+  m_nBytes -= it->nBytes;
+  m_Index.erase(it->key);
+  m_Entries.erase(it);
+}
@@ -0,0 +1,76 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXCODEC_JBIG2_JBIG2_SYMBOLDICTCACHE_H_
+#define CORE_FXCODEC_JBIG2_JBIG2_SYMBOLDICTCACHE_H_
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "core/fxcrt/fx_system.h"
+
+class CJBig2_SymbolDict;
+
+// Cache is keyed by the ObjNum of a stream and an index within the stream.
+using CJBig2_CacheKey = std::pair<uint32_t, uint32_t>;
+
+// Least recently used (LRU) cache of the symbol dictionaries decoded from
+// JBIG2Globals streams. It is very common for a JBIG2 dictionary to span
+// multiple pages in a PDF file, and we do not want to decode the same
+// dictionary over and over again. Dictionaries are looked up by hash and
+// evicted, least recently used first, to keep the size of their symbol
+// bitmaps within a byte budget. The most recent one is kept even if it is
+// larger than the budget by itself.
+class CJBig2_SymbolDictCache {
+ public:
+  struct Stats {
+    uint32_t nHits;
+    uint32_t nMisses;
+    uint32_t nEvictions;
+    uint32_t nDicts;
+    uint32_t nBytes;
+    uint32_t nMaxBytes;
+  };
+
+  static const uint32_t kDefaultMaxBytes = 8 * 1024 * 1024;
+
+  explicit CJBig2_SymbolDictCache(uint32_t nMaxBytes);
+  ~CJBig2_SymbolDictCache();
+
+  // Returns a copy of the dictionary cached for |key| and counts a hit, or
+  // counts a miss and returns nullptr.
+  std::unique_ptr<CJBig2_SymbolDict> Find(const CJBig2_CacheKey& key);
+
+  // Stores |pDict| for |key|, evicting whatever it needs room from. If it
+  // is larger than the budget, it is the only dictionary left.
+  void Put(const CJBig2_CacheKey& key,
+           std::unique_ptr<CJBig2_SymbolDict> pDict);
+
+  Stats GetStats() const;
+
+ private:
+  struct KeyHash {
+    size_t operator()(const CJBig2_CacheKey& key) const;
+  };
+  struct Entry {
+    CJBig2_CacheKey key;
+    std::unique_ptr<CJBig2_SymbolDict> pDict;
+    uint32_t nBytes;
+  };
+  using EntryList = std::list<Entry>;
+
+  void Erase(EntryList::iterator it);
+
+  const uint32_t m_nMaxBytes;
+  EntryList m_Entries;  // Most recently used first.
+  std::unordered_map<CJBig2_CacheKey, EntryList::iterator, KeyHash> m_Index;
+  uint32_t m_nBytes;
+  uint32_t m_nHits;
+  uint32_t m_nMisses;
+  uint32_t m_nEvictions;
+};
+
+#endif  // CORE_FXCODEC_JBIG2_JBIG2_SYMBOLDICTCACHE_H_
@@ -0,0 +1,125 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcodec/jbig2/JBig2_SymbolDictCache.h"
+
+#include <memory>
+
+#include "core/fxcodec/jbig2/JBig2_Image.h"
+#include "core/fxcodec/jbig2/JBig2_SymbolDict.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+// A dictionary of |count| 32x|height| symbols, of 4 * |height| bytes each.
+std::unique_ptr<CJBig2_SymbolDict> MakeDict(int count, int height) {
+  auto pDict = pdfium::MakeUnique<CJBig2_SymbolDict>();
+  for (int i = 0; i < count; ++i) {
+    auto pImage = pdfium::MakeUnique<CJBig2_Image>(32, height);
+    pImage->setPixel(i % 32, 0, 1);
+    pDict->AddImage(std::move(pImage));
+  }
+  return pDict;
+}
+
+uint32_t DictSize(int count, int height) {
+  return sizeof(CJBig2_SymbolDict) +
+         count * (sizeof(CJBig2_Image) + 4 * height);
+}
+
+}  // namespace
+
+TEST(fxcodec, JBig2SymbolDictCacheFind) {
+  CJBig2_SymbolDictCache cache(1024 * 1024);
+  EXPECT_FALSE(cache.Find({1, 0}));
+  cache.Put({1, 0}, MakeDict(3, 10));
+  cache.Put({1, 200}, MakeDict(5, 10));
+
+  std::unique_ptr<CJBig2_SymbolDict> pDict = cache.Find({1, 0});
+  ASSERT_TRUE(pDict);
+  ASSERT_EQ(3u, pDict->NumImages());
+  EXPECT_EQ(10, pDict->GetImage(0)->height());
+  EXPECT_TRUE(pDict->GetImage(2)->getPixel(2, 0));
+  EXPECT_FALSE(cache.Find({2, 0}));
+
+  // The copy handed out does not change the cached dictionary.
+  pDict->GetImage(2)->setPixel(2, 0, 0);
+  pDict = cache.Find({1, 0});
+  ASSERT_TRUE(pDict);
+  EXPECT_TRUE(pDict->GetImage(2)->getPixel(2, 0));
+
+  CJBig2_SymbolDictCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(2u, stats.nHits);
+  EXPECT_EQ(2u, stats.nMisses);
+  EXPECT_EQ(0u, stats.nEvictions);
+  EXPECT_EQ(2u, stats.nDicts);
+  EXPECT_EQ(DictSize(3, 10) + DictSize(5, 10), stats.nBytes);
+  EXPECT_EQ(1024u * 1024, stats.nMaxBytes);
+}
+
+TEST(fxcodec, JBig2SymbolDictCacheEvictsLeastRecentlyUsed) {
+  CJBig2_SymbolDictCache cache(3 * DictSize(4, 100));
+  cache.Put({1, 0}, MakeDict(4, 100));
+  cache.Put({2, 0}, MakeDict(4, 100));
+  cache.Put({3, 0}, MakeDict(4, 100));
+  EXPECT_TRUE(cache.Find({1, 0}));
+
+  // 2 is the least recently used.
+  cache.Put({4, 0}, MakeDict(4, 100));
+  EXPECT_FALSE(cache.Find({2, 0}));
+  EXPECT_TRUE(cache.Find({1, 0}));
+  EXPECT_TRUE(cache.Find({3, 0}));
+  EXPECT_TRUE(cache.Find({4, 0}));
+
+  // A bigger one takes the room of two.
+  cache.Put({5, 0}, MakeDict(8, 100));
+  EXPECT_FALSE(cache.Find({1, 0}));
+  EXPECT_FALSE(cache.Find({3, 0}));
+  EXPECT_TRUE(cache.Find({4, 0}));
+  EXPECT_TRUE(cache.Find({5, 0}));
+
+  CJBig2_SymbolDictCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(3u, stats.nEvictions);
+  EXPECT_EQ(2u, stats.nDicts);
+  EXPECT_EQ(DictSize(4, 100) + DictSize(8, 100), stats.nBytes);
+}
+
+TEST(fxcodec, JBig2SymbolDictCacheBudget) {
+  CJBig2_SymbolDictCache cache(DictSize(4, 100));
+  cache.Put({1, 0}, MakeDict(4, 100));
+  EXPECT_EQ(1u, cache.GetStats().nDicts);
+
+  // Storing a key again replaces its dictionary.
+  cache.Put({1, 0}, MakeDict(2, 100));
+  std::unique_ptr<CJBig2_SymbolDict> pDict = cache.Find({1, 0});
+  ASSERT_TRUE(pDict);
+  EXPECT_EQ(2u, pDict->NumImages());
+
+  CJBig2_SymbolDictCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(0u, stats.nEvictions);
+  EXPECT_EQ(1u, stats.nDicts);
+  EXPECT_EQ(DictSize(2, 100), stats.nBytes);
+}
+
+TEST(fxcodec, JBig2SymbolDictCacheKeepsLargeDict) {
+  CJBig2_SymbolDictCache cache(DictSize(4, 100));
+  cache.Put({1, 0}, MakeDict(4, 100));
+
+  // Too large for the budget, so it is all that is kept.
+  cache.Put({2, 0}, MakeDict(5, 100));
+  EXPECT_FALSE(cache.Find({1, 0}));
+  EXPECT_TRUE(cache.Find({2, 0}));
+  EXPECT_EQ(DictSize(5, 100), cache.GetStats().nBytes);
+
+  // Until the next one comes along.
+  cache.Put({3, 0}, MakeDict(1, 100));
+  EXPECT_FALSE(cache.Find({2, 0}));
+  EXPECT_TRUE(cache.Find({3, 0}));
+
+  CJBig2_SymbolDictCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(2u, stats.nEvictions);
+  EXPECT_EQ(1u, stats.nDicts);
+  EXPECT_EQ(DictSize(1, 100), stats.nBytes);
+}
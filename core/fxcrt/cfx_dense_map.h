@@ -0,0 +1,216 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXCRT_CFX_DENSE_MAP_H_
+#define CORE_FXCRT_CFX_DENSE_MAP_H_
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "core/fxcrt/fx_system.h"
+
+// Ordered map keyed by small unsigned integers such as PDF object numbers.
+// Keys are stored in a flat vector indexed by the key itself, so lookups are
+// a bounds check plus an array access. Keys that are far beyond the number
+// of entries actually present go to a sparse std::map instead, so that a
+// handful of huge object numbers cannot force a huge allocation. The dense
+// part never holds more than about four times the number of entries, or of
+// the expected size hint, whichever is larger.
+//
+// Iteration visits keys in increasing order. As with std::vector, inserting
+// a key may invalidate iterators and references.
+template <typename V>
+class CFX_DenseMap {
+ public:
+  struct value_type {
+    value_type() : first(kAbsentKey), second() {}
+    value_type(uint32_t key, V value) : first(key), second(std::move(value)) {}
+
+    uint32_t first;
+    V second;
+  };
+
+ private:
+  template <typename MapType, typename ValueType, typename SparseIterator>
+  class Iterator {
+   public:
+    Iterator(MapType* pMap, size_t index, SparseIterator sparse_it)
+        : m_pMap(pMap), m_Index(index), m_SparseIt(sparse_it) {}
+
+    ValueType& operator*() const {
+      return InDense() ? m_pMap->m_Dense[m_Index] : m_SparseIt->second;
+    }
+    ValueType* operator->() const { return &operator*(); }
+    Iterator& operator++() {
+      if (InDense())
+        m_Index = m_pMap->NextDenseIndex(m_Index + 1);
+      else
+        ++m_SparseIt;
+      return *this;
+    }
+    bool operator==(const Iterator& that) const {
+      return m_Index == that.m_Index && m_SparseIt == that.m_SparseIt;
+    }
+    bool operator!=(const Iterator& that) const { return !(*this == that); }
+
+   private:
+    bool InDense() const { return m_Index < m_pMap->m_Dense.size(); }
+
+    MapType* m_pMap;
+    size_t m_Index;
+    SparseIterator m_SparseIt;
+  };
+
+  using SparseMap = std::map<uint32_t, value_type>;
+
+ public:
+  using iterator =
+      Iterator<CFX_DenseMap, value_type, typename SparseMap::iterator>;
+  using const_iterator = Iterator<const CFX_DenseMap,
+                                  const value_type,
+                                  typename SparseMap::const_iterator>;
+
+  CFX_DenseMap() : m_nCount(0), m_nExpectedSize(0) {}
+
+  bool empty() const { return m_nCount == 0; }
+  size_t size() const { return m_nCount; }
+
+  // Lets the dense part cover keys up to about four times |size| even while
+  // few entries are present yet, e.g. for objects parsed in random order.
+  void SetExpectedSize(size_t size) { m_nExpectedSize = size; }
+
+  V& operator[](uint32_t key) {
+    ASSERT(key != kAbsentKey);
+    if (key >= m_Dense.size() && ShouldBeDense(key))
+      GrowDense(key + 1);
+
+    if (key < m_Dense.size()) {
+      value_type& slot = m_Dense[key];
+      if (slot.first == kAbsentKey) {
+        slot.first = key;
+        ++m_nCount;
+      }
+      return slot.second;
+    }
+
+    auto it = m_Sparse.find(key);
+    if (it == m_Sparse.end()) {
+      it = m_Sparse.insert(std::make_pair(key, value_type(key, V()))).first;
+      ++m_nCount;
+    }
+    return it->second.second;
+  }
+
+  iterator find(uint32_t key) { return FindImpl<iterator>(this, key); }
+  const_iterator find(uint32_t key) const {
+    return FindImpl<const_iterator>(this, key);
+  }
+
+  iterator begin() {
+    return iterator(this, NextDenseIndex(0), m_Sparse.begin());
+  }
+  iterator end() { return iterator(this, m_Dense.size(), m_Sparse.end()); }
+  const_iterator begin() const {
+    return const_iterator(this, NextDenseIndex(0), m_Sparse.begin());
+  }
+  const_iterator end() const {
+    return const_iterator(this, m_Dense.size(), m_Sparse.end());
+  }
+
+  // Returns the largest key present. The map must not be empty.
+  uint32_t LastKey() const {
+    ASSERT(!empty());
+    return m_Sparse.empty() ? m_Dense.back().first : m_Sparse.rbegin()->first;
+  }
+
+  // Returns the number of entries removed, which is either 0 or 1.
+  size_t erase(uint32_t key) {
+    if (key < m_Dense.size()) {
+      value_type& slot = m_Dense[key];
+      if (slot.first == kAbsentKey)
+        return 0;
+      slot = value_type();
+      --m_nCount;
+      TrimDense();
+      return 1;
+    }
+    if (!m_Sparse.erase(key))
+      return 0;
+    --m_nCount;
+    return 1;
+  }
+
+  // Removes every entry whose key is |key| or larger.
+  void EraseFrom(uint32_t key) {
+    auto sparse_it = m_Sparse.lower_bound(key);
+    m_nCount -= std::distance(sparse_it, m_Sparse.end());
+    m_Sparse.erase(sparse_it, m_Sparse.end());
+    if (key < m_Dense.size()) {
+      for (size_t i = key; i < m_Dense.size(); ++i) {
+        if (m_Dense[i].first != kAbsentKey)
+          --m_nCount;
+      }
+      m_Dense.resize(key);
+      TrimDense();
+    }
+  }
+
+  void clear() {
+    m_Dense.clear();
+    m_Sparse.clear();
+    m_nCount = 0;
+  }
+
+ private:
+  static const uint32_t kAbsentKey = 0xFFFFFFFF;
+  static const size_t kMinDenseSize = 4096;
+
+  template <typename IteratorType, typename MapType>
+  static IteratorType FindImpl(MapType* pMap, uint32_t key) {
+    if (key < pMap->m_Dense.size()) {
+      if (pMap->m_Dense[key].first == kAbsentKey)
+        return pMap->end();
+      return IteratorType(pMap, key, pMap->m_Sparse.begin());
+    }
+    return IteratorType(pMap, pMap->m_Dense.size(), pMap->m_Sparse.find(key));
+  }
+
+  bool ShouldBeDense(uint32_t key) const {
+    size_t limit = 4 * (std::max(m_nCount, m_nExpectedSize) + 1);
+    return key < limit || key < kMinDenseSize;
+  }
+
+  // Extends the dense part to |new_size| slots and moves in any sparse
+  // entries that now fall inside it.
+  void GrowDense(size_t new_size) {
+    m_Dense.resize(new_size);
+    auto it = m_Sparse.begin();
+    while (it != m_Sparse.end() && it->first < new_size) {
+      m_Dense[it->first] = std::move(it->second);
+      it = m_Sparse.erase(it);
+    }
+  }
+
+  // Keeps the last dense slot occupied so that LastKey() stays O(1).
+  void TrimDense() {
+    while (!m_Dense.empty() && m_Dense.back().first == kAbsentKey)
+      m_Dense.pop_back();
+  }
+
+  size_t NextDenseIndex(size_t index) const {
+    while (index < m_Dense.size() && m_Dense[index].first == kAbsentKey)
+      ++index;
+    return index;
+  }
+
+  // Invariant: every key in |m_Sparse| is >= m_Dense.size().
+  std::vector<value_type> m_Dense;
+  SparseMap m_Sparse;
+  size_t m_nCount;
+  size_t m_nExpectedSize;
+};
+
+#endif  // CORE_FXCRT_CFX_DENSE_MAP_H_
@@ -0,0 +1,152 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcrt/cfx_dense_map.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/ptr_util.h"
+#include "third_party/base/stl_util.h"
+
+namespace {
+
+template <typename V>
+std::vector<uint32_t> KeysOf(const CFX_DenseMap<V>& map) {
+  std::vector<uint32_t> keys;
+  for (const auto& it : map)
+    keys.push_back(it.first);
+  return keys;
+}
+
+}  // namespace
+
+TEST(fxcrt, DenseMapEmpty) {
+  CFX_DenseMap<int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(0u, map.size());
+  EXPECT_TRUE(map.begin() == map.end());
+  EXPECT_TRUE(map.find(0) == map.end());
+  EXPECT_TRUE(map.find(100000) == map.end());
+  EXPECT_EQ(0u, map.erase(5));
+}
+
+TEST(fxcrt, DenseMapInsertFind) {
+  CFX_DenseMap<int> map;
+  map[3] = 30;
+  map[1] = 10;
+  map[7] = 70;
+  EXPECT_EQ(3u, map.size());
+  EXPECT_EQ(7u, map.LastKey());
+  EXPECT_TRUE(pdfium::ContainsKey(map, 1));
+  EXPECT_FALSE(pdfium::ContainsKey(map, 2));
+  EXPECT_EQ(30, map.find(3)->second);
+  EXPECT_EQ(std::vector<uint32_t>({1, 3, 7}), KeysOf(map));
+
+  // Default-constructed on access, like std::map.
+  EXPECT_EQ(0, map[5]);
+  EXPECT_EQ(4u, map.size());
+}
+
+TEST(fxcrt, DenseMapSparseKeys) {
+  CFX_DenseMap<int> map;
+  map[1000000] = 1;
+  map[2] = 2;
+  map[500000] = 3;
+  EXPECT_EQ(3u, map.size());
+  EXPECT_EQ(1000000u, map.LastKey());
+  EXPECT_EQ(std::vector<uint32_t>({2, 500000, 1000000}), KeysOf(map));
+  EXPECT_EQ(3, map.find(500000)->second);
+
+  EXPECT_EQ(1u, map.erase(1000000));
+  EXPECT_EQ(500000u, map.LastKey());
+  EXPECT_EQ(0u, map.erase(1000000));
+  EXPECT_EQ(2u, map.size());
+}
+
+TEST(fxcrt, DenseMapSparseKeysMigrate) {
+  CFX_DenseMap<int> map;
+  map[20000] = 1;
+  for (uint32_t i = 0; i < 20000; ++i)
+    map[i] = i;
+  EXPECT_EQ(20001u, map.size());
+  EXPECT_EQ(20000u, map.LastKey());
+  uint32_t expected = 0;
+  for (const auto& it : map)
+    EXPECT_EQ(expected++, it.first);
+  EXPECT_EQ(20001u, expected);
+  EXPECT_EQ(1, map.find(20000)->second);
+}
+
+TEST(fxcrt, DenseMapExpectedSize) {
+  CFX_DenseMap<int> map;
+  map.SetExpectedSize(100000);
+  map[399999] = 1;
+  map[3] = 2;
+  EXPECT_EQ(std::vector<uint32_t>({3, 399999}), KeysOf(map));
+}
+
+TEST(fxcrt, DenseMapEraseFrom) {
+  CFX_DenseMap<int> map;
+  for (uint32_t i = 0; i < 10; ++i)
+    map[i] = i;
+  map[800000] = 8;
+  map.EraseFrom(5);
+  EXPECT_EQ(5u, map.size());
+  EXPECT_EQ(4u, map.LastKey());
+  EXPECT_EQ(std::vector<uint32_t>({0, 1, 2, 3, 4}), KeysOf(map));
+
+  map.EraseFrom(0);
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(fxcrt, DenseMapEraseLastTrims) {
+  CFX_DenseMap<int> map;
+  map[1] = 1;
+  map[9] = 9;
+  EXPECT_EQ(1u, map.erase(9));
+  EXPECT_EQ(1u, map.LastKey());
+  map[4] = 4;
+  EXPECT_EQ(4u, map.LastKey());
+  EXPECT_EQ(std::vector<uint32_t>({1, 4}), KeysOf(map));
+}
+
+TEST(fxcrt, DenseMapMoveOnlyValues) {
+  CFX_DenseMap<std::unique_ptr<int>> map;
+  map[900000] = pdfium::MakeUnique<int>(9);
+  for (uint32_t i = 0; i < 5000; ++i)
+    map[i] = pdfium::MakeUnique<int>(i);
+  EXPECT_EQ(9, *map.find(900000)->second);
+  EXPECT_EQ(4999, *map[4999]);
+  map.clear();
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(fxcrt, DenseMapMatchesStdMap) {
+  CFX_DenseMap<uint32_t> map;
+  std::map<uint32_t, uint32_t> expected;
+  uint32_t seed = 1;
+  for (int i = 0; i < 20000; ++i) {
+    seed = seed * 1103515245 + 12345;
+    uint32_t key = (seed >> 8) % (i % 7 == 0 ? 1048576 : 30000);
+    if (seed & 1) {
+      map[key] = i;
+      expected[key] = i;
+    } else {
+      EXPECT_EQ(expected.erase(key), map.erase(key));
+    }
+  }
+  ASSERT_EQ(expected.size(), map.size());
+  auto it = map.begin();
+  for (const auto& pair : expected) {
+    ASSERT_TRUE(it != map.end());
+    EXPECT_EQ(pair.first, it->first);
+    EXPECT_EQ(pair.second, it->second);
+    ++it;
+  }
+  EXPECT_TRUE(it == map.end());
+  EXPECT_EQ(expected.rbegin()->first, map.LastKey());
+}
@@ -0,0 +1,13 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcrt/cfx_mutex.h"
+
+// static
+bool CFX_Mutex::s_bThreadSafe = false;
+
+// static
+void CFX_Mutex::SetThreadSafeMode(bool bThreadSafe) {
+  s_bThreadSafe = bThreadSafe;
+}
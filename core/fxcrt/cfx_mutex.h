@@ -0,0 +1,53 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXCRT_CFX_MUTEX_H_
+#define CORE_FXCRT_CFX_MUTEX_H_
+
+#include <mutex>
+
+#include "core/fxcrt/fx_system.h"
+
+// Recursive mutex that only locks once the library has been switched into
+// thread-safe mode, so single-threaded embedders do not pay for locking.
+// The mode must be chosen at library initialization, before any lock is
+// taken, and must not change while any lock is held.
+class CFX_Mutex {
+ public:
+  static void SetThreadSafeMode(bool bThreadSafe);
+  static bool IsThreadSafeMode() { return s_bThreadSafe; }
+
+  CFX_Mutex() {}
+  CFX_Mutex(const CFX_Mutex&) = delete;
+  CFX_Mutex& operator=(const CFX_Mutex&) = delete;
+
+  void Lock() {
+    if (s_bThreadSafe)
+      m_Mutex.lock();
+  }
+  void Unlock() {
+    if (s_bThreadSafe)
+      m_Mutex.unlock();
+  }
+
+ private:
+  static bool s_bThreadSafe;
+
+  std::recursive_mutex m_Mutex;
+};
+
+class CFX_AutoLock {
+ public:
+  explicit CFX_AutoLock(CFX_Mutex* pMutex) : m_pMutex(pMutex) {
+    m_pMutex->Lock();
+  }
+  CFX_AutoLock(const CFX_AutoLock&) = delete;
+  CFX_AutoLock& operator=(const CFX_AutoLock&) = delete;
+  ~CFX_AutoLock() { m_pMutex->Unlock(); }
+
+ private:
+  CFX_Mutex* const m_pMutex;
+};
+
+#endif  // CORE_FXCRT_CFX_MUTEX_H_
@@ -0,0 +1,53 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcrt/cfx_mutex.h"
+
+#include <thread>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+class ScopedThreadSafeMode {
+ public:
+  ScopedThreadSafeMode() { CFX_Mutex::SetThreadSafeMode(true); }
+  ~ScopedThreadSafeMode() { CFX_Mutex::SetThreadSafeMode(false); }
+};
+
+}  // namespace
+
+TEST(fxcrt, MutexDisabledByDefault) {
+  EXPECT_FALSE(CFX_Mutex::IsThreadSafeMode());
+  CFX_Mutex mutex;
+  CFX_AutoLock lock(&mutex);
+  CFX_AutoLock nested(&mutex);
+}
+
+TEST(fxcrt, MutexRecursive) {
+  ScopedThreadSafeMode mode;
+  CFX_Mutex mutex;
+  CFX_AutoLock lock(&mutex);
+  CFX_AutoLock nested(&mutex);
+  EXPECT_TRUE(CFX_Mutex::IsThreadSafeMode());
+}
+
+TEST(fxcrt, MutexSerializesThreads) {
+  ScopedThreadSafeMode mode;
+  CFX_Mutex mutex;
+  int counter = 0;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&mutex, &counter]() {
+      for (int j = 0; j < 10000; ++j) {
+        CFX_AutoLock lock(&mutex);
+        ++counter;
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(40000, counter);
+}
@@ -7,6 +7,8 @@
 #ifndef CORE_FXCRT_CFX_SHARED_COPY_ON_WRITE_H_
 #define CORE_FXCRT_CFX_SHARED_COPY_ON_WRITE_H_
 
+#include <atomic>
+
 #include "core/fxcrt/cfx_retain_ptr.h"
 #include "core/fxcrt/fx_system.h"
 
@@ -76,7 +78,9 @@ class CFX_SharedCopyOnWrite {
     // Since the count increments with each new pointer, the largest value is
     // the number of pointers that can fit into the address space. The size of
     // the address space itself is a good upper bound on it.
-    intptr_t m_RefCount;
+    // Atomic because threads rendering tiles of one page all copy the
+    // states of that page's objects.
+    std::atomic<intptr_t> m_RefCount;
   };
 
   CFX_RetainPtr<CountedObj> m_pObject;
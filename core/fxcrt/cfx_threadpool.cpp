@@ -0,0 +1,121 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcrt/cfx_threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace {
+
+CFX_ThreadPool* g_pDefaultPool = nullptr;
+
+// Shared between the caller of ParallelFor() and the helper tasks it posts.
+// Helpers may outlive the call, so they only touch |pFunc| while indices
+// remain to be claimed, which the caller waits for.
+struct ParallelForState {
+  ParallelForState(size_t count, const std::function<void(size_t)>* pFunc)
+      : nCount(count), nNext(0), nDone(0), pFunc(pFunc) {}
+
+  // Claims and runs indices until none are left.
+  void RunIndices() {
+    size_t nFinished = 0;
+    for (size_t i = nNext++; i < nCount; i = nNext++) {
+      (*pFunc)(i);
+      ++nFinished;
+    }
+    if (!nFinished)
+      return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    nDone += nFinished;
+    if (nDone == nCount)
+      done.notify_all();
+  }
+
+  const size_t nCount;
+  std::atomic<size_t> nNext;
+  size_t nDone;
+  const std::function<void(size_t)>* const pFunc;
+  std::mutex mutex;
+  std::condition_variable done;
+};
+
+}  // namespace
+
+// static
+CFX_ThreadPool* CFX_ThreadPool::Get() {
+  return g_pDefaultPool;
+}
+
+// static
+void CFX_ThreadPool::Create(size_t nThreads) {
+  ASSERT(!g_pDefaultPool);
+  if (nThreads)
+    g_pDefaultPool = new CFX_ThreadPool(nThreads);
+}
+
+// static
+void CFX_ThreadPool::Destroy() {
+  delete g_pDefaultPool;
+  g_pDefaultPool = nullptr;
+}
+
+CFX_ThreadPool::CFX_ThreadPool(size_t nThreads) : m_bStopping(false) {
+  for (size_t i = 0; i < nThreads; ++i)
+    m_Threads.emplace_back(&CFX_ThreadPool::WorkerMain, this);
+}
+
+CFX_ThreadPool::~CFX_ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_bStopping = true;
+  }
+  m_TaskAvailable.notify_all();
+  for (auto& thread : m_Threads)
+    thread.join();
+}
+
+void CFX_ThreadPool::PostTask(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Tasks.push_back(std::move(task));
+  }
+  m_TaskAvailable.notify_one();
+}
+
+void CFX_ThreadPool::ParallelFor(size_t count,
+                                 const std::function<void(size_t)>& func) {
+  if (!count)
+    return;
+
+  auto pState = std::make_shared<ParallelForState>(count, &func);
+  size_t nHelpers = std::min(m_Threads.size(), count - 1);
+  for (size_t i = 0; i < nHelpers; ++i)
+    PostTask([pState]() { pState->RunIndices(); });
+
+  pState->RunIndices();
+  std::unique_lock<std::mutex> lock(pState->mutex);
+  pState->done.wait(lock,
+                    [&pState]() { return pState->nDone == pState->nCount; });
+}
+
+void CFX_ThreadPool::WorkerMain() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_TaskAvailable.wait(
+          lock, [this]() { return m_bStopping || !m_Tasks.empty(); });
+      if (m_Tasks.empty())
+        return;
+
+      task = std::move(m_Tasks.front());
+      m_Tasks.pop_front();
+    }
+    task();
+  }
+}
@@ -0,0 +1,57 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXCRT_CFX_THREADPOOL_H_
+#define CORE_FXCRT_CFX_THREADPOOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/fxcrt/fx_system.h"
+
+// Fixed set of worker threads for spreading independent pieces of work,
+// such as decoding several streams, over the available cores. Tasks must
+// not touch objects that other threads may use at the same time; in
+// particular, strings and PDF objects are not safe to share between tasks.
+class CFX_ThreadPool {
+ public:
+  // Returns the process-wide pool, or nullptr if the embedder did not ask
+  // for worker threads.
+  static CFX_ThreadPool* Get();
+  static void Create(size_t nThreads);
+  static void Destroy();
+
+  explicit CFX_ThreadPool(size_t nThreads);
+  CFX_ThreadPool(const CFX_ThreadPool&) = delete;
+  CFX_ThreadPool& operator=(const CFX_ThreadPool&) = delete;
+
+  // Runs the tasks that are still queued, then stops the threads.
+  ~CFX_ThreadPool();
+
+  size_t GetThreadCount() const { return m_Threads.size(); }
+
+  // Queues |task| to run on one of the worker threads.
+  void PostTask(std::function<void()> task);
+
+  // Calls |func| once for every index in [0, |count|), using the worker
+  // threads and the calling thread, and returns once all calls are done.
+  // May be called from within a task; the calling thread then does the
+  // work itself if every worker is busy.
+  void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+ private:
+  void WorkerMain();
+
+  std::mutex m_Mutex;
+  std::condition_variable m_TaskAvailable;
+  std::deque<std::function<void()>> m_Tasks;
+  bool m_bStopping;
+  std::vector<std::thread> m_Threads;
+};
+
+#endif  // CORE_FXCRT_CFX_THREADPOOL_H_
@@ -0,0 +1,50 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcrt/cfx_threadpool.h"
+
+#include <atomic>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+TEST(fxcrt, ThreadPoolNoDefault) {
+  EXPECT_FALSE(CFX_ThreadPool::Get());
+  CFX_ThreadPool::Create(0);
+  EXPECT_FALSE(CFX_ThreadPool::Get());
+  CFX_ThreadPool::Destroy();
+}
+
+TEST(fxcrt, ThreadPoolPostTask) {
+  std::atomic<int> counter(0);
+  {
+    CFX_ThreadPool pool(3);
+    EXPECT_EQ(3u, pool.GetThreadCount());
+    for (int i = 0; i < 100; ++i)
+      pool.PostTask([&counter]() { ++counter; });
+  }
+  // Queued tasks have run by the time the pool is gone.
+  EXPECT_EQ(100, counter);
+}
+
+TEST(fxcrt, ThreadPoolParallelFor) {
+  CFX_ThreadPool pool(4);
+  std::vector<int> results(1000);
+  pool.ParallelFor(results.size(),
+                   [&results](size_t i) { results[i] += static_cast<int>(i); });
+  for (size_t i = 0; i < results.size(); ++i)
+    EXPECT_EQ(static_cast<int>(i), results[i]);
+
+  // Nothing to do.
+  pool.ParallelFor(0, [](size_t i) { ADD_FAILURE(); });
+}
+
+TEST(fxcrt, ThreadPoolNestedParallelFor) {
+  CFX_ThreadPool pool(2);
+  std::atomic<int> counter(0);
+  pool.ParallelFor(8, [&pool, &counter](size_t) {
+    pool.ParallelFor(8, [&counter](size_t) { ++counter; });
+  });
+  EXPECT_EQ(64, counter);
+}
@@ -32,6 +32,10 @@ class IFXCRT_FileAccess {
                           FX_FILESIZE pos) = 0;
   virtual bool Flush() = 0;
   virtual bool Truncate(FX_FILESIZE szFile) = 0;
+
+  // Returns the file contents if the file was opened read-only and could be
+  // mapped into memory, or nullptr.
+  virtual const uint8_t* GetMappedData() const = 0;
 };
 
 #ifdef __cplusplus
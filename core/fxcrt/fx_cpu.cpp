@@ -0,0 +1,53 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcrt/fx_cpu.h"
+
+#include <atomic>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+
+std::atomic<uint32_t> g_FeatureMask(~0u);
+
+uint32_t DetectFeatures() {
+  uint32_t features = 0;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  // Like the MSVC branch, "avx2" also requires OS support for the AVX state.
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2"))
+    features |= FXCPU_SSE2;
+  if (__builtin_cpu_supports("avx2"))
+    features |= FXCPU_AVX2;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  int info[4];
+  __cpuid(info, 0);
+  int max_leaf = info[0];
+  __cpuid(info, 1);
+  if (info[3] & (1 << 26))
+    features |= FXCPU_SSE2;
+  bool bOSXSave = !!(info[2] & (1 << 27));
+  if (max_leaf >= 7 && bOSXSave && (_xgetbv(0) & 6) == 6) {
+    __cpuidex(info, 7, 0);
+    if (info[1] & (1 << 5))
+      features |= FXCPU_AVX2;
+  }
+#endif
+  return features;
+}
+
+}  // namespace
+
+uint32_t FXCPU_GetFeatures() {
+  static const uint32_t s_Features = DetectFeatures();
+  return s_Features & g_FeatureMask.load(std::memory_order_relaxed);
+}
+
+void FXCPU_SetFeatureMaskForTesting(uint32_t mask) {
+  g_FeatureMask.store(mask, std::memory_order_relaxed);
+}
@@ -0,0 +1,22 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXCRT_FX_CPU_H_
+#define CORE_FXCRT_FX_CPU_H_
+
+#include <stdint.h>
+
+// Instruction set extensions that vectorized code paths may depend on.
+#define FXCPU_SSE2 0x01
+#define FXCPU_AVX2 0x02
+
+// Returns the FXCPU_* extensions usable on this machine, i.e. supported by
+// both the processor and the operating system. Detection runs once.
+uint32_t FXCPU_GetFeatures();
+
+// Hides the extensions outside |mask| from FXCPU_GetFeatures(), so tests can
+// compare the portable code paths with the vectorized ones. Pass ~0u to undo.
+void FXCPU_SetFeatureMaskForTesting(uint32_t mask);
+
+#endif  // CORE_FXCRT_FX_CPU_H_
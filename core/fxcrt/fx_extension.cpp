@@ -74,6 +74,7 @@ class CFX_CRTFileStream final : public IFX_SeekableStream {
   size_t ReadBlock(void* buffer, size_t size) override;
   bool WriteBlock(const void* buffer, FX_FILESIZE offset, size_t size) override;
   bool Flush() override;
+  const uint8_t* GetMappedData() override;
 
  private:
   explicit CFX_CRTFileStream(std::unique_ptr<IFXCRT_FileAccess> pFA);
@@ -119,6 +120,10 @@ bool CFX_CRTFileStream::Flush() {
   return m_pFile->Flush();
 }
 
+const uint8_t* CFX_CRTFileStream::GetMappedData() {
+  return m_pFile->GetMappedData();
+}
+
 #define FX_MEMSTREAM_BlockSize (64 * 1024)
 #define FX_MEMSTREAM_Consecutive 0x01
 #define FX_MEMSTREAM_TakeOver 0x02
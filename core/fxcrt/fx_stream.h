@@ -85,6 +85,12 @@ class IFX_SeekableReadStream : public IFX_ReadStream {
 
   virtual bool ReadBlock(void* buffer, FX_FILESIZE offset, size_t size) = 0;
   virtual FX_FILESIZE GetSize() = 0;
+
+  // Returns all GetSize() bytes of the stream if they are addressable in
+  // memory and stay valid and unchanged for the lifetime of the stream, so
+  // that readers can use them in place instead of copying them out with
+  // ReadBlock(). Returns nullptr otherwise.
+  virtual const uint8_t* GetMappedData();
 };
 
 class IFX_SeekableStream : public IFX_SeekableReadStream,
@@ -6,12 +6,17 @@
 
 #include "core/fxcrt/fxcrt_posix.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "core/fxcrt/fx_basic.h"
 
 #if _FXM_PLATFORM_ == _FXM_PLATFORM_LINUX_ || \
     _FXM_PLATFORM_ == _FXM_PLATFORM_APPLE_ || \
     _FXM_PLATFORM_ == _FXM_PLATFORM_ANDROID_
 
+#include <sys/mman.h>
+
 // static
 IFXCRT_FileAccess* IFXCRT_FileAccess::Create() {
   return new CFXCRT_FileAccess_Posix;
@@ -32,7 +37,8 @@ void FXCRT_Posix_GetFileMode(uint32_t dwModes,
     nMasks = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
   }
 }
-CFXCRT_FileAccess_Posix::CFXCRT_FileAccess_Posix() : m_nFD(-1) {}
+CFXCRT_FileAccess_Posix::CFXCRT_FileAccess_Posix()
+    : m_nFD(-1), m_pMappedData(nullptr), m_nMappedSize(0) {}
 CFXCRT_FileAccess_Posix::~CFXCRT_FileAccess_Posix() {
   Close();
 }
@@ -46,7 +52,30 @@ bool CFXCRT_FileAccess_Posix::Open(const CFX_ByteStringC& fileName,
   int32_t nMasks;
   FXCRT_Posix_GetFileMode(dwMode, nFlags, nMasks);
   m_nFD = open(fileName.c_str(), nFlags, nMasks);
-  return m_nFD > -1;
+  if (m_nFD < 0)
+    return false;
+
+  if (dwMode & FX_FILEMODE_ReadOnly)
+    MapFile();
+  return true;
+}
+
+void CFXCRT_FileAccess_Posix::MapFile() {
+  FX_FILESIZE size = GetSize();
+  if (size <= 0 ||
+      static_cast<uint64_t>(size) > std::numeric_limits<size_t>::max()) {
+    return;
+  }
+  // The mapping is a snapshot of the file as it is now. Like any reader of
+  // mapped memory, this faults if another process truncates the file while
+  // it is open; regular reads are used whenever mapping is not possible.
+  void* pData = mmap(nullptr, static_cast<size_t>(size), PROT_READ,
+                     MAP_PRIVATE, m_nFD, 0);
+  if (pData == MAP_FAILED)
+    return;
+
+  m_pMappedData = pData;
+  m_nMappedSize = static_cast<size_t>(size);
 }
 
 bool CFXCRT_FileAccess_Posix::Open(const CFX_WideStringC& fileName,
@@ -58,6 +87,11 @@ void CFXCRT_FileAccess_Posix::Close() {
   if (m_nFD < 0) {
     return;
   }
+  if (m_pMappedData) {
+    munmap(m_pMappedData, m_nMappedSize);
+    m_pMappedData = nullptr;
+    m_nMappedSize = 0;
+  }
   close(m_nFD);
   m_nFD = -1;
 }
@@ -65,6 +99,9 @@ FX_FILESIZE CFXCRT_FileAccess_Posix::GetSize() const {
   if (m_nFD < 0) {
     return 0;
   }
+  if (m_pMappedData)
+    return static_cast<FX_FILESIZE>(m_nMappedSize);
+
   struct stat s;
   FXSYS_memset(&s, 0, sizeof(s));
   fstat(m_nFD, &s);
@@ -103,10 +140,21 @@ size_t CFXCRT_FileAccess_Posix::ReadPos(void* pBuffer,
   if (pos >= GetSize()) {
     return 0;
   }
-  if (SetPosition(pos) == (FX_FILESIZE)-1) {
-    return 0;
+  if (m_pMappedData && pos >= 0) {
+    size_t nRead = std::min(szBuffer, m_nMappedSize - static_cast<size_t>(pos));
+    FXSYS_memcpy(pBuffer, static_cast<const uint8_t*>(m_pMappedData) + pos,
+                 nRead);
+    SetPosition(pos + nRead);
+    return nRead;
   }
-  return Read(pBuffer, szBuffer);
+  // Use pread() so that concurrent positioned reads from several threads do
+  // not race on the shared file offset. The offset is still advanced
+  // afterwards for callers that mix positioned and sequential reads.
+  ssize_t nRead = pread(m_nFD, pBuffer, szBuffer, pos);
+  if (nRead < 0)
+    return 0;
+  SetPosition(pos + nRead);
+  return nRead;
 }
 size_t CFXCRT_FileAccess_Posix::WritePos(const void* pBuffer,
                                          size_t szBuffer,
@@ -134,4 +182,8 @@ bool CFXCRT_FileAccess_Posix::Truncate(FX_FILESIZE szFile) {
   return !ftruncate(m_nFD, szFile);
 }
 
+const uint8_t* CFXCRT_FileAccess_Posix::GetMappedData() const {
+  return static_cast<const uint8_t*>(m_pMappedData);
+}
+
 #endif
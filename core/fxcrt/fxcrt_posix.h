@@ -32,9 +32,14 @@ class CFXCRT_FileAccess_Posix : public IFXCRT_FileAccess {
                   FX_FILESIZE pos) override;
   bool Flush() override;
   bool Truncate(FX_FILESIZE szFile) override;
+  const uint8_t* GetMappedData() const override;
 
  protected:
+  void MapFile();
+
   int32_t m_nFD;
+  void* m_pMappedData;
+  size_t m_nMappedSize;
 };
 #endif
 
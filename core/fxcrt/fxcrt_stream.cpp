@@ -22,6 +22,10 @@ size_t IFX_SeekableReadStream::ReadBlock(void* buffer, size_t size) {
   return 0;
 }
 
+const uint8_t* IFX_SeekableReadStream::GetMappedData() {
+  return nullptr;
+}
+
 bool IFX_SeekableStream::WriteBlock(const void* buffer, size_t size) {
   return WriteBlock(buffer, GetSize(), size);
 }
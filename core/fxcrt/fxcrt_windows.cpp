@@ -185,4 +185,8 @@ bool CFXCRT_FileAccess_Win64::Truncate(FX_FILESIZE szFile) {
 
   return !!::SetEndOfFile(m_hFile);
 }
+
+const uint8_t* CFXCRT_FileAccess_Win64::GetMappedData() const {
+  return nullptr;
+}
 #endif
@@ -30,6 +30,7 @@ class CFXCRT_FileAccess_Win64 : public IFXCRT_FileAccess {
                   FX_FILESIZE pos) override;
   bool Flush() override;
   bool Truncate(FX_FILESIZE szFile) override;
+  const uint8_t* GetMappedData() const override;
 
  protected:
   void* m_hFile;
@@ -16,8 +16,8 @@
 #include "core/fxge/cfx_pathdata.h"
 #include "core/fxge/cfx_renderdevice.h"
 #include "core/fxge/dib/dib_int.h"
+#include "core/fxge/fx_font.h"
 #include "core/fxge/fx_freetype.h"
-#include "core/fxge/ge/fx_text_int.h"
 #include "third_party/base/ptr_util.h"
 
 #include "core/fxge/apple/apple_int.h"
@@ -10,12 +10,14 @@
 #include <map>
 #include <memory>
 
+#include "core/fxge/cfx_glyphcache.h"
 #include "core/fxge/fx_font.h"
 #include "core/fxge/fx_freetype.h"
 
 class CFX_FaceCache {
  public:
-  explicit CFX_FaceCache(FXFT_Face face);
+  // Glyph bitmaps are kept in |pGlyphCache|, which must outlive this.
+  CFX_FaceCache(FXFT_Face face, CFX_GlyphCache* pGlyphCache);
   ~CFX_FaceCache();
   const CFX_GlyphBitmap* LoadGlyphBitmap(const CFX_Font* pFont,
                                          uint32_t glyph_index,
@@ -44,18 +46,17 @@ class CFX_FaceCache {
                                           const CFX_Matrix* pMatrix,
                                           int dest_width,
                                           int anti_alias);
-  CFX_GlyphBitmap* LookUpGlyphBitmap(const CFX_Font* pFont,
-                                     const CFX_Matrix* pMatrix,
-                                     const CFX_ByteString& FaceGlyphsKey,
-                                     uint32_t glyph_index,
-                                     bool bFontStyle,
-                                     int dest_width,
-                                     int anti_alias);
+  const CFX_GlyphBitmap* LookUpGlyphBitmap(const CFX_Font* pFont,
+                                           const CFX_Matrix* pMatrix,
+                                           const CFX_GlyphCache::Key& key,
+                                           bool bFontStyle,
+                                           int dest_width,
+                                           int anti_alias);
   void InitPlatform();
   void DestroyPlatform();
 
   FXFT_Face const m_Face;
-  std::map<CFX_ByteString, std::unique_ptr<CFX_SizeGlyphCache>> m_SizeMap;
+  CFX_GlyphCache* const m_pGlyphCache;
   std::map<uint32_t, std::unique_ptr<CFX_PathData>> m_PathMap;
 #if defined _SKIA_SUPPORT_ || _SKIA_SUPPORT_PATHS_
   CFX_TypeFace* m_pTypeface;
@@ -7,10 +7,15 @@
 #ifndef CORE_FXGE_CFX_FONTCACHE_H_
 #define CORE_FXGE_CFX_FONTCACHE_H_
 
+#include <list>
 #include <map>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
+#include "core/fxcrt/cfx_mutex.h"
 #include "core/fxcrt/fx_system.h"
+#include "core/fxge/cfx_glyphcache.h"
 #include "core/fxge/fx_font.h"
 #include "core/fxge/fx_freetype.h"
 
@@ -18,14 +23,44 @@ class CFX_FaceCache;
 
 class CFX_FontCache {
  public:
+  struct EmbeddedFaceStats {
+    uint32_t nHits;
+    uint32_t nMisses;
+    uint32_t nEvictions;
+    uint32_t nFaces;
+    uint32_t nBytes;
+    uint32_t nMaxBytes;
+  };
+
   CFX_FontCache();
   ~CFX_FontCache();
   CFX_FaceCache* GetCachedFace(const CFX_Font* pFont);
   void ReleaseCachedFace(const CFX_Font* pFont);
+  CFX_GlyphCache* GetGlyphCache() { return &m_GlyphCache; }
 #ifdef _SKIA_SUPPORT_
   CFX_TypeFace* GetDeviceCache(const CFX_Font* pFont);
 #endif
 
+  // Embedded fonts with the same font program share one face, and with it
+  // one face cache and its glyphs, whichever document they come from. Faces
+  // no font uses any more are kept as long as the font programs of all the
+  // faces fit in |nMaxBytes|, the least recently used going first. 0, the
+  // default, turns sharing off.
+  void SetEmbeddedFaceCacheLimit(uint32_t nMaxBytes);
+  EmbeddedFaceStats GetEmbeddedFaceStats() const;
+
+  // Returns the shared face for the font program in |pData|, loading it
+  // from a copy the cache keeps if need be, and that copy in |*ppFontData|.
+  // Returns nullptr if sharing is off, if the program does not fit or if
+  // it does not load; the caller loads a face of its own then.
+  FXFT_Face GetEmbeddedFace(const uint8_t* pData,
+                            uint32_t size,
+                            uint8_t** ppFontData);
+
+  // Lets go of |face| from GetEmbeddedFace(). Returns false if |face| is
+  // not a shared face.
+  bool ReleaseEmbeddedFace(FXFT_Face face);
+
  private:
   struct CountedFaceCache {
     CountedFaceCache();
@@ -34,9 +69,39 @@ class CFX_FontCache {
     uint32_t m_nCount;
   };
 
+  struct EmbeddedFace {
+    uint32_t hash;
+    std::vector<uint8_t> data;
+    FXFT_Face face;
+    FXFT_CharMap charmap;  // As FreeType selected it on load.
+    int nRefs;
+  };
+  using EmbeddedFaceList = std::list<EmbeddedFace>;
+
   using CFX_FTCacheMap = std::map<FXFT_Face, std::unique_ptr<CountedFaceCache>>;
+
+  CFX_FaceCache* GetCachedFaceLocked(FXFT_Face face);
+  void ReleaseCachedFaceLocked(FXFT_Face face);
+  void EraseEmbeddedFaceLocked(EmbeddedFaceList::iterator it);
+  // Evicts unused shared faces until |nReserve| more bytes fit within the
+  // budget. Returns false if they do not.
+  bool TrimEmbeddedFacesLocked(uint32_t nReserve);
+
+  // Declared first, as the face caches remove their glyphs on destruction.
+  CFX_GlyphCache m_GlyphCache;
+  mutable CFX_Mutex m_Lock;
   CFX_FTCacheMap m_FTFaceMap;
   CFX_FTCacheMap m_ExtFaceMap;
+  EmbeddedFaceList m_EmbeddedFaces;  // Most recently used first.
+  std::unordered_multimap<uint32_t, EmbeddedFaceList::iterator>
+      m_EmbeddedHashIndex;
+  std::unordered_map<FXFT_Face, EmbeddedFaceList::iterator>
+      m_EmbeddedFaceIndex;
+  uint32_t m_nEmbeddedBytes;
+  uint32_t m_nMaxEmbeddedBytes;
+  uint32_t m_nEmbeddedHits;
+  uint32_t m_nEmbeddedMisses;
+  uint32_t m_nEmbeddedEvictions;
 };
 
 #endif  // CORE_FXGE_CFX_FONTCACHE_H_
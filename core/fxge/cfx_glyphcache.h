@@ -0,0 +1,110 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXGE_CFX_GLYPHCACHE_H_
+#define CORE_FXGE_CFX_GLYPHCACHE_H_
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "core/fxcrt/cfx_mutex.h"
+#include "core/fxcrt/fx_system.h"
+#include "core/fxge/fx_font.h"
+
+// Process-wide cache of rendered glyph bitmaps, shared by all faces. The
+// least recently used glyphs are evicted to keep the total size within a
+// byte budget, whichever face they belong to.
+//
+// Glyphs are handed out pinned, as the text renderer uses all the glyphs of
+// a text object at once: a pinned glyph is not evicted until it is
+// unpinned, even if that takes the cache over its budget for a while.
+class CFX_GlyphCache {
+ public:
+  // Everything a glyph bitmap depends on. Plain data, so that it is cheap
+  // to build and to hash for every glyph drawn.
+  struct Key {
+    bool operator==(const Key& that) const;
+
+    const void* pFace;  // The CFX_FaceCache the glyph is rendered with.
+    uint32_t glyph_index;
+    int32_t matrix[4];  // In units of 1/10000.
+    int32_t dest_width;
+    int32_t anti_alias;
+    // Of the substitute font, if there is one, else 0.
+    int32_t weight;
+    int32_t italic_angle;
+    uint32_t flags;
+  };
+
+  // Values for Key::flags.
+  static const uint32_t kSubstFont = 1 << 0;
+  static const uint32_t kVertical = 1 << 1;
+  static const uint32_t kNativeText = 1 << 2;
+
+  struct Stats {
+    uint32_t nHits;
+    uint32_t nMisses;
+    uint32_t nEvictions;
+    uint32_t nGlyphs;
+    uint32_t nBytes;
+    uint32_t nMaxBytes;
+  };
+
+  static const uint32_t kDefaultMaxBytes = 32 * 1024 * 1024;
+
+  CFX_GlyphCache();
+  ~CFX_GlyphCache();
+
+  void SetMaxBytes(uint32_t nMaxBytes);
+  Stats GetStats() const;
+
+  // Looks up the glyph for |key| and counts a hit, or counts a miss and
+  // returns false. On a hit, |*ppGlyph| receives the glyph, pinned, or
+  // nullptr if it failed to render.
+  bool Lookup(const Key& key, const CFX_GlyphBitmap** ppGlyph);
+
+  // Stores |pGlyph|, which may be null, for |key| and returns it, pinned.
+  // If the cache holds a glyph for |key| already, as another thread
+  // rendered it meanwhile, that one is returned instead.
+  const CFX_GlyphBitmap* Put(const Key& key,
+                             std::unique_ptr<CFX_GlyphBitmap> pGlyph);
+
+  // Unpins the glyphs in |glyphs|, once for each time they occur, and
+  // evicts what only stayed beyond the budget as it was pinned.
+  void Unpin(const std::vector<FXTEXT_GLYPHPOS>& glyphs);
+
+  // Drops the glyphs of |pFace|, which is going away.
+  void RemoveFace(const void* pFace);
+
+ private:
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+  struct Entry {
+    Key key;
+    std::unique_ptr<CFX_GlyphBitmap> pGlyph;
+    uint32_t nBytes;
+  };
+  using EntryList = std::list<Entry>;
+
+  void PinLocked(const CFX_GlyphBitmap* pGlyph);
+  EntryList::iterator EraseLocked(EntryList::iterator it);
+  // Evicts unpinned glyphs until |nReserve| more bytes fit within the
+  // budget, or there are no more to evict.
+  void TrimLocked(uint32_t nReserve);
+
+  mutable CFX_Mutex m_Lock;
+  EntryList m_Entries;  // Most recently used first.
+  std::unordered_map<Key, EntryList::iterator, KeyHash> m_Index;
+  std::unordered_map<const CFX_GlyphBitmap*, int> m_Pins;
+  uint32_t m_nBytes;
+  uint32_t m_nMaxBytes;
+  uint32_t m_nHits;
+  uint32_t m_nMisses;
+  uint32_t m_nEvictions;
+};
+
+#endif  // CORE_FXGE_CFX_GLYPHCACHE_H_
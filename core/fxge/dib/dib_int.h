@@ -9,10 +9,14 @@
 
 #include <stdint.h>
 
+#include <vector>
+
 #include "core/fxcrt/fx_coordinates.h"
 #include "core/fxge/fx_dib.h"
 
+class CFX_ThreadPool;
 class IFX_ScanlineComposer;
+struct FXDIB_StretchKernels;
 
 extern const int16_t SDP_Table[513];
 
@@ -81,6 +85,31 @@ class CStretchEngine {
   bool ContinueStretchHorz(IFX_Pause* pPause);
   void StretchVert();
 
+  // Returns the pool to spread a pass over |rows| rows of the destination
+  // width over, or nullptr if the pass is too small or there is no pool.
+  CFX_ThreadPool* GetWorkerPool(int rows) const;
+  bool ContinueStretchHorzInBands(CFX_ThreadPool* pPool, IFX_Pause* pPause);
+  // Resamples source |row| into the intermediate buffers. Returns false if
+  // the weights run out.
+  bool StretchHorzRow(int row,
+                      const uint8_t* src_scan,
+                      const uint8_t* src_scan_mask) const;
+  void StretchVertInBands(CFX_ThreadPool* pPool,
+                          const CWeightTable& table,
+                          const FXDIB_StretchKernels* pKernels);
+  // Resamples destination |row| from the intermediate buffers, with
+  // |pKernels| unless it is nullptr. Pixels of methods 6 and 8 that have no
+  // alpha at all keep their colors; |pColorWritten|, unless nullptr, gets
+  // whether each pixel's were written. |pSums| is scratch space. Returns
+  // false if the weights run out.
+  bool StretchVertRow(const CWeightTable& table,
+                      const FXDIB_StretchKernels* pKernels,
+                      int row,
+                      uint8_t* dest_scan,
+                      uint8_t* dest_scan_mask,
+                      uint8_t* pColorWritten,
+                      std::vector<int32_t>* pSums) const;
+
   FXDIB_Format m_DestFormat;
   int m_DestBpp;
   int m_SrcBpp;
@@ -7,6 +7,7 @@
 #include "core/fxcodec/fx_codec.h"
 #include "core/fxge/cfx_gemodule.h"
 #include "core/fxge/dib/dib_int.h"
+#include "core/fxge/dib/fx_dib_simd.h"
 #include "core/fxge/ge/cfx_cliprgn.h"
 
 namespace {
@@ -746,6 +747,15 @@ void CompositeRow_Argb2Argb(uint8_t* dest_scan,
                             const uint8_t* clip_scan,
                             uint8_t* dest_alpha_scan,
                             const uint8_t* src_alpha_scan) {
+  const FXDIB_CompositeKernels* pKernels = FXDIB_GetCompositeKernels();
+  if (pKernels && !blend_type && !dest_alpha_scan && !src_alpha_scan) {
+    int done = pKernels->Argb2Argb(dest_scan, src_scan, pixel_count, clip_scan);
+    dest_scan += done * 4;
+    src_scan += done * 4;
+    if (clip_scan)
+      clip_scan += done;
+    pixel_count -= done;
+  }
   int blended_colors[3];
   bool bNonseparableBlend = blend_type >= FXDIB_BLEND_NONSEPARABLE;
   if (!dest_alpha_scan) {
@@ -1288,6 +1298,15 @@ void CompositeRow_Argb2Rgb_NoBlend(uint8_t* dest_scan,
                                    int dest_Bpp,
                                    const uint8_t* clip_scan,
                                    const uint8_t* src_alpha_scan) {
+  const FXDIB_CompositeKernels* pKernels = FXDIB_GetCompositeKernels();
+  if (pKernels && dest_Bpp == 4 && !src_alpha_scan) {
+    int done = pKernels->Argb2Rgb32(dest_scan, src_scan, width, clip_scan);
+    dest_scan += done * 4;
+    src_scan += done * 4;
+    if (clip_scan)
+      clip_scan += done;
+    width -= done;
+  }
   int dest_gap = dest_Bpp - 3;
   if (src_alpha_scan) {
     for (int col = 0; col < width; col++) {
@@ -1437,6 +1456,14 @@ void CompositeRow_Rgb2Rgb_NoBlend_Clip(uint8_t* dest_scan,
                                        int dest_Bpp,
                                        int src_Bpp,
                                        const uint8_t* clip_scan) {
+  const FXDIB_CompositeKernels* pKernels = FXDIB_GetCompositeKernels();
+  if (pKernels && dest_Bpp == 4 && src_Bpp == 4) {
+    int done = pKernels->Rgb322Rgb32Clip(dest_scan, src_scan, width, clip_scan);
+    dest_scan += done * 4;
+    src_scan += done * 4;
+    clip_scan += done;
+    width -= done;
+  }
   for (int col = 0; col < width; col++) {
     int src_alpha = clip_scan[col];
     if (src_alpha == 255) {
@@ -2491,6 +2518,16 @@ void CompositeRow_ByteMask2Argb(uint8_t* dest_scan,
                                 int pixel_count,
                                 int blend_type,
                                 const uint8_t* clip_scan) {
+  const FXDIB_CompositeKernels* pKernels = FXDIB_GetCompositeKernels();
+  if (pKernels && !blend_type && mask_alpha >= 0 && mask_alpha <= 255) {
+    int done = pKernels->ByteMask2Argb(dest_scan, src_scan, mask_alpha, src_r,
+                                       src_g, src_b, pixel_count, clip_scan);
+    dest_scan += done * 4;
+    src_scan += done;
+    if (clip_scan)
+      clip_scan += done;
+    pixel_count -= done;
+  }
   for (int col = 0; col < pixel_count; col++) {
     int src_alpha;
     if (clip_scan) {
@@ -2630,6 +2667,17 @@ void CompositeRow_ByteMask2Rgb(uint8_t* dest_scan,
                                int blend_type,
                                int Bpp,
                                const uint8_t* clip_scan) {
+  const FXDIB_CompositeKernels* pKernels = FXDIB_GetCompositeKernels();
+  if (pKernels && !blend_type && Bpp == 4 && mask_alpha >= 0 &&
+      mask_alpha <= 255) {
+    int done = pKernels->ByteMask2Rgb32(dest_scan, src_scan, mask_alpha, src_r,
+                                        src_g, src_b, pixel_count, clip_scan);
+    dest_scan += done * 4;
+    src_scan += done;
+    if (clip_scan)
+      clip_scan += done;
+    pixel_count -= done;
+  }
   for (int col = 0; col < pixel_count; col++) {
     int src_alpha;
     if (clip_scan) {
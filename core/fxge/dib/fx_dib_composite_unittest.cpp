@@ -0,0 +1,142 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "core/fxcrt/fx_cpu.h"
+#include "core/fxge/fx_dib.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+struct CompositeCase {
+  FXDIB_Format dest_format;
+  FXDIB_Format src_format;
+  uint32_t mask_color;
+  int blend_type;
+};
+
+const CompositeCase kCases[] = {
+    {FXDIB_Argb, FXDIB_Argb, 0, FXDIB_BLEND_NORMAL},
+    {FXDIB_Rgb32, FXDIB_Argb, 0, FXDIB_BLEND_NORMAL},
+    {FXDIB_Rgb, FXDIB_Argb, 0, FXDIB_BLEND_NORMAL},
+    {FXDIB_Rgb32, FXDIB_Rgb32, 0, FXDIB_BLEND_NORMAL},
+    {FXDIB_Rgb32, FXDIB_Rgb, 0, FXDIB_BLEND_NORMAL},
+    {FXDIB_Argb, FXDIB_Argb, 0, FXDIB_BLEND_MULTIPLY},
+    {FXDIB_Argb, FXDIB_8bppMask, 0xff3399cc, FXDIB_BLEND_NORMAL},
+    {FXDIB_Argb, FXDIB_8bppMask, 0x80102030, FXDIB_BLEND_NORMAL},
+    {FXDIB_Rgb32, FXDIB_8bppMask, 0xffcc9933, FXDIB_BLEND_NORMAL},
+    {FXDIB_Rgb32, FXDIB_8bppMask, 0x01fefdfc, FXDIB_BLEND_NORMAL},
+    {FXDIB_Rgb, FXDIB_8bppMask, 0xc0405060, FXDIB_BLEND_NORMAL},
+    {FXDIB_Rgb32, FXDIB_8bppMask, 0xffffffff, FXDIB_BLEND_SCREEN},
+};
+
+// Deterministic bytes, a third of them 0 or 255 since those values take
+// shortcuts in the compositing code.
+class ByteSource {
+ public:
+  ByteSource() : m_State(12345) {}
+
+  uint8_t Next() {
+    m_State = m_State * 1103515245 + 12345;
+    uint32_t value = m_State >> 16;
+    switch (value % 6) {
+      case 0:
+        return 0;
+      case 1:
+        return 255;
+      default:
+        return static_cast<uint8_t>(value >> 3);
+    }
+  }
+
+  std::vector<uint8_t> Row(size_t size) {
+    std::vector<uint8_t> row(size);
+    for (uint8_t& byte : row)
+      byte = Next();
+    return row;
+  }
+
+  // Rows of pixels where all of a run of pixels are opaque or transparent,
+  // so that whole vectors of them take the shortcuts.
+  std::vector<uint8_t> PixelRow(int width, int Bpp) {
+    std::vector<uint8_t> row = Row(width * Bpp);
+    if (Bpp == 4) {
+      for (int i = 0; i < width; ++i) {
+        int run = (i / 8) % 3;
+        if (run)
+          row[i * 4 + 3] = run == 1 ? 0 : 255;
+      }
+    }
+    return row;
+  }
+
+ private:
+  uint32_t m_State;
+};
+
+std::vector<uint8_t> Composite(uint32_t cpu_features,
+                               const CompositeCase& test_case,
+                               const std::vector<uint8_t>& dest,
+                               const std::vector<uint8_t>& src,
+                               const uint8_t* clip_scan,
+                               int width) {
+  FXCPU_SetFeatureMaskForTesting(cpu_features);
+  CFX_ScanlineCompositor compositor;
+  EXPECT_TRUE(compositor.Init(test_case.dest_format, test_case.src_format,
+                              width, nullptr, test_case.mask_color,
+                              test_case.blend_type, !!clip_scan));
+  std::vector<uint8_t> result = dest;
+  if (test_case.src_format == FXDIB_8bppMask) {
+    compositor.CompositeByteMaskLine(result.data(), src.data(), width,
+                                     clip_scan);
+  } else {
+    compositor.CompositeRgbBitmapLine(result.data(), src.data(), width,
+                                      clip_scan);
+  }
+  FXCPU_SetFeatureMaskForTesting(~0u);
+  return result;
+}
+
+}  // namespace
+
+TEST(fx_dib_composite, VectorizedMatchesScalar) {
+  ByteSource bytes;
+  for (const CompositeCase& test_case : kCases) {
+    int dest_Bpp = (test_case.dest_format & 0xff) >> 3;
+    int src_Bpp = (test_case.src_format & 0xff) >> 3;
+    for (int width = 1; width <= 41; ++width) {
+      std::vector<uint8_t> dest = bytes.PixelRow(width, dest_Bpp);
+      std::vector<uint8_t> src = bytes.PixelRow(width, src_Bpp);
+      std::vector<uint8_t> clip = bytes.Row(width);
+      for (const uint8_t* clip_scan : {static_cast<uint8_t*>(nullptr),
+                                       clip.data()}) {
+        std::vector<uint8_t> expected =
+            Composite(0, test_case, dest, src, clip_scan, width);
+        EXPECT_EQ(expected, Composite(FXCPU_SSE2, test_case, dest, src,
+                                      clip_scan, width))
+            << "SSE2, case " << (&test_case - kCases) << ", width " << width;
+        EXPECT_EQ(expected,
+                  Composite(~0u, test_case, dest, src, clip_scan, width))
+            << "all, case " << (&test_case - kCases) << ", width " << width;
+      }
+    }
+  }
+}
+
+TEST(fx_dib_composite, ArgbOverArgb) {
+  // Two half transparent pixels, enough of them for the vectorized code.
+  const int kWidth = 16;
+  std::vector<uint8_t> dest(kWidth * 4);
+  std::vector<uint8_t> src(kWidth * 4);
+  for (int i = 0; i < kWidth; ++i) {
+    FXARGB_SETDIB(&dest[i * 4], 0x800000ff);
+    FXARGB_SETDIB(&src[i * 4], 0x80ff0000);
+  }
+  CompositeCase test_case = {FXDIB_Argb, FXDIB_Argb, 0, FXDIB_BLEND_NORMAL};
+  std::vector<uint8_t> result =
+      Composite(~0u, test_case, dest, src, nullptr, kWidth);
+  for (int i = 0; i < kWidth; ++i)
+    EXPECT_EQ(0xc0aa0055, FXARGB_GETDIB(&result[i * 4]));
+}
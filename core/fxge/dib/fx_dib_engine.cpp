@@ -7,13 +7,21 @@
 #include <limits.h>
 
 #include <algorithm>
+#include <vector>
 
+#include "core/fxcrt/cfx_threadpool.h"
 #include "core/fxge/dib/dib_int.h"
+#include "core/fxge/dib/fx_dib_simd.h"
 #include "core/fxge/fx_dib.h"
 #include "third_party/base/ptr_util.h"
 
 namespace {
 
+// Passes over at least this many destination pixels are spread over the
+// worker threads, a band of rows at a time.
+const int64_t kMinParallelStretchPixels = 256 * 1024;
+const int kStretchBandRows = 64;
+
 bool SourceSizeWithinLimit(int width, int height) {
   const int kMaxProgressiveStretchPixels = 1000000;
   return !height || width < kMaxProgressiveStretchPixels / height;
@@ -30,6 +38,20 @@ FXDIB_Format GetStretchedFormat(const CFX_DIBSource& src) {
   return format;
 }
 
+// The scalar counterpart of FXDIB_StretchKernels::StretchSums().
+void SumRows(int32_t* sums,
+             const uint8_t* src,
+             int src_pitch,
+             const int* weights,
+             int weight_count,
+             int len) {
+  std::fill(sums, sums + len, 0);
+  for (int j = 0; j < weight_count; j++, src += src_pitch) {
+    for (int i = 0; i < len; i++)
+      sums[i] += weights[j] * src[i];
+  }
+}
+
 }  // namespace
 
 CWeightTable::CWeightTable()
@@ -297,9 +319,7 @@ CStretchEngine::CStretchEngine(IFX_ScanlineComposer* pDestBitmap,
   if (!m_pDestScanline) {
     return;
   }
-  if (dest_format == FXDIB_Rgb32) {
-    FXSYS_memset(m_pDestScanline, 255, size);
-  }
+  FXSYS_memset(m_pDestScanline, dest_format == FXDIB_Rgb32 ? 255 : 0, size);
   m_InterPitch = (m_DestClip.Width() * m_DestBpp + 31) / 32 * 4;
   m_ExtraMaskPitch = (m_DestClip.Width() * 8 + 31) / 32 * 4;
   m_pInterBuf = nullptr;
@@ -381,6 +401,14 @@ CStretchEngine::~CStretchEngine() {
   FX_Free(m_pDestMaskScanline);
 }
 
+CFX_ThreadPool* CStretchEngine::GetWorkerPool(int rows) const {
+  if (static_cast<int64_t>(m_DestClip.Width()) * rows <
+      kMinParallelStretchPixels) {
+    return nullptr;
+  }
+  return CFX_ThreadPool::Get();
+}
+
 bool CStretchEngine::Continue(IFX_Pause* pPause) {
   while (m_State == 1) {
     if (ContinueStretchHorz(pPause)) {
@@ -431,7 +459,10 @@ bool CStretchEngine::ContinueStretchHorz(IFX_Pause* pPause) {
   if (m_pSource->SkipToScanline(m_CurRow, pPause))
     return true;
 
-  int Bpp = m_DestBpp / 8;
+  CFX_ThreadPool* pPool = GetWorkerPool(m_SrcClip.Height());
+  if (pPool)
+    return ContinueStretchHorzInBands(pPool, pPause);
+
   static const int kStrechPauseRows = 10;
   int rows_to_go = kStrechPauseRows;
   for (; m_CurRow < m_SrcClip.bottom; m_CurRow++) {
@@ -443,245 +474,302 @@ bool CStretchEngine::ContinueStretchHorz(IFX_Pause* pPause) {
     }
 
     const uint8_t* src_scan = m_pSource->GetScanline(m_CurRow);
-    uint8_t* dest_scan =
-        m_pInterBuf + (m_CurRow - m_SrcClip.top) * m_InterPitch;
     const uint8_t* src_scan_mask = nullptr;
-    uint8_t* dest_scan_mask = nullptr;
-    if (m_pExtraAlphaBuf) {
+    if (m_pExtraAlphaBuf)
       src_scan_mask = m_pSource->m_pAlphaMask->GetScanline(m_CurRow);
-      dest_scan_mask =
-          m_pExtraAlphaBuf + (m_CurRow - m_SrcClip.top) * m_ExtraMaskPitch;
-    }
-    switch (m_TransMethod) {
-      case 1:
-      case 2: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
-          int dest_a = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight =
-                m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return false;
-
-            int pixel_weight = *pWeight;
-            if (src_scan[j / 8] & (1 << (7 - j % 8))) {
-              dest_a += pixel_weight * 255;
-            }
-          }
-          if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-            dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
+    if (!StretchHorzRow(m_CurRow, src_scan, src_scan_mask))
+      return false;
+
+    rows_to_go--;
+  }
+  return false;
+}
+
+bool CStretchEngine::ContinueStretchHorzInBands(CFX_ThreadPool* pPool,
+                                                IFX_Pause* pPause) {
+  // The source may reuse one buffer for all its scanlines, and may not be
+  // read from other threads, so each band of rows is copied out first.
+  // Scanlines may point straight into stream data that ends right after the
+  // last pixel of the last row, so only the bytes up to the clip are read.
+  const size_t src_pitch = m_pSource->GetPitch();
+  const size_t src_bytes = (m_SrcClip.right * m_pSource->GetBPP() + 7) / 8;
+  const size_t mask_pitch =
+      m_pExtraAlphaBuf ? m_pSource->m_pAlphaMask->GetPitch() : 0;
+  const size_t mask_bytes =
+      m_pExtraAlphaBuf
+          ? (m_SrcClip.right * m_pSource->m_pAlphaMask->GetBPP() + 7) / 8
+          : 0;
+  std::vector<uint8_t> src_rows(kStretchBandRows * src_pitch);
+  std::vector<uint8_t> mask_rows(kStretchBandRows * mask_pitch);
+  std::vector<uint8_t> results(kStretchBandRows);
+  while (m_CurRow < m_SrcClip.bottom) {
+    const int band_top = m_CurRow;
+    const int count = std::min(kStretchBandRows, m_SrcClip.bottom - band_top);
+    for (int i = 0; i < count; ++i) {
+      FXSYS_memcpy(&src_rows[i * src_pitch],
+                   m_pSource->GetScanline(band_top + i), src_bytes);
+      if (mask_pitch) {
+        FXSYS_memcpy(&mask_rows[i * mask_pitch],
+                     m_pSource->m_pAlphaMask->GetScanline(band_top + i),
+                     mask_bytes);
+      }
+    }
+    pPool->ParallelFor(count, [this, band_top, src_pitch, mask_pitch,
+                               &src_rows, &mask_rows, &results](size_t i) {
+      results[i] = StretchHorzRow(
+          band_top + static_cast<int>(i), &src_rows[i * src_pitch],
+          mask_pitch ? &mask_rows[i * mask_pitch] : nullptr);
+    });
+    if (std::find(results.begin(), results.begin() + count, 0) !=
+        results.begin() + count) {
+      return false;
+    }
+
+    m_CurRow += count;
+    if (m_CurRow < m_SrcClip.bottom && pPause && pPause->NeedToPauseNow())
+      return true;
+  }
+  return false;
+}
+
+bool CStretchEngine::StretchHorzRow(int row,
+                                    const uint8_t* src_scan,
+                                    const uint8_t* src_scan_mask) const {
+  int Bpp = m_DestBpp / 8;
+  uint8_t* dest_scan = m_pInterBuf + (row - m_SrcClip.top) * m_InterPitch;
+  uint8_t* dest_scan_mask = nullptr;
+  if (m_pExtraAlphaBuf) {
+    dest_scan_mask =
+        m_pExtraAlphaBuf + (row - m_SrcClip.top) * m_ExtraMaskPitch;
+  }
+  switch (m_TransMethod) {
+    case 1:
+    case 2: {
+      for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
+        PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+        int dest_a = 0;
+        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
+             j++) {
+          int* pWeight =
+              m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
+          if (!pWeight)
+            return false;
+
+          int pixel_weight = *pWeight;
+          if (src_scan[j / 8] & (1 << (7 - j % 8))) {
+            dest_a += pixel_weight * 255;
           }
-          *dest_scan++ = (uint8_t)(dest_a >> 16);
         }
-        break;
+        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+          dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
+        }
+        *dest_scan++ = (uint8_t)(dest_a >> 16);
       }
-      case 3: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
-          int dest_a = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight =
-                m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return false;
-
-            int pixel_weight = *pWeight;
-            dest_a += pixel_weight * src_scan[j];
-          }
-          if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-            dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
-          }
-          *dest_scan++ = (uint8_t)(dest_a >> 16);
+      break;
+    }
+    case 3: {
+      for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
+        PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+        int dest_a = 0;
+        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
+             j++) {
+          int* pWeight =
+              m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
+          if (!pWeight)
+            return false;
+
+          int pixel_weight = *pWeight;
+          dest_a += pixel_weight * src_scan[j];
         }
-        break;
+        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+          dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
+        }
+        *dest_scan++ = (uint8_t)(dest_a >> 16);
       }
-      case 4: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
-          int dest_a = 0, dest_r = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight =
-                m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return false;
-
-            int pixel_weight = *pWeight;
-            pixel_weight = pixel_weight * src_scan_mask[j] / 255;
-            dest_r += pixel_weight * src_scan[j];
-            dest_a += pixel_weight;
-          }
-          if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-            dest_r = dest_r < 0 ? 0 : dest_r > 16711680 ? 16711680 : dest_r;
-            dest_a = dest_a < 0 ? 0 : dest_a > 65536 ? 65536 : dest_a;
-          }
-          *dest_scan++ = (uint8_t)(dest_r >> 16);
-          *dest_scan_mask++ = (uint8_t)((dest_a * 255) >> 16);
+      break;
+    }
+    case 4: {
+      for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
+        PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+        int dest_a = 0, dest_r = 0;
+        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
+             j++) {
+          int* pWeight =
+              m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
+          if (!pWeight)
+            return false;
+
+          int pixel_weight = *pWeight;
+          pixel_weight = pixel_weight * src_scan_mask[j] / 255;
+          dest_r += pixel_weight * src_scan[j];
+          dest_a += pixel_weight;
         }
-        break;
+        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+          dest_r = dest_r < 0 ? 0 : dest_r > 16711680 ? 16711680 : dest_r;
+          dest_a = dest_a < 0 ? 0 : dest_a > 65536 ? 65536 : dest_a;
+        }
+        *dest_scan++ = (uint8_t)(dest_r >> 16);
+        *dest_scan_mask++ = (uint8_t)((dest_a * 255) >> 16);
       }
-      case 5: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
-          int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight =
-                m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return false;
-
-            int pixel_weight = *pWeight;
-            unsigned long argb_cmyk = m_pSrcPalette[src_scan[j]];
-            if (m_DestFormat == FXDIB_Rgb) {
-              dest_r_y += pixel_weight * (uint8_t)(argb_cmyk >> 16);
-              dest_g_m += pixel_weight * (uint8_t)(argb_cmyk >> 8);
-              dest_b_c += pixel_weight * (uint8_t)argb_cmyk;
-            } else {
-              dest_b_c += pixel_weight * (uint8_t)(argb_cmyk >> 24);
-              dest_g_m += pixel_weight * (uint8_t)(argb_cmyk >> 16);
-              dest_r_y += pixel_weight * (uint8_t)(argb_cmyk >> 8);
-            }
-          }
-          if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-            dest_r_y =
-                dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
-            dest_g_m =
-                dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
-            dest_b_c =
-                dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
+      break;
+    }
+    case 5: {
+      for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
+        PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+        int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
+        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
+             j++) {
+          int* pWeight =
+              m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
+          if (!pWeight)
+            return false;
+
+          int pixel_weight = *pWeight;
+          unsigned long argb_cmyk = m_pSrcPalette[src_scan[j]];
+          if (m_DestFormat == FXDIB_Rgb) {
+            dest_r_y += pixel_weight * (uint8_t)(argb_cmyk >> 16);
+            dest_g_m += pixel_weight * (uint8_t)(argb_cmyk >> 8);
+            dest_b_c += pixel_weight * (uint8_t)argb_cmyk;
+          } else {
+            dest_b_c += pixel_weight * (uint8_t)(argb_cmyk >> 24);
+            dest_g_m += pixel_weight * (uint8_t)(argb_cmyk >> 16);
+            dest_r_y += pixel_weight * (uint8_t)(argb_cmyk >> 8);
           }
-          *dest_scan++ = (uint8_t)(dest_b_c >> 16);
-          *dest_scan++ = (uint8_t)(dest_g_m >> 16);
-          *dest_scan++ = (uint8_t)(dest_r_y >> 16);
         }
-        break;
+        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+          dest_r_y =
+              dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
+          dest_g_m =
+              dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
+          dest_b_c =
+              dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
+        }
+        *dest_scan++ = (uint8_t)(dest_b_c >> 16);
+        *dest_scan++ = (uint8_t)(dest_g_m >> 16);
+        *dest_scan++ = (uint8_t)(dest_r_y >> 16);
       }
-      case 6: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
-          int dest_a = 0, dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight =
-                m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return false;
-
-            int pixel_weight = *pWeight;
-            pixel_weight = pixel_weight * src_scan_mask[j] / 255;
-            unsigned long argb_cmyk = m_pSrcPalette[src_scan[j]];
-            if (m_DestFormat == FXDIB_Rgba) {
-              dest_r_y += pixel_weight * (uint8_t)(argb_cmyk >> 16);
-              dest_g_m += pixel_weight * (uint8_t)(argb_cmyk >> 8);
-              dest_b_c += pixel_weight * (uint8_t)argb_cmyk;
-            } else {
-              dest_b_c += pixel_weight * (uint8_t)(argb_cmyk >> 24);
-              dest_g_m += pixel_weight * (uint8_t)(argb_cmyk >> 16);
-              dest_r_y += pixel_weight * (uint8_t)(argb_cmyk >> 8);
-            }
-            dest_a += pixel_weight;
-          }
-          if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-            dest_b_c =
-                dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
-            dest_g_m =
-                dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
-            dest_r_y =
-                dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
-            dest_a = dest_a < 0 ? 0 : dest_a > 65536 ? 65536 : dest_a;
+      break;
+    }
+    case 6: {
+      for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
+        PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+        int dest_a = 0, dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
+        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
+             j++) {
+          int* pWeight =
+              m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
+          if (!pWeight)
+            return false;
+
+          int pixel_weight = *pWeight;
+          pixel_weight = pixel_weight * src_scan_mask[j] / 255;
+          unsigned long argb_cmyk = m_pSrcPalette[src_scan[j]];
+          if (m_DestFormat == FXDIB_Rgba) {
+            dest_r_y += pixel_weight * (uint8_t)(argb_cmyk >> 16);
+            dest_g_m += pixel_weight * (uint8_t)(argb_cmyk >> 8);
+            dest_b_c += pixel_weight * (uint8_t)argb_cmyk;
+          } else {
+            dest_b_c += pixel_weight * (uint8_t)(argb_cmyk >> 24);
+            dest_g_m += pixel_weight * (uint8_t)(argb_cmyk >> 16);
+            dest_r_y += pixel_weight * (uint8_t)(argb_cmyk >> 8);
           }
-          *dest_scan++ = (uint8_t)(dest_b_c >> 16);
-          *dest_scan++ = (uint8_t)(dest_g_m >> 16);
-          *dest_scan++ = (uint8_t)(dest_r_y >> 16);
-          *dest_scan_mask++ = (uint8_t)((dest_a * 255) >> 16);
+          dest_a += pixel_weight;
         }
-        break;
+        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+          dest_b_c =
+              dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
+          dest_g_m =
+              dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
+          dest_r_y =
+              dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
+          dest_a = dest_a < 0 ? 0 : dest_a > 65536 ? 65536 : dest_a;
+        }
+        *dest_scan++ = (uint8_t)(dest_b_c >> 16);
+        *dest_scan++ = (uint8_t)(dest_g_m >> 16);
+        *dest_scan++ = (uint8_t)(dest_r_y >> 16);
+        *dest_scan_mask++ = (uint8_t)((dest_a * 255) >> 16);
       }
-      case 7: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
-          int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight =
-                m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return false;
-
-            int pixel_weight = *pWeight;
-            const uint8_t* src_pixel = src_scan + j * Bpp;
-            dest_b_c += pixel_weight * (*src_pixel++);
-            dest_g_m += pixel_weight * (*src_pixel++);
-            dest_r_y += pixel_weight * (*src_pixel);
-          }
-          if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-            dest_b_c =
-                dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
-            dest_g_m =
-                dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
-            dest_r_y =
-                dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
-          }
-          *dest_scan++ = (uint8_t)((dest_b_c) >> 16);
-          *dest_scan++ = (uint8_t)((dest_g_m) >> 16);
-          *dest_scan++ = (uint8_t)((dest_r_y) >> 16);
-          dest_scan += Bpp - 3;
+      break;
+    }
+    case 7: {
+      for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
+        PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+        int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
+        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
+             j++) {
+          int* pWeight =
+              m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
+          if (!pWeight)
+            return false;
+
+          int pixel_weight = *pWeight;
+          const uint8_t* src_pixel = src_scan + j * Bpp;
+          dest_b_c += pixel_weight * (*src_pixel++);
+          dest_g_m += pixel_weight * (*src_pixel++);
+          dest_r_y += pixel_weight * (*src_pixel);
         }
-        break;
+        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+          dest_b_c =
+              dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
+          dest_g_m =
+              dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
+          dest_r_y =
+              dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
+        }
+        *dest_scan++ = (uint8_t)((dest_b_c) >> 16);
+        *dest_scan++ = (uint8_t)((dest_g_m) >> 16);
+        *dest_scan++ = (uint8_t)((dest_r_y) >> 16);
+        dest_scan += Bpp - 3;
       }
-      case 8: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
-          int dest_a = 0, dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight =
-                m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return false;
-
-            int pixel_weight = *pWeight;
-            const uint8_t* src_pixel = src_scan + j * Bpp;
-            if (m_DestFormat == FXDIB_Argb) {
-              pixel_weight = pixel_weight * src_pixel[3] / 255;
-            } else {
-              pixel_weight = pixel_weight * src_scan_mask[j] / 255;
-            }
-            dest_b_c += pixel_weight * (*src_pixel++);
-            dest_g_m += pixel_weight * (*src_pixel++);
-            dest_r_y += pixel_weight * (*src_pixel);
-            dest_a += pixel_weight;
-          }
-          if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-            dest_r_y =
-                dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
-            dest_g_m =
-                dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
-            dest_b_c =
-                dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
-            dest_a = dest_a < 0 ? 0 : dest_a > 65536 ? 65536 : dest_a;
-          }
-          *dest_scan++ = (uint8_t)((dest_b_c) >> 16);
-          *dest_scan++ = (uint8_t)((dest_g_m) >> 16);
-          *dest_scan++ = (uint8_t)((dest_r_y) >> 16);
+      break;
+    }
+    case 8: {
+      for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
+        PixelWeight* pPixelWeights = m_WeightTable.GetPixelWeight(col);
+        int dest_a = 0, dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
+        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
+             j++) {
+          int* pWeight =
+              m_WeightTable.GetValueFromPixelWeight(pPixelWeights, j);
+          if (!pWeight)
+            return false;
+
+          int pixel_weight = *pWeight;
+          const uint8_t* src_pixel = src_scan + j * Bpp;
           if (m_DestFormat == FXDIB_Argb) {
-            *dest_scan = (uint8_t)((dest_a * 255) >> 16);
-          }
-          if (dest_scan_mask) {
-            *dest_scan_mask++ = (uint8_t)((dest_a * 255) >> 16);
+            pixel_weight = pixel_weight * src_pixel[3] / 255;
+          } else {
+            pixel_weight = pixel_weight * src_scan_mask[j] / 255;
           }
-          dest_scan += Bpp - 3;
+          dest_b_c += pixel_weight * (*src_pixel++);
+          dest_g_m += pixel_weight * (*src_pixel++);
+          dest_r_y += pixel_weight * (*src_pixel);
+          dest_a += pixel_weight;
         }
-        break;
+        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+          dest_r_y =
+              dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
+          dest_g_m =
+              dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
+          dest_b_c =
+              dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
+          dest_a = dest_a < 0 ? 0 : dest_a > 65536 ? 65536 : dest_a;
+        }
+        *dest_scan++ = (uint8_t)((dest_b_c) >> 16);
+        *dest_scan++ = (uint8_t)((dest_g_m) >> 16);
+        *dest_scan++ = (uint8_t)((dest_r_y) >> 16);
+        if (m_DestFormat == FXDIB_Argb) {
+          *dest_scan = (uint8_t)((dest_a * 255) >> 16);
+        }
+        if (dest_scan_mask) {
+          *dest_scan_mask++ = (uint8_t)((dest_a * 255) >> 16);
+        }
+        dest_scan += Bpp - 3;
       }
+      break;
     }
-    rows_to_go--;
   }
-  return false;
+  return true;
 }
 
 void CStretchEngine::StretchVert() {
@@ -694,165 +782,290 @@ void CStretchEngine::StretchVert() {
   if (!ret)
     return;
 
-  const int DestBpp = m_DestBpp / 8;
+  const FXDIB_StretchKernels* pKernels = FXDIB_GetStretchKernels();
+  CFX_ThreadPool* pPool = GetWorkerPool(m_DestClip.Height());
+  if (pPool) {
+    StretchVertInBands(pPool, table, pKernels);
+    return;
+  }
+
+  std::vector<int32_t> sums;
   for (int row = m_DestClip.top; row < m_DestClip.bottom; row++) {
-    unsigned char* dest_scan = m_pDestScanline;
-    unsigned char* dest_scan_mask = m_pDestMaskScanline;
-    PixelWeight* pPixelWeights = table.GetPixelWeight(row);
-    switch (m_TransMethod) {
-      case 1:
-      case 2:
-      case 3: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          unsigned char* src_scan =
-              m_pInterBuf + (col - m_DestClip.left) * DestBpp;
-          int dest_a = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight = table.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return;
-
-            int pixel_weight = *pWeight;
-            dest_a +=
-                pixel_weight * src_scan[(j - m_SrcClip.top) * m_InterPitch];
-          }
-          if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-            dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
-          }
-          *dest_scan = (uint8_t)(dest_a >> 16);
-          dest_scan += DestBpp;
+    if (!StretchVertRow(table, pKernels, row, m_pDestScanline,
+                        m_pDestMaskScanline, nullptr, &sums)) {
+      return;
+    }
+    m_pDestBitmap->ComposeScanline(row - m_DestClip.top, m_pDestScanline,
+                                   m_pDestMaskScanline);
+  }
+}
+
+void CStretchEngine::StretchVertInBands(CFX_ThreadPool* pPool,
+                                        const CWeightTable& table,
+                                        const FXDIB_StretchKernels* pKernels) {
+  // Rows are worked out a band at a time on the worker threads, then composed
+  // in order on this one. The bytes that the pass never writes keep the
+  // values m_pDestScanline has, so every row of a band starts as a copy of
+  // it. The colors of pixels without any alpha carry over from the row
+  // before in methods 6 and 8, which is done as the rows are composed.
+  const int width = m_DestClip.Width();
+  const int DestBpp = m_DestBpp / 8;
+  const size_t pitch = (width * m_DestBpp + 31) / 32 * 4;
+  const size_t mask_pitch = m_pDestMaskScanline ? m_ExtraMaskPitch : 0;
+  const bool bCarryColors = m_TransMethod == 6 || m_TransMethod == 8;
+  std::vector<uint8_t> rows(kStretchBandRows * pitch);
+  for (int i = 0; i < kStretchBandRows; ++i)
+    FXSYS_memcpy(&rows[i * pitch], m_pDestScanline, pitch);
+  std::vector<uint8_t> masks(kStretchBandRows * mask_pitch);
+  std::vector<uint8_t> written(bCarryColors ? kStretchBandRows * width : 0);
+  std::vector<std::vector<int32_t>> sums(kStretchBandRows);
+  std::vector<uint8_t> results(kStretchBandRows);
+  for (int band_top = m_DestClip.top; band_top < m_DestClip.bottom;
+       band_top += kStretchBandRows) {
+    const int count = std::min(kStretchBandRows, m_DestClip.bottom - band_top);
+    pPool->ParallelFor(count, [this, &table, pKernels, band_top, pitch,
+                               mask_pitch, width, &rows, &masks, &written,
+                               &sums, &results](size_t i) {
+      results[i] = StretchVertRow(
+          table, pKernels, band_top + static_cast<int>(i), &rows[i * pitch],
+          mask_pitch ? &masks[i * mask_pitch] : nullptr,
+          written.empty() ? nullptr : &written[i * width], &sums[i]);
+    });
+    for (int i = 0; i < count; ++i) {
+      if (!results[i])
+        return;
+
+      const uint8_t* dest_scan = &rows[i * pitch];
+      if (bCarryColors) {
+        const uint8_t* pWritten = &written[i * width];
+        for (int col = 0; col < width; col++) {
+          uint8_t* pixel = m_pDestScanline + col * DestBpp;
+          const uint8_t* src_pixel = dest_scan + col * DestBpp;
+          if (pWritten[col])
+            FXSYS_memcpy(pixel, src_pixel, 3);
+          if (m_DestFormat == FXDIB_Argb)
+            pixel[3] = src_pixel[3];
         }
-        break;
+        dest_scan = m_pDestScanline;
       }
-      case 4: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          unsigned char* src_scan =
-              m_pInterBuf + (col - m_DestClip.left) * DestBpp;
-          unsigned char* src_scan_mask =
-              m_pExtraAlphaBuf + (col - m_DestClip.left);
-          int dest_a = 0, dest_k = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight = table.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return;
-
-            int pixel_weight = *pWeight;
-            dest_k +=
-                pixel_weight * src_scan[(j - m_SrcClip.top) * m_InterPitch];
-            dest_a += pixel_weight *
-                      src_scan_mask[(j - m_SrcClip.top) * m_ExtraMaskPitch];
-          }
-          if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-            dest_k = dest_k < 0 ? 0 : dest_k > 16711680 ? 16711680 : dest_k;
-            dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
-          }
-          *dest_scan = (uint8_t)(dest_k >> 16);
-          dest_scan += DestBpp;
-          *dest_scan_mask++ = (uint8_t)(dest_a >> 16);
+      m_pDestBitmap->ComposeScanline(
+          band_top + i - m_DestClip.top, dest_scan,
+          mask_pitch ? &masks[i * mask_pitch] : m_pDestMaskScanline);
+    }
+  }
+}
+
+bool CStretchEngine::StretchVertRow(const CWeightTable& table,
+                                    const FXDIB_StretchKernels* pKernels,
+                                    int row,
+                                    uint8_t* dest_scan,
+                                    uint8_t* dest_scan_mask,
+                                    uint8_t* pColorWritten,
+                                    std::vector<int32_t>* pSums) const {
+  const int DestBpp = m_DestBpp / 8;
+  const int width = m_DestClip.Width();
+  const bool bClamp = !!(m_Flags & FXDIB_BICUBIC_INTERPOL);
+  PixelWeight* pPixelWeights = table.GetPixelWeight(row);
+  // The weights of a row run out at the same source row for every column,
+  // so the scalar code would stop at the first one.
+  const int weight_count =
+      pPixelWeights->m_SrcEnd - pPixelWeights->m_SrcStart + 1;
+  if (weight_count > 0 &&
+      static_cast<size_t>(weight_count) > table.GetPixelWeightSize()) {
+    return false;
+  }
+
+  const int* weights = pPixelWeights->m_Weights;
+  const uint8_t* src_rows =
+      m_pInterBuf + (pPixelWeights->m_SrcStart - m_SrcClip.top) * m_InterPitch;
+  const uint8_t* mask_rows = nullptr;
+  if (m_pExtraAlphaBuf) {
+    mask_rows = m_pExtraAlphaBuf +
+                (pPixelWeights->m_SrcStart - m_SrcClip.top) * m_ExtraMaskPitch;
+  }
+  // The pixels the kernels did, the scalar code does the rest.
+  int done = 0;
+  switch (m_TransMethod) {
+    case 1:
+    case 2:
+    case 3: {
+      if (pKernels && DestBpp == 1) {
+        done = pKernels->StretchBytes(dest_scan, src_rows, m_InterPitch,
+                                      weights, weight_count, width, bClamp,
+                                      0xffffffff);
+        dest_scan += done;
+      }
+      for (int col = m_DestClip.left + done; col < m_DestClip.right; col++) {
+        unsigned char* src_scan =
+            m_pInterBuf + (col - m_DestClip.left) * DestBpp;
+        int dest_a = 0;
+        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
+             j++) {
+          int* pWeight = table.GetValueFromPixelWeight(pPixelWeights, j);
+          if (!pWeight)
+            return false;
+
+          int pixel_weight = *pWeight;
+          dest_a +=
+              pixel_weight * src_scan[(j - m_SrcClip.top) * m_InterPitch];
         }
-        break;
+        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+          dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
+        }
+        *dest_scan = (uint8_t)(dest_a >> 16);
+        dest_scan += DestBpp;
       }
-      case 5:
-      case 7: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          unsigned char* src_scan =
-              m_pInterBuf + (col - m_DestClip.left) * DestBpp;
-          int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight = table.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return;
-
-            int pixel_weight = *pWeight;
-            const uint8_t* src_pixel =
-                src_scan + (j - m_SrcClip.top) * m_InterPitch;
-            dest_b_c += pixel_weight * (*src_pixel++);
-            dest_g_m += pixel_weight * (*src_pixel++);
-            dest_r_y += pixel_weight * (*src_pixel);
-          }
-          if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-            dest_r_y =
-                dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
-            dest_g_m =
-                dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
-            dest_b_c =
-                dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
-          }
-          dest_scan[0] = (uint8_t)((dest_b_c) >> 16);
-          dest_scan[1] = (uint8_t)((dest_g_m) >> 16);
-          dest_scan[2] = (uint8_t)((dest_r_y) >> 16);
-          dest_scan += DestBpp;
+      break;
+    }
+    case 4: {
+      if (pKernels && mask_rows) {
+        pKernels->StretchBytes(dest_scan, src_rows, m_InterPitch, weights,
+                               weight_count, width, bClamp, 0xffffffff);
+        done = pKernels->StretchBytes(dest_scan_mask, mask_rows,
+                                      m_ExtraMaskPitch, weights, weight_count,
+                                      width, bClamp, 0xffffffff);
+        dest_scan += done * DestBpp;
+        dest_scan_mask += done;
+      }
+      for (int col = m_DestClip.left + done; col < m_DestClip.right; col++) {
+        unsigned char* src_scan =
+            m_pInterBuf + (col - m_DestClip.left) * DestBpp;
+        unsigned char* src_scan_mask =
+            m_pExtraAlphaBuf + (col - m_DestClip.left);
+        int dest_a = 0, dest_k = 0;
+        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
+             j++) {
+          int* pWeight = table.GetValueFromPixelWeight(pPixelWeights, j);
+          if (!pWeight)
+            return false;
+
+          int pixel_weight = *pWeight;
+          dest_k +=
+              pixel_weight * src_scan[(j - m_SrcClip.top) * m_InterPitch];
+          dest_a += pixel_weight *
+                    src_scan_mask[(j - m_SrcClip.top) * m_ExtraMaskPitch];
         }
-        break;
+        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+          dest_k = dest_k < 0 ? 0 : dest_k > 16711680 ? 16711680 : dest_k;
+          dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
+        }
+        *dest_scan = (uint8_t)(dest_k >> 16);
+        dest_scan += DestBpp;
+        *dest_scan_mask++ = (uint8_t)(dest_a >> 16);
       }
-      case 6:
-      case 8: {
-        for (int col = m_DestClip.left; col < m_DestClip.right; col++) {
-          unsigned char* src_scan =
-              m_pInterBuf + (col - m_DestClip.left) * DestBpp;
-          unsigned char* src_scan_mask = nullptr;
-          if (m_DestFormat != FXDIB_Argb) {
-            src_scan_mask = m_pExtraAlphaBuf + (col - m_DestClip.left);
-          }
-          int dest_a = 0, dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
-          for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
-               j++) {
-            int* pWeight = table.GetValueFromPixelWeight(pPixelWeights, j);
-            if (!pWeight)
-              return;
-
-            int pixel_weight = *pWeight;
-            const uint8_t* src_pixel =
-                src_scan + (j - m_SrcClip.top) * m_InterPitch;
-            int mask_v = 255;
-            if (src_scan_mask) {
-              mask_v = src_scan_mask[(j - m_SrcClip.top) * m_ExtraMaskPitch];
-            }
-            dest_b_c += pixel_weight * (*src_pixel++);
-            dest_g_m += pixel_weight * (*src_pixel++);
-            dest_r_y += pixel_weight * (*src_pixel);
-            if (m_DestFormat == FXDIB_Argb) {
-              dest_a += pixel_weight * (*(src_pixel + 1));
-            } else {
-              dest_a += pixel_weight * mask_v;
-            }
-          }
-          if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
-            dest_r_y =
-                dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
-            dest_g_m =
-                dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
-            dest_b_c =
-                dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
-            dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
-          }
-          if (dest_a) {
-            int r = ((uint32_t)dest_r_y) * 255 / dest_a;
-            int g = ((uint32_t)dest_g_m) * 255 / dest_a;
-            int b = ((uint32_t)dest_b_c) * 255 / dest_a;
-            dest_scan[0] = b > 255 ? 255 : b < 0 ? 0 : b;
-            dest_scan[1] = g > 255 ? 255 : g < 0 ? 0 : g;
-            dest_scan[2] = r > 255 ? 255 : r < 0 ? 0 : r;
-          }
-          if (m_DestFormat == FXDIB_Argb) {
-            dest_scan[3] = (uint8_t)((dest_a) >> 16);
-          } else {
-            *dest_scan_mask = (uint8_t)((dest_a) >> 16);
-          }
-          dest_scan += DestBpp;
-          if (dest_scan_mask) {
-            dest_scan_mask++;
-          }
+      break;
+    }
+    case 5:
+    case 7: {
+      if (pKernels && (DestBpp == 3 || DestBpp == 4)) {
+        // The fourth byte of 32bpp pixels is left alone. A pixel the kernel
+        // did part of is done again.
+        done = pKernels->StretchBytes(
+                   dest_scan, src_rows, m_InterPitch, weights, weight_count,
+                   width * DestBpp, bClamp,
+                   DestBpp == 4 ? 0x00ffffff : 0xffffffff) /
+               DestBpp;
+        dest_scan += done * DestBpp;
+      }
+      for (int col = m_DestClip.left + done; col < m_DestClip.right; col++) {
+        unsigned char* src_scan =
+            m_pInterBuf + (col - m_DestClip.left) * DestBpp;
+        int dest_r_y = 0, dest_g_m = 0, dest_b_c = 0;
+        for (int j = pPixelWeights->m_SrcStart; j <= pPixelWeights->m_SrcEnd;
+             j++) {
+          int* pWeight = table.GetValueFromPixelWeight(pPixelWeights, j);
+          if (!pWeight)
+            return false;
+
+          int pixel_weight = *pWeight;
+          const uint8_t* src_pixel =
+              src_scan + (j - m_SrcClip.top) * m_InterPitch;
+          dest_b_c += pixel_weight * (*src_pixel++);
+          dest_g_m += pixel_weight * (*src_pixel++);
+          dest_r_y += pixel_weight * (*src_pixel);
         }
-        break;
+        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+          dest_r_y =
+              dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
+          dest_g_m =
+              dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
+          dest_b_c =
+              dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
+        }
+        dest_scan[0] = (uint8_t)((dest_b_c) >> 16);
+        dest_scan[1] = (uint8_t)((dest_g_m) >> 16);
+        dest_scan[2] = (uint8_t)((dest_r_y) >> 16);
+        dest_scan += DestBpp;
       }
+      break;
+    }
+    case 6:
+    case 8: {
+      // The sums of every byte of the colors, and of the alphas, come first;
+      // only then are the colors divided by the alphas.
+      const bool bArgb = m_DestFormat == FXDIB_Argb;
+      const int color_len = width * DestBpp;
+      pSums->resize(color_len + width);
+      int32_t* color_sums = pSums->data();
+      int32_t* alpha_sums = color_sums + color_len;
+      int summed = 0;
+      if (pKernels) {
+        summed = pKernels->StretchSums(color_sums, src_rows, m_InterPitch,
+                                       weights, weight_count, color_len);
+      }
+      SumRows(color_sums + summed, src_rows + summed, m_InterPitch, weights,
+              weight_count, color_len - summed);
+      if (!bArgb && mask_rows) {
+        summed = 0;
+        if (pKernels) {
+          summed = pKernels->StretchSums(alpha_sums, mask_rows,
+                                         m_ExtraMaskPitch, weights,
+                                         weight_count, width);
+        }
+        SumRows(alpha_sums + summed, mask_rows + summed, m_ExtraMaskPitch,
+                weights, weight_count, width - summed);
+      } else if (!bArgb) {
+        int weight_sum = 0;
+        for (int j = 0; j < weight_count; j++)
+          weight_sum += weights[j];
+        std::fill(alpha_sums, alpha_sums + width, weight_sum * 255);
+      }
+      for (int col = 0; col < width; col++) {
+        const int32_t* pixel_sums = color_sums + col * DestBpp;
+        int dest_b_c = pixel_sums[0];
+        int dest_g_m = pixel_sums[1];
+        int dest_r_y = pixel_sums[2];
+        int dest_a = bArgb ? pixel_sums[3] : alpha_sums[col];
+        if (m_Flags & FXDIB_BICUBIC_INTERPOL) {
+          dest_r_y =
+              dest_r_y < 0 ? 0 : dest_r_y > 16711680 ? 16711680 : dest_r_y;
+          dest_g_m =
+              dest_g_m < 0 ? 0 : dest_g_m > 16711680 ? 16711680 : dest_g_m;
+          dest_b_c =
+              dest_b_c < 0 ? 0 : dest_b_c > 16711680 ? 16711680 : dest_b_c;
+          dest_a = dest_a < 0 ? 0 : dest_a > 16711680 ? 16711680 : dest_a;
+        }
+        if (dest_a) {
+          int r = ((uint32_t)dest_r_y) * 255 / dest_a;
+          int g = ((uint32_t)dest_g_m) * 255 / dest_a;
+          int b = ((uint32_t)dest_b_c) * 255 / dest_a;
+          dest_scan[0] = b > 255 ? 255 : b < 0 ? 0 : b;
+          dest_scan[1] = g > 255 ? 255 : g < 0 ? 0 : g;
+          dest_scan[2] = r > 255 ? 255 : r < 0 ? 0 : r;
+        }
+        if (pColorWritten)
+          pColorWritten[col] = !!dest_a;
+        if (bArgb) {
+          dest_scan[3] = (uint8_t)((dest_a) >> 16);
+        } else if (dest_scan_mask) {
+          dest_scan_mask[col] = (uint8_t)((dest_a) >> 16);
+        }
+        dest_scan += DestBpp;
+      }
+      break;
     }
-    m_pDestBitmap->ComposeScanline(row - m_DestClip.top, m_pDestScanline,
-                                   m_pDestMaskScanline);
   }
+  return true;
 }
 
 CFX_ImageStretcher::CFX_ImageStretcher(IFX_ScanlineComposer* pDest,
@@ -4,17 +4,147 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_number.h"
 #include "core/fpdfapi/parser/cpdf_stream.h"
 #include "core/fpdfapi/render/cpdf_dibsource.h"
+#include "core/fxcrt/cfx_threadpool.h"
+#include "core/fxcrt/fx_cpu.h"
 #include "core/fxcrt/fx_memory.h"
 #include "core/fxge/dib/dib_int.h"
 #include "core/fxge/fx_dib.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "third_party/base/ptr_util.h"
 
+namespace {
+
+struct StretchCase {
+  FXDIB_Format src_format;
+  FXDIB_Format dest_format;
+  bool bPalette;
+};
+
+// One or more cases for each transfer method of CStretchEngine.
+const StretchCase kStretchCases[] = {
+    {FXDIB_1bppMask, FXDIB_8bppMask, false},
+    {FXDIB_8bppMask, FXDIB_8bppMask, false},
+    {FXDIB_8bppRgba, FXDIB_8bppRgba, false},
+    {FXDIB_8bppRgb, FXDIB_Rgb, true},
+    {FXDIB_8bppRgba, FXDIB_Rgba, true},
+    {FXDIB_Rgb, FXDIB_Rgb, false},
+    {FXDIB_Rgb32, FXDIB_Rgb32, false},
+    {FXDIB_Argb, FXDIB_Argb, false},
+    {FXDIB_Rgba, FXDIB_Rgba, false},
+};
+
+struct StretchSize {
+  int src_width;
+  int src_height;
+  int dest_width;
+  int dest_height;
+  FX_RECT clip;
+};
+
+// The last two are large enough for the vertical and the horizontal pass,
+// respectively, to use worker threads.
+const StretchSize kStretchSizes[] = {
+    {203, 151, 61, 47, FX_RECT(0, 0, 61, 47)},
+    {29, 23, 97, 71, FX_RECT(5, 3, 90, 70)},
+    {181, 133, 613, 457, FX_RECT(0, 0, 613, 457)},
+    {1100, 700, 400, 390, FX_RECT(0, 0, 400, 390)},
+};
+
+const int kStretchFlags[] = {0, FXDIB_INTERPOL, FXDIB_BICUBIC_INTERPOL,
+                             FXDIB_NOSMOOTH};
+
+class ScanlineRecorder : public IFX_ScanlineComposer {
+ public:
+  ScanlineRecorder(size_t line_size, size_t mask_size)
+      : m_LineSize(line_size), m_MaskSize(mask_size) {}
+
+  // IFX_ScanlineComposer
+  void ComposeScanline(int line,
+                       const uint8_t* scanline,
+                       const uint8_t* scan_extra_alpha) override {
+    EXPECT_EQ(m_nLines, line);
+    ++m_nLines;
+    m_Data.insert(m_Data.end(), scanline, scanline + m_LineSize);
+    if (m_MaskSize) {
+      m_Data.insert(m_Data.end(), scan_extra_alpha,
+                    scan_extra_alpha + m_MaskSize);
+    }
+  }
+  bool SetInfo(int width,
+               int height,
+               FXDIB_Format src_format,
+               uint32_t* pSrcPalette) override {
+    return true;
+  }
+
+  int m_nLines = 0;
+  std::vector<uint8_t> m_Data;
+
+ private:
+  const size_t m_LineSize;
+  const size_t m_MaskSize;
+};
+
+// Deterministic pixels, with blocks where the alpha is 0, so that some
+// destination pixels have no alpha at all.
+void FillBitmap(CFX_DIBitmap* pBitmap, uint32_t seed) {
+  uint32_t state = seed;
+  auto next = [&state]() {
+    state = state * 1103515245 + 12345;
+    return static_cast<uint8_t>(state >> 16);
+  };
+  for (int row = 0; row < pBitmap->GetHeight(); ++row) {
+    uint8_t* scan = pBitmap->GetBuffer() + row * pBitmap->GetPitch();
+    for (uint32_t i = 0; i < pBitmap->GetPitch(); ++i)
+      scan[i] = next();
+  }
+  if (pBitmap->HasAlpha()) {
+    CFX_DIBitmap* pAlpha = pBitmap->GetFormat() == FXDIB_Argb
+                               ? pBitmap
+                               : pBitmap->m_pAlphaMask;
+    int Bpp = pAlpha->GetBPP() / 8;
+    for (int row = 0; row < pAlpha->GetHeight(); ++row) {
+      uint8_t* scan = pAlpha->GetBuffer() + row * pAlpha->GetPitch();
+      for (int col = 0; col < pAlpha->GetWidth(); ++col) {
+        if ((col / 5 + row / 7) % 3 == 0)
+          scan[col * Bpp + Bpp - 1] = 0;
+      }
+    }
+  }
+  if (pBitmap->GetBPP() == 8 && pBitmap->GetFormat() != FXDIB_8bppMask) {
+    for (int i = 0; i < 256; ++i) {
+      next();
+      pBitmap->SetPaletteEntry(i, 0xff000000 | (state >> 8));
+    }
+  }
+}
+
+std::vector<uint8_t> Stretch(uint32_t cpu_features,
+                             const CFX_DIBitmap& source,
+                             FXDIB_Format dest_format,
+                             const StretchSize& size,
+                             int flags) {
+  FXCPU_SetFeatureMaskForTesting(cpu_features);
+  int width = size.clip.Width();
+  ScanlineRecorder recorder(width * (dest_format & 0xff) / 8,
+                            source.m_pAlphaMask ? width : 0);
+  CStretchEngine engine(&recorder, dest_format, size.dest_width,
+                        size.dest_height, size.clip, &source, flags);
+  EXPECT_TRUE(engine.StartStretchHorz());
+  EXPECT_FALSE(engine.Continue(nullptr));
+  EXPECT_EQ(size.clip.Height(), recorder.m_nLines);
+  FXCPU_SetFeatureMaskForTesting(~0u);
+  return recorder.m_Data;
+}
+
+}  // namespace
+
 TEST(CStretchEngine, OverflowInCtor) {
   FX_RECT clip_rect;
   std::unique_ptr<CPDF_Dictionary> dict_obj =
@@ -29,3 +159,36 @@ TEST(CStretchEngine, OverflowInCtor) {
                         &dib_source, 0);
   EXPECT_EQ(FXDIB_INTERPOL, engine.m_Flags);
 }
+
+TEST(CStretchEngine, VectorizedAndThreadedMatchScalar) {
+  for (const StretchCase& test_case : kStretchCases) {
+    for (const StretchSize& size : kStretchSizes) {
+      CFX_DIBitmap source;
+      ASSERT_TRUE(source.Create(size.src_width, size.src_height,
+                                test_case.src_format));
+      FillBitmap(&source, size.src_width);
+      if (!test_case.bPalette)
+        source.SetPalette(nullptr);
+      for (int flags : kStretchFlags) {
+        std::vector<uint8_t> expected =
+            Stretch(0, source, test_case.dest_format, size, flags);
+        ASSERT_FALSE(expected.empty());
+        EXPECT_EQ(expected, Stretch(FXCPU_SSE2, source, test_case.dest_format,
+                                    size, flags))
+            << "SSE2, case " << (&test_case - kStretchCases) << ", size "
+            << (&size - kStretchSizes) << ", flags " << flags;
+        EXPECT_EQ(expected,
+                  Stretch(~0u, source, test_case.dest_format, size, flags))
+            << "all, case " << (&test_case - kStretchCases) << ", size "
+            << (&size - kStretchSizes) << ", flags " << flags;
+
+        CFX_ThreadPool::Create(3);
+        EXPECT_EQ(expected,
+                  Stretch(~0u, source, test_case.dest_format, size, flags))
+            << "threads, case " << (&test_case - kStretchCases) << ", size "
+            << (&size - kStretchSizes) << ", flags " << flags;
+        CFX_ThreadPool::Destroy();
+      }
+    }
+  }
+}
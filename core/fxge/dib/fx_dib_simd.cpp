@@ -0,0 +1,127 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxge/dib/fx_dib_simd.h"
+
+#include "core/fxcrt/fx_cpu.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FXDIB_HAVE_SSE2
+#endif
+
+#ifdef FXDIB_HAVE_SSE2
+#include <emmintrin.h>
+#include <string.h>
+
+#include "core/fxge/dib/fx_dib_simd_kernels.h"
+
+namespace {
+
+struct SSE2Ops {
+  using Vec = __m128i;
+  using FVec = __m128;
+  static const int kPixels = 4;
+
+  static Vec Load(const uint8_t* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  }
+  static void Store(uint8_t* p, Vec v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+  }
+  static Vec LoadBytes(const uint8_t* p) {
+    int32_t bytes;
+    memcpy(&bytes, p, sizeof(bytes));
+    Vec zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(
+        _mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+  }
+  static Vec Set1(int32_t x) { return _mm_set1_epi32(x); }
+  static Vec Set1x64(int64_t x) {
+    return _mm_set_epi32(static_cast<int32_t>(x >> 32),
+                         static_cast<int32_t>(x),
+                         static_cast<int32_t>(x >> 32),
+                         static_cast<int32_t>(x));
+  }
+  static Vec And(Vec a, Vec b) { return _mm_and_si128(a, b); }
+  static Vec Or(Vec a, Vec b) { return _mm_or_si128(a, b); }
+  static Vec AndNot(Vec a, Vec b) { return _mm_andnot_si128(a, b); }
+  static Vec Add32(Vec a, Vec b) { return _mm_add_epi32(a, b); }
+  static Vec Sub32(Vec a, Vec b) { return _mm_sub_epi32(a, b); }
+  static Vec CmpEq32(Vec a, Vec b) { return _mm_cmpeq_epi32(a, b); }
+  static Vec CmpGt32(Vec a, Vec b) { return _mm_cmpgt_epi32(a, b); }
+  static Vec ShiftLeft32(Vec v, int n) { return _mm_slli_epi32(v, n); }
+  static Vec ShiftRight32(Vec v, int n) { return _mm_srli_epi32(v, n); }
+  static Vec MulSmall32(Vec a, Vec b) { return _mm_madd_epi16(a, b); }
+  static Vec Add16(Vec a, Vec b) { return _mm_add_epi16(a, b); }
+  static Vec Sub16(Vec a, Vec b) { return _mm_sub_epi16(a, b); }
+  static Vec Mul16(Vec a, Vec b) { return _mm_mullo_epi16(a, b); }
+  static Vec ShiftLeft16(Vec v, int n) { return _mm_slli_epi16(v, n); }
+  static Vec ShiftRight16(Vec v, int n) { return _mm_srli_epi16(v, n); }
+  static Vec UnpackLo8(Vec v) {
+    return _mm_unpacklo_epi8(v, _mm_setzero_si128());
+  }
+  static Vec UnpackHi8(Vec v) {
+    return _mm_unpackhi_epi8(v, _mm_setzero_si128());
+  }
+  static Vec UnpackLo16(Vec a, Vec b) { return _mm_unpacklo_epi16(a, b); }
+  static Vec UnpackHi16(Vec a, Vec b) { return _mm_unpackhi_epi16(a, b); }
+  static Vec UnpackLo32(Vec v) { return _mm_unpacklo_epi32(v, v); }
+  static Vec UnpackHi32(Vec v) { return _mm_unpackhi_epi32(v, v); }
+  static Vec Pack32(Vec lo, Vec hi) { return _mm_packs_epi32(lo, hi); }
+  static Vec Pack16(Vec lo, Vec hi) { return _mm_packus_epi16(lo, hi); }
+  static void Store32x4(int32_t* p, const Vec* v) {
+    for (int i = 0; i < 4; ++i)
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(p + 4 * i), v[i]);
+  }
+  static bool AllTrue(Vec mask) { return _mm_movemask_epi8(mask) == 0xffff; }
+  static FVec ToFloat(Vec v) { return _mm_cvtepi32_ps(v); }
+  static Vec TruncToInt(FVec v) { return _mm_cvttps_epi32(v); }
+  static FVec MulF(FVec a, FVec b) { return _mm_mul_ps(a, b); }
+  static FVec DivF(FVec a, FVec b) { return _mm_div_ps(a, b); }
+  static FVec Set1F(float x) { return _mm_set1_ps(x); }
+};
+
+}  // namespace
+#endif  // FXDIB_HAVE_SSE2
+
+const FXDIB_CompositeKernels* FXDIB_GetCompositeKernels() {
+  uint32_t features = FXCPU_GetFeatures();
+  if (features & FXCPU_AVX2) {
+    const FXDIB_CompositeKernels* pKernels = FXDIB_GetAVX2CompositeKernels();
+    if (pKernels)
+      return pKernels;
+  }
+  if (features & FXCPU_SSE2)
+    return FXDIB_GetSSE2CompositeKernels();
+  return nullptr;
+}
+
+const FXDIB_StretchKernels* FXDIB_GetStretchKernels() {
+  uint32_t features = FXCPU_GetFeatures();
+  if (features & FXCPU_AVX2) {
+    const FXDIB_StretchKernels* pKernels = FXDIB_GetAVX2StretchKernels();
+    if (pKernels)
+      return pKernels;
+  }
+  if (features & FXCPU_SSE2)
+    return FXDIB_GetSSE2StretchKernels();
+  return nullptr;
+}
+
+const FXDIB_CompositeKernels* FXDIB_GetSSE2CompositeKernels() {
+#ifdef FXDIB_HAVE_SSE2
+  return fxdib_simd::GetKernels<SSE2Ops>();
+#else
+  return nullptr;
+#endif
+}
+
+const FXDIB_StretchKernels* FXDIB_GetSSE2StretchKernels() {
+#ifdef FXDIB_HAVE_SSE2
+  return fxdib_simd::GetStretchKernels<SSE2Ops>();
+#else
+  return nullptr;
+#endif
+}
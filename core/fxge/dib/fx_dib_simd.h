@@ -0,0 +1,94 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXGE_DIB_FX_DIB_SIMD_H_
+#define CORE_FXGE_DIB_FX_DIB_SIMD_H_
+
+#include <stdint.h>
+
+// Vectorized versions of the common normal blend CompositeRow_*() functions
+// of fx_dib_composite.cpp, which stay the reference implementation. Each
+// kernel composites the longest prefix of the row that fills whole vectors
+// and returns its length in pixels; the caller finishes the row with the
+// scalar code. The results are bit for bit those of the scalar code.
+//
+// This header must only include system headers: it is shared with the
+// translation unit built for AVX2, which must not emit inline functions that
+// the rest of the library could end up calling.
+struct FXDIB_CompositeKernels {
+  // CompositeRow_Argb2Argb() without blending or separate alpha scans.
+  int (*Argb2Argb)(uint8_t* dest_scan,
+                   const uint8_t* src_scan,
+                   int pixel_count,
+                   const uint8_t* clip_scan);
+  // CompositeRow_Argb2Rgb_NoBlend() onto 32bpp RGB, without an alpha scan.
+  int (*Argb2Rgb32)(uint8_t* dest_scan,
+                    const uint8_t* src_scan,
+                    int width,
+                    const uint8_t* clip_scan);
+  // CompositeRow_Rgb2Rgb_NoBlend_Clip() from 32bpp RGB onto 32bpp RGB.
+  int (*Rgb322Rgb32Clip)(uint8_t* dest_scan,
+                         const uint8_t* src_scan,
+                         int width,
+                         const uint8_t* clip_scan);
+  // CompositeRow_ByteMask2Argb() without blending.
+  int (*ByteMask2Argb)(uint8_t* dest_scan,
+                       const uint8_t* src_scan,
+                       int mask_alpha,
+                       int src_r,
+                       int src_g,
+                       int src_b,
+                       int pixel_count,
+                       const uint8_t* clip_scan);
+  // CompositeRow_ByteMask2Rgb() onto 32bpp RGB without blending.
+  int (*ByteMask2Rgb32)(uint8_t* dest_scan,
+                        const uint8_t* src_scan,
+                        int mask_alpha,
+                        int src_r,
+                        int src_g,
+                        int src_b,
+                        int pixel_count,
+                        const uint8_t* clip_scan);
+};
+
+// Vectorized inner loops of the vertical pass of CStretchEngine, see
+// fx_dib_engine.cpp. Both take the bytes at the same offset of
+// |weight_count| rows that are |src_pitch| apart, and sum them times the
+// 16.16 fixed point |weights| of those rows, each of which must be within
+// +-2^22. Like the compositing kernels, they handle the longest prefix of
+// the |len| bytes that fills whole vectors and return its length.
+struct FXDIB_StretchKernels {
+  // Stores the sums as (uint8_t)(sum >> 16), after clamping them to
+  // [0, 255 << 16] if |bClamp|. Only the bytes set in |store_mask|, repeated
+  // every four bytes, are written.
+  int (*StretchBytes)(uint8_t* dest,
+                      const uint8_t* src,
+                      int src_pitch,
+                      const int* weights,
+                      int weight_count,
+                      int len,
+                      bool bClamp,
+                      uint32_t store_mask);
+  // Stores the sums themselves.
+  int (*StretchSums)(int32_t* sums,
+                     const uint8_t* src,
+                     int src_pitch,
+                     const int* weights,
+                     int weight_count,
+                     int len);
+};
+
+// Return the kernels for the widest instruction set that FXCPU_GetFeatures()
+// reports, or nullptr if none of them applies.
+const FXDIB_CompositeKernels* FXDIB_GetCompositeKernels();
+const FXDIB_StretchKernels* FXDIB_GetStretchKernels();
+
+// Return nullptr when the library is built for a target without SSE2, or
+// without a compiler flag for AVX2, respectively.
+const FXDIB_CompositeKernels* FXDIB_GetSSE2CompositeKernels();
+const FXDIB_CompositeKernels* FXDIB_GetAVX2CompositeKernels();
+const FXDIB_StretchKernels* FXDIB_GetSSE2StretchKernels();
+const FXDIB_StretchKernels* FXDIB_GetAVX2StretchKernels();
+
+#endif  // CORE_FXGE_DIB_FX_DIB_SIMD_H_
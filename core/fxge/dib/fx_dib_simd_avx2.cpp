@@ -0,0 +1,102 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Built with AVX2 code generation enabled, see the fxge_avx2 target. Only
+// reached after FXCPU_GetFeatures() reported AVX2, so nothing here may be
+// shared with the rest of the library: include system headers and
+// fx_dib_simd*.h only.
+
+#include "core/fxge/dib/fx_dib_simd.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+#include "core/fxge/dib/fx_dib_simd_kernels.h"
+
+namespace {
+
+struct AVX2Ops {
+  using Vec = __m256i;
+  using FVec = __m256;
+  static const int kPixels = 8;
+
+  static Vec Load(const uint8_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  static void Store(uint8_t* p, Vec v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+  }
+  static Vec LoadBytes(const uint8_t* p) {
+    return _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+  }
+  static Vec Set1(int32_t x) { return _mm256_set1_epi32(x); }
+  static Vec Set1x64(int64_t x) { return _mm256_set1_epi64x(x); }
+  static Vec And(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+  static Vec Or(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+  static Vec AndNot(Vec a, Vec b) { return _mm256_andnot_si256(a, b); }
+  static Vec Add32(Vec a, Vec b) { return _mm256_add_epi32(a, b); }
+  static Vec Sub32(Vec a, Vec b) { return _mm256_sub_epi32(a, b); }
+  static Vec CmpEq32(Vec a, Vec b) { return _mm256_cmpeq_epi32(a, b); }
+  static Vec CmpGt32(Vec a, Vec b) { return _mm256_cmpgt_epi32(a, b); }
+  static Vec ShiftLeft32(Vec v, int n) { return _mm256_slli_epi32(v, n); }
+  static Vec ShiftRight32(Vec v, int n) { return _mm256_srli_epi32(v, n); }
+  static Vec MulSmall32(Vec a, Vec b) { return _mm256_madd_epi16(a, b); }
+  static Vec Add16(Vec a, Vec b) { return _mm256_add_epi16(a, b); }
+  static Vec Sub16(Vec a, Vec b) { return _mm256_sub_epi16(a, b); }
+  static Vec Mul16(Vec a, Vec b) { return _mm256_mullo_epi16(a, b); }
+  static Vec ShiftLeft16(Vec v, int n) { return _mm256_slli_epi16(v, n); }
+  static Vec ShiftRight16(Vec v, int n) { return _mm256_srli_epi16(v, n); }
+  // Unpacking and packing both work within 128 bit halves, so a round trip
+  // through them keeps the pixel order.
+  static Vec UnpackLo8(Vec v) {
+    return _mm256_unpacklo_epi8(v, _mm256_setzero_si256());
+  }
+  static Vec UnpackHi8(Vec v) {
+    return _mm256_unpackhi_epi8(v, _mm256_setzero_si256());
+  }
+  static Vec UnpackLo16(Vec a, Vec b) { return _mm256_unpacklo_epi16(a, b); }
+  static Vec UnpackHi16(Vec a, Vec b) { return _mm256_unpackhi_epi16(a, b); }
+  static Vec UnpackLo32(Vec v) { return _mm256_unpacklo_epi32(v, v); }
+  static Vec UnpackHi32(Vec v) { return _mm256_unpackhi_epi32(v, v); }
+  static Vec Pack32(Vec lo, Vec hi) { return _mm256_packs_epi32(lo, hi); }
+  static Vec Pack16(Vec lo, Vec hi) { return _mm256_packus_epi16(lo, hi); }
+  // Each of the four vectors holds bytes 4i..4i+3 and 16+4i..16+4i+3 of the
+  // 32 they were unpacked from, in its two halves.
+  static void Store32x4(int32_t* p, const Vec* v) {
+    __m256i* out = reinterpret_cast<__m256i*>(p);
+    _mm256_storeu_si256(out, _mm256_permute2x128_si256(v[0], v[1], 0x20));
+    _mm256_storeu_si256(out + 1,
+                        _mm256_permute2x128_si256(v[2], v[3], 0x20));
+    _mm256_storeu_si256(out + 2,
+                        _mm256_permute2x128_si256(v[0], v[1], 0x31));
+    _mm256_storeu_si256(out + 3,
+                        _mm256_permute2x128_si256(v[2], v[3], 0x31));
+  }
+  static bool AllTrue(Vec mask) { return _mm256_movemask_epi8(mask) == -1; }
+  static FVec ToFloat(Vec v) { return _mm256_cvtepi32_ps(v); }
+  static Vec TruncToInt(FVec v) { return _mm256_cvttps_epi32(v); }
+  static FVec MulF(FVec a, FVec b) { return _mm256_mul_ps(a, b); }
+  static FVec DivF(FVec a, FVec b) { return _mm256_div_ps(a, b); }
+  static FVec Set1F(float x) { return _mm256_set1_ps(x); }
+};
+
+}  // namespace
+#endif  // __AVX2__
+
+const FXDIB_CompositeKernels* FXDIB_GetAVX2CompositeKernels() {
+#ifdef __AVX2__
+  return fxdib_simd::GetKernels<AVX2Ops>();
+#else
+  return nullptr;
+#endif
+}
+
+const FXDIB_StretchKernels* FXDIB_GetAVX2StretchKernels() {
+#ifdef __AVX2__
+  return fxdib_simd::GetStretchKernels<AVX2Ops>();
+#else
+  return nullptr;
+#endif
+}
@@ -0,0 +1,395 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXGE_DIB_FX_DIB_SIMD_KERNELS_H_
+#define CORE_FXGE_DIB_FX_DIB_SIMD_KERNELS_H_
+
+#include <stdint.h>
+
+#include "core/fxge/dib/fx_dib_simd.h"
+
+// The compositing kernels, written once against an |Ops| class that wraps the
+// intrinsics of one instruction set. |Ops| processes Ops::kPixels 32bpp
+// pixels at a time and provides:
+//   Vec, FVec               integer and float vectors
+//   Load(p), Store(p, v)    kPixels pixels, unaligned
+//   LoadBytes(p)            kPixels bytes, zero-extended to 32 bit lanes
+//   Set1(x), Set1x64(x)     broadcast a 32 or 64 bit value
+//   And, Or, AndNot(a, b)   bitwise ops, AndNot() is ~a & b
+//   Add32, Sub32            32 bit lane arithmetic
+//   CmpEq32, CmpGt32        32 bit lane comparison, signed
+//   ShiftLeft32, ShiftRight32
+//   MulSmall32(a, b)        32 bit lane product of values below 32768; in
+//                           general the sum of the products of the signed
+//                           16 bit halves of the lanes
+//   Add16, Sub16, Mul16, ShiftLeft16, ShiftRight16
+//                           16 bit lane arithmetic
+//   UnpackLo8, UnpackHi8    zero-extend the low or high bytes to 16 bits
+//   UnpackLo16(a, b), UnpackHi16(a, b)
+//                           interleave the low or high 16 bit lanes of a and
+//                           b into 32 bit lanes
+//   UnpackLo32, UnpackHi32  interleave the low or high 32 bit lanes with
+//                           themselves
+//   Pack32(lo, hi)          saturate 32 bit lanes to signed 16 bits
+//   Pack16(lo, hi)          saturate 16 bit lanes back to bytes
+//   Store32x4(p, v)         store the 32 bit lanes of four vectors unpacked
+//                           from one by UnpackLo8/Hi8 then UnpackLo16/Hi16,
+//                           in the order of the bytes they came from
+//   AllTrue(mask)           whether all lanes of a comparison are set
+//   ToFloat, TruncToInt, DivF, MulF, Set1F
+//                           float conversion and arithmetic
+//
+// Every |Ops| class has internal linkage, so each instantiation stays local to
+// the translation unit, and with it the instruction set it was compiled for.
+//
+// The integer divisions of the scalar code are reproduced exactly:
+// x / 255 == (x + 1 + (x >> 8)) >> 8 for all 0 <= x <= 255 * 255, and a float
+// quotient n / d truncates to the integer quotient whenever it is at most
+// 65025 and d is at most 255, since its fraction is then at least 1 / 255
+// away from the next integer, far more than a float rounding error.
+
+namespace fxdib_simd {
+
+// x / 255 in 32 bit lanes, for 0 <= x <= 255 * 255.
+template <typename Ops>
+typename Ops::Vec Div255(typename Ops::Vec x) {
+  return Ops::ShiftRight32(
+      Ops::Add32(Ops::Add32(x, Ops::Set1(1)), Ops::ShiftRight32(x, 8)), 8);
+}
+
+// x / 255 in 16 bit lanes, for 0 <= x <= 255 * 255.
+template <typename Ops>
+typename Ops::Vec Div255x16(typename Ops::Vec x) {
+  return Ops::ShiftRight16(
+      Ops::Add16(Ops::Add16(x, Ops::Set1(0x00010001)), Ops::ShiftRight16(x, 8)),
+      8);
+}
+
+template <typename Ops>
+typename Ops::Vec Select(typename Ops::Vec mask,
+                         typename Ops::Vec a,
+                         typename Ops::Vec b) {
+  return Ops::Or(Ops::And(mask, a), Ops::AndNot(mask, b));
+}
+
+template <typename Ops>
+typename Ops::Vec AlphaOf(typename Ops::Vec pixels) {
+  return Ops::ShiftRight32(pixels, 24);
+}
+
+// FXDIB_ALPHA_MERGE() of the color bytes of |dest| and |src| by the per pixel
+// |alpha| in 32 bit lanes. The fourth byte of every pixel keeps its |dest|
+// value, like the scalar code that never writes it.
+template <typename Ops>
+typename Ops::Vec MergeColors(typename Ops::Vec dest,
+                              typename Ops::Vec src,
+                              typename Ops::Vec alpha) {
+  using Vec = typename Ops::Vec;
+  // A weight of zero for the fourth byte makes the merge leave it unchanged.
+  const Vec kColorWeights = Ops::Set1x64(0x0000ffffffffffffLL);
+  const Vec k255 = Ops::Set1(0x00ff00ff);
+  Vec alpha16 = Ops::Or(alpha, Ops::ShiftLeft32(alpha, 16));
+  Vec alpha_lo = Ops::And(Ops::UnpackLo32(alpha16), kColorWeights);
+  Vec alpha_hi = Ops::And(Ops::UnpackHi32(alpha16), kColorWeights);
+  Vec lo = Div255x16<Ops>(
+      Ops::Add16(Ops::Mul16(Ops::UnpackLo8(dest), Ops::Sub16(k255, alpha_lo)),
+                 Ops::Mul16(Ops::UnpackLo8(src), alpha_lo)));
+  Vec hi = Div255x16<Ops>(
+      Ops::Add16(Ops::Mul16(Ops::UnpackHi8(dest), Ops::Sub16(k255, alpha_hi)),
+                 Ops::Mul16(Ops::UnpackHi8(src), alpha_hi)));
+  return Ops::Pack16(lo, hi);
+}
+
+// Combines |src_alpha| over the alpha of |dest|: returns the new alpha and
+// sets |alpha_ratio| to the weight of the source colors.
+template <typename Ops>
+typename Ops::Vec UnionAlpha(typename Ops::Vec back_alpha,
+                             typename Ops::Vec src_alpha,
+                             typename Ops::Vec* alpha_ratio) {
+  using Vec = typename Ops::Vec;
+  Vec dest_alpha =
+      Ops::Sub32(Ops::Add32(back_alpha, src_alpha),
+                 Div255<Ops>(Ops::MulSmall32(back_alpha, src_alpha)));
+  // Lanes where |dest_alpha| is 0 divide by 0; the callers discard them.
+  *alpha_ratio = Ops::TruncToInt(
+      Ops::DivF(Ops::ToFloat(Ops::MulSmall32(src_alpha, Ops::Set1(255))),
+                Ops::ToFloat(dest_alpha)));
+  return dest_alpha;
+}
+
+// mask_alpha * clip * mask / 255 / 255, or mask_alpha * mask / 255 without a
+// clip, for kPixels bytes of a mask.
+template <typename Ops>
+typename Ops::Vec MaskAlpha(const uint8_t* src_scan,
+                            const uint8_t* clip_scan,
+                            int mask_alpha) {
+  typename Ops::Vec mask = Ops::LoadBytes(src_scan);
+  if (!clip_scan)
+    return Div255<Ops>(Ops::MulSmall32(Ops::Set1(mask_alpha), mask));
+
+  // The triple product stays below 2^24, so it is exact as a float.
+  typename Ops::FVec product = Ops::MulF(
+      Ops::MulF(Ops::Set1F(static_cast<float>(mask_alpha)),
+                Ops::ToFloat(Ops::LoadBytes(clip_scan))),
+      Ops::ToFloat(mask));
+  return Div255<Ops>(
+      Ops::TruncToInt(Ops::DivF(product, Ops::Set1F(255.0f))));
+}
+
+template <typename Ops>
+int Argb2Argb(uint8_t* dest_scan,
+              const uint8_t* src_scan,
+              int pixel_count,
+              const uint8_t* clip_scan) {
+  using Vec = typename Ops::Vec;
+  const Vec kZero = Ops::Set1(0);
+  const Vec kAlphaMask = Ops::Set1(static_cast<int32_t>(0xff000000));
+  const Vec kColorMask = Ops::Set1(0x00ffffff);
+  int col = 0;
+  for (; col + Ops::kPixels <= pixel_count; col += Ops::kPixels) {
+    uint8_t* dest = dest_scan + col * 4;
+    Vec src = Ops::Load(src_scan + col * 4);
+    // Opaque sources replace the destination whatever it was.
+    if (!clip_scan &&
+        Ops::AllTrue(Ops::CmpEq32(Ops::And(src, kAlphaMask), kAlphaMask))) {
+      Ops::Store(dest, src);
+      continue;
+    }
+    Vec back = Ops::Load(dest);
+    Vec back_alpha = AlphaOf<Ops>(back);
+    Vec src_alpha = AlphaOf<Ops>(src);
+    if (clip_scan) {
+      src_alpha = Div255<Ops>(
+          Ops::MulSmall32(Ops::LoadBytes(clip_scan + col), src_alpha));
+    }
+    Vec alpha_ratio;
+    Vec dest_alpha = UnionAlpha<Ops>(back_alpha, src_alpha, &alpha_ratio);
+    Vec result =
+        Ops::Or(Ops::And(MergeColors<Ops>(back, src, alpha_ratio), kColorMask),
+                Ops::ShiftLeft32(dest_alpha, 24));
+    result = Select<Ops>(Ops::CmpEq32(src_alpha, kZero), back, result);
+    result = Select<Ops>(
+        Ops::CmpEq32(back_alpha, kZero),
+        Ops::Or(Ops::And(src, kColorMask), Ops::ShiftLeft32(src_alpha, 24)),
+        result);
+    Ops::Store(dest, result);
+  }
+  return col;
+}
+
+template <typename Ops>
+int Argb2Rgb32(uint8_t* dest_scan,
+               const uint8_t* src_scan,
+               int width,
+               const uint8_t* clip_scan) {
+  using Vec = typename Ops::Vec;
+  const Vec kZero = Ops::Set1(0);
+  int col = 0;
+  for (; col + Ops::kPixels <= width; col += Ops::kPixels) {
+    uint8_t* dest = dest_scan + col * 4;
+    Vec src = Ops::Load(src_scan + col * 4);
+    Vec src_alpha = AlphaOf<Ops>(src);
+    if (clip_scan) {
+      src_alpha = Div255<Ops>(
+          Ops::MulSmall32(src_alpha, Ops::LoadBytes(clip_scan + col)));
+    }
+    if (Ops::AllTrue(Ops::CmpEq32(src_alpha, kZero)))
+      continue;
+    Ops::Store(dest, MergeColors<Ops>(Ops::Load(dest), src, src_alpha));
+  }
+  return col;
+}
+
+template <typename Ops>
+int Rgb322Rgb32Clip(uint8_t* dest_scan,
+                    const uint8_t* src_scan,
+                    int width,
+                    const uint8_t* clip_scan) {
+  using Vec = typename Ops::Vec;
+  const Vec kZero = Ops::Set1(0);
+  int col = 0;
+  for (; col + Ops::kPixels <= width; col += Ops::kPixels) {
+    uint8_t* dest = dest_scan + col * 4;
+    Vec src_alpha = Ops::LoadBytes(clip_scan + col);
+    if (Ops::AllTrue(Ops::CmpEq32(src_alpha, kZero)))
+      continue;
+    Ops::Store(dest, MergeColors<Ops>(Ops::Load(dest),
+                                      Ops::Load(src_scan + col * 4),
+                                      src_alpha));
+  }
+  return col;
+}
+
+template <typename Ops>
+int ByteMask2Argb(uint8_t* dest_scan,
+                  const uint8_t* src_scan,
+                  int mask_alpha,
+                  int src_r,
+                  int src_g,
+                  int src_b,
+                  int pixel_count,
+                  const uint8_t* clip_scan) {
+  using Vec = typename Ops::Vec;
+  const Vec kZero = Ops::Set1(0);
+  const Vec kColorMask = Ops::Set1(0x00ffffff);
+  const Vec color = Ops::Set1(src_b | (src_g << 8) | (src_r << 16));
+  int col = 0;
+  for (; col + Ops::kPixels <= pixel_count; col += Ops::kPixels) {
+    uint8_t* dest = dest_scan + col * 4;
+    Vec src_alpha = MaskAlpha<Ops>(src_scan + col,
+                                   clip_scan ? clip_scan + col : nullptr,
+                                   mask_alpha);
+    Vec back = Ops::Load(dest);
+    Vec back_alpha = AlphaOf<Ops>(back);
+    Vec no_src = Ops::CmpEq32(src_alpha, kZero);
+    Vec no_back = Ops::CmpEq32(back_alpha, kZero);
+    // Nothing to draw over an existing background.
+    if (Ops::AllTrue(Ops::AndNot(no_back, no_src)))
+      continue;
+    Vec alpha_ratio;
+    Vec dest_alpha = UnionAlpha<Ops>(back_alpha, src_alpha, &alpha_ratio);
+    Vec result = Ops::Or(
+        Ops::And(MergeColors<Ops>(back, color, alpha_ratio), kColorMask),
+        Ops::ShiftLeft32(dest_alpha, 24));
+    result = Select<Ops>(no_src, back, result);
+    result = Select<Ops>(no_back,
+                         Ops::Or(color, Ops::ShiftLeft32(src_alpha, 24)),
+                         result);
+    Ops::Store(dest, result);
+  }
+  return col;
+}
+
+template <typename Ops>
+int ByteMask2Rgb32(uint8_t* dest_scan,
+                   const uint8_t* src_scan,
+                   int mask_alpha,
+                   int src_r,
+                   int src_g,
+                   int src_b,
+                   int pixel_count,
+                   const uint8_t* clip_scan) {
+  using Vec = typename Ops::Vec;
+  const Vec kZero = Ops::Set1(0);
+  const Vec color = Ops::Set1(src_b | (src_g << 8) | (src_r << 16));
+  int col = 0;
+  for (; col + Ops::kPixels <= pixel_count; col += Ops::kPixels) {
+    uint8_t* dest = dest_scan + col * 4;
+    Vec src_alpha = MaskAlpha<Ops>(src_scan + col,
+                                   clip_scan ? clip_scan + col : nullptr,
+                                   mask_alpha);
+    if (Ops::AllTrue(Ops::CmpEq32(src_alpha, kZero)))
+      continue;
+    Ops::Store(dest, MergeColors<Ops>(Ops::Load(dest), color, src_alpha));
+  }
+  return col;
+}
+
+// The weighted sums of 4 * kPixels bytes of |weight_count| rows, see
+// FXDIB_StretchKernels, in the lanes of |sums| as unpacked by UnpackLo8/Hi8
+// then UnpackLo16/Hi16. A weight w is split as w = 128 * (w >> 7) + (w & 127)
+// so that both parts, and the bytes times 128, fit in 16 bits; MulSmall32()
+// of the interleaved (byte << 7, byte) and (w >> 7, w & 127) is then exactly
+// byte * w.
+template <typename Ops>
+void SumRows(const uint8_t* src,
+             int src_pitch,
+             const int* weights,
+             int weight_count,
+             typename Ops::Vec* sums) {
+  using Vec = typename Ops::Vec;
+  for (int i = 0; i < 4; ++i)
+    sums[i] = Ops::Set1(0);
+  for (int j = 0; j < weight_count; ++j, src += src_pitch) {
+    Vec weight =
+        Ops::Set1(((weights[j] & 127) << 16) | ((weights[j] >> 7) & 0xffff));
+    Vec bytes = Ops::Load(src);
+    Vec lo = Ops::UnpackLo8(bytes);
+    Vec hi = Ops::UnpackHi8(bytes);
+    Vec lo128 = Ops::ShiftLeft16(lo, 7);
+    Vec hi128 = Ops::ShiftLeft16(hi, 7);
+    sums[0] = Ops::Add32(sums[0],
+                         Ops::MulSmall32(Ops::UnpackLo16(lo128, lo), weight));
+    sums[1] = Ops::Add32(sums[1],
+                         Ops::MulSmall32(Ops::UnpackHi16(lo128, lo), weight));
+    sums[2] = Ops::Add32(sums[2],
+                         Ops::MulSmall32(Ops::UnpackLo16(hi128, hi), weight));
+    sums[3] = Ops::Add32(sums[3],
+                         Ops::MulSmall32(Ops::UnpackHi16(hi128, hi), weight));
+  }
+}
+
+template <typename Ops>
+int StretchBytes(uint8_t* dest,
+                 const uint8_t* src,
+                 int src_pitch,
+                 const int* weights,
+                 int weight_count,
+                 int len,
+                 bool bClamp,
+                 uint32_t store_mask) {
+  using Vec = typename Ops::Vec;
+  const int kStep = 4 * Ops::kPixels;
+  const Vec kZero = Ops::Set1(0);
+  const Vec kMax = Ops::Set1(255 << 16);
+  const Vec kByte = Ops::Set1(0xff);
+  const Vec keep = Ops::Set1(static_cast<int32_t>(store_mask));
+  int offset = 0;
+  for (; offset + kStep <= len; offset += kStep) {
+    Vec sums[4];
+    SumRows<Ops>(src + offset, src_pitch, weights, weight_count, sums);
+    for (Vec& sum : sums) {
+      if (bClamp) {
+        sum = Select<Ops>(Ops::CmpGt32(sum, kMax), kMax, sum);
+        sum = Ops::AndNot(Ops::CmpGt32(kZero, sum), sum);
+      }
+      // The low byte of sum >> 16, whether the shift is signed or not.
+      sum = Ops::And(Ops::ShiftRight32(sum, 16), kByte);
+    }
+    Vec result = Ops::Pack16(Ops::Pack32(sums[0], sums[1]),
+                             Ops::Pack32(sums[2], sums[3]));
+    if (store_mask != 0xffffffff)
+      result = Select<Ops>(keep, result, Ops::Load(dest + offset));
+    Ops::Store(dest + offset, result);
+  }
+  return offset;
+}
+
+template <typename Ops>
+int StretchSums(int32_t* sums,
+                const uint8_t* src,
+                int src_pitch,
+                const int* weights,
+                int weight_count,
+                int len) {
+  const int kStep = 4 * Ops::kPixels;
+  int offset = 0;
+  for (; offset + kStep <= len; offset += kStep) {
+    typename Ops::Vec vecs[4];
+    SumRows<Ops>(src + offset, src_pitch, weights, weight_count, vecs);
+    Ops::Store32x4(sums + offset, vecs);
+  }
+  return offset;
+}
+
+template <typename Ops>
+const FXDIB_CompositeKernels* GetKernels() {
+  static const FXDIB_CompositeKernels s_Kernels = {
+      Argb2Argb<Ops>,     Argb2Rgb32<Ops>,     Rgb322Rgb32Clip<Ops>,
+      ByteMask2Argb<Ops>, ByteMask2Rgb32<Ops>,
+  };
+  return &s_Kernels;
+}
+
+template <typename Ops>
+const FXDIB_StretchKernels* GetStretchKernels() {
+  static const FXDIB_StretchKernels s_Kernels = {
+      StretchBytes<Ops>, StretchSums<Ops>,
+  };
+  return &s_Kernels;
+}
+
+}  // namespace fxdib_simd
+
+#endif  // CORE_FXGE_DIB_FX_DIB_SIMD_KERNELS_H_
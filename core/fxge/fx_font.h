@@ -22,7 +22,6 @@ typedef void* FXFT_Library;
 class CFX_FaceCache;
 class CFX_GlyphBitmap;
 class CFX_PathData;
-class CFX_SizeGlyphCache;
 
 #if defined _SKIA_SUPPORT_ || defined _SKIA_SUPPORT_PATHS_
 class SkTypeface;
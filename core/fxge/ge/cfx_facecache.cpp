@@ -9,13 +9,13 @@
 #include <algorithm>
 #include <limits>
 #include <memory>
+#include <utility>
 
 #include "core/fxge/cfx_fontmgr.h"
 #include "core/fxge/cfx_gemodule.h"
 #include "core/fxge/cfx_pathdata.h"
 #include "core/fxge/cfx_substfont.h"
 #include "core/fxge/fx_freetype.h"
-#include "core/fxge/ge/fx_text_int.h"
 #include "third_party/base/numerics/safe_math.h"
 
 #if defined _SKIA_SUPPORT_ || _SKIA_SUPPORT_PATHS_
@@ -74,10 +74,41 @@ void ContrastAdjust(uint8_t* pDataIn,
     }
   }
 }
+
+CFX_GlyphCache::Key MakeGlyphKey(const CFX_FaceCache* pFaceCache,
+                                 const CFX_Font* pFont,
+                                 uint32_t glyph_index,
+                                 const CFX_Matrix* pMatrix,
+                                 int dest_width,
+                                 int anti_alias) {
+  CFX_GlyphCache::Key key;
+  key.pFace = pFaceCache;
+  key.glyph_index = glyph_index;
+  key.matrix[0] = static_cast<int>(pMatrix->a * 10000);
+  key.matrix[1] = static_cast<int>(pMatrix->b * 10000);
+  key.matrix[2] = static_cast<int>(pMatrix->c * 10000);
+  key.matrix[3] = static_cast<int>(pMatrix->d * 10000);
+  key.dest_width = dest_width;
+  key.anti_alias = anti_alias;
+  key.weight = 0;
+  key.italic_angle = 0;
+  key.flags = 0;
+  const CFX_SubstFont* pSubstFont = pFont->GetSubstFont();
+  if (pSubstFont) {
+    key.weight = pSubstFont->m_Weight;
+    key.italic_angle = pSubstFont->m_ItalicAngle;
+    key.flags |= CFX_GlyphCache::kSubstFont;
+    if (pFont->IsVertical())
+      key.flags |= CFX_GlyphCache::kVertical;
+  }
+  return key;
+}
+
 }  // namespace
 
-CFX_FaceCache::CFX_FaceCache(FXFT_Face face)
-    : m_Face(face)
+CFX_FaceCache::CFX_FaceCache(FXFT_Face face, CFX_GlyphCache* pGlyphCache)
+    : m_Face(face),
+      m_pGlyphCache(pGlyphCache)
 #if defined _SKIA_SUPPORT_ || _SKIA_SUPPORT_PATHS_
       ,
       m_pTypeface(nullptr)
@@ -86,6 +117,7 @@ CFX_FaceCache::CFX_FaceCache(FXFT_Face face)
 }
 
 CFX_FaceCache::~CFX_FaceCache() {
+  m_pGlyphCache->RemoveFace(this);
 #if defined _SKIA_SUPPORT_ || _SKIA_SUPPORT_PATHS_
   SkSafeUnref(m_pTypeface);
 #endif
@@ -264,90 +296,31 @@ const CFX_GlyphBitmap* CFX_FaceCache::LoadGlyphBitmap(const CFX_Font* pFont,
   if (glyph_index == kInvalidGlyphIndex)
     return nullptr;
 
-  _CFX_UniqueKeyGen keygen;
-  int nMatrixA = static_cast<int>(pMatrix->a * 10000);
-  int nMatrixB = static_cast<int>(pMatrix->b * 10000);
-  int nMatrixC = static_cast<int>(pMatrix->c * 10000);
-  int nMatrixD = static_cast<int>(pMatrix->d * 10000);
-#if _FXM_PLATFORM_ != _FXM_PLATFORM_APPLE_
-  if (pFont->GetSubstFont()) {
-    keygen.Generate(9, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                    anti_alias, pFont->GetSubstFont()->m_Weight,
-                    pFont->GetSubstFont()->m_ItalicAngle, pFont->IsVertical());
-  } else {
-    keygen.Generate(6, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                    anti_alias);
-  }
-#else
-  if (text_flags & FXTEXT_NO_NATIVETEXT) {
-    if (pFont->GetSubstFont()) {
-      keygen.Generate(9, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                      anti_alias, pFont->GetSubstFont()->m_Weight,
-                      pFont->GetSubstFont()->m_ItalicAngle,
-                      pFont->IsVertical());
-    } else {
-      keygen.Generate(6, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                      anti_alias);
-    }
-  } else {
-    if (pFont->GetSubstFont()) {
-      keygen.Generate(10, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                      anti_alias, pFont->GetSubstFont()->m_Weight,
-                      pFont->GetSubstFont()->m_ItalicAngle, pFont->IsVertical(),
-                      3);
-    } else {
-      keygen.Generate(7, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                      anti_alias, 3);
-    }
-  }
-#endif
-  CFX_ByteString FaceGlyphsKey(keygen.m_Key, keygen.m_KeyLen);
+  CFX_GlyphCache::Key key = MakeGlyphKey(this, pFont, glyph_index, pMatrix,
+                                         dest_width, anti_alias);
 #if _FXM_PLATFORM_ != _FXM_PLATFORM_APPLE_ || defined _SKIA_SUPPORT_ || \
     defined _SKIA_SUPPORT_PATHS_
-  return LookUpGlyphBitmap(pFont, pMatrix, FaceGlyphsKey, glyph_index,
-                           bFontStyle, dest_width, anti_alias);
+  return LookUpGlyphBitmap(pFont, pMatrix, key, bFontStyle, dest_width,
+                           anti_alias);
 #else
   if (text_flags & FXTEXT_NO_NATIVETEXT) {
-    return LookUpGlyphBitmap(pFont, pMatrix, FaceGlyphsKey, glyph_index,
-                             bFontStyle, dest_width, anti_alias);
+    return LookUpGlyphBitmap(pFont, pMatrix, key, bFontStyle, dest_width,
+                             anti_alias);
   }
-  CFX_GlyphBitmap* pGlyphBitmap;
-  auto it = m_SizeMap.find(FaceGlyphsKey);
-  if (it != m_SizeMap.end()) {
-    CFX_SizeGlyphCache* pSizeCache = it->second.get();
-    auto it2 = pSizeCache->m_GlyphMap.find(glyph_index);
-    if (it2 != pSizeCache->m_GlyphMap.end())
-      return it2->second;
+  key.flags |= CFX_GlyphCache::kNativeText;
+  const CFX_GlyphBitmap* pGlyphBitmap;
+  if (m_pGlyphCache->Lookup(key, &pGlyphBitmap))
+    return pGlyphBitmap;
 
-    pGlyphBitmap = RenderGlyph_Nativetext(pFont, glyph_index, pMatrix,
-                                          dest_width, anti_alias);
-    if (pGlyphBitmap) {
-      pSizeCache->m_GlyphMap[glyph_index] = pGlyphBitmap;
-      return pGlyphBitmap;
-    }
-  } else {
-    pGlyphBitmap = RenderGlyph_Nativetext(pFont, glyph_index, pMatrix,
-                                          dest_width, anti_alias);
-    if (pGlyphBitmap) {
-      CFX_SizeGlyphCache* pSizeCache = new CFX_SizeGlyphCache;
-      m_SizeMap[FaceGlyphsKey] =
-          std::unique_ptr<CFX_SizeGlyphCache>(pSizeCache);
-      pSizeCache->m_GlyphMap[glyph_index] = pGlyphBitmap;
-      return pGlyphBitmap;
-    }
-  }
-  if (pFont->GetSubstFont()) {
-    keygen.Generate(9, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                    anti_alias, pFont->GetSubstFont()->m_Weight,
-                    pFont->GetSubstFont()->m_ItalicAngle, pFont->IsVertical());
-  } else {
-    keygen.Generate(6, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                    anti_alias);
-  }
-  CFX_ByteString FaceGlyphsKey2(keygen.m_Key, keygen.m_KeyLen);
+  std::unique_ptr<CFX_GlyphBitmap> pNativeBitmap(RenderGlyph_Nativetext(
+      pFont, glyph_index, pMatrix, dest_width, anti_alias));
+  if (pNativeBitmap)
+    return m_pGlyphCache->Put(key, std::move(pNativeBitmap));
+
+  key.flags &= ~CFX_GlyphCache::kNativeText;
   text_flags |= FXTEXT_NO_NATIVETEXT;
-  return LookUpGlyphBitmap(pFont, pMatrix, FaceGlyphsKey2, glyph_index,
-                           bFontStyle, dest_width, anti_alias);
+  return LookUpGlyphBitmap(pFont, pMatrix, key, bFontStyle, dest_width,
+                           anti_alias);
 #endif
 }
 
@@ -367,28 +340,20 @@ CFX_TypeFace* CFX_FaceCache::GetDeviceCache(const CFX_Font* pFont) {
 void CFX_FaceCache::InitPlatform() {}
 #endif
 
-CFX_GlyphBitmap* CFX_FaceCache::LookUpGlyphBitmap(
+const CFX_GlyphBitmap* CFX_FaceCache::LookUpGlyphBitmap(
     const CFX_Font* pFont,
     const CFX_Matrix* pMatrix,
-    const CFX_ByteString& FaceGlyphsKey,
-    uint32_t glyph_index,
+    const CFX_GlyphCache::Key& key,
     bool bFontStyle,
     int dest_width,
     int anti_alias) {
-  CFX_SizeGlyphCache* pSizeCache;
-  auto it = m_SizeMap.find(FaceGlyphsKey);
-  if (it == m_SizeMap.end()) {
-    pSizeCache = new CFX_SizeGlyphCache;
-    m_SizeMap[FaceGlyphsKey] = std::unique_ptr<CFX_SizeGlyphCache>(pSizeCache);
-  } else {
-    pSizeCache = it->second.get();
-  }
-  auto it2 = pSizeCache->m_GlyphMap.find(glyph_index);
-  if (it2 != pSizeCache->m_GlyphMap.end())
-    return it2->second;
+  const CFX_GlyphBitmap* pGlyphBitmap;
+  if (m_pGlyphCache->Lookup(key, &pGlyphBitmap))
+    return pGlyphBitmap;
 
-  CFX_GlyphBitmap* pGlyphBitmap = RenderGlyph(pFont, glyph_index, bFontStyle,
-                                              pMatrix, dest_width, anti_alias);
-  pSizeCache->m_GlyphMap[glyph_index] = pGlyphBitmap;
-  return pGlyphBitmap;
+  // Glyphs that fail to render are cached as well, so that they are not
+  // tried again.
+  std::unique_ptr<CFX_GlyphBitmap> pNewBitmap(RenderGlyph(
+      pFont, key.glyph_index, bFontStyle, pMatrix, dest_width, anti_alias));
+  return m_pGlyphCache->Put(key, std::move(pNewBitmap));
 }
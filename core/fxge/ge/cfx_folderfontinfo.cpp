@@ -6,13 +6,25 @@
 
 #include "core/fxge/ge/cfx_folderfontinfo.h"
 
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <atomic>
 #include <limits>
+#include <utility>
 
 #include "core/fxge/cfx_fontmapper.h"
 #include "core/fxge/fx_font.h"
-
+#include "third_party/base/ptr_util.h"
 #include "third_party/base/stl_util.h"
 
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
 namespace {
 
 const struct {
@@ -57,6 +69,20 @@ CFX_ByteString FPDF_LoadTableFromTT(FXSYS_FILE* pFile,
   return CFX_ByteString();
 }
 
+// Unique to this process and to this save within it, so that processes, or
+// threads, saving the same index at once never write to the same file.
+CFX_ByteString GetTempIndexPath(const CFX_ByteString& path) {
+  static std::atomic<uint32_t> s_nSaves(0);
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+  int pid = _getpid();
+#else
+  int pid = getpid();
+#endif
+  CFX_ByteString temp_path;
+  temp_path.Format("%s.%d.%u.tmp", path.c_str(), pid, s_nSaves++);
+  return temp_path;
+}
+
 uint32_t GetCharset(int charset) {
   switch (charset) {
     case FXFONT_SHIFTJIS_CHARSET:
@@ -97,23 +123,134 @@ int32_t GetSimilarValue(int weight,
   return iSimilarValue;
 }
 
-}  // namespace
+// The charsets of the faces, in the order they are reported to the mapper.
+const struct {
+  uint32_t m_Flag;
+  int m_Charset;
+} kCharsetFlags[] = {
+    {CHARSET_FLAG_SHIFTJIS, FXFONT_SHIFTJIS_CHARSET},
+    {CHARSET_FLAG_GB, FXFONT_GB2312_CHARSET},
+    {CHARSET_FLAG_BIG5, FXFONT_CHINESEBIG5_CHARSET},
+    {CHARSET_FLAG_KOREAN, FXFONT_HANGUL_CHARSET},
+    {CHARSET_FLAG_SYMBOL, FXFONT_SYMBOL_CHARSET},
+    {CHARSET_FLAG_ANSI, FXFONT_ANSI_CHARSET},
+};
 
-CFX_FolderFontInfo::CFX_FolderFontInfo() {}
+const char kIndexMagic[4] = {'P', 'F', 'I', 'X'};
+const uint32_t kIndexVersion = 1;
+
+// What is checked to tell whether a font file changed since it was indexed.
+bool GetFileStamp(const CFX_ByteString& path,
+                  int64_t* pModifiedTime,
+                  uint32_t* pFileSize) {
+  struct stat info;
+  if (stat(path.c_str(), &info) != 0 || info.st_size < 0 ||
+      static_cast<uint64_t>(info.st_size) >
+          std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  *pModifiedTime = info.st_mtime;
+  *pFileSize = static_cast<uint32_t>(info.st_size);
+  return true;
+}
 
-CFX_FolderFontInfo::~CFX_FolderFontInfo() {
-  for (const auto& pair : m_FontList)
-    delete pair.second;
+void AppendUInt(uint64_t value, std::vector<uint8_t>* pData) {
+  while (value >= 0x80) {
+    pData->push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  pData->push_back(static_cast<uint8_t>(value));
 }
 
+void AppendBytes(const CFX_ByteString& bytes, std::vector<uint8_t>* pData) {
+  AppendUInt(bytes.GetLength(), pData);
+  pData->insert(pData->end(), bytes.raw_str(),
+                bytes.raw_str() + bytes.GetLength());
+}
+
+class IndexReader {
+ public:
+  IndexReader(const uint8_t* pData, uint32_t size)
+      : m_pData(pData), m_Size(size), m_Offset(0) {}
+
+  bool AtEnd() const { return m_Offset == m_Size; }
+
+  bool ReadUInt64(uint64_t* pValue) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (m_Offset >= m_Size)
+        return false;
+      uint8_t byte = m_pData[m_Offset++];
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) {
+        *pValue = value;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ReadUInt(uint32_t* pValue) {
+    uint64_t value;
+    if (!ReadUInt64(&value) || value > std::numeric_limits<uint32_t>::max())
+      return false;
+    *pValue = static_cast<uint32_t>(value);
+    return true;
+  }
+
+  bool ReadBytes(CFX_ByteString* pBytes) {
+    uint32_t length;
+    if (!ReadUInt(&length) || length > m_Size - m_Offset)
+      return false;
+    *pBytes = CFX_ByteString(m_pData + m_Offset, length);
+    m_Offset += length;
+    return true;
+  }
+
+  bool ReadMagic() {
+    if (m_Size - m_Offset < sizeof(kIndexMagic) ||
+        FXSYS_memcmp(m_pData + m_Offset, kIndexMagic, sizeof(kIndexMagic)) !=
+            0) {
+      return false;
+    }
+    m_Offset += sizeof(kIndexMagic);
+    return true;
+  }
+
+ private:
+  const uint8_t* const m_pData;
+  const uint32_t m_Size;
+  uint32_t m_Offset;
+};
+
+}  // namespace
+
+CFX_FolderFontInfo::FontFile::FontFile() : m_ModifiedTime(0), m_FileSize(0) {}
+
+CFX_FolderFontInfo::FontFile::~FontFile() {}
+
+CFX_FolderFontInfo::CFX_FolderFontInfo()
+    : m_pMapper(nullptr), m_nScannedFiles(0), m_bIndexStale(false) {}
+
+CFX_FolderFontInfo::~CFX_FolderFontInfo() {}
+
 void CFX_FolderFontInfo::AddPath(const CFX_ByteStringC& path) {
   m_PathList.push_back(CFX_ByteString(path));
 }
 
 bool CFX_FolderFontInfo::EnumFontList(CFX_FontMapper* pMapper) {
   m_pMapper = pMapper;
+  m_bIndexStale = m_FontIndexPath.IsEmpty() ||
+                  !LoadFontIndex(m_FontIndexPath, &m_IndexedFiles);
   for (const auto& path : m_PathList)
     ScanPath(path);
+
+  // Files that went away leave the index out of date too.
+  if (!m_IndexedFiles.empty())
+    m_bIndexStale = true;
+  m_IndexedFiles.clear();
+  if (!m_FontIndexPath.IsEmpty() && m_bIndexStale)
+    SaveFontIndex(m_FontIndexPath);
   return true;
 }
 
@@ -149,10 +286,39 @@ void CFX_FolderFontInfo::ScanPath(const CFX_ByteString& path) {
 }
 
 void CFX_FolderFontInfo::ScanFile(const CFX_ByteString& path) {
+  // Folders listed more than once have their faces reported once.
+  if (pdfium::ContainsKey(m_FontFiles, path))
+    return;
+
+  int64_t modified_time = 0;
+  uint32_t file_size = 0;
+  bool bStamped = GetFileStamp(path, &modified_time, &file_size);
+  auto indexed = m_IndexedFiles.find(path);
+  if (indexed != m_IndexedFiles.end()) {
+    std::unique_ptr<FontFile> pIndexed = std::move(indexed->second);
+    m_IndexedFiles.erase(indexed);
+    if (bStamped && pIndexed->m_ModifiedTime == modified_time &&
+        pIndexed->m_FileSize == file_size) {
+      for (const auto& pInfo : pIndexed->m_Faces)
+        AddFace(pInfo.get());
+      m_FontFiles[path] = std::move(pIndexed);
+      return;
+    }
+  }
+  m_bIndexStale = true;
+
   FXSYS_FILE* pFile = FXSYS_fopen(path.c_str(), "rb");
   if (!pFile)
     return;
 
+  // Files with no faces are indexed too, so that they are not read again.
+  ++m_nScannedFiles;
+  auto pNewFontFile = pdfium::MakeUnique<FontFile>();
+  FontFile* pFontFile = pNewFontFile.get();
+  pFontFile->m_ModifiedTime = bStamped ? modified_time : -1;
+  pFontFile->m_FileSize = file_size;
+  m_FontFiles[path] = std::move(pNewFontFile);
+
   FXSYS_fseek(pFile, 0, FXSYS_SEEK_END);
 
   uint32_t filesize = FXSYS_ftell(pFile);
@@ -181,11 +347,11 @@ void CFX_FolderFontInfo::ScanFile(const CFX_ByteString& path) {
     }
     for (uint32_t i = 0; i < nFaces; i++) {
       uint8_t* p = offsets + i * 4;
-      ReportFace(path, pFile, filesize, GET_TT_LONG(p));
+      ReportFace(path, pFile, filesize, GET_TT_LONG(p), pFontFile);
     }
     FX_Free(offsets);
   } else {
-    ReportFace(path, pFile, filesize, 0);
+    ReportFace(path, pFile, filesize, 0, pFontFile);
   }
   FXSYS_fclose(pFile);
 }
@@ -193,7 +359,8 @@ void CFX_FolderFontInfo::ScanFile(const CFX_ByteString& path) {
 void CFX_FolderFontInfo::ReportFace(const CFX_ByteString& path,
                                     FXSYS_FILE* pFile,
                                     uint32_t filesize,
-                                    uint32_t offset) {
+                                    uint32_t offset,
+                                    FontFile* pFontFile) {
   FXSYS_fseek(pFile, offset, FXSYS_SEEK_SET);
   char buffer[16];
   if (!FXSYS_fread(buffer, 12, 1, pFile))
@@ -218,38 +385,24 @@ void CFX_FolderFontInfo::ReportFace(const CFX_ByteString& path,
   if (style != "Regular")
     facename += " " + style;
 
-  if (pdfium::ContainsKey(m_FontList, facename))
-    return;
-
-  CFX_FontFaceInfo* pInfo =
-      new CFX_FontFaceInfo(path, facename, tables, offset, filesize);
+  auto pInfo = pdfium::MakeUnique<CFX_FontFaceInfo>(path, facename, tables,
+                                                     offset, filesize);
   CFX_ByteString os2 =
       FPDF_LoadTableFromTT(pFile, tables.raw_str(), nTables, 0x4f532f32);
   if (os2.GetLength() >= 86) {
     const uint8_t* p = os2.raw_str() + 78;
     uint32_t codepages = GET_TT_LONG(p);
-    if (codepages & (1 << 17)) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_SHIFTJIS_CHARSET);
+    if (codepages & (1 << 17))
       pInfo->m_Charsets |= CHARSET_FLAG_SHIFTJIS;
-    }
-    if (codepages & (1 << 18)) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_GB2312_CHARSET);
+    if (codepages & (1 << 18))
       pInfo->m_Charsets |= CHARSET_FLAG_GB;
-    }
-    if (codepages & (1 << 20)) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_CHINESEBIG5_CHARSET);
+    if (codepages & (1 << 20))
       pInfo->m_Charsets |= CHARSET_FLAG_BIG5;
-    }
-    if ((codepages & (1 << 19)) || (codepages & (1 << 21))) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_HANGUL_CHARSET);
+    if ((codepages & (1 << 19)) || (codepages & (1 << 21)))
       pInfo->m_Charsets |= CHARSET_FLAG_KOREAN;
-    }
-    if (codepages & (1 << 31)) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_SYMBOL_CHARSET);
+    if (codepages & (1 << 31))
       pInfo->m_Charsets |= CHARSET_FLAG_SYMBOL;
-    }
   }
-  m_pMapper->AddInstalledFont(facename, FXFONT_ANSI_CHARSET);
   pInfo->m_Charsets |= CHARSET_FLAG_ANSI;
   pInfo->m_Styles = 0;
   if (style.Find("Bold") > -1)
@@ -259,9 +412,142 @@ void CFX_FolderFontInfo::ReportFace(const CFX_ByteString& path,
   if (facename.Find("Serif") > -1)
     pInfo->m_Styles |= FXFONT_SERIF;
 
+  AddFace(pInfo.get());
+  pFontFile->m_Faces.push_back(std::move(pInfo));
+}
+
+void CFX_FolderFontInfo::AddFace(CFX_FontFaceInfo* pInfo) {
+  const CFX_ByteString& facename = pInfo->m_FaceName;
+  if (pdfium::ContainsKey(m_FontList, facename))
+    return;
+
+  for (const auto& charset : kCharsetFlags) {
+    if (pInfo->m_Charsets & charset.m_Flag)
+      m_pMapper->AddInstalledFont(facename, charset.m_Charset);
+  }
   m_FontList[facename] = pInfo;
 }
 
+bool CFX_FolderFontInfo::LoadFontIndex(const CFX_ByteString& path,
+                                       FontFileMap* pFiles) {
+  FXSYS_FILE* pFile = FXSYS_fopen(path.c_str(), "rb");
+  if (!pFile)
+    return false;
+
+  std::vector<uint8_t> data;
+  FXSYS_fseek(pFile, 0, FXSYS_SEEK_END);
+  long size = FXSYS_ftell(pFile);
+  FXSYS_fseek(pFile, 0, FXSYS_SEEK_SET);
+  if (size > 0 &&
+      static_cast<unsigned long>(size) <=
+          std::numeric_limits<uint32_t>::max()) {
+    data.resize(size);
+    if (FXSYS_fread(data.data(), size, 1, pFile) != 1)
+      data.clear();
+  }
+  FXSYS_fclose(pFile);
+
+  IndexReader reader(data.data(), data.size());
+  uint32_t version;
+  uint32_t file_count;
+  if (!reader.ReadMagic() || !reader.ReadUInt(&version) ||
+      version != kIndexVersion || !reader.ReadUInt(&file_count)) {
+    return false;
+  }
+
+  FontFileMap files;
+  for (uint32_t i = 0; i < file_count; ++i) {
+    CFX_ByteString file_path;
+    uint64_t modified_time;
+    uint32_t face_count;
+    auto pFontFile = pdfium::MakeUnique<FontFile>();
+    if (!reader.ReadBytes(&file_path) || !reader.ReadUInt64(&modified_time) ||
+        !reader.ReadUInt(&pFontFile->m_FileSize) ||
+        !reader.ReadUInt(&face_count)) {
+      return false;
+    }
+    pFontFile->m_ModifiedTime = static_cast<int64_t>(modified_time);
+    for (uint32_t j = 0; j < face_count; ++j) {
+      CFX_ByteString facename;
+      CFX_ByteString tables;
+      uint32_t offset;
+      uint32_t styles;
+      uint32_t charsets;
+      if (!reader.ReadBytes(&facename) || !reader.ReadBytes(&tables) ||
+          !reader.ReadUInt(&offset) || !reader.ReadUInt(&styles) ||
+          !reader.ReadUInt(&charsets)) {
+        return false;
+      }
+      auto pInfo = pdfium::MakeUnique<CFX_FontFaceInfo>(
+          file_path, facename, tables, offset, pFontFile->m_FileSize);
+      pInfo->m_Styles = styles;
+      pInfo->m_Charsets = charsets;
+      pFontFile->m_Faces.push_back(std::move(pInfo));
+    }
+    files[file_path] = std::move(pFontFile);
+  }
+  if (!reader.AtEnd())
+    return false;
+
+  *pFiles = std::move(files);
+  return true;
+}
+
+void CFX_FolderFontInfo::SetFontIndexPath(const CFX_ByteString& path) {
+  m_FontIndexPath = path;
+}
+
+bool CFX_FolderFontInfo::SaveFontIndex(const CFX_ByteString& path) {
+  if (!m_pMapper)
+    return false;
+
+  // Files whose stamp could not be read are left to be read every time.
+  uint32_t file_count = 0;
+  for (const auto& file : m_FontFiles) {
+    if (file.second->m_ModifiedTime >= 0)
+      ++file_count;
+  }
+
+  std::vector<uint8_t> data(kIndexMagic, kIndexMagic + sizeof(kIndexMagic));
+  AppendUInt(kIndexVersion, &data);
+  AppendUInt(file_count, &data);
+  for (const auto& file : m_FontFiles) {
+    const FontFile* pFontFile = file.second.get();
+    if (pFontFile->m_ModifiedTime < 0)
+      continue;
+
+    AppendBytes(file.first, &data);
+    AppendUInt(pFontFile->m_ModifiedTime, &data);
+    AppendUInt(pFontFile->m_FileSize, &data);
+    AppendUInt(pFontFile->m_Faces.size(), &data);
+    for (const auto& pInfo : pFontFile->m_Faces) {
+      AppendBytes(pInfo->m_FaceName, &data);
+      AppendBytes(pInfo->m_FontTables, &data);
+      AppendUInt(pInfo->m_FontOffset, &data);
+      AppendUInt(pInfo->m_Styles, &data);
+      AppendUInt(pInfo->m_Charsets, &data);
+    }
+  }
+
+  // Written aside and renamed, so that other processes never read half an
+  // index.
+  CFX_ByteString temp_path = GetTempIndexPath(path);
+  FXSYS_FILE* pFile = FXSYS_fopen(temp_path.c_str(), "wb");
+  if (!pFile)
+    return false;
+
+  bool bWritten = FXSYS_fwrite(data.data(), data.size(), 1, pFile) == 1;
+  bWritten = FXSYS_fclose(pFile) == 0 && bWritten;
+  if (bWritten && rename(temp_path.c_str(), path.c_str()) != 0) {
+    // Windows does not rename over an existing file.
+    remove(path.c_str());
+    bWritten = rename(temp_path.c_str(), path.c_str()) == 0;
+  }
+  if (!bWritten)
+    remove(temp_path.c_str());
+  return bWritten;
+}
+
 void* CFX_FolderFontInfo::GetSubstFont(const CFX_ByteString& face) {
   for (size_t iBaseFont = 0; iBaseFont < FX_ArraySize(Base14Substs);
        iBaseFont++) {
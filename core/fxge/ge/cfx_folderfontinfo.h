@@ -8,6 +8,7 @@
 #define CORE_FXGE_GE_CFX_FOLDERFONTINFO_H_
 
 #include <map>
+#include <memory>
 #include <vector>
 
 #include "core/fxge/cfx_fontmapper.h"
@@ -43,14 +44,36 @@ class CFX_FolderFontInfo : public IFX_SystemFontInfo {
   void DeleteFont(void* hFont) override;
   bool GetFaceName(void* hFont, CFX_ByteString& name) override;
   bool GetFontCharset(void* hFont, int& charset) override;
+  void SetFontIndexPath(const CFX_ByteString& path) override;
+  bool SaveFontIndex(const CFX_ByteString& path) override;
+
+  // The number of font files EnumFontList() had to open, as they were not
+  // in the font index or changed since.
+  uint32_t GetScannedFileCount() const { return m_nScannedFiles; }
 
  protected:
+  // The faces of a font file, and the file they were found in. Faces with
+  // the name of a face found before are kept too, so that they are there if
+  // the other file goes away.
+  struct FontFile {
+    FontFile();
+    ~FontFile();
+
+    int64_t m_ModifiedTime;
+    uint32_t m_FileSize;
+    std::vector<std::unique_ptr<CFX_FontFaceInfo>> m_Faces;
+  };
+  using FontFileMap = std::map<CFX_ByteString, std::unique_ptr<FontFile>>;
+
   void ScanPath(const CFX_ByteString& path);
   void ScanFile(const CFX_ByteString& path);
   void ReportFace(const CFX_ByteString& path,
                   FXSYS_FILE* pFile,
                   uint32_t filesize,
-                  uint32_t offset);
+                  uint32_t offset,
+                  FontFile* pFontFile);
+  void AddFace(CFX_FontFaceInfo* pInfo);
+  bool LoadFontIndex(const CFX_ByteString& path, FontFileMap* pFiles);
   void* GetSubstFont(const CFX_ByteString& face);
   void* FindFont(int weight,
                  bool bItalic,
@@ -59,9 +82,16 @@ class CFX_FolderFontInfo : public IFX_SystemFontInfo {
                  const FX_CHAR* family,
                  bool bMatchName);
 
+  // Owned by |m_FontFiles|.
   std::map<CFX_ByteString, CFX_FontFaceInfo*> m_FontList;
   std::vector<CFX_ByteString> m_PathList;
   CFX_FontMapper* m_pMapper;
+  FontFileMap m_FontFiles;
+  // The font index, while EnumFontList() checks it against the files.
+  FontFileMap m_IndexedFiles;
+  CFX_ByteString m_FontIndexPath;
+  uint32_t m_nScannedFiles;
+  bool m_bIndexStale;
 };
 
 #endif  // CORE_FXGE_GE_CFX_FOLDERFONTINFO_H_
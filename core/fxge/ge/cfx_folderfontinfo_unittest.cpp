@@ -0,0 +1,273 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxge/ge/cfx_folderfontinfo.h"
+
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/fxcrt/fx_stream.h"
+#include "core/fxge/cfx_gemodule.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/utils/path_service.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+const uint32_t kTableOS2 = FXDWORD_GET_MSBFIRST("OS/2");
+
+void AppendShort(uint16_t value, std::vector<uint8_t>* pData) {
+  pData->push_back(value >> 8);
+  pData->push_back(value & 0xFF);
+}
+
+void AppendLong(uint32_t value, std::vector<uint8_t>* pData) {
+  AppendShort(value >> 16, pData);
+  AppendShort(value & 0xFFFF, pData);
+}
+
+// A TrueType face with just the tables the folder font info reads, to be
+// put at |offset| in its file.
+std::vector<uint8_t> MakeFace(const std::string& family,
+                              const std::string& style,
+                              uint32_t codepages,
+                              uint32_t offset) {
+  std::vector<uint8_t> name;
+  AppendShort(0, &name);  // Format.
+  AppendShort(2, &name);  // Count.
+  AppendShort(6 + 2 * 12, &name);
+  uint16_t string_offset = 0;
+  for (const std::string* pString : {&family, &style}) {
+    AppendShort(1, &name);  // Macintosh platform, Roman encoding.
+    AppendShort(0, &name);
+    AppendShort(0, &name);
+    AppendShort(pString == &family ? 1 : 2, &name);
+    AppendShort(pString->size(), &name);
+    AppendShort(string_offset, &name);
+    string_offset += pString->size();
+  }
+  name.insert(name.end(), family.begin(), family.end());
+  name.insert(name.end(), style.begin(), style.end());
+
+  std::vector<uint8_t> os2(78);
+  AppendLong(codepages, &os2);
+  os2.resize(86);
+
+  std::vector<uint8_t> face;
+  AppendLong(0x00010000, &face);
+  AppendShort(2, &face);
+  face.resize(12);
+  uint32_t table_offset = offset + 12 + 2 * 16;
+  for (const auto& table :
+       {std::make_pair(kTableNAME, &name), std::make_pair(kTableOS2, &os2)}) {
+    AppendLong(table.first, &face);
+    AppendLong(0, &face);
+    AppendLong(table_offset, &face);
+    AppendLong(table.second->size(), &face);
+    table_offset += table.second->size();
+  }
+  face.insert(face.end(), name.begin(), name.end());
+  face.insert(face.end(), os2.begin(), os2.end());
+  return face;
+}
+
+// A TrueType collection of two faces.
+std::vector<uint8_t> MakeCollection(const std::string& family1,
+                                    const std::string& family2) {
+  std::vector<uint8_t> data;
+  AppendLong(kTableTTCF, &data);
+  AppendLong(0x00010000, &data);
+  AppendLong(2, &data);
+  uint32_t offset = 12 + 2 * 4;
+  std::vector<uint8_t> face1 = MakeFace(family1, "Regular", 0, offset);
+  std::vector<uint8_t> face2 =
+      MakeFace(family2, "Regular", 0, offset + face1.size());
+  AppendLong(offset, &data);
+  AppendLong(offset + face1.size(), &data);
+  data.insert(data.end(), face1.begin(), face1.end());
+  data.insert(data.end(), face2.begin(), face2.end());
+  return data;
+}
+
+void WriteFile(const std::string& path, const std::vector<uint8_t>& data) {
+  FXSYS_FILE* pFile = FXSYS_fopen(path.c_str(), "wb");
+  ASSERT_TRUE(pFile) << path;
+  if (!data.empty())
+    EXPECT_EQ(1u, FXSYS_fwrite(data.data(), data.size(), 1, pFile));
+  FXSYS_fclose(pFile);
+}
+
+// A folder of fonts for a test, removed along with the test.
+class TestFontFolder {
+ public:
+  explicit TestFontFolder(const std::string& name) {
+    PathService::GetExecutableDir(&m_Path);
+    if (!PathService::EndsWithSeparator(m_Path))
+      m_Path += static_cast<char>(FX_GetFolderSeparator());
+    m_Path += name;
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+    _mkdir(m_Path.c_str());
+#else
+    mkdir(m_Path.c_str(), 0755);
+#endif
+  }
+
+  ~TestFontFolder() {
+    for (const std::string& file : m_Files)
+      remove(file.c_str());
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+    _rmdir(m_Path.c_str());
+#else
+    rmdir(m_Path.c_str());
+#endif
+  }
+
+  const std::string& path() const { return m_Path; }
+
+  std::string AddFile(const std::string& name,
+                      const std::vector<uint8_t>& data) {
+    std::string path = FilePath(name);
+    WriteFile(path, data);
+    return path;
+  }
+
+  std::string FilePath(const std::string& name) {
+    std::string path =
+        m_Path + static_cast<char>(FX_GetFolderSeparator()) + name;
+    m_Files.push_back(path);
+    return path;
+  }
+
+ private:
+  std::string m_Path;
+  std::vector<std::string> m_Files;
+};
+
+// Looks for the fonts in |folder| as the system font info does.
+class FontList {
+ public:
+  FontList(const TestFontFolder& folder, const std::string& index_path)
+      : m_Mapper(CFX_GEModule::Get()->GetFontMgr()) {
+    auto pFontInfo = pdfium::MakeUnique<CFX_FolderFontInfo>();
+    m_pFontInfo = pFontInfo.get();
+    m_pFontInfo->AddPath(folder.path().c_str());
+    m_pFontInfo->SetFontIndexPath(index_path.c_str());
+    m_Mapper.SetSystemFontInfo(std::move(pFontInfo));
+    m_Mapper.LoadInstalledFonts();
+  }
+
+  CFX_FolderFontInfo* font_info() const { return m_pFontInfo; }
+
+  std::vector<std::string> GetInstalledFonts() const {
+    std::vector<std::string> fonts;
+    for (int i = 0; i < m_Mapper.GetFaceSize(); ++i)
+      fonts.push_back(m_Mapper.GetFaceName(i).c_str());
+    return fonts;
+  }
+
+  std::vector<uint8_t> GetNameTable(const char* face) const {
+    void* hFont = m_pFontInfo->GetFont(face);
+    if (!hFont)
+      return std::vector<uint8_t>();
+    std::vector<uint8_t> table(
+        m_pFontInfo->GetFontData(hFont, kTableNAME, nullptr, 0));
+    m_pFontInfo->GetFontData(hFont, kTableNAME, table.data(), table.size());
+    return table;
+  }
+
+ private:
+  CFX_FontMapper m_Mapper;
+  CFX_FolderFontInfo* m_pFontInfo;
+};
+
+}  // namespace
+
+TEST(fxge, FolderFontIndex) {
+  TestFontFolder folder("folderfontinfo_index");
+  std::string sans_path =
+      folder.AddFile("b.ttf", MakeFace("Test Sans", "Bold", 1 << 18, 0));
+  folder.AddFile("a.ttc", MakeCollection("Test Serif", "Test Sans"));
+  folder.AddFile("c.txt", MakeFace("Not A Font", "Regular", 0, 0));
+  std::string index_path = folder.FilePath("fonts.idx");
+
+  std::vector<std::string> fonts;
+  std::vector<uint8_t> name_table;
+  {
+    FontList list(folder, index_path);
+    EXPECT_EQ(2u, list.font_info()->GetScannedFileCount());
+    fonts = list.GetInstalledFonts();
+    // Test Sans Bold is reported for two charsets.
+    EXPECT_EQ(4u, fonts.size());
+    name_table = list.GetNameTable("Test Sans Bold");
+    EXPECT_FALSE(name_table.empty());
+    EXPECT_TRUE(list.GetNameTable("Not A Font").empty());
+  }
+
+  // Later on, the fonts come from the index.
+  {
+    FontList list(folder, index_path);
+    EXPECT_EQ(0u, list.font_info()->GetScannedFileCount());
+    EXPECT_EQ(fonts, list.GetInstalledFonts());
+    EXPECT_EQ(name_table, list.GetNameTable("Test Sans Bold"));
+    EXPECT_FALSE(list.GetNameTable("Test Serif").empty());
+  }
+
+  // Files that changed are read again.
+  WriteFile(sans_path, MakeFace("Test Mono", "Regular", 0, 0));
+  {
+    FontList list(folder, index_path);
+    EXPECT_EQ(1u, list.font_info()->GetScannedFileCount());
+    EXPECT_TRUE(list.GetNameTable("Test Sans Bold").empty());
+    EXPECT_FALSE(list.GetNameTable("Test Mono").empty());
+  }
+  {
+    FontList list(folder, index_path);
+    EXPECT_EQ(0u, list.font_info()->GetScannedFileCount());
+    EXPECT_FALSE(list.GetNameTable("Test Mono").empty());
+    EXPECT_FALSE(list.GetNameTable("Test Serif").empty());
+  }
+}
+
+TEST(fxge, FolderFontIndexRejectsBadData) {
+  TestFontFolder folder("folderfontinfo_bad_index");
+  folder.AddFile("a.ttf", MakeFace("Test Sans", "Regular", 0, 0));
+  std::string index_path = folder.FilePath("fonts.idx");
+
+  CFX_FolderFontInfo font_info;
+  EXPECT_FALSE(font_info.SaveFontIndex(index_path.c_str()));
+
+  std::vector<uint8_t> good_index;
+  {
+    FontList list(folder, index_path);
+    EXPECT_EQ(1u, list.font_info()->GetScannedFileCount());
+    FXSYS_FILE* pFile = FXSYS_fopen(index_path.c_str(), "rb");
+    ASSERT_TRUE(pFile);
+    uint8_t buffer[4096];
+    size_t size = FXSYS_fread(buffer, 1, sizeof(buffer), pFile);
+    FXSYS_fclose(pFile);
+    good_index.assign(buffer, buffer + size);
+  }
+
+  // Indexes that do not load are replaced.
+  std::vector<uint8_t> corrupt = good_index;
+  corrupt[0] = 'X';
+  std::vector<uint8_t> longer = good_index;
+  longer.push_back(0);
+  for (const std::vector<uint8_t>& bad_index :
+       {std::vector<uint8_t>(), corrupt, longer,
+        std::vector<uint8_t>(good_index.begin(), good_index.end() - 1)}) {
+    WriteFile(index_path, bad_index);
+    {
+      FontList list(folder, index_path);
+      EXPECT_EQ(1u, list.font_info()->GetScannedFileCount());
+      EXPECT_FALSE(list.GetNameTable("Test Sans").empty());
+    }
+    FontList list(folder, index_path);
+    EXPECT_EQ(0u, list.font_info()->GetScannedFileCount());
+  }
+}
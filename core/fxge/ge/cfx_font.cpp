@@ -20,7 +20,6 @@
 #include "core/fxge/cfx_pathdata.h"
 #include "core/fxge/cfx_substfont.h"
 #include "core/fxge/fx_freetype.h"
-#include "core/fxge/ge/fx_text_int.h"
 #include "third_party/base/ptr_util.h"
 
 #define EM_ADJUST(em, a) (em == 0 ? (a) : (a)*1000 / em)
@@ -311,7 +310,8 @@ CFX_Font::~CFX_Font() {
 void CFX_Font::DeleteFace() {
   ClearFaceCache();
   if (m_bEmbedded) {
-    FXFT_Done_Face(m_Face);
+    if (!CFX_GEModule::Get()->GetFontCache()->ReleaseEmbeddedFace(m_Face))
+      FXFT_Done_Face(m_Face);
   } else {
     CFX_GEModule::Get()->GetFontMgr()->ReleaseFace(m_Face);
   }
@@ -375,12 +375,17 @@ int CFX_Font::GetGlyphWidth(uint32_t glyph_index) {
 }
 
 bool CFX_Font::LoadEmbedded(const uint8_t* data, uint32_t size) {
+  m_bEmbedded = true;
+  m_dwSize = size;
+  m_Face = CFX_GEModule::Get()->GetFontCache()->GetEmbeddedFace(data, size,
+                                                                &m_pFontData);
+  if (m_Face)
+    return true;
+
   std::vector<uint8_t> temp(data, data + size);
   m_pFontDataAllocation.swap(temp);
   m_Face = FT_LoadFont(m_pFontDataAllocation.data(), size);
   m_pFontData = m_pFontDataAllocation.data();
-  m_bEmbedded = true;
-  m_dwSize = size;
   return !!m_Face;
 }
 
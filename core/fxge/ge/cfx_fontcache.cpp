@@ -6,10 +6,13 @@
 
 #include "core/fxge/cfx_fontcache.h"
 
+#include <iterator>
 #include <memory>
 #include <utility>
 
 #include "core/fxge/cfx_facecache.h"
+#include "core/fxge/cfx_fontmgr.h"
+#include "core/fxge/cfx_gemodule.h"
 #include "core/fxge/fx_font.h"
 #include "core/fxge/fx_freetype.h"
 
@@ -17,15 +20,28 @@ CFX_FontCache::CountedFaceCache::CountedFaceCache() {}
 
 CFX_FontCache::CountedFaceCache::~CountedFaceCache() {}
 
-CFX_FontCache::CFX_FontCache() {}
+CFX_FontCache::CFX_FontCache()
+    : m_nEmbeddedBytes(0),
+      m_nMaxEmbeddedBytes(0),
+      m_nEmbeddedHits(0),
+      m_nEmbeddedMisses(0),
+      m_nEmbeddedEvictions(0) {}
 
 CFX_FontCache::~CFX_FontCache() {
+  while (!m_EmbeddedFaces.empty()) {
+    ASSERT(!m_EmbeddedFaces.front().nRefs);
+    EraseEmbeddedFaceLocked(m_EmbeddedFaces.begin());
+  }
   ASSERT(m_ExtFaceMap.empty());
   ASSERT(m_FTFaceMap.empty());
 }
 
 CFX_FaceCache* CFX_FontCache::GetCachedFace(const CFX_Font* pFont) {
-  FXFT_Face face = pFont->GetFace();
+  CFX_AutoLock lock(&m_Lock);
+  return GetCachedFaceLocked(pFont->GetFace());
+}
+
+CFX_FaceCache* CFX_FontCache::GetCachedFaceLocked(FXFT_Face face) {
   const bool bExternal = !face;
   CFX_FTCacheMap& map = bExternal ? m_ExtFaceMap : m_FTFaceMap;
   auto it = map.find(face);
@@ -37,7 +53,8 @@ CFX_FaceCache* CFX_FontCache::GetCachedFace(const CFX_Font* pFont) {
 
   std::unique_ptr<CountedFaceCache> counted_face_cache(new CountedFaceCache);
   counted_face_cache->m_nCount = 2;
-  CFX_FaceCache* face_cache = new CFX_FaceCache(bExternal ? nullptr : face);
+  CFX_FaceCache* face_cache =
+      new CFX_FaceCache(bExternal ? nullptr : face, &m_GlyphCache);
   counted_face_cache->m_Obj.reset(face_cache);
   map[face] = std::move(counted_face_cache);
   return face_cache;
@@ -50,7 +67,11 @@ CFX_TypeFace* CFX_FontCache::GetDeviceCache(const CFX_Font* pFont) {
 #endif
 
 void CFX_FontCache::ReleaseCachedFace(const CFX_Font* pFont) {
-  FXFT_Face face = pFont->GetFace();
+  CFX_AutoLock lock(&m_Lock);
+  ReleaseCachedFaceLocked(pFont->GetFace());
+}
+
+void CFX_FontCache::ReleaseCachedFaceLocked(FXFT_Face face) {
   const bool bExternal = !face;
   CFX_FTCacheMap& map = bExternal ? m_ExtFaceMap : m_FTFaceMap;
 
@@ -65,3 +86,114 @@ void CFX_FontCache::ReleaseCachedFace(const CFX_Font* pFont) {
     map.erase(it);
   }
 }
+
+void CFX_FontCache::SetEmbeddedFaceCacheLimit(uint32_t nMaxBytes) {
+  CFX_AutoLock lock(&m_Lock);
+  m_nMaxEmbeddedBytes = nMaxBytes;
+  TrimEmbeddedFacesLocked(0);
+}
+
+CFX_FontCache::EmbeddedFaceStats CFX_FontCache::GetEmbeddedFaceStats() const {
+  CFX_AutoLock lock(&m_Lock);
+  EmbeddedFaceStats stats;
+  stats.nHits = m_nEmbeddedHits;
+  stats.nMisses = m_nEmbeddedMisses;
+  stats.nEvictions = m_nEmbeddedEvictions;
+  stats.nFaces = m_EmbeddedFaces.size();
+  stats.nBytes = m_nEmbeddedBytes;
+  stats.nMaxBytes = m_nMaxEmbeddedBytes;
+  return stats;
+}
+
+FXFT_Face CFX_FontCache::GetEmbeddedFace(const uint8_t* pData,
+                                         uint32_t size,
+                                         uint8_t** ppFontData) {
+  CFX_AutoLock lock(&m_Lock);
+  if (!m_nMaxEmbeddedBytes || !size)
+    return nullptr;
+
+  uint32_t hash = FX_HashCode_GetA(CFX_ByteStringC(pData, size), false);
+  auto range = m_EmbeddedHashIndex.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    EmbeddedFaceList::iterator entry = it->second;
+    if (entry->data.size() != size ||
+        FXSYS_memcmp(entry->data.data(), pData, size) != 0) {
+      continue;
+    }
+    ++m_nEmbeddedHits;
+    ++entry->nRefs;
+    m_EmbeddedFaces.splice(m_EmbeddedFaces.begin(), m_EmbeddedFaces, entry);
+    // Fonts select the charmaps they need on the face as they load, so hand
+    // it out with the charmap it was loaded with.
+    entry->face->charmap = entry->charmap;
+    *ppFontData = entry->data.data();
+    return entry->face;
+  }
+
+  ++m_nEmbeddedMisses;
+  if (!TrimEmbeddedFacesLocked(size))
+    return nullptr;
+
+  std::vector<uint8_t> data(pData, pData + size);
+  FXFT_Face face = CFX_GEModule::Get()->GetFontMgr()->GetFixedFace(
+      data.data(), size, 0);
+  if (!face)
+    return nullptr;
+
+  m_EmbeddedFaces.push_front(
+      {hash, std::move(data), face, FXFT_Get_Face_Charmap(face), 1});
+  m_EmbeddedHashIndex.insert(std::make_pair(hash, m_EmbeddedFaces.begin()));
+  m_EmbeddedFaceIndex[face] = m_EmbeddedFaces.begin();
+  m_nEmbeddedBytes += size;
+  // The face cache stays along with the face, so that its glyphs are there
+  // for the next document that uses the font.
+  GetCachedFaceLocked(face);
+  *ppFontData = m_EmbeddedFaces.front().data.data();
+  return face;
+}
+
+bool CFX_FontCache::ReleaseEmbeddedFace(FXFT_Face face) {
+  CFX_AutoLock lock(&m_Lock);
+  auto it = m_EmbeddedFaceIndex.find(face);
+  if (it == m_EmbeddedFaceIndex.end())
+    return false;
+
+  ASSERT(it->second->nRefs > 0);
+  --it->second->nRefs;
+  TrimEmbeddedFacesLocked(0);
+  return true;
+}
+
+void CFX_FontCache::EraseEmbeddedFaceLocked(EmbeddedFaceList::iterator it) {
+  auto range = m_EmbeddedHashIndex.equal_range(it->hash);
+  for (auto index = range.first; index != range.second; ++index) {
+    if (index->second == it) {
+      m_EmbeddedHashIndex.erase(index);
+      break;
+    }
+  }
+  m_EmbeddedFaceIndex.erase(it->face);
+  m_nEmbeddedBytes -= it->data.size();
+  ReleaseCachedFaceLocked(it->face);
+  FXFT_Done_Face(it->face);
+  m_EmbeddedFaces.erase(it);
+}
+
+bool CFX_FontCache::TrimEmbeddedFacesLocked(uint32_t nReserve) {
+  if (nReserve > m_nMaxEmbeddedBytes)
+    return false;
+
+  auto it = m_EmbeddedFaces.end();
+  while (m_nEmbeddedBytes > m_nMaxEmbeddedBytes - nReserve &&
+         it != m_EmbeddedFaces.begin()) {
+    --it;
+    if (it->nRefs)
+      continue;
+
+    auto next = std::next(it);
+    EraseEmbeddedFaceLocked(it);
+    it = next;
+    ++m_nEmbeddedEvictions;
+  }
+  return m_nEmbeddedBytes <= m_nMaxEmbeddedBytes - nReserve;
+}
@@ -0,0 +1,160 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxge/cfx_fontcache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "core/fxge/cfx_fontmgr.h"
+#include "core/fxge/cfx_gemodule.h"
+#include "core/fxge/fx_freetype.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+struct FontProgram {
+  const uint8_t* pData;
+  uint32_t size;
+};
+
+// The font program of builtin font |index|, standing in for an embedded one.
+FontProgram GetFontProgram(size_t index) {
+  FontProgram program = {nullptr, 0};
+  CFX_GEModule::Get()->GetFontMgr()->GetBuiltinFont(index, &program.pData,
+                                                    &program.size);
+  return program;
+}
+
+}  // namespace
+
+TEST(fxge, EmbeddedFacesOffByDefault) {
+  CFX_FontCache cache;
+  FontProgram program = GetFontProgram(0);
+  ASSERT_TRUE(program.pData);
+  uint8_t* pFontData = nullptr;
+  EXPECT_FALSE(cache.GetEmbeddedFace(program.pData, program.size, &pFontData));
+
+  CFX_FontCache::EmbeddedFaceStats stats = cache.GetEmbeddedFaceStats();
+  EXPECT_EQ(0u, stats.nMisses);
+  EXPECT_EQ(0u, stats.nFaces);
+  EXPECT_EQ(0u, stats.nMaxBytes);
+}
+
+TEST(fxge, EmbeddedFacesShared) {
+  CFX_FontCache cache;
+  cache.SetEmbeddedFaceCacheLimit(1024 * 1024);
+  FontProgram program = GetFontProgram(0);
+  ASSERT_TRUE(program.pData);
+
+  uint8_t* pFontData1 = nullptr;
+  FXFT_Face face1 =
+      cache.GetEmbeddedFace(program.pData, program.size, &pFontData1);
+  ASSERT_TRUE(face1);
+  EXPECT_NE(program.pData, pFontData1);
+
+  // The same program, as embedded in another document.
+  std::vector<uint8_t> copy(program.pData, program.pData + program.size);
+  uint8_t* pFontData2 = nullptr;
+  EXPECT_EQ(face1,
+            cache.GetEmbeddedFace(copy.data(), copy.size(), &pFontData2));
+  EXPECT_EQ(pFontData1, pFontData2);
+
+  // A program that differs in a single byte is not the same.
+  copy.back() ^= 1;
+  uint8_t* pFontData3 = nullptr;
+  FXFT_Face face3 =
+      cache.GetEmbeddedFace(copy.data(), copy.size(), &pFontData3);
+  EXPECT_NE(face1, face3);
+
+  CFX_FontCache::EmbeddedFaceStats stats = cache.GetEmbeddedFaceStats();
+  EXPECT_EQ(1u, stats.nHits);
+  EXPECT_EQ(2u, stats.nMisses);
+  EXPECT_EQ(face3 ? 2u : 1u, stats.nFaces);
+
+  // Faces stay once released, for the next document to use.
+  EXPECT_TRUE(cache.ReleaseEmbeddedFace(face1));
+  EXPECT_TRUE(cache.ReleaseEmbeddedFace(face1));
+  if (face3)
+    EXPECT_TRUE(cache.ReleaseEmbeddedFace(face3));
+  EXPECT_FALSE(cache.ReleaseEmbeddedFace(nullptr));
+  stats = cache.GetEmbeddedFaceStats();
+  EXPECT_EQ(0u, stats.nEvictions);
+  EXPECT_EQ(face3 ? 2u : 1u, stats.nFaces);
+  EXPECT_EQ(face1,
+            cache.GetEmbeddedFace(program.pData, program.size, &pFontData1));
+  EXPECT_TRUE(cache.ReleaseEmbeddedFace(face1));
+
+  // Turning the cache off releases them.
+  cache.SetEmbeddedFaceCacheLimit(0);
+  stats = cache.GetEmbeddedFaceStats();
+  EXPECT_EQ(face3 ? 2u : 1u, stats.nEvictions);
+  EXPECT_EQ(0u, stats.nFaces);
+  EXPECT_EQ(0u, stats.nBytes);
+}
+
+TEST(fxge, EmbeddedFacesEviction) {
+  CFX_FontCache cache;
+  FontProgram programs[] = {GetFontProgram(0), GetFontProgram(1),
+                            GetFontProgram(2)};
+  uint32_t nMaxBytes = 0;
+  for (const FontProgram& program : programs) {
+    ASSERT_TRUE(program.pData);
+    nMaxBytes = std::max(nMaxBytes, program.size);
+  }
+  // Room for a single face.
+  cache.SetEmbeddedFaceCacheLimit(nMaxBytes);
+
+  uint8_t* pFontData = nullptr;
+  FXFT_Face face0 =
+      cache.GetEmbeddedFace(programs[0].pData, programs[0].size, &pFontData);
+  ASSERT_TRUE(face0);
+
+  // Faces in use are never evicted; programs that do not fit next to them
+  // are left for the caller to load on its own.
+  EXPECT_FALSE(
+      cache.GetEmbeddedFace(programs[1].pData, programs[1].size, &pFontData));
+  CFX_FontCache::EmbeddedFaceStats stats = cache.GetEmbeddedFaceStats();
+  EXPECT_EQ(0u, stats.nEvictions);
+  EXPECT_EQ(1u, stats.nFaces);
+  EXPECT_EQ(programs[0].size, stats.nBytes);
+
+  // Once released, the face makes room for the next one.
+  EXPECT_TRUE(cache.ReleaseEmbeddedFace(face0));
+  FXFT_Face face1 =
+      cache.GetEmbeddedFace(programs[1].pData, programs[1].size, &pFontData);
+  ASSERT_TRUE(face1);
+  stats = cache.GetEmbeddedFaceStats();
+  EXPECT_EQ(1u, stats.nEvictions);
+  EXPECT_EQ(1u, stats.nFaces);
+  EXPECT_EQ(programs[1].size, stats.nBytes);
+  EXPECT_TRUE(cache.ReleaseEmbeddedFace(face1));
+}
+
+TEST(fxge, EmbeddedFacesResetCharmap) {
+  CFX_FontCache cache;
+  cache.SetEmbeddedFaceCacheLimit(1024 * 1024);
+  FontProgram program = GetFontProgram(0);
+  ASSERT_TRUE(program.pData);
+
+  uint8_t* pFontData = nullptr;
+  FXFT_Face face =
+      cache.GetEmbeddedFace(program.pData, program.size, &pFontData);
+  ASSERT_TRUE(face);
+  ASSERT_LT(1, FXFT_Get_Face_CharmapCount(face));
+  FXFT_CharMap loaded = FXFT_Get_Face_Charmap(face);
+
+  // Another font selects a charmap of its own on the shared face.
+  FXFT_CharMap other = FXFT_Get_Face_Charmaps(face)[0] == loaded
+                           ? FXFT_Get_Face_Charmaps(face)[1]
+                           : FXFT_Get_Face_Charmaps(face)[0];
+  EXPECT_EQ(0, FXFT_Set_Charmap(face, other));
+
+  // The next one gets the face as it was loaded.
+  EXPECT_EQ(face, cache.GetEmbeddedFace(program.pData, program.size,
+                                        &pFontData));
+  EXPECT_EQ(loaded, FXFT_Get_Face_Charmap(face));
+  EXPECT_TRUE(cache.ReleaseEmbeddedFace(face));
+  EXPECT_TRUE(cache.ReleaseEmbeddedFace(face));
+}
@@ -8,8 +8,8 @@
 
 #include "core/fxge/cfx_fontcache.h"
 #include "core/fxge/cfx_fontmgr.h"
+#include "core/fxge/fx_font.h"
 #include "core/fxge/ge/cfx_folderfontinfo.h"
-#include "core/fxge/ge/fx_text_int.h"
 
 namespace {
 
@@ -51,6 +51,10 @@ void CFX_GEModule::Init(const char** userFontPaths,
   m_pUserFontPaths = userFontPaths;
   InitPlatform();
   SetTextGamma(2.2f);
+
+  // Create the font cache up front so that GetFontCache() never has to
+  // allocate it while pages are being rendered from several threads.
+  GetFontCache();
 }
 
 CFX_FontCache* CFX_GEModule::GetFontCache() {
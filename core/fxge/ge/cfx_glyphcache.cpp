@@ -0,0 +1,167 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxge/cfx_glyphcache.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "core/fxcrt/fx_safe_types.h"
+
+namespace {
+
+// The memory taken by a cache entry for |pGlyph|, or 0 if it does not fit
+// in 32 bits. Failed glyphs are cached too, and take some memory as well.
+uint32_t GetEntrySize(const CFX_GlyphBitmap* pGlyph) {
+  FX_SAFE_UINT32 size = 128;
+  if (pGlyph) {
+    FX_SAFE_UINT32 bitmap_size = pGlyph->m_Bitmap.GetPitch();
+    bitmap_size *= pGlyph->m_Bitmap.GetHeight();
+    if (!bitmap_size.IsValid())
+      return 0;
+    size += sizeof(CFX_GlyphBitmap);
+    size += bitmap_size.ValueOrDie();
+  }
+  return size.ValueOrDefault(0);
+}
+
+}  // namespace
+
+bool CFX_GlyphCache::Key::operator==(const Key& that) const {
+  return pFace == that.pFace && glyph_index == that.glyph_index &&
+         matrix[0] == that.matrix[0] && matrix[1] == that.matrix[1] &&
+         matrix[2] == that.matrix[2] && matrix[3] == that.matrix[3] &&
+         dest_width == that.dest_width && anti_alias == that.anti_alias &&
+         weight == that.weight && italic_angle == that.italic_angle &&
+         flags == that.flags;
+}
+
+size_t CFX_GlyphCache::KeyHash::operator()(const Key& key) const {
+  size_t hash = reinterpret_cast<uintptr_t>(key.pFace);
+  for (uint32_t value :
+       {key.glyph_index, static_cast<uint32_t>(key.matrix[0]),
+        static_cast<uint32_t>(key.matrix[1]),
+        static_cast<uint32_t>(key.matrix[2]),
+        static_cast<uint32_t>(key.matrix[3]),
+        static_cast<uint32_t>(key.dest_width),
+        static_cast<uint32_t>(key.anti_alias),
+        static_cast<uint32_t>(key.weight),
+        static_cast<uint32_t>(key.italic_angle), key.flags}) {
+    hash = hash * 31 + value;
+  }
+  return hash;
+}
+
+CFX_GlyphCache::CFX_GlyphCache()
+    : m_nBytes(0),
+      m_nMaxBytes(kDefaultMaxBytes),
+      m_nHits(0),
+      m_nMisses(0),
+      m_nEvictions(0) {}
+
+CFX_GlyphCache::~CFX_GlyphCache() {}
+
+void CFX_GlyphCache::SetMaxBytes(uint32_t nMaxBytes) {
+  CFX_AutoLock lock(&m_Lock);
+  m_nMaxBytes = nMaxBytes;
+  TrimLocked(0);
+}
+
+CFX_GlyphCache::Stats CFX_GlyphCache::GetStats() const {
+  CFX_AutoLock lock(&m_Lock);
+  Stats stats;
+  stats.nHits = m_nHits;
+  stats.nMisses = m_nMisses;
+  stats.nEvictions = m_nEvictions;
+  stats.nGlyphs = m_Index.size();
+  stats.nBytes = m_nBytes;
+  stats.nMaxBytes = m_nMaxBytes;
+  return stats;
+}
+
+bool CFX_GlyphCache::Lookup(const Key& key, const CFX_GlyphBitmap** ppGlyph) {
+  CFX_AutoLock lock(&m_Lock);
+  auto it = m_Index.find(key);
+  if (it == m_Index.end()) {
+    ++m_nMisses;
+    return false;
+  }
+  ++m_nHits;
+  m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+  *ppGlyph = it->second->pGlyph.get();
+  PinLocked(*ppGlyph);
+  return true;
+}
+
+const CFX_GlyphBitmap* CFX_GlyphCache::Put(
+    const Key& key,
+    std::unique_ptr<CFX_GlyphBitmap> pGlyph) {
+  CFX_AutoLock lock(&m_Lock);
+  auto it = m_Index.find(key);
+  if (it != m_Index.end()) {
+    m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+    PinLocked(it->second->pGlyph.get());
+    return it->second->pGlyph.get();
+  }
+
+  // A glyph larger than the budget is cached all the same, as it has to
+  // stay around while pinned.
+  uint32_t nBytes = GetEntrySize(pGlyph.get());
+  TrimLocked(std::min(nBytes, m_nMaxBytes));
+  const CFX_GlyphBitmap* pResult = pGlyph.get();
+  m_Entries.push_front({key, std::move(pGlyph), nBytes});
+  m_Index[key] = m_Entries.begin();
+  m_nBytes += nBytes;
+  PinLocked(pResult);
+  return pResult;
+}
+
+void CFX_GlyphCache::Unpin(const std::vector<FXTEXT_GLYPHPOS>& glyphs) {
+  CFX_AutoLock lock(&m_Lock);
+  for (const FXTEXT_GLYPHPOS& glyph : glyphs) {
+    auto it = m_Pins.find(glyph.m_pGlyph);
+    if (it != m_Pins.end() && --it->second == 0)
+      m_Pins.erase(it);
+  }
+  TrimLocked(0);
+}
+
+void CFX_GlyphCache::RemoveFace(const void* pFace) {
+  CFX_AutoLock lock(&m_Lock);
+  auto it = m_Entries.begin();
+  while (it != m_Entries.end()) {
+    if (it->key.pFace == pFace) {
+      ASSERT(!m_Pins.count(it->pGlyph.get()));
+      m_Pins.erase(it->pGlyph.get());
+      it = EraseLocked(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void CFX_GlyphCache::PinLocked(const CFX_GlyphBitmap* pGlyph) {
+  if (pGlyph)
+    ++m_Pins[pGlyph];
+}
+
+CFX_GlyphCache::EntryList::iterator CFX_GlyphCache::EraseLocked(
+    EntryList::iterator it) {
+  m_nBytes -= it->nBytes;
+  m_Index.erase(it->key);
+  return m_Entries.erase(it);
+}
+
+void CFX_GlyphCache::TrimLocked(uint32_t nReserve) {
+  auto it = m_Entries.end();
+  while (m_nBytes > m_nMaxBytes - nReserve && it != m_Entries.begin()) {
+    --it;
+    if (m_Pins.count(it->pGlyph.get()))
+      continue;
+
+    it = EraseLocked(it);
+    ++m_nEvictions;
+  }
+}
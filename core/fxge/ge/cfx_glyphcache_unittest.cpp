@@ -0,0 +1,165 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxge/cfx_glyphcache.h"
+
+#include <memory>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+// Stand-ins for the faces the glyphs belong to.
+const int kFaceA = 1;
+const int kFaceB = 2;
+
+CFX_GlyphCache::Key MakeKey(const void* pFace, uint32_t glyph_index) {
+  CFX_GlyphCache::Key key;
+  key.pFace = pFace;
+  key.glyph_index = glyph_index;
+  key.matrix[0] = 10000;
+  key.matrix[1] = 0;
+  key.matrix[2] = 0;
+  key.matrix[3] = 10000;
+  key.dest_width = 0;
+  key.anti_alias = 1;
+  key.weight = 0;
+  key.italic_angle = 0;
+  key.flags = 0;
+  return key;
+}
+
+// A glyph of 32x|height| 8 bpp pixels.
+std::unique_ptr<CFX_GlyphBitmap> MakeGlyph(int height) {
+  auto pGlyph = pdfium::MakeUnique<CFX_GlyphBitmap>();
+  pGlyph->m_Top = height;
+  pGlyph->m_Left = 0;
+  pGlyph->m_Bitmap.Create(32, height, FXDIB_8bppMask);
+  return pGlyph;
+}
+
+uint32_t GlyphSize(int height) {
+  return 128 + sizeof(CFX_GlyphBitmap) + 32 * height;
+}
+
+// Unpins |pGlyph| as the text renderer does.
+void Unpin(CFX_GlyphCache* pCache, const CFX_GlyphBitmap* pGlyph) {
+  std::vector<FXTEXT_GLYPHPOS> glyphs(1);
+  glyphs[0].m_pGlyph = pGlyph;
+  pCache->Unpin(glyphs);
+}
+
+}  // namespace
+
+TEST(fxge, GlyphCacheLookup) {
+  CFX_GlyphCache cache;
+  const CFX_GlyphBitmap* pGlyph = nullptr;
+  EXPECT_FALSE(cache.Lookup(MakeKey(&kFaceA, 5), &pGlyph));
+  const CFX_GlyphBitmap* pPut = cache.Put(MakeKey(&kFaceA, 5), MakeGlyph(10));
+  ASSERT_TRUE(pPut);
+  EXPECT_EQ(10, pPut->m_Top);
+  EXPECT_EQ(nullptr, cache.Put(MakeKey(&kFaceA, 6), nullptr));
+
+  ASSERT_TRUE(cache.Lookup(MakeKey(&kFaceA, 5), &pGlyph));
+  EXPECT_EQ(pPut, pGlyph);
+  ASSERT_TRUE(cache.Lookup(MakeKey(&kFaceA, 6), &pGlyph));
+  EXPECT_EQ(nullptr, pGlyph);
+  EXPECT_FALSE(cache.Lookup(MakeKey(&kFaceB, 5), &pGlyph));
+  CFX_GlyphCache::Key other_size = MakeKey(&kFaceA, 5);
+  other_size.matrix[3] = 20000;
+  EXPECT_FALSE(cache.Lookup(other_size, &pGlyph));
+
+  // Storing a glyph cached already keeps the cached one.
+  EXPECT_EQ(pPut, cache.Put(MakeKey(&kFaceA, 5), MakeGlyph(20)));
+
+  CFX_GlyphCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(2u, stats.nHits);
+  EXPECT_EQ(3u, stats.nMisses);
+  EXPECT_EQ(0u, stats.nEvictions);
+  EXPECT_EQ(2u, stats.nGlyphs);
+  EXPECT_EQ(GlyphSize(10) + 128, stats.nBytes);
+  EXPECT_EQ(32u * 1024 * 1024, stats.nMaxBytes);
+}
+
+TEST(fxge, GlyphCacheEviction) {
+  CFX_GlyphCache cache;
+  cache.SetMaxBytes(3 * GlyphSize(10));
+  const CFX_GlyphBitmap* pGlyphs[4];
+  for (uint32_t i = 0; i < 3; ++i) {
+    pGlyphs[i] = cache.Put(MakeKey(&kFaceA, i), MakeGlyph(10));
+    Unpin(&cache, pGlyphs[i]);
+  }
+  EXPECT_EQ(0u, cache.GetStats().nEvictions);
+
+  // Glyph 0 is used again, so glyph 1 is the least recently used.
+  const CFX_GlyphBitmap* pGlyph = nullptr;
+  ASSERT_TRUE(cache.Lookup(MakeKey(&kFaceA, 0), &pGlyph));
+  Unpin(&cache, pGlyph);
+  pGlyphs[3] = cache.Put(MakeKey(&kFaceB, 3), MakeGlyph(10));
+  Unpin(&cache, pGlyphs[3]);
+  EXPECT_FALSE(cache.Lookup(MakeKey(&kFaceA, 1), &pGlyph));
+  for (uint32_t i : {0, 2}) {
+    ASSERT_TRUE(cache.Lookup(MakeKey(&kFaceA, i), &pGlyph));
+    Unpin(&cache, pGlyph);
+  }
+  CFX_GlyphCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(1u, stats.nEvictions);
+  EXPECT_EQ(3u, stats.nGlyphs);
+  EXPECT_EQ(3 * GlyphSize(10), stats.nBytes);
+
+  // Shrinking the budget evicts right away.
+  cache.SetMaxBytes(GlyphSize(10));
+  stats = cache.GetStats();
+  EXPECT_EQ(3u, stats.nEvictions);
+  EXPECT_EQ(1u, stats.nGlyphs);
+  EXPECT_TRUE(cache.Lookup(MakeKey(&kFaceA, 2), &pGlyph));
+}
+
+TEST(fxge, GlyphCachePinnedGlyphsStay) {
+  CFX_GlyphCache cache;
+  cache.SetMaxBytes(2 * GlyphSize(10));
+  std::vector<FXTEXT_GLYPHPOS> glyphs(4);
+  for (uint32_t i = 0; i < 3; ++i)
+    glyphs[i].m_pGlyph = cache.Put(MakeKey(&kFaceA, i), MakeGlyph(10));
+  // The same glyph twice, as for repeated chars.
+  const CFX_GlyphBitmap* pGlyph = nullptr;
+  ASSERT_TRUE(cache.Lookup(MakeKey(&kFaceA, 2), &pGlyph));
+  glyphs[3].m_pGlyph = pGlyph;
+
+  // All are in use, so none is evicted even though they do not fit.
+  CFX_GlyphCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(0u, stats.nEvictions);
+  EXPECT_EQ(3u, stats.nGlyphs);
+  EXPECT_EQ(3 * GlyphSize(10), stats.nBytes);
+  for (const FXTEXT_GLYPHPOS& glyph : glyphs)
+    EXPECT_EQ(10, glyph.m_pGlyph->m_Bitmap.GetHeight());
+
+  // Once unpinned, the cache goes back within its budget.
+  cache.Unpin(glyphs);
+  stats = cache.GetStats();
+  EXPECT_EQ(1u, stats.nEvictions);
+  EXPECT_EQ(2u, stats.nGlyphs);
+  EXPECT_EQ(2 * GlyphSize(10), stats.nBytes);
+  EXPECT_FALSE(cache.Lookup(MakeKey(&kFaceA, 0), &pGlyph));
+}
+
+TEST(fxge, GlyphCacheRemoveFace) {
+  CFX_GlyphCache cache;
+  for (uint32_t i = 0; i < 3; ++i) {
+    Unpin(&cache, cache.Put(MakeKey(&kFaceA, i), MakeGlyph(10)));
+    Unpin(&cache, cache.Put(MakeKey(&kFaceB, i), MakeGlyph(20)));
+  }
+  cache.RemoveFace(&kFaceA);
+
+  CFX_GlyphCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(0u, stats.nEvictions);
+  EXPECT_EQ(3u, stats.nGlyphs);
+  EXPECT_EQ(3 * GlyphSize(20), stats.nBytes);
+  const CFX_GlyphBitmap* pGlyph = nullptr;
+  EXPECT_FALSE(cache.Lookup(MakeKey(&kFaceA, 1), &pGlyph));
+  ASSERT_TRUE(cache.Lookup(MakeKey(&kFaceB, 1), &pGlyph));
+  EXPECT_EQ(20, pGlyph->m_Top);
+}
@@ -13,7 +13,10 @@
 
 #include "core/fxcrt/fx_safe_types.h"
 #include "core/fxge/cfx_facecache.h"
+#include "core/fxge/cfx_fontcache.h"
 #include "core/fxge/cfx_fxgedevice.h"
+#include "core/fxge/cfx_gemodule.h"
+#include "core/fxge/cfx_glyphcache.h"
 #include "core/fxge/cfx_graphstatedata.h"
 #include "core/fxge/cfx_pathdata.h"
 #include "core/fxge/ifx_renderdevicedriver.h"
@@ -50,6 +53,20 @@ void AdjustGlyphSpace(std::vector<FXTEXT_GLYPHPOS>* pGlyphAndPos) {
   }
 }
 
+// The glyph cache hands out glyphs pinned. Unpins those of a text object
+// once it is drawn, so that the cache may evict them again.
+class ScopedGlyphPins {
+ public:
+  explicit ScopedGlyphPins(const std::vector<FXTEXT_GLYPHPOS>* pGlyphs)
+      : m_pGlyphs(pGlyphs) {}
+  ~ScopedGlyphPins() {
+    CFX_GEModule::Get()->GetFontCache()->GetGlyphCache()->Unpin(*m_pGlyphs);
+  }
+
+ private:
+  const std::vector<FXTEXT_GLYPHPOS>* const m_pGlyphs;
+};
+
 const uint8_t g_TextGammaAdjust[256] = {
     0,   2,   3,   4,   6,   7,   8,   10,  11,  12,  13,  15,  16,  17,  18,
     19,  21,  22,  23,  24,  25,  26,  27,  29,  30,  31,  32,  33,  34,  35,
@@ -898,6 +915,7 @@ bool CFX_RenderDevice::DrawNormalText(int nChars,
     }
   }
   std::vector<FXTEXT_GLYPHPOS> glyphs(nChars);
+  ScopedGlyphPins pins(&glyphs);
   CFX_Matrix matrixCTM = GetCTM();
   FX_FLOAT scale_x = FXSYS_fabs(matrixCTM.a);
   FX_FLOAT scale_y = FXSYS_fabs(matrixCTM.d);
@@ -64,6 +64,12 @@ int IFX_SystemFontInfo::GetFaceIndex(void* hFont) {
   return 0;
 }
 
+void IFX_SystemFontInfo::SetFontIndexPath(const CFX_ByteString& path) {}
+
+bool IFX_SystemFontInfo::SaveFontIndex(const CFX_ByteString& path) {
+  return false;
+}
+
 extern "C" {
 unsigned long _FTStreamRead(FXFT_Stream stream,
                             unsigned long offset,
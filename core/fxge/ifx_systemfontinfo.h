@@ -46,6 +46,14 @@ class IFX_SystemFontInfo {
   virtual bool GetFontCharset(void* hFont, int& charset) = 0;
   virtual int GetFaceIndex(void* hFont);
   virtual void DeleteFont(void* hFont) = 0;
+
+  // Font infos that look for font files themselves keep what they find at
+  // |path|, and load it from there rather than read every file again. Others
+  // ignore it.
+  virtual void SetFontIndexPath(const CFX_ByteString& path);
+  // Writes the fonts EnumFontList() found to |path|, for SetFontIndexPath().
+  // Returns false if that is not supported, or on failure.
+  virtual bool SaveFontIndex(const CFX_ByteString& path);
 };
 
 #endif  // CORE_FXGE_IFX_SYSTEMFONTINFO_H_
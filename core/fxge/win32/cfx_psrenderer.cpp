@@ -14,7 +14,7 @@
 #include "core/fxge/cfx_fontcache.h"
 #include "core/fxge/cfx_pathdata.h"
 #include "core/fxge/cfx_renderdevice.h"
-#include "core/fxge/ge/fx_text_int.h"
+#include "core/fxge/fx_font.h"
 #include "core/fxge/win32/cpsoutput.h"
 
 struct PSGlyph {
@@ -201,3 +201,15 @@ DLLEXPORT void FPDF_FreeDefaultSystemFontInfo(
     FPDF_SYSFONTINFO* pDefaultFontInfo) {
   FX_Free(static_cast<FPDF_SYSFONTINFO_DEFAULT*>(pDefaultFontInfo));
 }
+
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_BuildSystemFontIndex(FPDF_BYTESTRING index_path) {
+  if (!index_path || !*index_path)
+    return false;
+
+  CFX_FontMapper* pMapper =
+      CFX_GEModule::Get()->GetFontMgr()->GetBuiltinMapper();
+  pMapper->LoadInstalledFonts();
+  IFX_SystemFontInfo* pFontInfo = pMapper->GetSystemFontInfo();
+  return pFontInfo && pFontInfo->SaveFontIndex(index_path);
+}
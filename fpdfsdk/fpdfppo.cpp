@@ -261,18 +261,20 @@ bool CPDF_PageOrganizer::UpdateReference(CPDF_Object* pObj,
     }
     case CPDF_Object::DICTIONARY: {
       CPDF_Dictionary* pDict = pObj->AsDictionary();
-      auto it = pDict->begin();
-      while (it != pDict->end()) {
-        const CFX_ByteString& key = it->first;
-        CPDF_Object* pNextObj = it->second.get();
-        ++it;
+      std::vector<CFX_ByteString> bad_keys;
+      for (const auto& it : *pDict) {
+        const CFX_ByteString& key = it.first;
         if (key == "Parent" || key == "Prev" || key == "First")
           continue;
+        CPDF_Object* pNextObj = it.second.get();
         if (!pNextObj)
           return false;
         if (!UpdateReference(pNextObj, pObjNumberMap))
-          pDict->RemoveFor(key);
+          bad_keys.push_back(key);
       }
+      // Removing entries invalidates the dictionary's iterators.
+      for (const auto& key : bad_keys)
+        pDict->RemoveFor(key);
       break;
     }
     case CPDF_Object::ARRAY: {
@@ -283,12 +283,24 @@ bool FPDF_Doc_Save(FPDF_DOCUMENT document,
   SendPreSaveToXFADoc(pContext, &fileList);
 #endif  // PDF_ENABLE_XFA
 
+  uint32_t options = 0;
+  if (flags & FPDF_PARALLEL_COMPRESSION)
+    options |= FPDFCREATE_PARALLEL_COMPRESS;
+  if (flags & FPDF_OBJECT_STREAMS)
+    options |= FPDFCREATE_OBJECTSTREAM;
+  int level = static_cast<int>((flags >> 12) & 0xF) - 1;
+  int32_t object_stream_size = static_cast<int32_t>((flags >> 16) & 0xFFFF);
+  flags &= 0xFF;
   if (flags < FPDF_INCREMENTAL || flags > FPDF_REMOVE_SECURITY)
     flags = 0;
 
   CPDF_Creator FileMaker(pPDFDoc);
   if (bSetVersion)
     FileMaker.SetFileVersion(fileVerion);
+  if (level >= 0)
+    FileMaker.SetCompressionLevel(level);
+  if (object_stream_size)
+    FileMaker.SetObjectStreamSize(object_stream_size);
   if (flags == FPDF_REMOVE_SECURITY) {
     flags = 0;
     FileMaker.RemoveSecurity();
@@ -296,7 +308,7 @@ bool FPDF_Doc_Save(FPDF_DOCUMENT document,
 
   CFX_RetainPtr<CFX_IFileWrite> pStreamWrite = CFX_IFileWrite::Create();
   pStreamWrite->Init(pFileWrite);
-  bool bRet = FileMaker.Create(pStreamWrite, flags);
+  bool bRet = FileMaker.Create(pStreamWrite, flags | options);
 #ifdef PDF_ENABLE_XFA
   SendPostSaveToXFADoc(pContext);
 #endif  // PDF_ENABLE_XFA
@@ -4,8 +4,14 @@
 
 #include "public/fpdf_save.h"
 
+#include <stdio.h>
 #include <string.h>
 
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "core/fxcrt/cfx_threadpool.h"
 #include "core/fxcrt/fx_string.h"
 #include "public/fpdf_edit.h"
 #include "public/fpdf_ppo.h"
@@ -15,6 +21,19 @@
 #include "testing/gmock/include/gmock/gmock-matchers.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/test_support.h"
+#include "testing/utils/path_service.h"
+
+namespace {
+
+class ScopedThreadPool {
+ public:
+  explicit ScopedThreadPool(size_t nThreads) {
+    CFX_ThreadPool::Create(nThreads);
+  }
+  ~ScopedThreadPool() { CFX_ThreadPool::Destroy(); }
+};
+
+}  // namespace
 
 class FPDFSaveEmbedderTest : public EmbedderTest, public TestSaver {};
 
@@ -68,3 +87,169 @@ TEST_F(FPDFSaveEmbedderTest, BUG_342) {
   EXPECT_THAT(GetString(),
               testing::Not(testing::HasSubstr("0000000000 65536 f\r\n")));
 }
+
+TEST_F(FPDFSaveEmbedderTest, SaveWithCompressionOptions) {
+  EXPECT_TRUE(OpenDocument("bookmarks.pdf"));
+  // Loading the pages parses their content streams, which have no filters,
+  // so saving Flate encodes them.
+  FPDF_PAGE page0 = LoadPage(0);
+  FPDF_PAGE page1 = LoadPage(1);
+  ASSERT_TRUE(page0);
+  ASSERT_TRUE(page1);
+
+  EXPECT_TRUE(FPDF_SaveAsCopy(document(), this, 0));
+  std::string expected = GetString();
+  EXPECT_THAT(expected, testing::Not(testing::HasSubstr("(Page1)Tj")));
+
+  // Level 0 stores the data as is, within a zlib stream.
+  ClearString();
+  EXPECT_TRUE(FPDF_SaveAsCopy(document(), this, FPDF_COMPRESSION_LEVEL(0)));
+  std::string stored = GetString();
+  EXPECT_THAT(stored, testing::HasSubstr("(Page1)Tj"));
+  EXPECT_THAT(stored, testing::HasSubstr("(Page2)Tj"));
+
+  ClearString();
+  EXPECT_TRUE(FPDF_SaveAsCopy(document(), this, FPDF_COMPRESSION_LEVEL(6)));
+  EXPECT_EQ(expected, GetString());
+
+  // Compressing on worker threads gives the same bytes.
+  {
+    ScopedThreadPool pool(2);
+    ClearString();
+    EXPECT_TRUE(FPDF_SaveAsCopy(document(), this, FPDF_PARALLEL_COMPRESSION));
+    EXPECT_EQ(expected, GetString());
+
+    ClearString();
+    EXPECT_TRUE(FPDF_SaveAsCopy(
+        document(), this,
+        FPDF_PARALLEL_COMPRESSION | FPDF_COMPRESSION_LEVEL(0)));
+    EXPECT_EQ(stored, GetString());
+  }
+
+  UnloadPage(page1);
+  UnloadPage(page0);
+}
+
+TEST_F(FPDFSaveEmbedderTest, SaveWithObjectStreams) {
+  EXPECT_TRUE(OpenDocument("bookmarks.pdf"));
+  EXPECT_TRUE(FPDF_SaveAsCopy(document(), this, 0));
+  size_t classic_size = GetString().length();
+
+  ClearString();
+  EXPECT_TRUE(FPDF_SaveAsCopy(document(), this, FPDF_OBJECT_STREAMS));
+  std::string saved = GetString();
+  EXPECT_THAT(saved, testing::StartsWith("%PDF-1.7\r\n"));
+  EXPECT_THAT(saved, testing::HasSubstr("/Type /ObjStm"));
+  EXPECT_THAT(saved, testing::HasSubstr("/Type /XRef"));
+  EXPECT_THAT(saved, testing::Not(testing::HasSubstr("trailer")));
+  EXPECT_LT(saved.length(), classic_size);
+
+  FPDF_DOCUMENT saved_doc =
+      FPDF_LoadMemDocument(saved.c_str(), saved.length(), nullptr);
+  ASSERT_TRUE(saved_doc);
+  EXPECT_EQ(2, FPDF_GetPageCount(saved_doc));
+  FPDF_PAGE page = FPDF_LoadPage(saved_doc, 1);
+  EXPECT_TRUE(page);
+  FPDF_ClosePage(page);
+  FPDF_CloseDocument(saved_doc);
+
+  // One object per object stream.
+  ClearString();
+  EXPECT_TRUE(FPDF_SaveAsCopy(document(), this, FPDF_OBJECT_STREAM_SIZE(1)));
+  saved = GetString();
+  size_t count = 0;
+  for (size_t pos = saved.find("/Type /ObjStm /N 1/"); pos != std::string::npos;
+       pos = saved.find("/Type /ObjStm /N 1/", pos + 1)) {
+    ++count;
+  }
+  EXPECT_LT(1u, count);
+  EXPECT_EQ(std::string::npos, saved.find("/Type /ObjStm /N 2"));
+  saved_doc = FPDF_LoadMemDocument(saved.c_str(), saved.length(), nullptr);
+  ASSERT_TRUE(saved_doc);
+  EXPECT_EQ(2, FPDF_GetPageCount(saved_doc));
+  FPDF_CloseDocument(saved_doc);
+
+  // Sizes above 32767 do not overflow into the other flags, and every object
+  // fits in a single object stream.
+  ClearString();
+  EXPECT_TRUE(
+      FPDF_SaveAsCopy(document(), this, FPDF_OBJECT_STREAM_SIZE(40000)));
+  saved = GetString();
+  size_t first = saved.find("/Type /ObjStm");
+  EXPECT_NE(std::string::npos, first);
+  EXPECT_EQ(std::string::npos, saved.find("/Type /ObjStm", first + 1));
+  EXPECT_EQ(std::string::npos, saved.find("trailer"));
+  saved_doc = FPDF_LoadMemDocument(saved.c_str(), saved.length(), nullptr);
+  ASSERT_TRUE(saved_doc);
+  EXPECT_EQ(2, FPDF_GetPageCount(saved_doc));
+  FPDF_CloseDocument(saved_doc);
+}
+
+TEST_F(FPDFSaveEmbedderTest, SaveWithObjectStreamsRaisesVersion) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  EXPECT_TRUE(FPDF_SaveWithVersion(document(), this, FPDF_OBJECT_STREAMS, 14));
+  EXPECT_THAT(GetString(), testing::StartsWith("%PDF-1.5\r\n"));
+}
+
+// Compares saving with an xref table against saving with object streams,
+// on files made by importing the pages of a test file many times.
+// Run with --gtest_also_run_disabled_tests.
+TEST_F(FPDFSaveEmbedderTest, DISABLED_Benchmark) {
+  struct Input {
+    const char* name;
+    int copies;
+  };
+  const Input kInputs[] = {{"page_labels.pdf", 300},
+                           {"annotiter.pdf", 500},
+                           {"tagged_alt_text.pdf", 500}};
+  struct Mode {
+    const char* name;
+    FPDF_DWORD flags;
+  };
+  const Mode kModes[] = {{"classic xref", 0},
+                         {"object streams (200)", FPDF_OBJECT_STREAMS},
+                         {"object streams (1000)",
+                          FPDF_OBJECT_STREAM_SIZE(1000)}};
+  for (const Input& input : kInputs) {
+    std::string file_path;
+    ASSERT_TRUE(PathService::GetTestFilePath(input.name, &file_path));
+    size_t file_length = 0;
+    std::unique_ptr<char, pdfium::FreeDeleter> file_contents =
+        GetFileContents(file_path.c_str(), &file_length);
+    ASSERT_TRUE(file_contents);
+    FPDF_DOCUMENT src_doc =
+        FPDF_LoadMemDocument(file_contents.get(), file_length, nullptr);
+    ASSERT_TRUE(src_doc);
+    FPDF_DOCUMENT doc = FPDF_CreateNewDocument();
+    for (int i = 0; i < input.copies; ++i) {
+      ASSERT_TRUE(
+          FPDF_ImportPages(doc, src_doc, nullptr, FPDF_GetPageCount(doc)));
+    }
+    printf("%s x%d (%d pages)\n", input.name, input.copies,
+           FPDF_GetPageCount(doc));
+    // Load it back, so that the objects saved are ones read from a file.
+    ClearString();
+    ASSERT_TRUE(FPDF_SaveAsCopy(doc, this, 0));
+    FPDF_CloseDocument(doc);
+    std::string saved = GetString();
+    doc = FPDF_LoadMemDocument(saved.c_str(), saved.size(), nullptr);
+    ASSERT_TRUE(doc);
+    for (const Mode& mode : kModes) {
+      double best = 0;
+      for (int i = 0; i < 7; ++i) {
+        ClearString();
+        auto start = std::chrono::steady_clock::now();
+        EXPECT_TRUE(FPDF_SaveAsCopy(doc, this, mode.flags));
+        double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+        if (i == 0 || seconds < best)
+          best = seconds;
+      }
+      printf("  %-22s %8zu bytes %6.1f ms\n", mode.name, GetString().size(),
+             best * 1000);
+    }
+    FPDF_CloseDocument(doc);
+    FPDF_CloseDocument(src_doc);
+  }
+}
@@ -7,15 +7,24 @@
 #include "public/fpdf_text.h"
 
 #include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "core/fpdfapi/page/cpdf_page.h"
+#include "core/fpdfapi/parser/cpdf_array.h"
+#include "core/fpdfapi/parser/cpdf_document.h"
+#include "core/fpdfapi/parser/cpdf_parser.h"
 #include "core/fpdfdoc/cpdf_viewerpreferences.h"
 #include "core/fpdftext/cpdf_linkextract.h"
+#include "core/fpdftext/cpdf_textindex.h"
 #include "core/fpdftext/cpdf_textpage.h"
 #include "core/fpdftext/cpdf_textpagefind.h"
+#include "core/fxcrt/cfx_threadpool.h"
 #include "fpdfsdk/fsdk_define.h"
 #include "third_party/base/numerics/safe_conversions.h"
+#include "third_party/base/ptr_util.h"
 #include "third_party/base/stl_util.h"
 
 #ifdef PDF_ENABLE_XFA
@@ -41,8 +50,116 @@ CPDF_LinkExtract* CPDFLinkExtractFromFPDFPageLink(FPDF_PAGELINK link) {
   return static_cast<CPDF_LinkExtract*>(link);
 }
 
+// Once made, the index is kept until the document is closed, so it can be
+// used after the lock is released.
+CPDF_TextIndex* GetTextIndex(CPDF_Document* pDoc) {
+  if (!pDoc)
+    return nullptr;
+
+  CFX_AutoLock lock(pDoc->GetLock());
+  return pDoc->TextIndexContext()->get();
+}
+
+// Identifies the document an index is for by the first element of its /ID,
+// which stays the same when the document is saved again. Files without one
+// are told apart by their size, their last cross-reference section and their
+// number of objects instead. Documents not loaded from a file have no ID.
+CFX_ByteString GetDocumentId(CPDF_Document* pDoc) {
+  CPDF_Parser* pParser = pDoc->GetParser();
+  if (!pParser)
+    return CFX_ByteString();
+
+  CPDF_Array* pIdArray = pParser->GetIDArray();
+  CFX_ByteString id = pIdArray ? pIdArray->GetStringAt(0) : CFX_ByteString();
+  if (!id.IsEmpty())
+    return id;
+
+  CFX_RetainPtr<IFX_SeekableReadStream> pFile = pParser->GetFileAccess();
+  if (!pFile)
+    return CFX_ByteString();
+
+  id.Format("size=%u xref=%u objs=%u", static_cast<uint32_t>(pFile->GetSize()),
+            static_cast<uint32_t>(pParser->GetLastXRefOffset()),
+            pParser->GetLastObjNum());
+  return id;
+}
+
+void AddToTextIndex(const CPDF_TextPage* pTextPage, CPDF_Page* pPage) {
+  CPDF_TextIndex* pIndex = GetTextIndex(pPage->m_pDocument);
+  if (!pIndex || !pPage->m_pFormDict)
+    return;
+
+  int page_index =
+      pPage->m_pDocument->GetPageIndex(pPage->m_pFormDict->GetObjNum());
+  if (page_index >= 0)
+    pIndex->AddPage(page_index, pTextPage);
+}
+
+std::unique_ptr<CPDF_Page> LoadTextOnlyPage(CPDF_Document* pDoc,
+                                            int page_index) {
+  CPDF_Dictionary* pDict = pDoc->GetPage(page_index);
+  if (!pDict)
+    return nullptr;
+
+  auto pPage = pdfium::MakeUnique<CPDF_Page>(pDoc, pDict, true);
+  pPage->SetTextOnly(true);
+  CFX_AutoLock lock(pDoc->GetLock());
+  pPage->ParseContent();
+  return pPage;
+}
+
+// The text of one page extracted by FPDFText_ExtractPages, kept until it is
+// handed to the sink on the calling thread.
+struct ExtractedPage {
+  CFX_ByteString text;  // UTF-16LE, NUL-terminated.
+  std::vector<FS_RECTF> char_boxes;
+  int char_count = 0;
+};
+
+void ExtractPage(CPDF_Document* pDoc,
+                 int page_index,
+                 FPDFText_Direction direction,
+                 bool bCharBoxes,
+                 ExtractedPage* pResult) {
+  std::unique_ptr<CPDF_Page> pPage = LoadTextOnlyPage(pDoc, page_index);
+  if (!pPage)
+    return;
+
+  CPDF_TextPage textpage(pPage.get(), direction);
+  textpage.ParseTextPage();
+  pResult->text = textpage.GetPageText().UTF16LE_Encode();
+  pResult->char_count = textpage.CountChars();
+  if (bCharBoxes) {
+    pResult->char_boxes.resize(pResult->char_count);
+    for (int i = 0; i < pResult->char_count; ++i) {
+      FPDF_CHAR_INFO charinfo;
+      textpage.GetCharInfo(i, &charinfo);
+      FS_RECTF& box = pResult->char_boxes[i];
+      box.left = charinfo.m_CharBox.left;
+      box.top = charinfo.m_CharBox.top;
+      box.right = charinfo.m_CharBox.right;
+      box.bottom = charinfo.m_CharBox.bottom;
+    }
+  }
+  if (CPDF_TextIndex* pIndex = GetTextIndex(pDoc))
+    pIndex->AddPage(page_index, &textpage);
+}
+
 }  // namespace
 
+DLLEXPORT FPDF_PAGE STDCALL FPDFText_LoadTextOnlyPage(FPDF_DOCUMENT document,
+                                                      int page_index) {
+#ifdef PDF_ENABLE_XFA
+  return FPDF_LoadPage(document, page_index);
+#else   // PDF_ENABLE_XFA
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc || page_index < 0 || page_index >= pDoc->GetPageCount())
+    return nullptr;
+
+  return LoadTextOnlyPage(pDoc, page_index).release();
+#endif  // PDF_ENABLE_XFA
+}
+
 DLLEXPORT FPDF_TEXTPAGE STDCALL FPDFText_LoadPage(FPDF_PAGE page) {
   CPDF_Page* pPDFPage = CPDFPageFromFPDFPage(page);
   if (!pPDFPage)
@@ -60,6 +177,7 @@ DLLEXPORT FPDF_TEXTPAGE STDCALL FPDFText_LoadPage(FPDF_PAGE page) {
       pPDFPage, viewRef.IsDirectionR2L() ? FPDFText_Direction::Right
                                          : FPDFText_Direction::Left);
   textpage->ParseTextPage();
+  AddToTextIndex(textpage, pPDFPage);
   return textpage;
 }
 
@@ -274,6 +392,187 @@ DLLEXPORT void STDCALL FPDFText_FindClose(FPDF_SCHHANDLE handle) {
   handle = nullptr;
 }
 
+// Index
+DLLEXPORT FPDF_BOOL STDCALL FPDFText_EnableIndex(FPDF_DOCUMENT document) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc)
+    return false;
+
+  CFX_AutoLock lock(pDoc->GetLock());
+  std::unique_ptr<CPDF_TextIndex>* pHolder = pDoc->TextIndexContext();
+  if (!pHolder->get()) {
+    *pHolder = pdfium::MakeUnique<CPDF_TextIndex>(pDoc->GetPageCount(),
+                                                  GetDocumentId(pDoc));
+  }
+  return true;
+}
+
+DLLEXPORT FPDF_BOOL STDCALL FPDFText_IndexPage(FPDF_DOCUMENT document,
+                                               int page_index) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  CPDF_TextIndex* pIndex = GetTextIndex(pDoc);
+  if (!pIndex || page_index < 0 || page_index >= pIndex->GetPageCount())
+    return false;
+  if (pIndex->IsPageIndexed(page_index))
+    return true;
+
+  std::unique_ptr<CPDF_Page> pPage = LoadTextOnlyPage(pDoc, page_index);
+  if (!pPage)
+    return false;
+
+  CPDF_ViewerPreferences viewRef(pDoc);
+  CPDF_TextPage textpage(pPage.get(), viewRef.IsDirectionR2L()
+                                          ? FPDFText_Direction::Right
+                                          : FPDFText_Direction::Left);
+  textpage.ParseTextPage();
+  pIndex->AddPage(page_index, &textpage);
+  return pIndex->IsPageIndexed(page_index);
+}
+
+DLLEXPORT int STDCALL FPDFText_CountIndexedPages(FPDF_DOCUMENT document) {
+  CPDF_TextIndex* pIndex =
+      GetTextIndex(CPDFDocumentFromFPDFDocument(document));
+  return pIndex ? pIndex->CountIndexedPages() : -1;
+}
+
+DLLEXPORT int STDCALL FPDFText_FindInIndex(FPDF_DOCUMENT document,
+                                           FPDF_WIDESTRING query,
+                                           FPDF_TEXTHIT* hits,
+                                           int max_hits) {
+  CPDF_TextIndex* pIndex =
+      GetTextIndex(CPDFDocumentFromFPDFDocument(document));
+  if (!pIndex)
+    return -1;
+  if (!query)
+    return 0;
+
+  FX_STRSIZE len = CFX_WideString::WStringLength(query);
+  std::vector<CPDF_TextIndex::Hit> found =
+      pIndex->Find(CFX_WideString::FromUTF16LE(query, len).AsStringC());
+  if (hits) {
+    int count = std::min(max_hits, pdfium::CollectionSize<int>(found));
+    for (int i = 0; i < count; ++i) {
+      hits[i].page_index = found[i].page_index;
+      hits[i].char_index = found[i].char_index;
+      hits[i].char_count = found[i].char_count;
+    }
+  }
+  return pdfium::CollectionSize<int>(found);
+}
+
+DLLEXPORT unsigned long STDCALL FPDFText_SaveIndex(FPDF_DOCUMENT document,
+                                                   void* buffer,
+                                                   unsigned long buflen) {
+  CPDF_TextIndex* pIndex =
+      GetTextIndex(CPDFDocumentFromFPDFDocument(document));
+  if (!pIndex)
+    return 0;
+
+  std::vector<uint8_t> data = pIndex->Serialize();
+  if (buffer && data.size() <= buflen)
+    FXSYS_memcpy(buffer, data.data(), data.size());
+  return pdfium::base::checked_cast<unsigned long>(data.size());
+}
+
+DLLEXPORT FPDF_BOOL STDCALL FPDFText_LoadIndex(FPDF_DOCUMENT document,
+                                               const void* data,
+                                               unsigned long size) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc || !data || size > std::numeric_limits<uint32_t>::max())
+    return false;
+
+  // Without an ID there is no telling which document the data was for.
+  CFX_ByteString id = GetDocumentId(pDoc);
+  if (id.IsEmpty())
+    return false;
+
+  // Pages extracted on other threads may be adding to the index, so an
+  // index that exists is loaded into rather than replaced.
+  const uint8_t* pData = static_cast<const uint8_t*>(data);
+  CPDF_TextIndex* pIndex = GetTextIndex(pDoc);
+  if (!pIndex) {
+    auto pNewIndex =
+        pdfium::MakeUnique<CPDF_TextIndex>(pDoc->GetPageCount(), id);
+    if (!pNewIndex->Deserialize(pData, static_cast<uint32_t>(size)))
+      return false;
+
+    CFX_AutoLock lock(pDoc->GetLock());
+    std::unique_ptr<CPDF_TextIndex>* pHolder = pDoc->TextIndexContext();
+    if (!pHolder->get()) {
+      *pHolder = std::move(pNewIndex);
+      return true;
+    }
+    pIndex = pHolder->get();
+  }
+  return pIndex->Deserialize(pData, static_cast<uint32_t>(size));
+}
+
+// Batch extraction
+DLLEXPORT int STDCALL FPDFText_ExtractPages(FPDF_DOCUMENT document,
+                                            int start_index,
+                                            int count,
+                                            int flags,
+                                            FPDF_TEXT_SINK* sink) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc || !sink || sink->version != 1 || !sink->OnPageText ||
+      start_index < 0 || count < 0 ||
+      count > pDoc->GetPageCount() - start_index) {
+    return -1;
+  }
+
+  CPDF_ViewerPreferences viewRef(pDoc);
+  const FPDFText_Direction direction = viewRef.IsDirectionR2L()
+                                           ? FPDFText_Direction::Right
+                                           : FPDFText_Direction::Left;
+  const bool bCharBoxes = !!(flags & FPDF_TEXT_CHARBOXES);
+
+  // Pages are extracted a batch at a time, a few per worker thread, so that
+  // only a bounded number of them is held until the sink takes them. Pages
+  // of one document can only be handled at once in thread-safe mode.
+  CFX_ThreadPool* pPool =
+      CFX_Mutex::IsThreadSafeMode() ? CFX_ThreadPool::Get() : nullptr;
+  const int batch_size =
+      pPool ? 2 * pdfium::base::checked_cast<int>(pPool->GetThreadCount() + 1)
+            : 1;
+  const unsigned short kNoText = 0;
+  int delivered = 0;
+  while (delivered < count) {
+    const int batch_start = start_index + delivered;
+    const int batch_count = std::min(batch_size, count - delivered);
+    std::vector<ExtractedPage> pages(batch_count);
+    auto extract = [pDoc, batch_start, direction, bCharBoxes,
+                    &pages](size_t i) {
+      ExtractPage(pDoc, batch_start + static_cast<int>(i), direction,
+                  bCharBoxes, &pages[i]);
+    };
+    if (pPool) {
+      pPool->ParallelFor(batch_count, extract);
+    } else {
+      for (int i = 0; i < batch_count; ++i)
+        extract(i);
+    }
+
+    for (int i = 0; i < batch_count; ++i) {
+      const ExtractedPage& page = pages[i];
+      FPDF_WIDESTRING text =
+          page.text.IsEmpty()
+              ? &kNoText
+              : reinterpret_cast<FPDF_WIDESTRING>(page.text.c_str());
+      int text_length =
+          page.text.IsEmpty() ? 0 : page.text.GetLength() / 2 - 1;
+      const FS_RECTF* char_boxes =
+          bCharBoxes && !page.char_boxes.empty() ? page.char_boxes.data()
+                                                 : nullptr;
+      ++delivered;
+      if (!sink->OnPageText(sink, batch_start + i, text, text_length,
+                            char_boxes, page.char_count)) {
+        return delivered;
+      }
+    }
+  }
+  return delivered;
+}
+
 // web link
 DLLEXPORT FPDF_PAGELINK STDCALL FPDFLink_LoadWebLinks(FPDF_TEXTPAGE text_page) {
   if (!text_page)
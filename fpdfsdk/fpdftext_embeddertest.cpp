@@ -3,13 +3,19 @@
 // found in the LICENSE file.
 
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "core/fxcrt/cfx_mutex.h"
+#include "core/fxcrt/cfx_threadpool.h"
 #include "core/fxcrt/fx_basic.h"
+#include "public/fpdf_edit.h"
 #include "public/fpdf_text.h"
 #include "public/fpdfview.h"
 #include "testing/embedder_test.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/test_support.h"
+#include "testing/utils/path_service.h"
 
 namespace {
 
@@ -27,6 +33,52 @@ bool check_unsigned_shorts(const char* expected,
   return true;
 }
 
+// Keeps what FPDFText_ExtractPages passes, stopping after |max_pages|.
+struct ExtractedPages : public FPDF_TEXT_SINK {
+  static FPDF_BOOL OnPageTextTrampoline(FPDF_TEXT_SINK* pThis,
+                                        int page_index,
+                                        FPDF_WIDESTRING text,
+                                        int text_length,
+                                        const FS_RECTF* char_boxes,
+                                        int char_count) {
+    auto* pages = static_cast<ExtractedPages*>(pThis);
+    pages->page_indices.push_back(page_index);
+    pages->texts.emplace_back(text, text + text_length + 1);
+    pages->char_boxes.emplace_back();
+    if (char_boxes) {
+      pages->char_boxes.back().assign(char_boxes, char_boxes + char_count);
+    }
+    pages->char_counts.push_back(char_count);
+    return static_cast<int>(pages->page_indices.size()) < pages->max_pages;
+  }
+
+  explicit ExtractedPages(int max) : max_pages(max) {
+    version = 1;
+    OnPageText = OnPageTextTrampoline;
+    user = nullptr;
+  }
+
+  const int max_pages;
+  std::vector<int> page_indices;
+  std::vector<std::vector<unsigned short>> texts;
+  std::vector<std::vector<FS_RECTF>> char_boxes;
+  std::vector<int> char_counts;
+};
+
+class ScopedThreadSafeMode {
+ public:
+  ScopedThreadSafeMode() { CFX_Mutex::SetThreadSafeMode(true); }
+  ~ScopedThreadSafeMode() { CFX_Mutex::SetThreadSafeMode(false); }
+};
+
+class ScopedThreadPool {
+ public:
+  explicit ScopedThreadPool(size_t nThreads) {
+    CFX_ThreadPool::Create(nThreads);
+  }
+  ~ScopedThreadPool() { CFX_ThreadPool::Destroy(); }
+};
+
 }  // namespace
 
 class FPDFTextEmbeddertest : public EmbedderTest {};
@@ -405,3 +457,252 @@ TEST_F(FPDFTextEmbeddertest, ToUnicode) {
   FPDFText_ClosePage(textpage);
   UnloadPage(page);
 }
+
+TEST_F(FPDFTextEmbeddertest, TextOnlyPage) {
+  EXPECT_TRUE(OpenDocument("text_and_graphics.pdf"));
+  EXPECT_FALSE(FPDFText_LoadTextOnlyPage(document(), -1));
+  EXPECT_FALSE(FPDFText_LoadTextOnlyPage(document(), 1));
+
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+  FPDF_PAGE text_only_page = FPDFText_LoadTextOnlyPage(document(), 0);
+  ASSERT_TRUE(text_only_page);
+
+  // A shading, two paths, two images, the text and the form.
+  EXPECT_EQ(7, FPDFPage_CountObject(page));
+  EXPECT_EQ(2, FPDFPage_CountObject(text_only_page));
+
+  FPDF_TEXTPAGE textpage = FPDFText_LoadPage(page);
+  ASSERT_TRUE(textpage);
+  FPDF_TEXTPAGE text_only_textpage = FPDFText_LoadPage(text_only_page);
+  ASSERT_TRUE(text_only_textpage);
+
+  static const char expected[] = "Hello, graphics!\r\nForm text";
+  unsigned short buffer[64];
+  int count = FPDFText_CountChars(text_only_textpage);
+  ASSERT_EQ(FPDFText_CountChars(textpage), count);
+  ASSERT_EQ(static_cast<int>(sizeof(expected)),
+            FPDFText_GetText(text_only_textpage, 0, count, buffer));
+  EXPECT_TRUE(check_unsigned_shorts(expected, buffer, sizeof(expected)));
+  for (int i = 0; i < count; ++i) {
+    double left[2];
+    double right[2];
+    double bottom[2];
+    double top[2];
+    FPDFText_GetCharBox(textpage, i, &left[0], &right[0], &bottom[0], &top[0]);
+    FPDFText_GetCharBox(text_only_textpage, i, &left[1], &right[1], &bottom[1],
+                        &top[1]);
+    EXPECT_EQ(left[0], left[1]) << i;
+    EXPECT_EQ(right[0], right[1]) << i;
+    EXPECT_EQ(bottom[0], bottom[1]) << i;
+    EXPECT_EQ(top[0], top[1]) << i;
+  }
+
+  FPDFText_ClosePage(text_only_textpage);
+  FPDFText_ClosePage(textpage);
+  FPDF_ClosePage(text_only_page);
+  UnloadPage(page);
+}
+
+TEST_F(FPDFTextEmbeddertest, TextIndex) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  std::unique_ptr<unsigned short, pdfium::FreeDeleter> world =
+      GetFPDFWideString(L"WORLD");
+  std::unique_ptr<unsigned short, pdfium::FreeDeleter> phrase =
+      GetFPDFWideString(L"goodbye world");
+
+  // Nothing works until the index is enabled.
+  EXPECT_EQ(-1, FPDFText_CountIndexedPages(document()));
+  EXPECT_EQ(-1, FPDFText_FindInIndex(document(), world.get(), nullptr, 0));
+  EXPECT_FALSE(FPDFText_IndexPage(document(), 0));
+  EXPECT_EQ(0u, FPDFText_SaveIndex(document(), nullptr, 0));
+
+  ASSERT_TRUE(FPDFText_EnableIndex(document()));
+  EXPECT_EQ(0, FPDFText_CountIndexedPages(document()));
+  EXPECT_EQ(0, FPDFText_FindInIndex(document(), world.get(), nullptr, 0));
+
+  // Loading the text of a page indexes it.
+  FPDF_PAGE page = LoadPage(0);
+  EXPECT_TRUE(page);
+  FPDF_TEXTPAGE textpage = FPDFText_LoadPage(page);
+  EXPECT_TRUE(textpage);
+  FPDFText_ClosePage(textpage);
+  UnloadPage(page);
+  EXPECT_EQ(1, FPDFText_CountIndexedPages(document()));
+  EXPECT_TRUE(FPDFText_IndexPage(document(), 0));
+  EXPECT_FALSE(FPDFText_IndexPage(document(), 1));
+
+  FPDF_TEXTHIT hits[2];
+  EXPECT_EQ(2, FPDFText_FindInIndex(document(), world.get(), hits, 1));
+  EXPECT_EQ(0, hits[0].page_index);
+  EXPECT_EQ(7, hits[0].char_index);
+  EXPECT_EQ(5, hits[0].char_count);
+  EXPECT_EQ(2, FPDFText_FindInIndex(document(), world.get(), hits, 2));
+  EXPECT_EQ(24, hits[1].char_index);
+  EXPECT_EQ(5, hits[1].char_count);
+  EXPECT_EQ(1, FPDFText_FindInIndex(document(), phrase.get(), hits, 2));
+  EXPECT_EQ(15, hits[0].char_index);
+  EXPECT_EQ(14, hits[0].char_count);
+
+  unsigned long size = FPDFText_SaveIndex(document(), nullptr, 0);
+  ASSERT_GT(size, 0u);
+  std::vector<char> data(size);
+  EXPECT_EQ(size, FPDFText_SaveIndex(document(), data.data(), size));
+
+  // A malformed index is rejected; a good one replaces the index.
+  EXPECT_FALSE(FPDFText_LoadIndex(document(), data.data(), size - 1));
+  EXPECT_TRUE(FPDFText_LoadIndex(document(), data.data(), size));
+  EXPECT_EQ(1, FPDFText_CountIndexedPages(document()));
+  EXPECT_EQ(2, FPDFText_FindInIndex(document(), world.get(), nullptr, 0));
+
+  // A document that was not loaded from a file cannot be told apart from
+  // any other.
+  FPDF_DOCUMENT new_doc = FPDF_CreateNewDocument();
+  ASSERT_TRUE(new_doc);
+  EXPECT_FALSE(FPDFText_LoadIndex(new_doc, data.data(), size));
+  FPDF_CloseDocument(new_doc);
+}
+
+TEST_F(FPDFTextEmbeddertest, TextIndexPage) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  ASSERT_TRUE(FPDFText_EnableIndex(document()));
+  EXPECT_TRUE(FPDFText_IndexPage(document(), 0));
+  EXPECT_EQ(1, FPDFText_CountIndexedPages(document()));
+
+  std::unique_ptr<unsigned short, pdfium::FreeDeleter> hello =
+      GetFPDFWideString(L"hello");
+  FPDF_TEXTHIT hit;
+  EXPECT_EQ(1, FPDFText_FindInIndex(document(), hello.get(), &hit, 1));
+  EXPECT_EQ(0, hit.page_index);
+  EXPECT_EQ(0, hit.char_index);
+  EXPECT_EQ(5, hit.char_count);
+}
+
+TEST_F(FPDFTextEmbeddertest, ExtractPages) {
+  EXPECT_TRUE(OpenDocument("bookmarks.pdf"));
+
+  ExtractedPages pages(100);
+  EXPECT_EQ(-1, FPDFText_ExtractPages(nullptr, 0, 1, 0, &pages));
+  EXPECT_EQ(-1, FPDFText_ExtractPages(document(), 0, 1, 0, nullptr));
+  EXPECT_EQ(-1, FPDFText_ExtractPages(document(), -1, 1, 0, &pages));
+  EXPECT_EQ(-1, FPDFText_ExtractPages(document(), 1, 2, 0, &pages));
+  EXPECT_EQ(-1, FPDFText_ExtractPages(document(), 0, -1, 0, &pages));
+  EXPECT_TRUE(pages.page_indices.empty());
+  EXPECT_EQ(0, FPDFText_ExtractPages(document(), 2, 0, 0, &pages));
+
+  ASSERT_EQ(2, FPDFText_ExtractPages(document(), 0, 2, FPDF_TEXT_CHARBOXES,
+                                     &pages));
+  ASSERT_EQ(std::vector<int>({0, 1}), pages.page_indices);
+
+  // Same as extracting the pages one at a time.
+  for (int i = 0; i < 2; ++i) {
+    FPDF_PAGE page = LoadPage(i);
+    ASSERT_TRUE(page);
+    FPDF_TEXTPAGE textpage = FPDFText_LoadPage(page);
+    ASSERT_TRUE(textpage);
+
+    int count = FPDFText_CountChars(textpage);
+    EXPECT_LT(0, count);
+    EXPECT_EQ(count, pages.char_counts[i]);
+    std::vector<unsigned short> text(count + 1);
+    EXPECT_EQ(count + 1, FPDFText_GetText(textpage, 0, count, text.data()));
+    EXPECT_EQ(text, pages.texts[i]);
+    ASSERT_EQ(static_cast<size_t>(count), pages.char_boxes[i].size());
+    for (int j = 0; j < count; ++j) {
+      double left;
+      double right;
+      double bottom;
+      double top;
+      FPDFText_GetCharBox(textpage, j, &left, &right, &bottom, &top);
+      const FS_RECTF& box = pages.char_boxes[i][j];
+      EXPECT_FLOAT_EQ(left, box.left) << j;
+      EXPECT_FLOAT_EQ(right, box.right) << j;
+      EXPECT_FLOAT_EQ(bottom, box.bottom) << j;
+      EXPECT_FLOAT_EQ(top, box.top) << j;
+    }
+
+    FPDFText_ClosePage(textpage);
+    UnloadPage(page);
+  }
+
+  // No boxes unless asked for.
+  ExtractedPages second_page(100);
+  EXPECT_EQ(1, FPDFText_ExtractPages(document(), 1, 1, 0, &second_page));
+  EXPECT_EQ(std::vector<int>({1}), second_page.page_indices);
+  EXPECT_EQ(pages.texts[1], second_page.texts[0]);
+  EXPECT_TRUE(second_page.char_boxes[0].empty());
+
+  // The sink can stop early.
+  ExtractedPages first_page(1);
+  EXPECT_EQ(1, FPDFText_ExtractPages(document(), 0, 2, 0, &first_page));
+  EXPECT_EQ(std::vector<int>({0}), first_page.page_indices);
+}
+
+TEST_F(FPDFTextEmbeddertest, ExtractPagesIndexes) {
+  EXPECT_TRUE(OpenDocument("bookmarks.pdf"));
+  ASSERT_TRUE(FPDFText_EnableIndex(document()));
+
+  ExtractedPages pages(100);
+  EXPECT_EQ(2, FPDFText_ExtractPages(document(), 0, 2, 0, &pages));
+  EXPECT_EQ(2, FPDFText_CountIndexedPages(document()));
+}
+
+TEST_F(FPDFTextEmbeddertest, ExtractPagesOnWorkerThreads) {
+  // Every page uses the same simple, CID and Type3 fonts, which are loaded
+  // by whichever page gets to them first.
+  const int kPageCount = 8;
+  ExtractedPages pages(100);
+  {
+    ScopedThreadSafeMode mode;
+    ScopedThreadPool pool(3);
+    ASSERT_TRUE(OpenDocument("shared_fonts.pdf"));
+    ASSERT_TRUE(FPDFText_EnableIndex(document()));
+    EXPECT_EQ(kPageCount,
+              FPDFText_ExtractPages(document(), 0, kPageCount,
+                                    FPDF_TEXT_CHARBOXES, &pages));
+    EXPECT_EQ(kPageCount, FPDFText_CountIndexedPages(document()));
+  }
+
+  // Same as extracting them from a fresh copy of the document, one page at
+  // a time.
+  std::string file_path;
+  ASSERT_TRUE(PathService::GetTestFilePath("shared_fonts.pdf", &file_path));
+  size_t file_length = 0;
+  std::unique_ptr<char, pdfium::FreeDeleter> file_contents =
+      GetFileContents(file_path.c_str(), &file_length);
+  ASSERT_TRUE(file_contents);
+  FPDF_DOCUMENT serial_doc =
+      FPDF_LoadMemDocument(file_contents.get(), file_length, nullptr);
+  ASSERT_TRUE(serial_doc);
+  ExtractedPages serial_pages(100);
+  EXPECT_EQ(kPageCount, FPDFText_ExtractPages(serial_doc, 0, kPageCount,
+                                              FPDF_TEXT_CHARBOXES,
+                                              &serial_pages));
+  FPDF_CloseDocument(serial_doc);
+
+  ASSERT_EQ(serial_pages.page_indices, pages.page_indices);
+  EXPECT_EQ(serial_pages.texts, pages.texts);
+  EXPECT_EQ(serial_pages.char_counts, pages.char_counts);
+  for (int i = 0; i < kPageCount; ++i) {
+    EXPECT_LT(0, pages.char_counts[i]);
+    ASSERT_EQ(serial_pages.char_boxes[i].size(), pages.char_boxes[i].size());
+    for (size_t j = 0; j < pages.char_boxes[i].size(); ++j) {
+      const FS_RECTF& expected = serial_pages.char_boxes[i][j];
+      const FS_RECTF& box = pages.char_boxes[i][j];
+      EXPECT_EQ(expected.left, box.left) << i << " " << j;
+      EXPECT_EQ(expected.top, box.top) << i << " " << j;
+      EXPECT_EQ(expected.right, box.right) << i << " " << j;
+      EXPECT_EQ(expected.bottom, box.bottom) << i << " " << j;
+    }
+  }
+
+  // The text of each font came out.
+  std::unique_ptr<unsigned short, pdfium::FreeDeleter> word =
+      GetFPDFWideString(L"seven");
+  FPDF_TEXTHIT hit;
+  EXPECT_EQ(1, FPDFText_FindInIndex(document(), word.get(), &hit, 1));
+  EXPECT_EQ(6, hit.page_index);
+  word = GetFPDFWideString(L"XXY");
+  EXPECT_EQ(1, FPDFText_FindInIndex(document(), word.get(), &hit, 1));
+  EXPECT_EQ(4, hit.page_index);
+}
@@ -8,24 +8,35 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "core/fpdfapi/cpdf_modulemgr.h"
 #include "core/fpdfapi/cpdf_pagerendercontext.h"
 #include "core/fpdfapi/page/cpdf_page.h"
+#include "core/fpdfapi/page/cpdf_pageobjectindex.h"
 #include "core/fpdfapi/parser/cpdf_array.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/parser/fpdf_parser_decode.h"
+#include "core/fpdfapi/render/cpdf_docrenderdata.h"
+#include "core/fpdfapi/render/cpdf_pagerendercache.h"
 #include "core/fpdfapi/render/cpdf_progressiverenderer.h"
 #include "core/fpdfapi/render/cpdf_renderoptions.h"
 #include "core/fpdfdoc/cpdf_annotlist.h"
 #include "core/fpdfdoc/cpdf_nametree.h"
 #include "core/fpdfdoc/cpdf_occontext.h"
 #include "core/fpdfdoc/cpdf_viewerpreferences.h"
+#include "core/fxcodec/JBig2_DocumentContext.h"
 #include "core/fxcodec/fx_codec.h"
+#include "core/fxcrt/cfx_mutex.h"
+#include "core/fxcrt/cfx_threadpool.h"
 #include "core/fxcrt/fx_memory.h"
 #include "core/fxcrt/fx_safe_types.h"
+#include "core/fxge/cfx_fontcache.h"
+#include "core/fxge/cfx_fontmapper.h"
 #include "core/fxge/cfx_fxgedevice.h"
 #include "core/fxge/cfx_gemodule.h"
+#include "core/fxge/cfx_glyphcache.h"
+#include "core/fxge/ifx_systemfontinfo.h"
 #include "fpdfsdk/cpdfsdk_formfillenvironment.h"
 #include "fpdfsdk/cpdfsdk_pageview.h"
 #include "fpdfsdk/fsdk_define.h"
@@ -33,6 +44,7 @@
 #include "fpdfsdk/javascript/ijs_runtime.h"
 #include "public/fpdf_ext.h"
 #include "public/fpdf_progressive.h"
+#include "third_party/base/numerics/safe_conversions.h"
 #include "third_party/base/numerics/safe_conversions_impl.h"
 #include "third_party/base/ptr_util.h"
 
@@ -53,13 +65,17 @@ namespace {
 // Also indicates whether library is currently initialized.
 CCodec_ModuleMgr* g_pCodecModule = nullptr;
 
+// Renders with |pCache| in place of the page's image cache if it is not
+// null, and looks up the visible page objects in |pIndex| if that is not.
 void RenderPageImpl(CPDF_PageRenderContext* pContext,
                     CPDF_Page* pPage,
                     const CFX_Matrix& matrix,
                     const FX_RECT& clipping_rect,
                     int flags,
                     bool bNeedToRestore,
-                    IFSDK_PAUSE_Adapter* pause) {
+                    IFSDK_PAUSE_Adapter* pause,
+                    CPDF_PageRenderCache* pCache,
+                    const CPDF_PageObjectIndex* pIndex) {
   if (!pContext->m_pOptions)
     pContext->m_pOptions = pdfium::MakeUnique<CPDF_RenderOptions>();
 
@@ -99,10 +115,13 @@ void RenderPageImpl(CPDF_PageRenderContext* pContext,
   pContext->m_pDevice->SaveState();
   pContext->m_pDevice->SetClip_Rect(clipping_rect);
 
-  pContext->m_pContext = pdfium::MakeUnique<CPDF_RenderContext>(pPage);
-  pContext->m_pContext->AppendLayer(pPage, &matrix);
+  pContext->m_pContext = pdfium::MakeUnique<CPDF_RenderContext>(
+      pPage, pCache ? pCache : pPage->GetRenderCache());
+  pContext->m_pContext->AppendIndexedLayer(pPage, pIndex, &matrix);
 
   if (flags & FPDF_ANNOT) {
+    // Appearance streams may be generated and parsed on demand here.
+    CFX_AutoLock lock(pPage->m_pDocument->GetLock());
     pContext->m_pAnnots = pdfium::MakeUnique<CPDF_AnnotList>(pPage);
     bool bPrinting = pContext->m_pDevice->GetDeviceClass() != FXDC_DISPLAY;
     pContext->m_pAnnots->DisplayAnnots(pPage, pContext->m_pContext.get(),
@@ -261,6 +280,39 @@ bool CFPDF_FileStream::Flush() {
 }
 #endif  // PDF_ENABLE_XFA
 
+// Backs FPDF_PAGETILES. Every render checks out an image cache of its own,
+// so concurrent renders never share a decoded image, while consecutive
+// tiles still reuse the images decoded for earlier ones.
+class CPDF_PageTiles {
+ public:
+  explicit CPDF_PageTiles(CPDF_Page* pPage)
+      : m_pPage(pPage), m_Index(pPage->GetPageObjectList()) {}
+
+  CPDF_Page* GetPage() const { return m_pPage; }
+  const CPDF_PageObjectIndex* GetIndex() const { return &m_Index; }
+
+  std::unique_ptr<CPDF_PageRenderCache> TakeCache() {
+    CFX_AutoLock lock(&m_Lock);
+    if (m_Caches.empty())
+      return pdfium::MakeUnique<CPDF_PageRenderCache>(m_pPage);
+
+    std::unique_ptr<CPDF_PageRenderCache> pCache = std::move(m_Caches.back());
+    m_Caches.pop_back();
+    return pCache;
+  }
+
+  void ReturnCache(std::unique_ptr<CPDF_PageRenderCache> pCache) {
+    CFX_AutoLock lock(&m_Lock);
+    m_Caches.push_back(std::move(pCache));
+  }
+
+ private:
+  CPDF_Page* const m_pPage;
+  const CPDF_PageObjectIndex m_Index;
+  CFX_Mutex m_Lock;
+  std::vector<std::unique_ptr<CPDF_PageRenderCache>> m_Caches;
+};
+
 }  // namespace
 
 UnderlyingDocumentType* UnderlyingFromFPDFDocument(FPDF_DOCUMENT doc) {
@@ -351,6 +403,8 @@ FPDF_InitLibraryWithConfig(const FPDF_LIBRARY_CONFIG* cfg) {
   if (g_pCodecModule)
     return;
 
+  CFX_Mutex::SetThreadSafeMode(cfg && cfg->version >= 3 &&
+                               cfg->m_bEnableMultiThreading);
   g_pCodecModule = new CCodec_ModuleMgr();
 
   CFX_GEModule* pModule = CFX_GEModule::Get();
@@ -363,6 +417,31 @@ FPDF_InitLibraryWithConfig(const FPDF_LIBRARY_CONFIG* cfg) {
   pModuleMgr->LoadEmbeddedJapan1CMaps();
   pModuleMgr->LoadEmbeddedCNS1CMaps();
   pModuleMgr->LoadEmbeddedKorea1CMaps();
+  if (cfg && cfg->version >= 4) {
+    CFX_ThreadPool::Create(cfg->m_nWorkerThreads);
+    pModuleMgr->SetPrefetchObjectStreams(!!cfg->m_bPrefetchObjectStreams);
+    pModuleMgr->SetObjectStreamCacheLimit(cfg->m_nObjectStreamCacheLimit);
+  }
+  if (cfg && cfg->version >= 5)
+    pModuleMgr->SetUseObjectArena(!!cfg->m_bUseObjectArena);
+  if (cfg && cfg->version >= 6 && cfg->m_nJBig2SymbolCacheLimit) {
+    g_pCodecModule->GetJbig2Module()->SetSymbolDictCacheBytes(
+        cfg->m_nJBig2SymbolCacheLimit);
+  }
+  if (cfg && cfg->version >= 7 && cfg->m_nGlyphCacheLimit) {
+    pModule->GetFontCache()->GetGlyphCache()->SetMaxBytes(
+        cfg->m_nGlyphCacheLimit);
+  }
+  if (cfg && cfg->version >= 8) {
+    pModule->GetFontCache()->SetEmbeddedFaceCacheLimit(
+        cfg->m_nEmbeddedFontCacheLimit);
+  }
+  if (cfg && cfg->version >= 9 && cfg->m_pFontIndexPath) {
+    IFX_SystemFontInfo* pFontInfo =
+        pModule->GetFontMgr()->GetBuiltinMapper()->GetSystemFontInfo();
+    if (pFontInfo)
+      pFontInfo->SetFontIndexPath(cfg->m_pFontIndexPath);
+  }
 
 #ifdef PDF_ENABLE_XFA
   FXJSE_Initialize();
@@ -381,6 +460,7 @@ DLLEXPORT void STDCALL FPDF_DestroyLibrary() {
   FXJSE_Finalize();
 #endif  // PDF_ENABLE_XFA
 
+  CFX_ThreadPool::Destroy();
   CPDF_ModuleMgr::Destroy();
   CFX_GEModule::Destroy();
 
@@ -388,6 +468,7 @@ DLLEXPORT void STDCALL FPDF_DestroyLibrary() {
   g_pCodecModule = nullptr;
 
   IJS_Runtime::Destroy();
+  CFX_Mutex::SetThreadSafeMode(false);
 }
 
 #ifndef _WIN32
@@ -514,6 +595,7 @@ class CMemFile final : public IFX_SeekableReadStream {
     FXSYS_memcpy(buffer, m_pBuf + offset, size);
     return true;
   }
+  const uint8_t* GetMappedData() override { return m_pBuf; }
 
  private:
   CMemFile(uint8_t* pBuf, FX_FILESIZE size) : m_pBuf(pBuf), m_size(size) {}
@@ -624,7 +706,10 @@ DLLEXPORT FPDF_PAGE STDCALL FPDF_LoadPage(FPDF_DOCUMENT document,
     return nullptr;
 
   CPDF_Page* pPage = new CPDF_Page(pDoc, pDict, true);
-  pPage->ParseContent();
+  {
+    CFX_AutoLock lock(pDoc->GetLock());
+    pPage->ParseContent();
+  }
   return pPage;
 #endif  // PDF_ENABLE_XFA
 }
@@ -762,11 +847,146 @@ DLLEXPORT void STDCALL FPDF_RenderPageBitmapWithMatrix(FPDF_BITMAP bitmap,
     clipping_rect.top = clipping->top;
   }
   RenderPageImpl(pContext, pPage, transform_matrix, clipping_rect.ToFxRect(),
-                 flags, true, nullptr);
+                 flags, true, nullptr, nullptr, nullptr);
 
   pPage->SetRenderContext(nullptr);
 }
 
+DLLEXPORT FPDF_PAGETILES STDCALL FPDF_LoadPageTiles(FPDF_PAGE page) {
+  CPDF_Page* pPage = CPDFPageFromFPDFPage(page);
+  if (!pPage || !pPage->IsParsed())
+    return nullptr;
+
+  return new CPDF_PageTiles(pPage);
+}
+
+DLLEXPORT void STDCALL FPDF_RenderPageTile(FPDF_PAGETILES tiles,
+                                           FPDF_BITMAP bitmap,
+                                           int start_x,
+                                           int start_y,
+                                           int size_x,
+                                           int size_y,
+                                           int rotate,
+                                           int flags) {
+  if (!tiles || !bitmap)
+    return;
+
+  CPDF_PageTiles* pTiles = static_cast<CPDF_PageTiles*>(tiles);
+  CPDF_Page* pPage = pTiles->GetPage();
+  std::unique_ptr<CPDF_PageRenderCache> pCache = pTiles->TakeCache();
+  {
+    // Not attached to the page, as other threads may be rendering it too.
+    CPDF_PageRenderContext context;
+    CFX_FxgeDevice* pDevice = new CFX_FxgeDevice;
+    context.m_pDevice.reset(pDevice);
+    CFX_DIBitmap* pBitmap = CFXBitmapFromFPDFBitmap(bitmap);
+    pDevice->Attach(pBitmap, !!(flags & FPDF_REVERSE_BYTE_ORDER), nullptr,
+                    false);
+
+    CFX_Matrix matrix;
+    pPage->GetDisplayMatrix(matrix, start_x, start_y, size_x, size_y, rotate);
+    FX_RECT rect(start_x, start_y, start_x + size_x, start_y + size_y);
+    RenderPageImpl(&context, pPage, matrix, rect, flags, true, nullptr,
+                   pCache.get(), pTiles->GetIndex());
+
+#ifdef _SKIA_SUPPORT_PATHS_
+    pDevice->Flush();
+    pBitmap->UnPreMultiply();
+#endif
+  }
+  pTiles->ReturnCache(std::move(pCache));
+}
+
+DLLEXPORT void STDCALL FPDF_ClosePageTiles(FPDF_PAGETILES tiles) {
+  delete static_cast<CPDF_PageTiles*>(tiles);
+}
+
+DLLEXPORT void STDCALL FPDF_SetImageCacheSize(FPDF_DOCUMENT document,
+                                              unsigned long max_bytes) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc)
+    return;
+
+  pDoc->GetRenderData()->GetImageCache()->SetMaxBytes(
+      pdfium::base::saturated_cast<uint32_t>(max_bytes));
+}
+
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_GetImageCacheStats(FPDF_DOCUMENT document, FPDF_IMAGECACHE_STATS* stats) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc || !stats)
+    return false;
+
+  CPDF_ImageCache::Stats cache_stats =
+      pDoc->GetRenderData()->GetImageCache()->GetStats();
+  stats->hits = cache_stats.nHits;
+  stats->misses = cache_stats.nMisses;
+  stats->evictions = cache_stats.nEvictions;
+  stats->images = cache_stats.nImages;
+  stats->bytes = cache_stats.nBytes;
+  stats->max_bytes = cache_stats.nMaxBytes;
+  return true;
+}
+
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_GetJBig2CacheStats(FPDF_DOCUMENT document, FPDF_JBIG2CACHE_STATS* stats) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc || !stats)
+    return false;
+
+  CFX_AutoLock lock(pDoc->GetLock());
+  JBig2_DocumentContext* pContext = pDoc->CodecContext()->get();
+  if (!pContext) {
+    // Nothing decoded yet.
+    FXSYS_memset(stats, 0, sizeof(*stats));
+    stats->max_bytes =
+        CPDF_ModuleMgr::Get()->GetJbig2Module()->GetSymbolDictCacheBytes();
+    return true;
+  }
+
+  CJBig2_SymbolDictCache::Stats cache_stats =
+      pContext->GetSymbolDictCache()->GetStats();
+  stats->hits = cache_stats.nHits;
+  stats->misses = cache_stats.nMisses;
+  stats->evictions = cache_stats.nEvictions;
+  stats->dicts = cache_stats.nDicts;
+  stats->bytes = cache_stats.nBytes;
+  stats->max_bytes = cache_stats.nMaxBytes;
+  return true;
+}
+
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_GetGlyphCacheStats(FPDF_GLYPHCACHE_STATS* stats) {
+  if (!stats || !g_pCodecModule)
+    return false;
+
+  CFX_GlyphCache::Stats cache_stats =
+      CFX_GEModule::Get()->GetFontCache()->GetGlyphCache()->GetStats();
+  stats->hits = cache_stats.nHits;
+  stats->misses = cache_stats.nMisses;
+  stats->evictions = cache_stats.nEvictions;
+  stats->glyphs = cache_stats.nGlyphs;
+  stats->bytes = cache_stats.nBytes;
+  stats->max_bytes = cache_stats.nMaxBytes;
+  return true;
+}
+
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_GetEmbeddedFontCacheStats(FPDF_EMBEDDEDFONTCACHE_STATS* stats) {
+  if (!stats || !g_pCodecModule)
+    return false;
+
+  CFX_FontCache::EmbeddedFaceStats cache_stats =
+      CFX_GEModule::Get()->GetFontCache()->GetEmbeddedFaceStats();
+  stats->hits = cache_stats.nHits;
+  stats->misses = cache_stats.nMisses;
+  stats->evictions = cache_stats.nEvictions;
+  stats->faces = cache_stats.nFaces;
+  stats->bytes = cache_stats.nBytes;
+  stats->max_bytes = cache_stats.nMaxBytes;
+  return true;
+}
+
 #ifdef _SKIA_SUPPORT_
 DLLEXPORT FPDF_RECORDER STDCALL FPDF_RenderPageSkp(FPDF_PAGE page,
                                                    int size_x,
@@ -979,7 +1199,8 @@ void FPDF_RenderPage_Retail(CPDF_PageRenderContext* pContext,
   CFX_Matrix matrix;
   pPage->GetDisplayMatrix(matrix, start_x, start_y, size_x, size_y, rotate);
   FX_RECT rect(start_x, start_y, start_x + size_x, start_y + size_y);
-  RenderPageImpl(pContext, pPage, matrix, rect, flags, bNeedToRestore, pause);
+  RenderPageImpl(pContext, pPage, matrix, rect, flags, bNeedToRestore, pause,
+                 nullptr, nullptr);
 }
 
 DLLEXPORT int STDCALL FPDF_GetPageSizeByIndex(FPDF_DOCUMENT document,
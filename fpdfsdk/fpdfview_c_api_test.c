@@ -170,8 +170,10 @@ int CheckPDFiumCApi() {
     CHK(FPDF_SetSystemFontInfo);
     CHK(FPDF_GetDefaultSystemFontInfo);
     CHK(FPDF_FreeDefaultSystemFontInfo);
+    CHK(FPDF_BuildSystemFontIndex);
 
     // fpdf_text.h
+    CHK(FPDFText_LoadTextOnlyPage);
     CHK(FPDFText_LoadPage);
     CHK(FPDFText_ClosePage);
     CHK(FPDFText_CountChars);
@@ -189,6 +191,13 @@ int CheckPDFiumCApi() {
     CHK(FPDFText_GetSchResultIndex);
     CHK(FPDFText_GetSchCount);
     CHK(FPDFText_FindClose);
+    CHK(FPDFText_EnableIndex);
+    CHK(FPDFText_IndexPage);
+    CHK(FPDFText_CountIndexedPages);
+    CHK(FPDFText_FindInIndex);
+    CHK(FPDFText_SaveIndex);
+    CHK(FPDFText_LoadIndex);
+    CHK(FPDFText_ExtractPages);
     CHK(FPDFLink_LoadWebLinks);
     CHK(FPDFLink_CountWebLinks);
     CHK(FPDFLink_GetURL);
@@ -226,6 +235,14 @@ int CheckPDFiumCApi() {
     CHK(FPDF_GetPageSizeByIndex);
     CHK(FPDF_RenderPageBitmap);
     CHK(FPDF_RenderPageBitmapWithMatrix);
+    CHK(FPDF_LoadPageTiles);
+    CHK(FPDF_RenderPageTile);
+    CHK(FPDF_ClosePageTiles);
+    CHK(FPDF_SetImageCacheSize);
+    CHK(FPDF_GetImageCacheStats);
+    CHK(FPDF_GetJBig2CacheStats);
+    CHK(FPDF_GetGlyphCacheStats);
+    CHK(FPDF_GetEmbeddedFontCacheStats);
     CHK(FPDF_ClosePage);
     CHK(FPDF_CloseDocument);
     CHK(FPDF_DeviceToPage);
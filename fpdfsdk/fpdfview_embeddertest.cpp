@@ -2,13 +2,93 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <limits>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "core/fxcrt/cfx_mutex.h"
 #include "fpdfsdk/fpdfview_c_api_test.h"
 #include "public/fpdfview.h"
 #include "testing/embedder_test.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "testing/utils/path_service.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+class ScopedThreadSafeMode {
+ public:
+  ScopedThreadSafeMode() { CFX_Mutex::SetThreadSafeMode(true); }
+  ~ScopedThreadSafeMode() { CFX_Mutex::SetThreadSafeMode(false); }
+};
+
+// A document with |nPages| pages in a single /Kids array, so that it has
+// |nPages| + 2 objects in its xref table.
+std::string MakeDocumentWithPages(int nPages) {
+  std::string doc = "%PDF-1.7\n";
+  std::vector<size_t> offsets;
+  char buf[64];
+  offsets.push_back(doc.size());
+  doc += "1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n";
+  offsets.push_back(doc.size());
+  doc += "2 0 obj\n<< /Type /Pages /Kids [";
+  for (int i = 0; i < nPages; ++i) {
+    snprintf(buf, sizeof(buf), "%d 0 R ", i + 3);
+    doc += buf;
+  }
+  snprintf(buf, sizeof(buf), "] /Count %d >>\nendobj\n", nPages);
+  doc += buf;
+  for (int i = 0; i < nPages; ++i) {
+    offsets.push_back(doc.size());
+    snprintf(buf, sizeof(buf), "%d 0 obj\n", i + 3);
+    doc += buf;
+    doc += "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 200 200] >>\nendobj\n";
+  }
+  size_t xref_offset = doc.size();
+  snprintf(buf, sizeof(buf), "xref\n0 %d\n", nPages + 3);
+  doc += buf;
+  doc += "0000000000 65535 f\r\n";
+  for (size_t offset : offsets) {
+    snprintf(buf, sizeof(buf), "%010u 00000 n\r\n",
+             static_cast<unsigned>(offset));
+    doc += buf;
+  }
+  snprintf(buf, sizeof(buf), "trailer\n<< /Size %d /Root 1 0 R >>\n",
+           nPages + 3);
+  doc += buf;
+  snprintf(buf, sizeof(buf), "startxref\n%u\n%%%%EOF\n",
+           static_cast<unsigned>(xref_offset));
+  doc += buf;
+  return doc;
+}
+
+// The most memory the process has used so far, in KB, or 0 if unknown.
+long GetPeakResidentKB() {
+#ifdef _WIN32
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
+}  // namespace
 
 TEST(fpdf, CApiTest) {
   EXPECT_TRUE(CheckPDFiumCApi());
@@ -378,3 +458,290 @@ TEST_F(FPDFViewEmbeddertest, FPDF_RenderPageBitmapWithMatrix) {
 
   UnloadPage(page);
 }
+
+TEST_F(FPDFViewEmbeddertest, FPDF_RenderPageTile) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_NE(nullptr, page);
+  const int width = static_cast<int>(FPDF_GetPageWidth(page)) * 2;
+  const int height = static_cast<int>(FPDF_GetPageHeight(page)) * 2;
+
+  FPDF_PAGETILES tiles = FPDF_LoadPageTiles(page);
+  ASSERT_NE(nullptr, tiles);
+
+  // Every tile matches FPDF_RenderPageBitmap() output for the same area.
+  const int kTileSize = 64;
+  const size_t kTileBytes = kTileSize * kTileSize * 4;
+  FPDF_BITMAP expected = FPDFBitmap_Create(kTileSize, kTileSize, 0);
+  FPDF_BITMAP tile = FPDFBitmap_Create(kTileSize, kTileSize, 0);
+  ASSERT_EQ(kTileSize * 4, FPDFBitmap_GetStride(tile));
+  for (int y = 0; y < height; y += kTileSize) {
+    for (int x = 0; x < width; x += kTileSize) {
+      FPDFBitmap_FillRect(expected, 0, 0, kTileSize, kTileSize, 0xFFFFFFFF);
+      FPDF_RenderPageBitmap(expected, page, -x, -y, width, height, 0, 0);
+      FPDFBitmap_FillRect(tile, 0, 0, kTileSize, kTileSize, 0xFFFFFFFF);
+      FPDF_RenderPageTile(tiles, tile, -x, -y, width, height, 0, 0);
+      ASSERT_EQ(0, memcmp(FPDFBitmap_GetBuffer(expected),
+                          FPDFBitmap_GetBuffer(tile), kTileBytes))
+          << "tile at " << x << ", " << y;
+    }
+  }
+  FPDFBitmap_Destroy(tile);
+  FPDFBitmap_Destroy(expected);
+  FPDF_ClosePageTiles(tiles);
+  UnloadPage(page);
+}
+
+TEST_F(FPDFViewEmbeddertest, ImageCache) {
+  EXPECT_TRUE(OpenDocument("tagged_alt_text.pdf"));
+  FPDF_IMAGECACHE_STATS stats;
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(0u, stats.max_bytes);
+  EXPECT_FALSE(FPDF_GetImageCacheStats(document(), nullptr));
+
+  // Each render loads the page afresh, so only the document cache can
+  // spare decoding the image again.
+  auto render = [this]() {
+    FPDF_PAGE page = LoadPage(0);
+    EXPECT_NE(nullptr, page);
+    FPDF_BITMAP bitmap = RenderPage(page);
+    const char* buffer = static_cast<const char*>(FPDFBitmap_GetBuffer(bitmap));
+    std::string pixels(buffer,
+                       FPDFBitmap_GetStride(bitmap) *
+                           FPDFBitmap_GetHeight(bitmap));
+    FPDFBitmap_Destroy(bitmap);
+    UnloadPage(page);
+    return pixels;
+  };
+  std::string expected = render();
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(0u, stats.misses);
+
+  FPDF_SetImageCacheSize(document(), 1024 * 1024);
+  EXPECT_EQ(expected, render());
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(1u, stats.images);
+  EXPECT_LT(0u, stats.bytes);
+  EXPECT_EQ(1024u * 1024u, stats.max_bytes);
+
+  EXPECT_EQ(expected, render());
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+
+  // A budget too small for the image keeps nothing.
+  FPDF_SetImageCacheSize(document(), 16);
+  EXPECT_EQ(expected, render());
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(1u, stats.evictions);
+  EXPECT_EQ(0u, stats.images);
+  EXPECT_EQ(0u, stats.bytes);
+}
+
+TEST_F(FPDFViewEmbeddertest, ImageDecodeReduction) {
+  // A JPEG and a JPEG 2000 image of 128x128 pixels, each drawn 30x30.
+  EXPECT_TRUE(OpenDocument("dct_jpx_images.pdf"));
+  FPDF_SetImageCacheSize(document(), 1024 * 1024);
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_NE(nullptr, page);
+  auto render = [&page](int size) {
+    FPDF_BITMAP bitmap = FPDFBitmap_Create(size, size, 0);
+    FPDFBitmap_FillRect(bitmap, 0, 0, size, size, 0xFFFFFFFF);
+    FPDF_RenderPageBitmap(bitmap, page, 0, 0, size, size, 0, 0);
+    const uint8_t* buffer =
+        static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
+    std::vector<uint8_t> pixels(
+        buffer, buffer + FPDFBitmap_GetStride(bitmap) * size);
+    FPDFBitmap_Destroy(bitmap);
+    return pixels;
+  };
+
+  // Drawn at 30 pixels, the images are decoded at a quarter of their size.
+  std::vector<uint8_t> reduced = render(200);
+  UnloadPage(page);
+  FPDF_IMAGECACHE_STATS stats;
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(2u, stats.images);
+  EXPECT_EQ(2u * 32 * 32 * 3, stats.bytes);
+
+  // Drawn larger, they are decoded again, in full.
+  page = LoadPage(0);
+  ASSERT_NE(nullptr, page);
+  render(800);
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(0u, stats.images);
+
+  // Then the full images serve smaller sizes too, and look much the same.
+  std::vector<uint8_t> full = render(200);
+  UnloadPage(page);
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(2u, stats.images);
+  EXPECT_EQ(2u * 128 * 128 * 3, stats.bytes);
+
+  ASSERT_EQ(full.size(), reduced.size());
+  int max_diff = 0;
+  for (size_t i = 0; i < full.size(); ++i)
+    max_diff = std::max(max_diff, std::abs(full[i] - reduced[i]));
+  EXPECT_LT(0, max_diff);
+  EXPECT_GT(64, max_diff);
+}
+
+TEST_F(FPDFViewEmbeddertest, JBig2SymbolDictCache) {
+  EXPECT_TRUE(OpenDocument("jbig2_globals.pdf"));
+  FPDF_JBIG2CACHE_STATS stats;
+  EXPECT_FALSE(FPDF_GetJBig2CacheStats(document(), nullptr));
+  EXPECT_FALSE(FPDF_GetJBig2CacheStats(nullptr, &stats));
+  ASSERT_TRUE(FPDF_GetJBig2CacheStats(document(), &stats));
+  EXPECT_EQ(0u, stats.misses);
+  EXPECT_EQ(0u, stats.dicts);
+  EXPECT_EQ(8u * 1024 * 1024, stats.max_bytes);
+
+  // The two images share their globals, which are decoded once.
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+  FPDF_BITMAP bitmap = RenderPage(page);
+  FPDFBitmap_Destroy(bitmap);
+  UnloadPage(page);
+  ASSERT_TRUE(FPDF_GetJBig2CacheStats(document(), &stats));
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(0u, stats.evictions);
+  EXPECT_EQ(1u, stats.dicts);
+  EXPECT_LT(0u, stats.bytes);
+  EXPECT_EQ(8u * 1024 * 1024, stats.max_bytes);
+}
+
+TEST_F(FPDFViewEmbeddertest, GlyphCache) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_GLYPHCACHE_STATS before;
+  EXPECT_FALSE(FPDF_GetGlyphCacheStats(nullptr));
+  ASSERT_TRUE(FPDF_GetGlyphCacheStats(&before));
+  EXPECT_EQ(32u * 1024 * 1024, before.max_bytes);
+
+  // The glyphs are rendered the first time only. The cache is shared by
+  // all documents, so only the changes are checked.
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+  FPDF_BITMAP bitmap = RenderPage(page);
+  FPDFBitmap_Destroy(bitmap);
+  FPDF_GLYPHCACHE_STATS first;
+  ASSERT_TRUE(FPDF_GetGlyphCacheStats(&first));
+  EXPECT_LT(before.misses, first.misses);
+  EXPECT_LT(before.glyphs, first.glyphs);
+  EXPECT_LT(before.bytes, first.bytes);
+
+  bitmap = RenderPage(page);
+  FPDFBitmap_Destroy(bitmap);
+  FPDF_GLYPHCACHE_STATS second;
+  ASSERT_TRUE(FPDF_GetGlyphCacheStats(&second));
+  EXPECT_EQ(first.misses, second.misses);
+  EXPECT_LT(first.hits, second.hits);
+  EXPECT_EQ(first.evictions, second.evictions);
+  EXPECT_EQ(first.glyphs, second.glyphs);
+  EXPECT_EQ(first.bytes, second.bytes);
+
+  // The glyphs go along with the fonts of the page.
+  UnloadPage(page);
+  FPDF_GLYPHCACHE_STATS unloaded;
+  ASSERT_TRUE(FPDF_GetGlyphCacheStats(&unloaded));
+  EXPECT_EQ(before.glyphs, unloaded.glyphs);
+  EXPECT_EQ(before.bytes, unloaded.bytes);
+  EXPECT_EQ(first.evictions, unloaded.evictions);
+}
+
+TEST_F(FPDFViewEmbeddertest, EmbeddedFontCacheOffByDefault) {
+  EXPECT_FALSE(FPDF_GetEmbeddedFontCacheStats(nullptr));
+  FPDF_EMBEDDEDFONTCACHE_STATS stats;
+  ASSERT_TRUE(FPDF_GetEmbeddedFontCacheStats(&stats));
+  EXPECT_EQ(0u, stats.max_bytes);
+
+  // Fonts are loaded for their document alone.
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+  FPDF_BITMAP bitmap = RenderPage(page);
+  FPDFBitmap_Destroy(bitmap);
+  UnloadPage(page);
+  ASSERT_TRUE(FPDF_GetEmbeddedFontCacheStats(&stats));
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_EQ(0u, stats.misses);
+  EXPECT_EQ(0u, stats.faces);
+  EXPECT_EQ(0u, stats.bytes);
+}
+
+TEST_F(FPDFViewEmbeddertest, SharedPatternsFromTwoThreads) {
+  // Both pages use the same tiling and shading patterns and soft mask, which
+  // are loaded by whichever page gets to them first.
+  ScopedThreadSafeMode mode;
+  ASSERT_TRUE(OpenDocument("shared_patterns.pdf"));
+  FPDF_PAGE pages[2] = {LoadPage(0), LoadPage(1)};
+  ASSERT_TRUE(pages[0]);
+  ASSERT_TRUE(pages[1]);
+
+  FPDF_BITMAP bitmaps[2] = {nullptr, nullptr};
+  std::thread other([&] { bitmaps[1] = RenderPage(pages[1]); });
+  bitmaps[0] = RenderPage(pages[0]);
+  other.join();
+
+  FPDF_BITMAP expected = RenderPage(pages[0]);
+  int size = FPDFBitmap_GetStride(expected) * FPDFBitmap_GetHeight(expected);
+  for (FPDF_BITMAP bitmap : bitmaps) {
+    EXPECT_EQ(0, memcmp(FPDFBitmap_GetBuffer(expected),
+                        FPDFBitmap_GetBuffer(bitmap), size));
+    FPDFBitmap_Destroy(bitmap);
+  }
+  FPDFBitmap_Destroy(expected);
+  UnloadPage(pages[0]);
+  UnloadPage(pages[1]);
+}
+
+// Times loading documents with large xref tables, then loading their last
+// page, which looks up every page object. Peak memory is that of the whole
+// process, so the documents go from smallest to largest.
+// Run with --gtest_also_run_disabled_tests.
+TEST_F(FPDFViewEmbeddertest, DISABLED_LargeXrefBenchmark) {
+  std::string file_path;
+  ASSERT_TRUE(PathService::GetExecutableDir(&file_path));
+  if (!PathService::EndsWithSeparator(file_path))
+    file_path.push_back(PATH_SEPARATOR);
+  file_path += "large_xref_benchmark.pdf";
+  for (int nPages : {20000, 200000, 1000000}) {
+    std::string contents = MakeDocumentWithPages(nPages);
+    FILE* file = fopen(file_path.c_str(), "wb");
+    ASSERT_TRUE(file);
+    ASSERT_EQ(contents.size(),
+              fwrite(contents.data(), 1, contents.size(), file));
+    fclose(file);
+    // Not counted in the peak.
+    const size_t file_size = contents.size();
+    contents.clear();
+    contents.shrink_to_fit();
+    double best_load = 0;
+    double best_page = 0;
+    for (int i = 0; i < 3; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      FPDF_DOCUMENT doc = FPDF_LoadDocument(file_path.c_str(), nullptr);
+      auto loaded = std::chrono::steady_clock::now();
+      ASSERT_TRUE(doc);
+      FPDF_PAGE page = FPDF_LoadPage(doc, nPages - 1);
+      auto page_loaded = std::chrono::steady_clock::now();
+      EXPECT_TRUE(page);
+      FPDF_ClosePage(page);
+      FPDF_CloseDocument(doc);
+      double load = std::chrono::duration<double>(loaded - start).count();
+      double last_page =
+          std::chrono::duration<double>(page_loaded - loaded).count();
+      if (i == 0 || load < best_load)
+        best_load = load;
+      if (i == 0 || last_page < best_page)
+        best_page = last_page;
+    }
+    printf("%7d objects (%5.1f MB): load %7.1f ms, last page %7.1f ms, "
+           "peak RSS %ld KB\n",
+           nPages + 2, file_size / 1048576.0, best_load * 1000,
+           best_page * 1000, GetPeakResidentKB());
+  }
+  remove(file_path.c_str());
+}
@@ -49,13 +49,34 @@ typedef struct FPDF_FILEWRITE_ {
 /** @brief Remove security. */
 #define FPDF_REMOVE_SECURITY 3
 
+// The flags below may be combined with one of the above.
+
+// Compress the document's streams on the worker threads requested through
+// m_nWorkerThreads in FPDF_LIBRARY_CONFIG, a batch at a time ahead of
+// writing them. The output is the same as without this flag.
+#define FPDF_PARALLEL_COMPRESSION 0x100
+// Compress streams with zlib at |level|, from 0 (no compression, fastest)
+// to 9 (smallest output), rather than the default level of 6.
+#define FPDF_COMPRESSION_LEVEL(level) ((((level) + 1) & 0xF) << 12)
+// Write a PDF 1.5 cross-reference stream rather than an xref table, and
+// pack the objects that are not streams into compressed object streams of
+// up to 200 objects each. The file version is raised to 1.5 if it is lower.
+#define FPDF_OBJECT_STREAMS 0x200
+// Same as FPDF_OBJECT_STREAMS, with up to |count| objects, from 1 to 65535,
+// in each object stream.
+#define FPDF_OBJECT_STREAM_SIZE(count) \
+  (FPDF_OBJECT_STREAMS | (((unsigned long)(count)&0xFFFF) << 16))
+
 // Function: FPDF_SaveAsCopy
 //          Saves the copy of specified document in custom way.
 // Parameters:
 //          document        -   Handle to document. Returned by
 //          FPDF_LoadDocument and FPDF_CreateNewDocument.
 //          pFileWrite      -   A pointer to a custom file write structure.
-//          flags           -   The creating flags.
+//          flags           -   The creating flags: FPDF_INCREMENTAL,
+//          FPDF_NO_INCREMENTAL or FPDF_REMOVE_SECURITY, optionally combined
+//          with FPDF_PARALLEL_COMPRESSION, FPDF_COMPRESSION_LEVEL() and
+//          FPDF_OBJECT_STREAMS or FPDF_OBJECT_STREAM_SIZE().
 // Return value:
 //          TRUE for succeed, FALSE for failed.
 //
@@ -309,6 +309,26 @@ DLLEXPORT FPDF_SYSFONTINFO* STDCALL FPDF_GetDefaultSystemFontInfo();
  **/
 DLLEXPORT void FPDF_FreeDefaultSystemFontInfo(FPDF_SYSFONTINFO* pFontInfo);
 
+/**
+ * Function: FPDF_BuildSystemFontIndex
+ *          Look for the fonts in the system font directories, and write what
+ *          was found to a font index file.
+ * Comments:
+ *          Run at install time, this spares the processes using the index
+ *          reading every font file on their first use of a system font: they
+ *          only check that the files are still the ones indexed. See
+ *          m_pFontIndexPath in FPDF_LIBRARY_CONFIG.
+ *          Only the system font info of the platform, not one set with
+ *          FPDF_SetSystemFontInfo(), can be indexed, and only on platforms
+ *          where it looks for font files itself.
+ * Parameters:
+ *          index_path      -   The file to write the index to.
+ * Return Value:
+ *          TRUE if the index was written.
+ **/
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_BuildSystemFontIndex(FPDF_BYTESTRING index_path);
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,6 +15,24 @@
 extern "C" {
 #endif
 
+// Function: FPDFText_LoadTextOnlyPage
+//          Load a page for text extraction only.
+// Parameters:
+//          document    -   Handle to the document.
+//          page_index  -   Zero-based index of the page.
+// Return value:
+//          A handle to the page, or NULL if it cannot be loaded.
+// Comments:
+//          Like FPDF_LoadPage, but only the text objects of the page, and the
+//          forms that hold them, are created. Paths, clips, colors, images
+//          and shadings are skipped, which makes parsing pages that have a
+//          lot of graphics much faster. Pass the page to FPDFText_LoadPage;
+//          rendering it draws the text only. Close it with FPDF_ClosePage.
+//          In builds with XFA support, the page is loaded fully.
+//
+DLLEXPORT FPDF_PAGE STDCALL FPDFText_LoadTextOnlyPage(FPDF_DOCUMENT document,
+                                                      int page_index);
+
 // Function: FPDFText_LoadPage
 //          Prepare information about all characters in a page.
 // Parameters:
@@ -313,6 +331,183 @@ DLLEXPORT int STDCALL FPDFText_GetSchCount(FPDF_SCHHANDLE handle);
 //
 DLLEXPORT void STDCALL FPDFText_FindClose(FPDF_SCHHANDLE handle);
 
+// Where a word or phrase was found by FPDFText_FindInIndex.
+typedef struct _FPDF_TEXTHIT {
+  // Zero-based index of the page.
+  int page_index;
+  // Index of the first character, as for the FPDFText functions.
+  int char_index;
+  // Number of characters, including any between the words of a phrase.
+  int char_count;
+} FPDF_TEXTHIT;
+
+// Function: FPDFText_EnableIndex
+//          Start building a full-text index of a document.
+// Parameters:
+//          document    -   Handle to the document.
+// Return value:
+//          TRUE if the index is enabled, FALSE if |document| is invalid.
+// Comments:
+//          From then on, the text of each page loaded with FPDFText_LoadPage
+//          is added to the index, once per page, so that it can be searched
+//          with FPDFText_FindInIndex without loading the page again.
+//          Calling this again keeps the index built so far.
+//
+DLLEXPORT FPDF_BOOL STDCALL FPDFText_EnableIndex(FPDF_DOCUMENT document);
+
+// Function: FPDFText_IndexPage
+//          Add the text of a page to the index of its document.
+// Parameters:
+//          document    -   Handle to the document.
+//          page_index  -   Zero-based index of the page.
+// Return value:
+//          TRUE if the page is indexed, FALSE if the index is not enabled or
+//          the page cannot be loaded.
+// Comments:
+//          Lets applications index pages they do not display, for instance
+//          in the background. Pages that are indexed already are skipped.
+//
+DLLEXPORT FPDF_BOOL STDCALL FPDFText_IndexPage(FPDF_DOCUMENT document,
+                                               int page_index);
+
+// Function: FPDFText_CountIndexedPages
+//          Get number of pages in the index of a document.
+// Parameters:
+//          document    -   Handle to the document.
+// Return value:
+//          Number of indexed pages, or -1 if the index is not enabled.
+//
+DLLEXPORT int STDCALL FPDFText_CountIndexedPages(FPDF_DOCUMENT document);
+
+// Function: FPDFText_FindInIndex
+//          Search the index of a document for a word or a phrase.
+// Parameters:
+//          document    -   Handle to the document.
+//          query       -   The words to look for, in UTF-16LE encoding,
+//                          terminated by NUL.
+//          hits        -   Array receiving the hits, in page and character
+//                          order. Can be NULL.
+//          max_hits    -   Number of elements in |hits|.
+// Return value:
+//          Total number of hits, which can be more than |max_hits|, or -1 if
+//          the index is not enabled.
+// Comments:
+//          Only whole words match, regardless of case. The words of a phrase
+//          must follow each other, with anything but letters and digits
+//          between them. Only indexed pages are searched.
+//
+DLLEXPORT int STDCALL FPDFText_FindInIndex(FPDF_DOCUMENT document,
+                                           FPDF_WIDESTRING query,
+                                           FPDF_TEXTHIT* hits,
+                                           int max_hits);
+
+// Function: FPDFText_SaveIndex
+//          Write the index of a document to a buffer.
+// Parameters:
+//          document    -   Handle to the document.
+//          buffer      -   Buffer receiving the index. Can be NULL.
+//          buflen      -   Size of |buffer| in bytes.
+// Return value:
+//          Size of the index in bytes, or 0 if the index is not enabled.
+//          |buffer| is only written if it is large enough.
+// Comments:
+//          The data can be stored next to the file and passed to
+//          FPDFText_LoadIndex when the same file is opened again.
+//
+DLLEXPORT unsigned long STDCALL FPDFText_SaveIndex(FPDF_DOCUMENT document,
+                                                   void* buffer,
+                                                   unsigned long buflen);
+
+// Function: FPDFText_LoadIndex
+//          Enable the index of a document with data from FPDFText_SaveIndex.
+// Parameters:
+//          document    -   Handle to the document.
+//          data        -   The index data.
+//          size        -   Size of |data| in bytes.
+// Return value:
+//          TRUE on success. FALSE if the data is malformed or was written
+//          for a different document, in which case the index is unchanged.
+// Comments:
+//          On success, the loaded index replaces any index built so far.
+//          Documents are told apart by their /ID, or by the layout of the
+//          file if they have none. Indexes of documents created with
+//          FPDF_CreateNewDocument cannot be loaded.
+//
+DLLEXPORT FPDF_BOOL STDCALL FPDFText_LoadIndex(FPDF_DOCUMENT document,
+                                               const void* data,
+                                               unsigned long size);
+
+// Flag for FPDFText_ExtractPages: also pass the box of every character.
+#define FPDF_TEXT_CHARBOXES 0x01
+
+// Interface receiving the text of the pages from FPDFText_ExtractPages.
+typedef struct _FPDF_TEXT_SINK {
+  // Version number of the interface. Currently must be 1.
+  int version;
+
+  // Method: OnPageText
+  //          Receive the text of one page.
+  // Interface Version:
+  //          1
+  // Implementation Required:
+  //          yes
+  // Parameters:
+  //          pThis       -   Pointer to the interface structure itself.
+  //          page_index  -   Zero-based index of the page.
+  //          text        -   The text of the page, in UTF-16LE encoding,
+  //                          terminated by NUL. The same as FPDFText_GetText
+  //                          gives for all its characters.
+  //          text_length -   Number of characters in |text|, not counting
+  //                          the terminating NUL.
+  //          char_boxes  -   The boxes of the characters in page space, as
+  //                          from FPDFText_GetCharBox, in character index
+  //                          order. NULL unless FPDF_TEXT_CHARBOXES is set.
+  //          char_count  -   Number of characters, as from
+  //                          FPDFText_CountChars.
+  // Return value:
+  //          Non-zero to go on with the next page, 0 to stop.
+  // Comments:
+  //          |text| and |char_boxes| are only valid during the call. Pages
+  //          that cannot be loaded are passed with no text.
+  //
+  FPDF_BOOL (*OnPageText)(struct _FPDF_TEXT_SINK* pThis,
+                          int page_index,
+                          FPDF_WIDESTRING text,
+                          int text_length,
+                          const FS_RECTF* char_boxes,
+                          int char_count);
+
+  // A user defined data pointer, used by user's application. Can be NULL.
+  void* user;
+} FPDF_TEXT_SINK;
+
+// Function: FPDFText_ExtractPages
+//          Extract the text of a range of pages.
+// Parameters:
+//          document    -   Handle to the document.
+//          start_index -   Zero-based index of the first page.
+//          count       -   Number of pages.
+//          flags       -   0 or FPDF_TEXT_CHARBOXES.
+//          sink        -   Receives the text of each page.
+// Return value:
+//          Number of pages passed to |sink|, or -1 if the arguments are
+//          invalid.
+// Comments:
+//          Gives the same text as loading each page with
+//          FPDFText_LoadTextOnlyPage and FPDFText_LoadPage, without the
+//          round trips. If the library was initialized with worker threads
+//          and multi-threading enabled, several pages are extracted at once
+//          on them. |sink| is always called on the calling thread, in page
+//          order, as soon as the pages before have been passed. If the
+//          document has an index (see FPDFText_EnableIndex), the pages are
+//          added to it.
+//
+DLLEXPORT int STDCALL FPDFText_ExtractPages(FPDF_DOCUMENT document,
+                                            int start_index,
+                                            int count,
+                                            int flags,
+                                            FPDF_TEXT_SINK* sink);
+
 // Function: FPDFLink_LoadWebLinks
 //          Prepare information about weblinks in a page.
 // Parameters:
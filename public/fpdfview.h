@@ -36,6 +36,7 @@ typedef void* FPDF_PAGE;
 typedef void* FPDF_PAGELINK;
 typedef void* FPDF_PAGEOBJECT;  // Page object(text, path, etc)
 typedef void* FPDF_PAGERANGE;
+typedef void* FPDF_PAGETILES;
 typedef void* FPDF_PATH;
 typedef void* FPDF_RECORDER;
 typedef void* FPDF_SCHHANDLE;
@@ -153,7 +154,7 @@ DLLEXPORT void STDCALL FPDF_InitLibrary();
 
 // Process-wide options for initializing the library.
 typedef struct FPDF_LIBRARY_CONFIG_ {
-  // Version number of the interface. Currently must be 2.
+  // Version number of the interface. Currently must be 2 to 9.
   int version;
 
   // Array of paths to scan in place of the defaults when using built-in
@@ -172,6 +173,86 @@ typedef struct FPDF_LIBRARY_CONFIG_ {
   // v8::Internals::kNumIsolateDataLots (exclusive). Note that 0 is fine
   // for most embedders.
   unsigned int m_v8EmbedderSlot;
+
+  // Version 3.
+
+  // Non-zero to make the library safe for loading and rendering different pages
+  // of the same document from several threads at once. In this mode,
+  // FPDF_LoadPage(), FPDF_RenderPageBitmap(), FPDF_RenderPageBitmapWithMatrix()
+  // and FPDF_ClosePage() may be called concurrently as long as no two threads
+  // use the same FPDF_PAGE, and FPDF_RenderPageTile() may be called
+  // concurrently even for the same FPDF_PAGETILES. The document-wide font,
+  // color space, pattern and image caches are then shared between threads.
+  // Content parsing and glyph loading are serialized per document;
+  // rasterization runs in parallel. Every other call, including
+  // FPDF_CloseDocument(), still requires that no other thread is using the
+  // document. When a custom FPDF_FILEACCESS is used, its m_GetBlock callback
+  // must itself be safe to call from any thread.
+  int m_bEnableMultiThreading;
+
+  // Version 4.
+
+  // Number of worker threads the library may start for work it can split
+  // up internally, such as decoding object streams. 0 starts none.
+  unsigned int m_nWorkerThreads;
+
+  // Non-zero to decode all compressed object streams of a document on the
+  // worker threads while it is being loaded, rather than one at a time when
+  // first needed. Has no effect without worker threads.
+  int m_bPrefetchObjectStreams;
+
+  // Upper bound, in bytes, on the decoded object stream data each document
+  // keeps for later lookups. When non-zero, streams whose objects have all
+  // been parsed are dropped, as are the least recently used ones beyond the
+  // bound; they are decoded again if needed. 0 keeps every decoded stream
+  // until the document is closed.
+  unsigned int m_nObjectStreamCacheLimit;
+
+  // Version 5.
+
+  // Non-zero to allocate the objects parsed from each document in large
+  // blocks that are freed together when the document is closed, instead of
+  // one at a time. Speeds up loading and closing documents with very many
+  // objects.
+  int m_bUseObjectArena;
+
+  // Version 6.
+
+  // Upper bound, in bytes, on the decoded JBIG2 symbol dictionaries each
+  // document keeps, so that a JBIG2Globals stream shared by many images is
+  // not decoded again for each of them. The least recently used
+  // dictionaries are released beyond the bound, but the most recent one is
+  // kept even if it is larger. 0 keeps the default of 8 MB. See
+  // FPDF_GetJBig2CacheStats() for sizing it.
+  unsigned int m_nJBig2SymbolCacheLimit;
+
+  // Version 7.
+
+  // Upper bound, in bytes, on the rendered glyph bitmaps kept for drawing
+  // text, across all fonts of all documents. The least recently used
+  // glyphs are released beyond the bound. 0 keeps the default of 32 MB.
+  // See FPDF_GetGlyphCacheStats() for sizing it.
+  unsigned int m_nGlyphCacheLimit;
+
+  // Version 8.
+
+  // Upper bound, in bytes, on the embedded font programs whose faces are
+  // shared between documents. When set, fonts embedded with the same font
+  // program in many documents are parsed once, and share their rendered
+  // glyphs. Faces no longer in use are kept within the bound for the next
+  // documents, the least recently used going first. 0, the default, loads
+  // embedded fonts for each document on their own.
+  // See FPDF_GetEmbeddedFontCacheStats() for sizing it.
+  unsigned int m_nEmbeddedFontCacheLimit;
+
+  // Version 9.
+
+  // Path to a font index file, as written by FPDF_BuildSystemFontIndex(),
+  // or NULL. When set, the fonts in the system font directories are taken
+  // from the index, and only the font files that are not in it, or changed
+  // since, are read. The index is brought up to date when it is out of date
+  // or missing, if the file can be written. The string is copied.
+  const char* m_pFontIndexPath;
 } FPDF_LIBRARY_CONFIG;
 
 // Function: FPDF_InitLibraryWithConfig
@@ -634,6 +715,198 @@ DLLEXPORT void STDCALL FPDF_RenderPageBitmapWithMatrix(FPDF_BITMAP bitmap,
                                                        const FS_RECTF* clipping,
                                                        int flags);
 
+// Function: FPDF_LoadPageTiles
+//          Prepare a page for rendering in many small pieces.
+// Parameters:
+//          page        -   Handle to the page. Returned by FPDF_LoadPage
+// Return value:
+//          A handle to pass to FPDF_RenderPageTile(), or NULL on failure.
+// Comments:
+//          This builds an index of the bounding boxes of the page objects,
+//          so that rendering a tile only visits the objects that intersect
+//          it rather than every object on the page. The page must not be
+//          modified while the handle is open, and the handle must be closed
+//          with FPDF_ClosePageTiles() before the page is closed.
+DLLEXPORT FPDF_PAGETILES STDCALL FPDF_LoadPageTiles(FPDF_PAGE page);
+
+// Function: FPDF_RenderPageTile
+//          Render part of a page to a device independent bitmap.
+// Parameters:
+//          tiles       -   Handle returned by FPDF_LoadPageTiles().
+//          bitmap      -   Handle to the device independent bitmap (as the
+//                          output buffer), typically covering a small part
+//                          of the display area.
+//          start_x     -   Left pixel position of the display area in
+//                          bitmap coordinates.
+//          start_y     -   Top pixel position of the display area in bitmap
+//                          coordinates.
+//          size_x      -   Horizontal size (in pixels) for displaying the page.
+//          size_y      -   Vertical size (in pixels) for displaying the page.
+//          rotate      -   Page orientation, as for FPDF_RenderPageBitmap().
+//          flags       -   As for FPDF_RenderPageBitmap().
+// Return value:
+//          None.
+// Comments:
+//          The output is the same as that of FPDF_RenderPageBitmap() with the
+//          same arguments. With m_bEnableMultiThreading set at
+//          initialization, tiles may be rendered from several threads at
+//          once; images are then decoded once per concurrent renderer.
+DLLEXPORT void STDCALL FPDF_RenderPageTile(FPDF_PAGETILES tiles,
+                                           FPDF_BITMAP bitmap,
+                                           int start_x,
+                                           int start_y,
+                                           int size_x,
+                                           int size_y,
+                                           int rotate,
+                                           int flags);
+
+// Function: FPDF_ClosePageTiles
+//          Release a handle returned by FPDF_LoadPageTiles().
+// Parameters:
+//          tiles       -   Handle returned by FPDF_LoadPageTiles().
+// Return value:
+//          None.
+DLLEXPORT void STDCALL FPDF_ClosePageTiles(FPDF_PAGETILES tiles);
+
+// Function: FPDF_SetImageCacheSize
+//          Set the memory budget of the document-wide decoded image cache.
+// Parameters:
+//          document    -   Handle to the document.
+//          max_bytes   -   The most memory, in bytes, that decoded images
+//                          kept for reuse by later pages may take. 0, the
+//                          default, disables the cache.
+// Return value:
+//          None.
+// Comments:
+//          Each page normally decodes the images it draws for itself, so an
+//          image shown on every page, such as a logo, is decoded again for
+//          every page loaded. With a budget, decoded images are kept after
+//          their pages are closed and reused by other pages, and the least
+//          recently used ones are released to stay within the budget.
+//          Images are measured by the size of their pixels once decoded.
+//          An image in use by an open page is not in the cache, so a page
+//          drawing it at the same time decodes its own copy. Inline images,
+//          images larger than the budget and images whose color space
+//          depends on the page's resources are not kept.
+DLLEXPORT void STDCALL FPDF_SetImageCacheSize(FPDF_DOCUMENT document,
+                                              unsigned long max_bytes);
+
+// Statistics of the document-wide decoded image cache.
+typedef struct FPDF_IMAGECACHE_STATS_ {
+  // Images found in the cache.
+  unsigned long hits;
+  // Images decoded since they were not in the cache.
+  unsigned long misses;
+  // Images released to stay within the budget.
+  unsigned long evictions;
+  // Images in the cache, which excludes those in use by open pages, and
+  // the memory they take in bytes.
+  unsigned long images;
+  unsigned long bytes;
+  // The budget set with FPDF_SetImageCacheSize().
+  unsigned long max_bytes;
+} FPDF_IMAGECACHE_STATS;
+
+// Function: FPDF_GetImageCacheStats
+//          Get statistics of the document-wide decoded image cache.
+// Parameters:
+//          document    -   Handle to the document.
+//          stats       -   Receives the statistics.
+// Return value:
+//          TRUE on success, FALSE if |document| or |stats| is NULL.
+// Comments:
+//          Lookups are only counted while the cache is enabled.
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_GetImageCacheStats(FPDF_DOCUMENT document, FPDF_IMAGECACHE_STATS* stats);
+
+// Statistics of the JBIG2 symbol dictionary cache of a document.
+typedef struct FPDF_JBIG2CACHE_STATS_ {
+  // Dictionaries found in the cache.
+  unsigned long hits;
+  // Dictionaries decoded since they were not in the cache.
+  unsigned long misses;
+  // Dictionaries released to stay within the budget.
+  unsigned long evictions;
+  // Dictionaries in the cache, and the memory they take in bytes.
+  unsigned long dicts;
+  unsigned long bytes;
+  // The budget, see m_nJBig2SymbolCacheLimit in FPDF_LIBRARY_CONFIG.
+  unsigned long max_bytes;
+} FPDF_JBIG2CACHE_STATS;
+
+// Function: FPDF_GetJBig2CacheStats
+//          Get statistics of the JBIG2 symbol dictionary cache of a
+//          document.
+// Parameters:
+//          document    -   Handle to the document.
+//          stats       -   Receives the statistics.
+// Return value:
+//          TRUE on success, FALSE if |document| or |stats| is NULL.
+// Comments:
+//          Only dictionaries from JBIG2Globals streams are cached. Many
+//          evictions along with misses mean the budget is too small for the
+//          dictionaries the document shares between its images.
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_GetJBig2CacheStats(FPDF_DOCUMENT document, FPDF_JBIG2CACHE_STATS* stats);
+
+// Statistics of the process-wide glyph bitmap cache.
+typedef struct FPDF_GLYPHCACHE_STATS_ {
+  // Glyphs found in the cache. The hit rate is hits / (hits + misses).
+  unsigned long hits;
+  // Glyphs rendered since they were not in the cache.
+  unsigned long misses;
+  // Glyphs released to stay within the budget.
+  unsigned long evictions;
+  // Glyphs in the cache, and the memory they take in bytes.
+  unsigned long glyphs;
+  unsigned long bytes;
+  // The budget, see m_nGlyphCacheLimit in FPDF_LIBRARY_CONFIG.
+  unsigned long max_bytes;
+} FPDF_GLYPHCACHE_STATS;
+
+// Function: FPDF_GetGlyphCacheStats
+//          Get statistics of the glyph bitmap cache shared by all documents.
+// Parameters:
+//          stats       -   Receives the statistics.
+// Return value:
+//          TRUE on success, FALSE if |stats| is NULL.
+// Comments:
+//          The cache only holds glyphs of text drawn as bitmaps, not of
+//          text drawn as paths, e.g. at very large sizes. Many evictions
+//          along with a low hit rate mean the budget is too small for the
+//          fonts and sizes in use.
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_GetGlyphCacheStats(FPDF_GLYPHCACHE_STATS* stats);
+
+// Statistics of the cache of embedded font faces shared by all documents.
+typedef struct FPDF_EMBEDDEDFONTCACHE_STATS_ {
+  // Embedded fonts that found their font program in the cache.
+  unsigned long hits;
+  // Embedded fonts that did not, while the cache was enabled.
+  unsigned long misses;
+  // Faces released to stay within the budget.
+  unsigned long evictions;
+  // Faces in the cache, in use or not, and the bytes of their programs.
+  unsigned long faces;
+  unsigned long bytes;
+  // The budget, see m_nEmbeddedFontCacheLimit in FPDF_LIBRARY_CONFIG.
+  unsigned long max_bytes;
+} FPDF_EMBEDDEDFONTCACHE_STATS;
+
+// Function: FPDF_GetEmbeddedFontCacheStats
+//          Get statistics of the cache of embedded font faces shared by all
+//          documents.
+// Parameters:
+//          stats       -   Receives the statistics.
+// Return value:
+//          TRUE on success, FALSE if |stats| is NULL.
+// Comments:
+//          A font program that does not fit in the budget next to the
+//          faces in use is loaded for its document alone, and counts as a
+//          miss.
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_GetEmbeddedFontCacheStats(FPDF_EMBEDDEDFONTCACHE_STATS* stats);
+
 #ifdef _SKIA_SUPPORT_
 DLLEXPORT FPDF_RECORDER STDCALL FPDF_RenderPageSkp(FPDF_PAGE page,
                                                    int size_x,